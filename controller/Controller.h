@@ -18,7 +18,9 @@
 #ifndef CONTROLLER_CONTROLLER_H_
 #define CONTROLLER_CONTROLLER_H_
 
+#include <map>
 #include <memory>
+#include <string>
 
 #include "core/RepositoryFactory.h"
 #include "core/ConfigurationFactory.h"
@@ -162,6 +164,56 @@ int getJstacks(std::unique_ptr<org::apache::nifi::minifi::io::Socket> socket, st
   return 0;
 }
 
+/**
+ * Lists the provenance events matching the query.
+ * @param socket socket ptr
+ * @param arguments criteria of the query, see ProvenanceQuery::parse
+ */
+int getProvenance(std::unique_ptr<org::apache::nifi::minifi::io::Socket> socket, std::ostream &out, const std::map<std::string, std::string> &arguments) {
+  socket->initialize();
+  uint8_t op = org::apache::nifi::minifi::c2::Operation::DESCRIBE;
+  org::apache::nifi::minifi::io::BufferStream stream;
+  stream.write(&op, 1);
+  stream.write("provenance");
+  stream.write(gsl::narrow<uint16_t>(arguments.size()));
+  for (const auto &argument : arguments) {
+    stream.write(argument.first);
+    stream.write(argument.second);
+  }
+  if (org::apache::nifi::minifi::io::isError(socket->write(stream.getBuffer(), stream.size()))) {
+    return -1;
+  }
+  // read the response
+  uint8_t resp = 0;
+  socket->read(&resp, 1);
+  if (resp == org::apache::nifi::minifi::c2::Operation::DESCRIBE) {
+    std::string error;
+    socket->read(error);
+    if (!error.empty()) {
+      out << error << std::endl;
+      return 0;
+    }
+    uint64_t size = 0;
+    socket->read(size);
+    for (uint64_t i = 0; i < size; i++) {
+      org::apache::nifi::minifi::utils::Identifier event_id;
+      org::apache::nifi::minifi::utils::Identifier flow_file_uuid;
+      std::string event_type, component_id, component_type, details;
+      uint64_t event_time = 0;
+      socket->read(event_id);
+      socket->read(event_type);
+      socket->read(event_time);
+      socket->read(component_id);
+      socket->read(component_type);
+      socket->read(flow_file_uuid);
+      socket->read(details);
+      out << event_time << " " << event_type << " " << event_id.to_string() << " FlowFile " << flow_file_uuid.to_string()
+          << " by " << component_type << " " << component_id << (details.empty() ? "" : ": ") << details << std::endl;
+    }
+  }
+  return 0;
+}
+
 /**
  * Prints the connection size for the provided connection.
  * @param socket socket ptr
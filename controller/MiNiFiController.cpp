@@ -100,6 +100,8 @@ int main(int argc, char **argv) {
   ("updateflow", "Updates the flow of the agent using the provided flow file", cxxopts::value<std::string>())  //NOLINT
   ("getfull", "Reports a list of full connections")  //NOLINT
   ("jstack", "Returns backtraces from the agent")  //NOLINT
+  ("provenance", "Lists the provenance events matching all of the criteria: flowFileUuid=<uuid>, lineage=true, componentId=<id>, "
+      "startTime=<ms since epoch>, endTime=<ms since epoch>, maxResults=<count>", cxxopts::value<std::vector<std::string>>())  //NOLINT
   ("manifest", "Generates a manifest for the current binary")  //NOLINT
   ("noheaders", "Removes headers from output streams");
 
@@ -205,6 +207,21 @@ int main(int argc, char **argv) {
         std::cout << "Could not connect to remote host " << host << ":" << port << std::endl;
     }
 
+    if (result.count("provenance") > 0) {
+      std::map<std::string, std::string> arguments;
+      for (const auto& criterion : result["provenance"].as<std::vector<std::string>>()) {
+        const auto separator = criterion.find('=');
+        if (separator == std::string::npos) {
+          std::cout << "Invalid provenance criterion " << criterion << ", expected <name>=<value>" << std::endl;
+          exit(1);
+        }
+        arguments[criterion.substr(0, separator)] = criterion.substr(separator + 1);
+      }
+      auto socket = secure_context != nullptr ? stream_factory_->createSecureSocket(host, port, secure_context) : stream_factory_->createSocket(host, port);
+      if (getProvenance(std::move(socket), std::cout, arguments) < 0)
+        std::cout << "Could not connect to remote host " << host << ":" << port << std::endl;
+    }
+
     if (result.count("updateflow") > 0) {
       auto& flow_file = result["updateflow"].as<std::string>();
       auto socket = secure_context != nullptr ? stream_factory_->createSecureSocket(host, port, secure_context) : stream_factory_->createSocket(host, port);
@@ -0,0 +1,127 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "OpenMetricsPublisher.h"
+
+#include <utility>
+
+#include "core/Resource.h"
+#include "core/state/OpenMetrics.h"
+#include "utils/TimeUtil.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace extensions {
+namespace civetweb {
+
+bool OpenMetricsPublisher::Handler::handleGet(CivetServer* /*server*/, struct mg_connection* conn) {
+  std::shared_ptr<const std::string> response;
+  {
+    std::lock_guard<std::mutex> lock(response_mutex_);
+    response = response_;
+  }
+  mg_printf(conn, "HTTP/1.1 200 OK\r\nContent-Type: %s\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n", state::OPEN_METRICS_CONTENT_TYPE, response->size());
+  mg_write(conn, response->data(), response->size());
+  return true;
+}
+
+void OpenMetricsPublisher::Handler::setResponse(std::shared_ptr<const std::string> response) {
+  std::lock_guard<std::mutex> lock(response_mutex_);
+  response_ = std::move(response);
+}
+
+OpenMetricsPublisher::OpenMetricsPublisher(const std::string& name, const utils::Identifier& uuid)
+    : state::MetricsPublisher(name, uuid) {
+}
+
+OpenMetricsPublisher::~OpenMetricsPublisher() {
+  // the timer and the server threads call back into this object
+  if (refresh_timer_) {
+    refresh_timer_->stop();
+  }
+  if (server_) {
+    server_->close();
+  }
+}
+
+void OpenMetricsPublisher::initialize(const std::shared_ptr<Configure>& configuration) {
+  const auto port = configuration->get(Configure::nifi_metrics_publisher_port);
+  if (!port) {
+    throw Exception(GENERAL_EXCEPTION, std::string(Configure::nifi_metrics_publisher_port) + " is not set");
+  }
+  const auto refresh_interval = configuration->get(Configure::nifi_metrics_publisher_refresh_interval)
+      | utils::flatMap(utils::timeutils::StringToDuration<std::chrono::milliseconds>)
+      | utils::valueOrElse([] { return DEFAULT_REFRESH_INTERVAL; });
+
+  const std::vector<std::string> options{
+    "listening_ports", *port,
+    "num_threads", "2"
+  };
+  try {
+    server_ = std::make_unique<CivetServer>(options);
+  } catch (const CivetException& exception) {
+    throw Exception(GENERAL_EXCEPTION, std::string("Could not listen on port ") + *port + ": " + exception.what());
+  }
+  server_->addHandler(PATH, handler_);
+  logger_->log_info("Publishing metrics on port %d, path %s", getPort().value_or(0), PATH);
+
+  refresh_timer_ = std::make_unique<utils::CallBackTimer>(refresh_interval, [this] { refresh(); });
+  refresh_timer_->start();
+}
+
+void OpenMetricsPublisher::setMetricNodes(std::vector<std::shared_ptr<state::response::ResponseNode>> nodes) {
+  {
+    std::lock_guard<std::mutex> lock(nodes_mutex_);
+    nodes_ = std::move(nodes);
+  }
+  refresh();
+}
+
+void OpenMetricsPublisher::refresh() {
+  std::vector<state::PublishedMetric> metrics;
+  {
+    std::lock_guard<std::mutex> lock(nodes_mutex_);
+    for (const auto& node : nodes_) {
+      auto node_metrics = node->calculateMetrics();
+      metrics.insert(metrics.end(), std::make_move_iterator(node_metrics.begin()), std::make_move_iterator(node_metrics.end()));
+    }
+  }
+  handler_.setResponse(std::make_shared<const std::string>(state::serializeOpenMetrics(metrics)));
+}
+
+std::optional<int> OpenMetricsPublisher::getPort() const {
+  if (!server_) {
+    return std::nullopt;
+  }
+  const auto ports = server_->getListeningPorts();
+  if (ports.empty()) {
+    return std::nullopt;
+  }
+  return ports.front();
+}
+
+REGISTER_RESOURCE(OpenMetricsPublisher, "Serves the metrics of the agent in the OpenMetrics text format, to be scraped by Prometheus");
+
+}  // namespace civetweb
+}  // namespace extensions
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
@@ -0,0 +1,93 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "CivetServer.h"
+#include "core/logging/Logger.h"
+#include "core/logging/LoggerConfiguration.h"
+#include "core/state/MetricsPublisher.h"
+#include "utils/CallBackTimer.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace extensions {
+namespace civetweb {
+
+/**
+ * Purpose: Serves the metrics of the agent in the OpenMetrics text format on /metrics, to be scraped by Prometheus.
+ *
+ * The metrics are rendered on a timer, every nifi.metrics.publisher.refresh.interval, so that a scrape only
+ * copies the last rendering and does not touch the flow.
+ */
+class OpenMetricsPublisher : public state::MetricsPublisher {
+ public:
+  static constexpr const char* PATH = "/metrics";
+  static constexpr std::chrono::milliseconds DEFAULT_REFRESH_INTERVAL{1000};
+
+  explicit OpenMetricsPublisher(const std::string& name, const utils::Identifier& uuid = {});
+  ~OpenMetricsPublisher() override;
+
+  void initialize(const std::shared_ptr<Configure>& configuration) override;
+  void setMetricNodes(std::vector<std::shared_ptr<state::response::ResponseNode>> nodes) override;
+
+  /**
+   * Renders the metrics of the current nodes for the following scrapes.
+   */
+  void refresh();
+
+  /**
+   * Returns the port the endpoint listens on, which is only known after initialize if the configured port is 0.
+   */
+  std::optional<int> getPort() const;
+
+ private:
+  class Handler : public CivetHandler {
+   public:
+    bool handleGet(CivetServer* server, struct mg_connection* conn) override;
+
+    void setResponse(std::shared_ptr<const std::string> response);
+
+   private:
+    std::mutex response_mutex_;
+    std::shared_ptr<const std::string> response_ = std::make_shared<const std::string>();
+  };
+
+  std::mutex nodes_mutex_;
+  std::vector<std::shared_ptr<state::response::ResponseNode>> nodes_;
+
+  Handler handler_;
+  std::unique_ptr<CivetServer> server_;
+  std::unique_ptr<utils::CallBackTimer> refresh_timer_;
+  std::shared_ptr<core::logging::Logger> logger_ = core::logging::LoggerFactory<OpenMetricsPublisher>::getLogger();
+};
+
+}  // namespace civetweb
+}  // namespace extensions
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
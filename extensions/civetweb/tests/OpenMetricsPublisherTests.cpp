@@ -0,0 +1,85 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <memory>
+#include <string>
+
+#include "TestBase.h"
+#include "client/HTTPClient.h"
+#include "core/repository/VolatileContentRepository.h"
+#include "core/state/OpenMetrics.h"
+#include "core/state/nodes/QueueMetrics.h"
+#include "metrics/OpenMetricsPublisher.h"
+#include "properties/Configure.h"
+#include "FlowFileRecord.h"
+#include "unit/ProvenanceTestHelper.h"
+
+using minifi::extensions::civetweb::OpenMetricsPublisher;
+
+namespace {
+
+std::string scrape(int port) {
+  utils::HTTPClient client;
+  client.initialize("GET", "http://localhost:" + std::to_string(port) + OpenMetricsPublisher::PATH);
+  REQUIRE(client.submit());
+  REQUIRE(200 == client.getResponseCode());
+  REQUIRE(minifi::state::OPEN_METRICS_CONTENT_TYPE == client.getHeaderValue("Content-Type"));
+  const auto& body = client.getResponseBody();
+  return std::string(body.begin(), body.end());
+}
+
+}  // namespace
+
+TEST_CASE("The publisher needs a port", "[openmetricspublisher]") {
+  OpenMetricsPublisher publisher("OpenMetricsPublisher");
+  REQUIRE_THROWS(publisher.initialize(std::make_shared<minifi::Configure>()));
+}
+
+TEST_CASE("The published metrics can be scraped", "[openmetricspublisher]") {
+  auto configuration = std::make_shared<minifi::Configure>();
+  configuration->set(minifi::Configure::nifi_metrics_publisher_port, "0");
+  // the test refreshes explicitly
+  configuration->set(minifi::Configure::nifi_metrics_publisher_refresh_interval, "1 h");
+
+  OpenMetricsPublisher publisher("OpenMetricsPublisher");
+  publisher.initialize(configuration);
+  const auto port = publisher.getPort();
+  REQUIRE(port);
+  REQUIRE("# EOF\n" == scrape(*port));
+
+  std::shared_ptr<core::ContentRepository> content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+  content_repo->initialize(configuration);
+  std::shared_ptr<core::Repository> repo = std::make_shared<TestRepository>();
+  auto connection = std::make_shared<minifi::Connection>(repo, content_repo, "testconnection");
+  auto queue_metrics = std::make_shared<minifi::state::response::QueueMetrics>();
+  queue_metrics->addConnection(connection);
+  publisher.setMetricNodes({queue_metrics});
+
+  const std::string queued_bytes = "minifi_connection_queued_bytes{connection_name=\"testconnection\",connection_uuid=\"" + connection->getUUIDStr() + "\"} ";
+  REQUIRE(scrape(*port).find(queued_bytes + "0\n") != std::string::npos);
+
+  auto flow_file = std::make_shared<minifi::FlowFileRecord>();
+  flow_file->setSize(10);
+  connection->put(flow_file);
+  // the scrapes are served from the last rendering
+  REQUIRE(scrape(*port).find(queued_bytes + "0\n") != std::string::npos);
+  publisher.refresh();
+  REQUIRE(scrape(*port).find(queued_bytes + "10\n") != std::string::npos);
+
+  publisher.setMetricNodes({});
+  REQUIRE("# EOF\n" == scrape(*port));
+}
@@ -23,6 +23,8 @@
 #include <algorithm>
 #include <regex>
 #include <functional>
+#include <iterator>
+#include <memory>
 #include <string>
 
 #include "rapidjson/reader.h"
@@ -91,19 +93,7 @@ Expression make_dynamic(const std::function<Value(const Parameters &params, cons
 }
 
 Expression make_dynamic_attr(const std::string &attribute_id) {
-  return make_dynamic([attribute_id](const Parameters &params, const std::vector<Expression>& /*sub_exprs*/) -> Value {
-    std::string result;
-    const auto cur_flow_file = params.flow_file.lock();
-    if (cur_flow_file && cur_flow_file->getAttribute(attribute_id, result)) {
-      return Value(result);
-    } else {
-      auto registry = params.registry_.lock();
-      if (registry && registry->getConfigurationProperty(attribute_id , result)) {
-        return Value(result);
-      }
-    }
-    return Value();
-  });
+  return Expression(Program::attribute(attribute_id));
 }
 
 Value resolve_user_id(const std::vector<Value> &args) {
@@ -791,16 +781,14 @@ Value expr_replace(const std::vector<Value> &args) {
   return Value(result);
 }
 
-Value expr_replaceFirst(const std::vector<Value> &args) {
+Value expr_replaceFirst(const std::vector<Value> &args, const std::regex &find) {
   std::string result = args[0].asString();
-  const std::regex find(args[1].asString());
   const std::string &replace = args[2].asString();
   return Value(std::regex_replace(result, find, replace, std::regex_constants::format_first_only));
 }
 
-Value expr_replaceAll(const std::vector<Value> &args) {
+Value expr_replaceAll(const std::vector<Value> &args, const std::regex &find) {
   std::string result = args[0].asString();
-  const std::regex find(args[1].asString());
   const std::string &replace = args[2].asString();
   return Value(std::regex_replace(result, find, replace));
 }
@@ -815,25 +803,47 @@ Value expr_replaceNull(const std::vector<Value> &args) {
 
 Value expr_replaceEmpty(const std::vector<Value> &args) {
   std::string result = args[0].asString();
-  const std::regex find("^[ \n\r\t]*$");
+  static const std::regex find("^[ \n\r\t]*$");
   const std::string &replace = args[1].asString();
   return Value(std::regex_replace(result, find, replace));
 }
 
-Value expr_matches(const std::vector<Value> &args) {
+Value expr_matches(const std::vector<Value> &args, const std::regex &expr) {
   const auto &subject = args[0].asString();
-  const std::regex expr = std::regex(args[1].asString());
 
   return Value(std::regex_match(subject.begin(), subject.end(), expr));
 }
 
-Value expr_find(const std::vector<Value> &args) {
+Value expr_find(const std::vector<Value> &args, const std::regex &expr) {
   const auto &subject = args[0].asString();
-  const std::regex expr = std::regex(args[1].asString());
 
   return Value(std::regex_search(subject.begin(), subject.end(), expr));
 }
 
+/**
+ * Evaluates a regex function whose pattern (the second argument) is only known at evaluation time.
+ */
+template<Value T(const std::vector<Value> &, const std::regex &)>
+Value expr_with_regex(const std::vector<Value> &args) {
+  return T(args, std::regex(args[1].asString()));
+}
+
+/**
+ * Compiles the pattern of a non-dynamic expression.
+ *
+ * @return nullptr if the pattern is dynamic or invalid, in which case it is compiled on evaluation
+ */
+std::shared_ptr<const std::regex> compile_static_regex(const Expression &pattern) {
+  if (pattern.is_dynamic()) {
+    return nullptr;
+  }
+  try {
+    return std::make_shared<const std::regex>(pattern(Parameters{}).asString());
+  } catch (const std::regex_error &) {
+    return nullptr;
+  }
+}
+
 #endif  // EXPRESSION_LANGUAGE_USE_REGEX
 
 Value expr_trim(const std::vector<Value> &args) {
@@ -943,13 +953,68 @@ Value expr_random(const std::vector<Value>& /*args*/) {
   return Value(distribution(generator));
 }
 
-template<Value T(const std::vector<Value> &)>
-Expression make_dynamic_function_incomplete(const std::string &function_name, const std::vector<Expression> &args, std::size_t num_args) {
+/**
+ * Whether the function returns the same value whenever it is called with the same arguments,
+ * so that calls with non-dynamic arguments can be evaluated at compile time.
+ */
+bool is_deterministic_function(const std::string &function_name) {
+  return function_name != "hostname" && function_name != "ip" && function_name != "UUID" && function_name != "random"
+      && function_name != "now" && function_name != "resolve_user_id";
+}
+
+/**
+ * Creates a call of fn with the results of the (non-multi) argument expressions. Calls with
+ * non-dynamic arguments are folded into constants, calls with compiled arguments are compiled
+ * into a program.
+ */
+Expression make_function_call(const std::string &function_name, const std::vector<Expression> &args, Program::Function fn) {
+  const bool all_args_static = std::none_of(args.begin(), args.end(), [](const Expression &arg) { return arg.is_dynamic(); });
+  if (all_args_static && is_deterministic_function(function_name)) {
+    std::vector<Value> evaluated_args;
+    for (const auto &arg : args) {
+      evaluated_args.emplace_back(arg(Parameters{}));
+    }
+    try {
+      return Expression(fn(evaluated_args));
+    } catch (const std::exception &) {
+      // leave reporting the error to the evaluation
+    }
+  }
+
+  std::vector<std::shared_ptr<const Program>> arg_programs;
+  for (const auto &arg : args) {
+    auto arg_program = arg.get_program();
+    if (!arg_program) {
+      break;
+    }
+    arg_programs.push_back(std::move(arg_program));
+  }
+  if (arg_programs.size() == args.size()) {
+    return Expression(Program::call(arg_programs, std::move(fn)));
+  }
+
+  return make_dynamic([args, fn](const Parameters &params, const std::vector<Expression>& /*sub_exprs*/) -> Value {
+    std::vector<Value> evaluated_args;
+
+    for (const auto &arg : args) {
+      evaluated_args.emplace_back(arg(params));
+    }
+
+    return fn(evaluated_args);
+  });
+}
+
+void check_arg_count(const std::string &function_name, const std::vector<Expression> &args, std::size_t num_args) {
   if (args.size() < num_args) {
     std::stringstream message_ss;
     message_ss << "Expression language function " << function_name << " called with " << args.size() << " argument(s), but " << num_args << " are required";
     throw std::runtime_error(message_ss.str());
   }
+}
+
+template<Value T(const std::vector<Value> &)>
+Expression make_dynamic_function_incomplete(const std::string &function_name, const std::vector<Expression> &args, std::size_t num_args) {
+  check_arg_count(function_name, args, num_args);
 
   if (!args.empty() && args[0].is_multi()) {
     std::vector<Expression> multi_args;
@@ -963,18 +1028,32 @@ Expression make_dynamic_function_incomplete(const std::string &function_name, co
     },
                                  multi_args);
   } else {
-    return make_dynamic([=](const Parameters &params, const std::vector<Expression>& /*sub_exprs*/) -> Value {
-      std::vector<Value> evaluated_args;
+    return make_function_call(function_name, args, T);
+  }
+}
 
-      for (const auto &arg : args) {
-        evaluated_args.emplace_back(arg(params));
-      }
+#ifdef EXPRESSION_LANGUAGE_USE_REGEX
 
-      return T(evaluated_args);
-    });
+/**
+ * Creates a regex function call, the pattern is compiled only once if it is not dynamic.
+ */
+template<Value T(const std::vector<Value> &, const std::regex &)>
+Expression make_regex_function(const std::string &function_name, const std::vector<Expression> &args, std::size_t num_args) {
+  check_arg_count(function_name, args, num_args);
+
+  if (args.size() > 1 && !args[0].is_multi()) {
+    if (const auto regex = compile_static_regex(args[1])) {
+      return make_function_call(function_name, args, [regex](const std::vector<Value> &args) -> Value {
+        return T(args, *regex);
+      });
+    }
   }
+
+  return make_dynamic_function_incomplete<expr_with_regex<T>>(function_name, args, num_args);
 }
 
+#endif  // EXPRESSION_LANGUAGE_USE_REGEX
+
 Value expr_literal(const std::vector<Value> &args) {
   return args[0];
 }
@@ -1180,11 +1259,14 @@ Expression make_allMatchingAttributes(const std::string &function_name, const st
     return Value(all_true);
   });
 
+  std::vector<std::shared_ptr<const std::regex>> static_regexes;
+  std::transform(args.begin(), args.end(), std::back_inserter(static_regexes), compile_static_regex);
+
   result.make_multi([=](const Parameters &params) -> std::vector<Expression> {
     std::vector<Expression> out_exprs;
 
-    for (const auto &arg : args) {
-      const std::regex attr_regex = std::regex(arg(params).asString());
+    for (std::size_t i = 0; i < args.size(); ++i) {
+      const auto attr_regex = static_regexes[i] ? static_regexes[i] : std::make_shared<const std::regex>(args[i](params).asString());
       const auto cur_flow_file = params.flow_file.lock();
       std::map<std::string, std::string> attrs;
 
@@ -1193,7 +1275,7 @@ Expression make_allMatchingAttributes(const std::string &function_name, const st
       }
 
       for (const auto &attr : attrs) {
-        if (std::regex_match(attr.first.begin(), attr.first.end(), attr_regex)) {
+        if (std::regex_match(attr.first.begin(), attr.first.end(), *attr_regex)) {
           out_exprs.emplace_back(make_dynamic([=](const Parameters& /*params*/,
                       const std::vector<Expression>& /*sub_exprs*/) -> Value {
                     std::string attr_val;
@@ -1233,11 +1315,14 @@ Expression make_anyMatchingAttribute(const std::string &function_name, const std
     return Value(any_true);
   });
 
+  std::vector<std::shared_ptr<const std::regex>> static_regexes;
+  std::transform(args.begin(), args.end(), std::back_inserter(static_regexes), compile_static_regex);
+
   result.make_multi([=](const Parameters &params) -> std::vector<Expression> {
     std::vector<Expression> out_exprs;
 
-    for (const auto &arg : args) {
-      const std::regex attr_regex = std::regex(arg(params).asString());
+    for (std::size_t i = 0; i < args.size(); ++i) {
+      const auto attr_regex = static_regexes[i] ? static_regexes[i] : std::make_shared<const std::regex>(args[i](params).asString());
       const auto cur_flow_file = params.flow_file.lock();
       std::map<std::string, std::string> attrs;
 
@@ -1246,7 +1331,7 @@ Expression make_anyMatchingAttribute(const std::string &function_name, const std
       }
 
       for (const auto &attr : attrs) {
-        if (std::regex_match(attr.first.begin(), attr.first.end(), attr_regex)) {
+        if (std::regex_match(attr.first.begin(), attr.first.end(), *attr_regex)) {
           out_exprs.emplace_back(make_dynamic([=](const Parameters& /*params*/,
                       const std::vector<Expression>& /*sub_exprs*/) -> Value {
                     std::string attr_val;
@@ -1460,17 +1545,17 @@ Expression make_dynamic_function(const std::string &function_name, const std::ve
   } else if (function_name == "replace") {
     return make_dynamic_function_incomplete<expr_replace>(function_name, args, 2);
   } else if (function_name == "replaceFirst") {
-    return make_dynamic_function_incomplete<expr_replaceFirst>(function_name, args, 2);
+    return make_regex_function<expr_replaceFirst>(function_name, args, 2);
   } else if (function_name == "replaceAll") {
-    return make_dynamic_function_incomplete<expr_replaceAll>(function_name, args, 2);
+    return make_regex_function<expr_replaceAll>(function_name, args, 2);
   } else if (function_name == "replaceNull") {
     return make_dynamic_function_incomplete<expr_replaceNull>(function_name, args, 1);
   } else if (function_name == "replaceEmpty") {
     return make_dynamic_function_incomplete<expr_replaceEmpty>(function_name, args, 1);
   } else if (function_name == "matches") {
-    return make_dynamic_function_incomplete<expr_matches>(function_name, args, 1);
+    return make_regex_function<expr_matches>(function_name, args, 1);
   } else if (function_name == "find") {
-    return make_dynamic_function_incomplete<expr_find>(function_name, args, 1);
+    return make_regex_function<expr_find>(function_name, args, 1);
   } else if (function_name == "allMatchingAttributes") {
     return make_allMatchingAttributes(function_name, args);
   } else if (function_name == "anyMatchingAttribute") {
@@ -1565,6 +1650,14 @@ Expression make_function_composition(const Expression &arg, const std::vector<st
   return expr;
 }
 
+Expression::Expression(Program program)
+    : Expression(Value()) {
+  program_ = std::make_shared<const Program>(std::move(program));
+  val_fn_ = [program = program_](const Parameters &params, const std::vector<Expression>& /*sub_exprs*/) -> Value {
+    return (*program)(params);
+  };
+}
+
 bool Expression::is_dynamic() const {
   if (val_fn_) {
     return true;
@@ -1574,6 +1667,14 @@ bool Expression::is_dynamic() const {
 }
 
 Expression Expression::operator+(const Expression &other_expr) const {
+  if (is_dynamic() || other_expr.is_dynamic()) {
+    const auto program = get_program();
+    const auto other_program = other_expr.get_program();
+    if (program && other_program) {
+      return Expression(Program::concat(*program, *other_program));
+    }
+  }
+
   if (is_dynamic() && other_expr.is_dynamic()) {
     auto val_fn = val_fn_;
     auto other_val_fn = other_expr.val_fn_;
@@ -1619,7 +1720,9 @@ Expression Expression::operator+(const Expression &other_expr) const {
 }
 
 Value Expression::operator()(const Parameters &params) const {
-  if (is_dynamic()) {
+  if (program_) {
+    return (*program_)(params);
+  } else if (is_dynamic()) {
     return val_fn_(params, sub_expr_generator_(params));
   } else {
     return val_;
@@ -1655,6 +1758,16 @@ Expression Expression::compose_multi(const std::function<Value(const std::vector
   return result;
 }
 
+std::shared_ptr<const Program> Expression::get_program() const {
+  if (program_) {
+    return program_;
+  } else if (!is_dynamic()) {
+    return std::make_shared<const Program>(Program::constant(val_));
+  } else {
+    return nullptr;
+  }
+}
+
 Expression Expression::make_aggregate(std::function<Value(const Parameters &params, const std::vector<Expression> &sub_exprs)> val_fn) const {
   auto sub_expr_generator = sub_expr_generator_;
   return make_dynamic([sub_expr_generator,
@@ -18,6 +18,7 @@
 #include "ProcessContextExpr.h"
 #include <memory>
 #include <string>
+#include <utility>
 
 namespace org {
 namespace apache {
@@ -29,38 +30,116 @@ bool ProcessContextExpr::getProperty(const Property &property, std::string &valu
   if (!property.supportsExpressionLangauge()) {
     return ProcessContext::getProperty(property.getName(), value);
   }
-  auto name = property.getName();
-  if (expressions_.find(name) == expressions_.end()) {
-    std::string expression_str;
-    if (!ProcessContext::getProperty(name, expression_str)) {
-      return false;
-    }
-    logger_->log_debug("Compiling expression for %s/%s: %s", getProcessorNode()->getName(), name, expression_str);
-    expressions_.emplace(name, expression::compile(expression_str));
-    expression_strs_.insert_or_assign(name, expression_str);
+  const auto compiled = getExpression(property.getName(), false);
+  if (!compiled) {
+    return false;
   }
-
-  minifi::expression::Parameters p(shared_from_this(), flow_file);
-  value = expressions_[name](p).asString();
-  logger_->log_debug(R"(expression "%s" of property "%s" evaluated to: %s)", expression_strs_[name], name, value);
-  return true;
+  return evaluate(*compiled, value, flow_file);
 }
 
 bool ProcessContextExpr::getDynamicProperty(const Property &property, std::string &value, const std::shared_ptr<FlowFile> &flow_file) {
   if (!property.supportsExpressionLangauge()) {
     return ProcessContext::getDynamicProperty(property.getName(), value);
   }
-  auto name = property.getName();
-  if (dynamic_property_expressions_.find(name) == dynamic_property_expressions_.end()) {
+  return evaluate(*getExpression(property.getName(), true), value, flow_file);
+}
+
+PropertyHandle ProcessContextExpr::getPropertyHandle(const Property &property) {
+  if (property.supportsExpressionLangauge()) {
+    const auto it = property_indexes_.find(property.getName());
+    if (it != property_indexes_.end()) {
+      return PropertyHandle(property, false, this, it->second);
+    }
+  }
+  return ProcessContext::getPropertyHandle(property);
+}
+
+PropertyHandle ProcessContextExpr::getDynamicPropertyHandle(const Property &property) {
+  if (property.supportsExpressionLangauge()) {
+    const auto it = dynamic_property_indexes_.find(property.getName());
+    if (it != dynamic_property_indexes_.end()) {
+      return PropertyHandle(property, true, this, it->second);
+    }
+  }
+  return ProcessContext::getDynamicPropertyHandle(property);
+}
+
+bool ProcessContextExpr::getProperty(const PropertyHandle &handle, std::string &value, const std::shared_ptr<FlowFile> &flow_file) {
+  if (handle.isResolvedBy(this) && handle.getIndex() < expressions_.size()) {
+    return evaluate(expressions_[handle.getIndex()], value, flow_file);
+  }
+  return ProcessContext::getProperty(handle, value, flow_file);
+}
+
+void ProcessContextExpr::onSchedule() {
+  expressions_.clear();
+  property_indexes_.clear();
+  dynamic_property_indexes_.clear();
+  {
+    std::lock_guard<std::mutex> lock(late_expressions_mutex_);
+    late_expressions_.clear();
+    late_dynamic_property_expressions_.clear();
+  }
+
+  const auto &processor_node = getProcessorNode();
+  const auto try_compile = [this, &processor_node](const std::string &name, const std::string &expression_str, bool dynamic) {
+    try {
+      expressions_.push_back(compileExpression(name, expression_str, dynamic));
+      (dynamic ? dynamic_property_indexes_ : property_indexes_).emplace(name, expressions_.size() - 1);
+    } catch (const std::exception &e) {
+      // compiled again (and reported) when the property is evaluated
+      logger_->log_debug("Failed to compile expression for %s/%s: %s", processor_node->getName(), name, e.what());
+    }
+  };
+
+  for (const auto &property : processor_node->getProperties()) {
     std::string expression_str;
+    if (property.second.supportsExpressionLangauge() && ProcessContext::getProperty(property.first, expression_str)) {
+      try_compile(property.first, expression_str, false);
+    }
+  }
+  for (const auto &name : processor_node->getDynamicPropertyKeys()) {
+    std::string expression_str;
+    ProcessContext::getDynamicProperty(name, expression_str);
+    try_compile(name, expression_str, true);
+  }
+}
+
+ProcessContextExpr::CompiledExpression ProcessContextExpr::compileExpression(const std::string &name, std::string expression_str, bool dynamic) const {
+  logger_->log_debug("Compiling expression for %s/%s: %s", getProcessorNode()->getName(), name, expression_str);
+  auto expression = expression::compile(expression_str);
+  return CompiledExpression{name, std::move(expression_str), dynamic, std::move(expression)};
+}
+
+const ProcessContextExpr::CompiledExpression* ProcessContextExpr::getExpression(const std::string &name, bool dynamic) {
+  const auto &indexes = dynamic ? dynamic_property_indexes_ : property_indexes_;
+  const auto it = indexes.find(name);
+  if (it != indexes.end()) {
+    return &expressions_[it->second];
+  }
+
+  std::lock_guard<std::mutex> lock(late_expressions_mutex_);
+  auto &late_expressions = dynamic ? late_dynamic_property_expressions_ : late_expressions_;
+  const auto late_it = late_expressions.find(name);
+  if (late_it != late_expressions.end()) {
+    return &late_it->second;
+  }
+  std::string expression_str;
+  if (dynamic) {
     ProcessContext::getDynamicProperty(name, expression_str);
-    logger_->log_debug("Compiling expression for %s/%s: %s", getProcessorNode()->getName(), name, expression_str);
-    dynamic_property_expressions_.emplace(name, expression::compile(expression_str));
-    expression_strs_.insert_or_assign(name, expression_str);
+  } else if (!ProcessContext::getProperty(name, expression_str)) {
+    return nullptr;
+  }
+  return &late_expressions.emplace(name, compileExpression(name, std::move(expression_str), dynamic)).first->second;
+}
+
+bool ProcessContextExpr::evaluate(const CompiledExpression &compiled, std::string &value, const std::shared_ptr<FlowFile> &flow_file) {
+  minifi::expression::Parameters p(flow_file);
+  p.registry_ = weak_from_this();
+  value = compiled.expression(p).asString();
+  if (logger_->should_log(logging::LOG_LEVEL::debug)) {
+    logger_->log_debug(R"(expression "%s" of %sproperty "%s" evaluated to: %s)", compiled.expression_str, compiled.dynamic ? "dynamic " : "", compiled.property_name, value);
   }
-  minifi::expression::Parameters p(shared_from_this(), flow_file);
-  value = dynamic_property_expressions_[name](p).asString();
-  logger_->log_debug(R"(expression "%s" of dynamic property "%s" evaluated to: %s)", expression_strs_[name], name, value);
   return true;
 }
 
@@ -19,8 +19,10 @@
 
 #include <ProcessContext.h>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <string>
+#include <vector>
 #include "impl/expression/Expression.h"
 
 namespace org {
@@ -65,10 +67,44 @@ class ProcessContextExpr final : public core::ProcessContext {
 
   bool getDynamicProperty(const Property &property, std::string &value, const std::shared_ptr<FlowFile> &flow_file) override;
 
+  /**
+   * Compiles the expressions of the properties, these are evaluated without locking afterwards.
+   */
+  void onSchedule() override;
+
+  PropertyHandle getPropertyHandle(const Property &property) override;
+
+  PropertyHandle getDynamicPropertyHandle(const Property &property) override;
+
+  bool getProperty(const PropertyHandle &handle, std::string &value, const std::shared_ptr<FlowFile> &flow_file) override;
+
  private:
-  std::unordered_map<std::string, org::apache::nifi::minifi::expression::Expression> expressions_;
-  std::unordered_map<std::string, org::apache::nifi::minifi::expression::Expression> dynamic_property_expressions_;
-  std::unordered_map<std::string, std::string> expression_strs_;
+  struct CompiledExpression {
+    std::string property_name;
+    std::string expression_str;
+    bool dynamic;
+    org::apache::nifi::minifi::expression::Expression expression;
+  };
+
+  CompiledExpression compileExpression(const std::string &name, std::string expression_str, bool dynamic) const;
+
+  /**
+   * Looks up the compiled expression of a property, compiling it if it was not set when the
+   * processor was scheduled (or the context is used without scheduling).
+   * @return nullptr if the (non-dynamic) property is not set
+   */
+  const CompiledExpression* getExpression(const std::string &name, bool dynamic);
+
+  bool evaluate(const CompiledExpression &compiled, std::string &value, const std::shared_ptr<FlowFile> &flow_file);
+
+  std::vector<CompiledExpression> expressions_;
+  std::unordered_map<std::string, size_t> property_indexes_;
+  std::unordered_map<std::string, size_t> dynamic_property_indexes_;
+
+  std::mutex late_expressions_mutex_;
+  std::unordered_map<std::string, CompiledExpression> late_expressions_;
+  std::unordered_map<std::string, CompiledExpression> late_dynamic_property_expressions_;
+
   std::shared_ptr<logging::Logger> logger_;
 };
 
@@ -0,0 +1,186 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "expression/Program.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include "expression/Expression.h"
+#include "utils/gsl.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace expression {
+
+namespace {
+
+Value get_attribute(const std::shared_ptr<core::FlowFile> &flow_file, const Parameters &params, const std::string &attribute_id) {
+  std::string result;
+  if (flow_file && flow_file->getAttribute(attribute_id, result)) {
+    return Value(result);
+  }
+  const auto registry = params.registry_.lock();
+  if (registry && registry->getConfigurationProperty(attribute_id, result)) {
+    return Value(result);
+  }
+  return Value();
+}
+
+}  // namespace
+
+Program Program::constant(Value value) {
+  Program program;
+  program.constants_.push_back(std::move(value));
+  program.emit(OpCode::PUSH_CONSTANT, 0, 0);
+  return program;
+}
+
+Program Program::attribute(std::string attribute_id) {
+  Program program;
+  program.attribute_ids_.push_back(std::move(attribute_id));
+  program.emit(OpCode::PUSH_ATTRIBUTE, 0, 0);
+  return program;
+}
+
+Program Program::call(const std::vector<std::shared_ptr<const Program>> &args, Function fn) {
+  Program program;
+  for (const auto &arg : args) {
+    program.append(*arg);
+  }
+  program.functions_.push_back(std::move(fn));
+  program.emit(OpCode::CALL, program.functions_.size() - 1, args.size());
+  return program;
+}
+
+Program Program::concat(const Program &lhs, const Program &rhs) {
+  Program program;
+  size_t arg_count = 0;
+  if (!lhs.code_.empty() && lhs.code_.back().op_code == OpCode::CONCAT) {
+    // continue the concatenation of lhs instead of nesting it
+    program = lhs;
+    arg_count = program.code_.back().arg_count;
+    program.code_.pop_back();
+    program.stack_size_ = arg_count;
+  } else if (!lhs.is_constant() || !lhs.constants_.front().asString().empty()) {
+    program.append(lhs);
+    arg_count = 1;
+  }
+
+  const bool last_operand_is_constant = arg_count > 0 && program.code_.back().op_code == OpCode::PUSH_CONSTANT;
+  if (rhs.is_constant() && last_operand_is_constant) {
+    auto &constant = program.constants_[program.code_.back().operand];
+    constant = Value(constant.asString().append(rhs.constants_.front().asString()));
+  } else if (!rhs.is_constant() || !rhs.constants_.front().asString().empty() || arg_count == 0) {
+    program.append(rhs);
+    ++arg_count;
+  }
+
+  program.emit(OpCode::CONCAT, 0, arg_count);
+  return program;
+}
+
+Value Program::operator()(const Parameters &params) const {
+  std::shared_ptr<core::FlowFile> flow_file;
+  if (!attribute_ids_.empty()) {
+    flow_file = params.flow_file.lock();
+  }
+
+  std::vector<Value> stack;
+  stack.reserve(max_stack_size_);
+  std::vector<Value> args;
+
+  for (const auto &instruction : code_) {
+    switch (instruction.op_code) {
+      case OpCode::PUSH_CONSTANT:
+        stack.push_back(constants_[instruction.operand]);
+        break;
+      case OpCode::PUSH_ATTRIBUTE:
+        stack.push_back(get_attribute(flow_file, params, attribute_ids_[instruction.operand]));
+        break;
+      case OpCode::CALL: {
+        const auto first_arg = std::prev(stack.end(), instruction.arg_count);
+        args.assign(std::make_move_iterator(first_arg), std::make_move_iterator(stack.end()));
+        stack.erase(first_arg, stack.end());
+        stack.push_back(functions_[instruction.operand](args));
+        break;
+      }
+      case OpCode::CONCAT: {
+        const auto first_arg = std::prev(stack.end(), instruction.arg_count);
+        std::string result;
+        for (auto it = first_arg; it != stack.end(); ++it) {
+          result.append(it->asString());
+        }
+        stack.erase(first_arg, stack.end());
+        stack.emplace_back(std::move(result));
+        break;
+      }
+    }
+  }
+
+  if (stack.empty()) {
+    return Value();
+  }
+  return std::move(stack.back());
+}
+
+bool Program::is_constant() const {
+  return code_.size() == 1 && code_.front().op_code == OpCode::PUSH_CONSTANT;
+}
+
+void Program::append(const Program &other) {
+  const auto constant_offset = constants_.size();
+  const auto attribute_offset = attribute_ids_.size();
+  const auto function_offset = functions_.size();
+  constants_.insert(constants_.end(), other.constants_.begin(), other.constants_.end());
+  attribute_ids_.insert(attribute_ids_.end(), other.attribute_ids_.begin(), other.attribute_ids_.end());
+  functions_.insert(functions_.end(), other.functions_.begin(), other.functions_.end());
+
+  for (auto instruction : other.code_) {
+    switch (instruction.op_code) {
+      case OpCode::PUSH_CONSTANT:
+        instruction.operand += gsl::narrow<uint32_t>(constant_offset);
+        break;
+      case OpCode::PUSH_ATTRIBUTE:
+        instruction.operand += gsl::narrow<uint32_t>(attribute_offset);
+        break;
+      case OpCode::CALL:
+        instruction.operand += gsl::narrow<uint32_t>(function_offset);
+        break;
+      case OpCode::CONCAT:
+        break;
+    }
+    code_.push_back(instruction);
+  }
+  max_stack_size_ = std::max(max_stack_size_, stack_size_ + other.max_stack_size_);
+  stack_size_ += other.stack_size_;
+}
+
+void Program::emit(OpCode op_code, size_t operand, size_t arg_count) {
+  code_.push_back(Instruction{op_code, gsl::narrow<uint32_t>(operand), gsl::narrow<uint32_t>(arg_count)});
+  stack_size_ = stack_size_ - arg_count + 1;
+  max_stack_size_ = std::max(max_stack_size_, stack_size_);
+}
+
+} /* namespace expression */
+} /* namespace minifi */
+} /* namespace nifi */
+} /* namespace apache */
+} /* namespace org */
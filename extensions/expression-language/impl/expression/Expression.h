@@ -33,6 +33,7 @@
 #include <vector>
 
 #include "common/Value.h"
+#include "expression/Program.h"
 #include "FlowFile.h"
 #include "VariableRegistry.h"
 
@@ -76,6 +77,11 @@ class Expression {
     sub_expr_generator_ = [](const Parameters& /*params*/) -> std::vector<Expression> {return {};};
   }
 
+  /**
+   * Creates a dynamic expression evaluated by running the given program.
+   */
+  explicit Expression(Program program);
+
   /**
    * Whether or not this expression is dynamic. If it is not dynamic, then
    * the expression can be computed at compile time when composed with other
@@ -130,12 +136,21 @@ class Expression {
 
   Expression make_aggregate(std::function<Value(const Parameters &params, const std::vector<Expression> &sub_exprs)> val_fn) const;
 
+  /**
+   * The program evaluating this expression, which is a single constant for non-dynamic
+   * expressions.
+   *
+   * @return nullptr if the expression depends on closures (e.g. multi-expressions)
+   */
+  std::shared_ptr<const Program> get_program() const;
+
  protected:
   Value val_;
   std::function<Value(const Parameters &params, const std::vector<Expression> &sub_exprs)> val_fn_;
   std::vector<Expression> fn_args_;
   std::function<std::vector<Expression>(const Parameters &params)> sub_expr_generator_;
   bool is_multi_;
+  std::shared_ptr<const Program> program_;
 };
 
 /**
@@ -0,0 +1,111 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/Value.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace expression {
+
+struct Parameters;
+
+/**
+ * Flat, postfix form of an expression built from constants, attribute references,
+ * function calls and concatenations. The instructions are executed on a value stack,
+ * so evaluating a program needs neither nested closures nor per call argument vectors.
+ *
+ * Multi-expressions (e.g. allAttributes) can't be compiled into a program, expressions
+ * depending on them are evaluated through their closures instead.
+ */
+class Program {
+ public:
+  using Function = std::function<Value(const std::vector<Value> &args)>;
+
+  /**
+   * Program pushing a single constant value.
+   */
+  static Program constant(Value value);
+
+  /**
+   * Program looking up a flow file attribute, falling back to the variable registry.
+   */
+  static Program attribute(std::string attribute_id);
+
+  /**
+   * Program calling fn with the results of the argument programs.
+   */
+  static Program call(const std::vector<std::shared_ptr<const Program>> &args, Function fn);
+
+  /**
+   * Program concatenating the string results of the two programs. Chained concatenations
+   * are merged into a single instruction, adjacent constants are merged into one.
+   */
+  static Program concat(const Program &lhs, const Program &rhs);
+
+  Value operator()(const Parameters &params) const;
+
+  bool is_constant() const;
+
+  /**
+   * Number of instructions in the program.
+   */
+  size_t size() const {
+    return code_.size();
+  }
+
+ private:
+  enum class OpCode : uint8_t {
+    PUSH_CONSTANT,
+    PUSH_ATTRIBUTE,
+    CALL,
+    CONCAT
+  };
+
+  struct Instruction {
+    OpCode op_code;
+    // index into constants_, attribute_ids_ or functions_
+    uint32_t operand;
+    // number of values popped by CALL and CONCAT
+    uint32_t arg_count;
+  };
+
+  void append(const Program &other);
+  void emit(OpCode op_code, size_t operand, size_t arg_count);
+
+  std::vector<Instruction> code_;
+  std::vector<Value> constants_;
+  std::vector<std::string> attribute_ids_;
+  std::vector<Function> functions_;
+  size_t stack_size_ = 0;
+  size_t max_stack_size_ = 0;
+};
+
+} /* namespace expression */
+} /* namespace minifi */
+} /* namespace nifi */
+} /* namespace apache */
+} /* namespace org */
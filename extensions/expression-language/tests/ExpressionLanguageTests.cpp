@@ -18,8 +18,11 @@
 
 #include <time.h>
 
+#include <chrono>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 #ifndef DISABLE_CURL
 #ifdef WIN32
 #pragma comment(lib, "libcurl.lib")
@@ -1566,3 +1569,73 @@ TEST_CASE("resolve_user_id_test", "[resolve_user_id tests]") {
 }
 }
 
+TEST_CASE("Constant sub-expressions are evaluated at compile time", "[expressionConstantFolding]") {
+  auto expr = expression::compile("${literal(2):plus(3)}");
+  REQUIRE_FALSE(expr.is_dynamic());
+  REQUIRE("5" == expr(expression::Parameters{ }).asString());
+
+  auto expr2 = expression::compile("${literal('abc'):toUpper():append(${attr})}_${attr:prepend(${literal('x'):append('y')})}");
+  REQUIRE(expr2.is_dynamic());
+  auto flow_file_a = std::make_shared<core::FlowFile>();
+  flow_file_a->addAttribute("attr", "def");
+  REQUIRE("ABCdef_xydef" == expr2(expression::Parameters{ flow_file_a }).asString());
+
+  auto uuid_expr = expression::compile("${UUID()}");
+  REQUIRE(uuid_expr.is_dynamic());
+  REQUIRE(uuid_expr(expression::Parameters{ }).asString() != uuid_expr(expression::Parameters{ }).asString());
+
+  // errors of constant calls are reported on evaluation, as for dynamic ones
+  auto invalid_expr = expression::compile("${literal(10):toRadix(1)}");
+  REQUIRE(invalid_expr.is_dynamic());
+  REQUIRE_THROWS(invalid_expr(expression::Parameters{ }));
+}
+
+#ifdef EXPRESSION_LANGUAGE_USE_REGEX
+
+TEST_CASE("Regex functions with constant and dynamic patterns", "[expressionRegexPatterns]") {
+  auto flow_file_a = std::make_shared<core::FlowFile>();
+  flow_file_a->addAttribute("attr", "abc.def");
+  flow_file_a->addAttribute("pattern", "[a-c]+\\..*");
+  flow_file_a->addAttribute("xyz_a", "hello");
+
+  REQUIRE("true" == expression::compile("${attr:matches('[a-c]+\\\\..*')}")(expression::Parameters{ flow_file_a }).asString());
+  REQUIRE("true" == expression::compile("${attr:matches(${pattern})}")(expression::Parameters{ flow_file_a }).asString());
+  REQUIRE("abc" == expression::compile("${attr:replaceAll('\\\\..*', '')}")(expression::Parameters{ flow_file_a }).asString());
+  REQUIRE("true" == expression::compile("${anyMatchingAttribute('xyz_.*', ${pattern}):contains('hello')}")(expression::Parameters{ flow_file_a }).asString());
+
+  // invalid constant patterns are reported on evaluation
+  auto invalid_expr = expression::compile("${attr:find('[a-c')}");
+  REQUIRE_THROWS(invalid_expr(expression::Parameters{ flow_file_a }));
+}
+
+#endif  // EXPRESSION_LANGUAGE_USE_REGEX
+
+TEST_CASE("Expression evaluation throughput", "[speed]") {
+  const std::vector<std::string> expressions = {
+    "text_before${attr}text_after",
+    "text_before${attr:substring(6, 8)}text_after",
+    "${attr:toUpper():append('_suffix')}",
+    "${attr:length():plus(${literal(2):multiply(3)})}",
+    "${attr:startsWith('__flow'):and(${attr:endsWith('a__')})}",
+    "${attr:replaceAll('\\\\..*', '')}",
+    "${attr:matches('.*_value_.*')}",
+    "${anyMatchingAttribute('att.*'):contains('value')}",
+  };
+  constexpr int evaluations = 10000;
+
+  auto flow_file = std::make_shared<core::FlowFile>();
+  flow_file->addAttribute("attr", "__flow_a_attr_value_a__");
+  const expression::Parameters params{ flow_file };
+
+  for (const auto &expr_str : expressions) {
+    auto expr = expression::compile(expr_str);
+    int non_null_results = 0;
+    const auto before = std::chrono::steady_clock::now();
+    for (int i = 0; i < evaluations; ++i) {
+      non_null_results += expr(params).isNull() ? 0 : 1;
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - before;
+    REQUIRE(non_null_results == evaluations);
+    std::cerr << expr_str << ": " << std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / evaluations << "ns per evaluation" << std::endl;
+  }
+}
@@ -0,0 +1,79 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "TestBase.h"
+#include "core/FlowFile.h"
+#include "core/PropertyHandle.h"
+#include "processors/UpdateAttribute.h"
+
+TEST_CASE("ProcessContextExpr evaluates the properties compiled when scheduled", "[ProcessContextExpr]") {
+  TestController test_controller;
+  auto plan = test_controller.createPlan();
+  auto update_attribute = plan->addProcessor("UpdateAttribute", "update_attribute");
+  plan->setProperty(update_attribute, "greeting", "hello ${name}", true);
+  auto context = plan->getProcessContextForProcessor(update_attribute);
+  context->onSchedule();
+
+  auto flow_file = std::make_shared<core::FlowFile>();
+  flow_file->setAttribute("name", "world");
+
+  const auto greeting = core::PropertyBuilder::createProperty("greeting")->supportsExpressionLanguage(true)->build();
+  const auto handle = context->getDynamicPropertyHandle(greeting);
+  REQUIRE(handle.isResolvedBy(context.get()));
+
+  std::string value;
+  REQUIRE(context->getProperty(handle, value, flow_file));
+  REQUIRE(value == "hello world");
+  REQUIRE(context->getDynamicProperty(greeting, value, flow_file));
+  REQUIRE(value == "hello world");
+
+  SECTION("Properties set after scheduling are compiled on first use") {
+    plan->setProperty(update_attribute, "farewell", "bye ${name}", true);
+    const auto farewell = core::PropertyBuilder::createProperty("farewell")->supportsExpressionLanguage(true)->build();
+    const auto late_handle = context->getDynamicPropertyHandle(farewell);
+    REQUIRE_FALSE(late_handle.isResolvedBy(context.get()));
+    REQUIRE(context->getProperty(late_handle, value, flow_file));
+    REQUIRE(value == "bye world");
+  }
+
+  SECTION("Handles can be evaluated concurrently") {
+    std::atomic<int> mismatches{0};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+      threads.emplace_back([&, i] {
+        auto thread_flow_file = std::make_shared<core::FlowFile>();
+        thread_flow_file->setAttribute("name", std::to_string(i));
+        for (int j = 0; j < 1000; ++j) {
+          std::string thread_value;
+          if (!context->getProperty(handle, thread_value, thread_flow_file) || thread_value != "hello " + std::to_string(i)) {
+            ++mismatches;
+          }
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    REQUIRE(mismatches == 0);
+  }
+}
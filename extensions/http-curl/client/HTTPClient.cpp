@@ -157,6 +157,22 @@ bool HTTPClient::setSpecificSSLVersion(SSLVersion specific_version) {
 #endif
 }
 
+bool HTTPClient::setHTTPVersion(HTTPVersion version) {
+  CURLcode ret = CURLE_UNKNOWN_OPTION;
+  switch (version) {
+    case HTTPVersion::HTTP_1_1:
+      ret = curl_easy_setopt(http_session_, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_1);
+      break;
+    case HTTPVersion::HTTP_2:
+      ret = curl_easy_setopt(http_session_, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+      break;
+  }
+  if (ret != CURLE_OK) {
+    logger_->log_debug("HTTP version is not supported by libcurl: %s", curl_easy_strerror(ret));
+  }
+  return ret == CURLE_OK;
+}
+
 // If not set, the default will be TLS 1.0, see https://curl.haxx.se/libcurl/c/CURLOPT_SSLVERSION.html
 bool HTTPClient::setMinimumSSLVersion(SSLVersion minimum_version) {
   CURLcode ret = CURLE_UNKNOWN_OPTION;
@@ -264,10 +280,17 @@ void HTTPClient::setUseChunkedEncoding() {
 }
 
 bool HTTPClient::submit() {
+  if (!prepareSubmit()) {
+    return false;
+  }
+  return finishSubmit(curl_easy_perform(http_session_));
+}
+
+bool HTTPClient::prepareSubmit() {
   if (IsNullOrEmpty(url_))
     return false;
 
-  int absoluteTimeout = std::max(0, 3 * static_cast<int>(read_timeout_ms_.count()));
+  int absoluteTimeout = static_cast<int>(getAbsoluteTimeout().count());
 
   curl_easy_setopt(http_session_, CURLOPT_NOSIGNAL, 1);
   // setting it to 0 will result in the default 300 second timeout
@@ -311,7 +334,11 @@ bool HTTPClient::submit() {
   if (form_ != nullptr) {
     curl_easy_setopt(http_session_, CURLOPT_MIMEPOST, form_);
   }
-  res = curl_easy_perform(http_session_);
+  return true;
+}
+
+bool HTTPClient::finishSubmit(CURLcode result) {
+  res = result;
   if (callback == nullptr) {
     read_callback_.close();
   }
@@ -320,7 +347,7 @@ bool HTTPClient::submit() {
   http_code_ = http_code;
   curl_easy_getinfo(http_session_, CURLINFO_CONTENT_TYPE, &content_type_str_);
   if (res == CURLE_OPERATION_TIMEDOUT) {
-    logger_->log_error("HTTP operation timed out, with absolute timeout %dms\n", absoluteTimeout);
+    logger_->log_error("HTTP operation timed out, with absolute timeout %dms\n", static_cast<int>(getAbsoluteTimeout().count()));
   }
   if (res != CURLE_OK) {
     logger_->log_error("curl_easy_perform() failed %s on %s, error code %d\n", curl_easy_strerror(res), url_, res);
@@ -41,6 +41,7 @@
 #include <vector>
 #include <memory>
 #include <map>
+#include <algorithm>
 #include <chrono>
 #include <string>
 #ifdef WIN32
@@ -60,6 +61,14 @@ namespace nifi {
 namespace minifi {
 namespace utils {
 
+class HTTPConnectionPool;
+
+enum class HTTPVersion : uint8_t {
+  HTTP_1_1,
+  // HTTP/2 over TLS negotiated with ALPN, falls back to HTTP/1.1 for unencrypted connections or servers without HTTP/2 support
+  HTTP_2,
+};
+
 /**
  * Purpose and Justification: Pull the basics for an HTTPClient into a self contained class. Simply provide
  * the URL and an SSLContextService ( can be null).
@@ -148,6 +157,11 @@ class HTTPClient : public BaseHTTPClient, public core::Connectable {
 
   bool setMinimumSSLVersion(SSLVersion minimum_version) override;
 
+  /**
+   * @return false if the requested version is not supported by the linked libcurl, in which case its default is used
+   */
+  bool setHTTPVersion(HTTPVersion version);
+
   DEPRECATED(/*deprecated in*/ 0.8.0, /*will remove in */ 2.0) void setKeepAliveProbe(long probe) {  // NOLINT deprecated
     keep_alive_probe_ = std::chrono::milliseconds(probe * 1000);
   }
@@ -239,6 +253,26 @@ class HTTPClient : public BaseHTTPClient, public core::Connectable {
   }
 
  private:
+  friend class HTTPConnectionPool;
+
+  /**
+   * Sets the options of the transfer, submit() is split into this and finishSubmit() so that the transfer can be
+   * performed either by curl_easy_perform or by a curl multi handle of an HTTPConnectionPool.
+   * @return false if the transfer cannot be started
+   */
+  bool prepareSubmit();
+
+  /**
+   * Collects the response of a finished transfer
+   * @param result result of the transfer
+   * @return true if the transfer succeeded
+   */
+  bool finishSubmit(CURLcode result);
+
+  std::chrono::milliseconds getAbsoluteTimeout() const {
+    return std::max(std::chrono::milliseconds{0}, 3 * read_timeout_ms_);
+  }
+
   static int onProgress(void *client, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow);
 
   struct Progress{
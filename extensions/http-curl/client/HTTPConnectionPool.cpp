@@ -0,0 +1,162 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "HTTPConnectionPool.h"
+
+#include <unordered_map>
+#include <utility>
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace utils {
+
+namespace {
+// upper limit of a single wait for socket activity, curl_multi_wait returns earlier if one of the transfers has a shorter timeout
+constexpr int MAX_WAIT_MS = 1000;
+}  // namespace
+
+HTTPConnectionPool::HTTPConnectionPool(size_t max_connections)
+    : max_connections_(max_connections),
+      share_(curl_share_init()) {
+  curl_share_setopt(share_, CURLSHOPT_LOCKFUNC, &HTTPConnectionPool::lockShare);
+  curl_share_setopt(share_, CURLSHOPT_UNLOCKFUNC, &HTTPConnectionPool::unlockShare);
+  curl_share_setopt(share_, CURLSHOPT_USERDATA, static_cast<void*>(this));
+  // the connection cache is not shared: curl does not support using the same connection from several threads
+  curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+  curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+}
+
+HTTPConnectionPool::~HTTPConnectionPool() {
+  idle_multi_handles_.clear();
+  curl_share_cleanup(share_);
+}
+
+void HTTPConnectionPool::lockShare(CURL* /*handle*/, curl_lock_data data, curl_lock_access /*access*/, void* pool) {
+  static_cast<HTTPConnectionPool*>(pool)->share_mutexes_.at(data).lock();
+}
+
+void HTTPConnectionPool::unlockShare(CURL* /*handle*/, curl_lock_data data, void* pool) {
+  static_cast<HTTPConnectionPool*>(pool)->share_mutexes_.at(data).unlock();
+}
+
+HTTPConnectionPool::MultiHandle HTTPConnectionPool::acquireMultiHandle() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!idle_multi_handles_.empty()) {
+      MultiHandle multi = std::move(idle_multi_handles_.back());
+      idle_multi_handles_.pop_back();
+      return multi;
+    }
+  }
+  MultiHandle multi{curl_multi_init()};
+#if CURL_AT_LEAST_VERSION(7, 43, 0)
+  curl_multi_setopt(multi.get(), CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+#endif
+  // by default the connection cache shrinks to 4 times the number of transfers, which might close the connections of an earlier larger batch
+  curl_multi_setopt(multi.get(), CURLMOPT_MAXCONNECTS, gsl::narrow<long>(max_connections_));  // NOLINT long due to libcurl API
+  return multi;
+}
+
+void HTTPConnectionPool::releaseMultiHandle(MultiHandle multi) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  idle_multi_handles_.push_back(std::move(multi));
+}
+
+std::vector<bool> HTTPConnectionPool::submit(gsl::span<HTTPClient* const> clients) {
+  std::vector<bool> results(clients.size(), false);
+  MultiHandle multi = acquireMultiHandle();
+  if (!multi) {
+    logger_->log_error("Failed to create curl multi handle");
+    return results;
+  }
+
+  std::unordered_map<CURL*, size_t> transfers;
+  const auto finish = [&](CURL* handle, CURLcode result) {
+    const size_t index = transfers.at(handle);
+    curl_multi_remove_handle(multi.get(), handle);
+    // the client may outlive the pool
+    curl_easy_setopt(handle, CURLOPT_SHARE, nullptr);
+    long new_connections = 0;  // NOLINT long due to libcurl API
+    if (curl_easy_getinfo(handle, CURLINFO_NUM_CONNECTS, &new_connections) == CURLE_OK && new_connections > 0) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      connection_count_ += gsl::narrow<size_t>(new_connections);
+    }
+    results[index] = clients[index]->finishSubmit(result);
+    transfers.erase(handle);
+  };
+
+  for (size_t i = 0; i < clients.size(); ++i) {
+    HTTPClient& client = *clients[i];
+    if (!client.prepareSubmit()) {
+      continue;
+    }
+    curl_easy_setopt(client.http_session_, CURLOPT_SHARE, share_);
+#if CURL_AT_LEAST_VERSION(7, 43, 0)
+    // prefer waiting for a connection which can be multiplexed over opening a new one
+    curl_easy_setopt(client.http_session_, CURLOPT_PIPEWAIT, 1L);
+#endif
+    if (curl_multi_add_handle(multi.get(), client.http_session_) != CURLM_OK) {
+      logger_->log_error("Failed to add the transfer of %s to the curl multi handle", client.getURL());
+      results[i] = client.finishSubmit(CURLE_FAILED_INIT);
+      continue;
+    }
+    transfers.emplace(client.http_session_, i);
+  }
+
+  while (!transfers.empty()) {
+    int running_transfers = 0;
+    CURLMcode multi_result = curl_multi_perform(multi.get(), &running_transfers);
+    if (multi_result == CURLM_OK) {
+      int queued_messages = 0;
+      while (CURLMsg* message = curl_multi_info_read(multi.get(), &queued_messages)) {
+        if (message->msg == CURLMSG_DONE) {
+          // the message is freed when the handle is removed
+          CURL* handle = message->easy_handle;
+          finish(handle, message->data.result);
+        }
+      }
+      if (transfers.empty()) {
+        break;
+      }
+      multi_result = curl_multi_wait(multi.get(), nullptr, 0, MAX_WAIT_MS, nullptr);
+    }
+    if (multi_result != CURLM_OK) {
+      logger_->log_error("curl multi handle failed: %s", curl_multi_strerror(multi_result));
+      while (!transfers.empty()) {
+        finish(transfers.begin()->first, CURLE_FAILED_INIT);
+      }
+      // the connections of a failed multi handle are not reused
+      return results;
+    }
+  }
+
+  releaseMultiHandle(std::move(multi));
+  return results;
+}
+
+size_t HTTPConnectionPool::getConnectionCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return connection_count_;
+}
+
+}  // namespace utils
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
@@ -0,0 +1,100 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <array>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "HTTPClient.h"
+#include "utils/gsl.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace utils {
+
+/**
+ * Performs the transfers of several HTTPClients concurrently on the calling thread.
+ *
+ * Each submit() borrows a curl multi handle, which keeps its connections open after the transfers finished, so
+ * later requests to the same host reuse them (and their TLS session) instead of connecting again. Transfers
+ * to a host supporting HTTP/2 are multiplexed over a single connection. The DNS cache and the TLS sessions are
+ * shared between all multi handles of the pool.
+ *
+ * A multi handle is only used by one thread at a time, the pool keeps as many of them as the number of
+ * threads calling submit() concurrently. As the TLS sessions are shared, a pool must only be used with a single
+ * SSL context.
+ */
+class HTTPConnectionPool {
+ public:
+  static constexpr size_t DEFAULT_MAX_CONNECTIONS = 16;
+
+  /**
+   * @param max_connections the number of connections kept open by each of the curl multi handles
+   */
+  explicit HTTPConnectionPool(size_t max_connections = DEFAULT_MAX_CONNECTIONS);
+  ~HTTPConnectionPool();
+
+  HTTPConnectionPool(const HTTPConnectionPool&) = delete;
+  HTTPConnectionPool& operator=(const HTTPConnectionPool&) = delete;
+
+  /**
+   * Performs the requests of the clients, which have to be set up the same way as before HTTPClient::submit().
+   * Blocks until all of the transfers finished.
+   * @return for each client, whether the transfer succeeded, the same as the return value of HTTPClient::submit()
+   */
+  std::vector<bool> submit(gsl::span<HTTPClient* const> clients);
+
+  /**
+   * @return the number of connections opened by the pool so far
+   */
+  size_t getConnectionCount() const;
+
+ private:
+  struct MultiHandleDeleter {
+    void operator()(CURLM* multi) const {
+      curl_multi_cleanup(multi);
+    }
+  };
+  using MultiHandle = std::unique_ptr<CURLM, MultiHandleDeleter>;
+
+  MultiHandle acquireMultiHandle();
+  void releaseMultiHandle(MultiHandle multi);
+
+  static void lockShare(CURL* handle, curl_lock_data data, curl_lock_access access, void* pool);
+  static void unlockShare(CURL* handle, curl_lock_data data, void* pool);
+
+  size_t max_connections_;
+  CURLSH* share_{nullptr};
+  std::array<std::mutex, CURL_LOCK_DATA_LAST> share_mutexes_;
+
+  mutable std::mutex mutex_;
+  std::vector<MultiHandle> idle_multi_handles_;
+  size_t connection_count_{0};
+
+  std::shared_ptr<core::logging::Logger> logger_{core::logging::LoggerFactory<HTTPConnectionPool>::getLogger()};
+};
+
+}  // namespace utils
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
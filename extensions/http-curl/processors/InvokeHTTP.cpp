@@ -22,6 +22,7 @@
 #else
 #include <regex.h>
 #endif
+#include <algorithm>
 #include <memory>
 #include <cinttypes>
 #include <cstdint>
@@ -38,6 +39,7 @@
 #include "io/StreamFactory.h"
 #include "ResourceClaim.h"
 #include "utils/gsl.h"
+#include "utils/ProcessorConfigUtils.h"
 #include "utils/StringUtils.h"
 
 namespace org {
@@ -114,6 +116,24 @@ core::Property InvokeHTTP::AlwaysOutputResponse("Always Output Response", "Will
                                                 "false");
 core::Property InvokeHTTP::PenalizeOnNoRetry("Penalize on \"No Retry\"", "Enabling this property will penalize FlowFiles that are routed to the \"No Retry\" relationship.", "false");
 
+core::Property InvokeHTTP::MaxRequestsInFlight(
+    core::PropertyBuilder::createProperty("Max Requests In Flight")
+      ->withDescription("The maximum number of FlowFiles sent concurrently by a single trigger of the processor. "
+                        "The connections are kept open between the triggers and are reused by the requests to the same host, "
+                        "requests to an HTTP/2 server are multiplexed over a single connection.")
+      ->isRequired(true)
+      ->withDefaultValue<uint64_t>(1)
+      ->build());
+
+core::Property InvokeHTTP::HttpVersion(
+    core::PropertyBuilder::createProperty("HTTP Version")
+      ->withDescription("The HTTP version to use. HTTP/2 is only used over TLS connections to servers supporting it, "
+                        "and if libcurl was built with HTTP/2 support, otherwise HTTP/1.1 is used.")
+      ->isRequired(true)
+      ->withDefaultValue(toString(HttpVersionOption::HTTP_2))
+      ->withAllowableValues(HttpVersionOption::values())
+      ->build());
+
 core::Property InvokeHTTP::DisablePeerVerification("Disable Peer Verification", "Disables peer verification for the SSL session", "false");
 const char* InvokeHTTP::STATUS_CODE = "invokehttp.status.code";
 const char* InvokeHTTP::STATUS_MESSAGE = "invokehttp.status.message";
@@ -165,6 +185,8 @@ void InvokeHTTP::initialize() {
   properties.insert(FollowRedirects);
   properties.insert(PropPutOutputAttributes);
   properties.insert(PenalizeOnNoRetry);
+  properties.insert(MaxRequestsInFlight);
+  properties.insert(HttpVersion);
 
   setSupportedProperties(properties);
   // Set the supported relationships
@@ -172,6 +194,13 @@ void InvokeHTTP::initialize() {
 }
 
 void InvokeHTTP::onSchedule(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSessionFactory>& /*sessionFactory*/) {
+  context->getProperty(MaxRequestsInFlight.getName(), max_requests_in_flight_);
+  if (max_requests_in_flight_ == 0) {
+    throw Exception(PROCESS_SCHEDULE_EXCEPTION, MaxRequestsInFlight.getName() + " must be at least 1");
+  }
+  http_version_ = utils::parseEnumProperty<HttpVersionOption>(*context, HttpVersion);
+  connection_pool_ = std::make_unique<utils::HTTPConnectionPool>(std::max<size_t>(max_requests_in_flight_, utils::HTTPConnectionPool::DEFAULT_MAX_CONNECTIONS));
+
   if (!context->getProperty(Method.getName(), method_)) {
     logger_->log_debug("%s attribute is missing, so default value of %s will be used", Method.getName(), Method.getValue());
     return;
@@ -271,39 +300,59 @@ bool InvokeHTTP::emitFlowFile(const std::string &method) {
 }
 
 void InvokeHTTP::onTrigger(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSession> &session) {
-  auto flowFile = session->get();
-
-  std::string url = url_;
+  std::vector<std::shared_ptr<core::FlowFile>> flow_files;
+  while (flow_files.size() < max_requests_in_flight_) {
+    auto flowFile = session->get();
+    if (flowFile == nullptr) {
+      break;
+    }
+    flow_files.push_back(flowFile);
+  }
 
-  if (flowFile == nullptr) {
+  if (flow_files.empty()) {
     if (!emitFlowFile(method_)) {
       logger_->log_debug("InvokeHTTP -- create flow file with  %s", method_);
-      flowFile = session->create();
+      flow_files.push_back(session->create());
     } else {
       logger_->log_debug("Exiting because method is %s and there is no flowfile available to execute it, yielding", method_);
       yield();
       return;
     }
   } else {
-    logger_->log_debug("InvokeHTTP -- Received flowfile");
+    logger_->log_debug("InvokeHTTP -- Received %zu flowfile(s)", flow_files.size());
   }
 
   logger_->log_debug("onTrigger InvokeHTTP with %s to %s", method_, url_);
 
-  // create a transaction id
-  std::string tx_id = generateId();
+  std::vector<Request> requests;
+  requests.reserve(flow_files.size());
+  std::vector<utils::HTTPClient*> clients;
+  clients.reserve(flow_files.size());
+  for (const auto& flowFile : flow_files) {
+    requests.push_back(createRequest(session, flowFile));
+    clients.push_back(requests.back().client.get());
+  }
 
-  // Note: callback must be declared before callbackObj so that they are destructed in the correct order
-  std::unique_ptr<utils::ByteInputCallBack> callback = nullptr;
-  std::unique_ptr<utils::HTTPUploadCallback> callbackObj = nullptr;
+  logger_->log_trace("InvokeHTTP -- curl performed");
+  const auto results = connection_pool_->submit(clients);
+  for (size_t i = 0; i < requests.size(); ++i) {
+    processResponse(requests[i], results[i], context, session);
+  }
+}
 
-  // Client declared after the callbacks to make sure the callbacks are still available when the client is destructed
-  utils::HTTPClient client(url_, ssl_context_service_);
+InvokeHTTP::Request InvokeHTTP::createRequest(const std::shared_ptr<core::ProcessSession> &session, const std::shared_ptr<core::FlowFile> &flowFile) {
+  Request request;
+  request.flow_file = flowFile;
+  // create a transaction id
+  request.tx_id = generateId();
+  request.client = std::make_unique<utils::HTTPClient>(url_, ssl_context_service_);
+  utils::HTTPClient& client = *request.client;
 
   client.initialize(method_);
   client.setConnectionTimeout(connect_timeout_ms_);
   client.setReadTimeout(read_timeout_ms_);
   client.setFollowRedirects(follow_redirects_);
+  client.setHTTPVersion(http_version_ == HttpVersionOption::HTTP_2 ? utils::HTTPVersion::HTTP_2 : utils::HTTPVersion::HTTP_1_1);
 
   if (send_body_ && !content_type_.empty()) {
     client.setContentType(content_type_);
@@ -324,21 +373,21 @@ void InvokeHTTP::onTrigger(const std::shared_ptr<core::ProcessContext> &context,
     logger_->log_trace("InvokeHTTP -- reading flowfile");
     std::shared_ptr<ResourceClaim> claim = flowFile->getResourceClaim();
     if (claim) {
-      callback = std::unique_ptr<utils::ByteInputCallBack>(new utils::ByteInputCallBack());
+      request.callback = std::unique_ptr<utils::ByteInputCallBack>(new utils::ByteInputCallBack());
       if (send_body_) {
-        session->read(flowFile, callback.get());
+        session->read(flowFile, request.callback.get());
       }
-      callbackObj = std::unique_ptr<utils::HTTPUploadCallback>(new utils::HTTPUploadCallback);
-      callbackObj->ptr = callback.get();
-      callbackObj->pos = 0;
-      logger_->log_trace("InvokeHTTP -- Setting callback, size is %d", callback->getBufferSize());
+      request.callback_obj = std::unique_ptr<utils::HTTPUploadCallback>(new utils::HTTPUploadCallback);
+      request.callback_obj->ptr = request.callback.get();
+      request.callback_obj->pos = 0;
+      logger_->log_trace("InvokeHTTP -- Setting callback, size is %d", request.callback->getBufferSize());
       if (!send_body_) {
         client.appendHeader("Content-Length", "0");
       } else if (!use_chunked_encoding_) {
         client.appendHeader("Content-Length", std::to_string(flowFile->getSize()));
       }
-      client.setUploadCallback(callbackObj.get());
-      client.setSeekFunction(callbackObj.get());
+      client.setUploadCallback(request.callback_obj.get());
+      client.setSeekFunction(request.callback_obj.get());
     } else {
       logger_->log_error("InvokeHTTP -- no resource claim");
     }
@@ -349,9 +398,15 @@ void InvokeHTTP::onTrigger(const std::shared_ptr<core::ProcessContext> &context,
 
   // append all headers
   client.build_header_list(attribute_to_send_regex_, flowFile->getAttributes());
+  return request;
+}
 
-  logger_->log_trace("InvokeHTTP -- curl performed");
-  if (client.submit()) {
+void InvokeHTTP::processResponse(Request &request, bool submitted, const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSession> &session) {
+  const std::shared_ptr<core::FlowFile>& flowFile = request.flow_file;
+  utils::HTTPClient& client = *request.client;
+  const std::string& tx_id = request.tx_id;
+
+  if (submitted) {
     logger_->log_trace("InvokeHTTP -- curl successful");
 
     bool putToAttribute = !IsNullOrEmpty(put_attribute_name_);
@@ -389,7 +444,7 @@ void InvokeHTTP::onTrigger(const std::shared_ptr<core::ProcessContext> &context,
       response_flow->addAttribute(STATUS_CODE, std::to_string(http_code));
       if (!response_headers.empty())
         response_flow->addAttribute(STATUS_MESSAGE, response_headers.at(0));
-      response_flow->addAttribute(REQUEST_URL, url);
+      response_flow->addAttribute(REQUEST_URL, url_);
       response_flow->addAttribute(TRANSACTION_ID, tx_id);
       io::BufferStream stream((const uint8_t*) response_body.data(), gsl::narrow<unsigned int>(response_body.size()));
       // need an import from the data stream.
@@ -21,6 +21,7 @@
 #include <curl/curl.h>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "FlowFileRecord.h"
 #include "core/Processor.h"
@@ -30,6 +31,8 @@
 #include "core/logging/LoggerConfiguration.h"
 #include "utils/Id.h"
 #include "../client/HTTPClient.h"
+#include "../client/HTTPConnectionPool.h"
+#include "utils/Enum.h"
 #include "utils/Export.h"
 
 namespace org {
@@ -78,6 +81,14 @@ class InvokeHTTP : public core::Processor {
 
   EXTENSIONAPI static core::Property PenalizeOnNoRetry;
 
+  EXTENSIONAPI static core::Property MaxRequestsInFlight;
+  EXTENSIONAPI static core::Property HttpVersion;
+
+  SMART_ENUM(HttpVersionOption,
+             (HTTP_1_1, "1.1"),
+             (HTTP_2, "2")
+  )
+
   EXTENSIONAPI static const char* STATUS_CODE;
   EXTENSIONAPI static const char* STATUS_MESSAGE;
   EXTENSIONAPI static const char* RESPONSE_BODY;
@@ -104,6 +115,28 @@ class InvokeHTTP : public core::Processor {
   }
 
  protected:
+  struct Request {
+    std::shared_ptr<core::FlowFile> flow_file;
+    std::string tx_id;
+    // Note: callback must be declared before callback_obj so that they are destructed in the correct order
+    std::unique_ptr<utils::ByteInputCallBack> callback;
+    std::unique_ptr<utils::HTTPUploadCallback> callback_obj;
+    // Client declared after the callbacks to make sure the callbacks are still available when the client is destructed
+    std::unique_ptr<utils::HTTPClient> client;
+  };
+
+  /**
+   * Sets up the client sending the flow file, reads the content of the flow file if it is to be sent.
+   */
+  Request createRequest(const std::shared_ptr<core::ProcessSession> &session, const std::shared_ptr<core::FlowFile> &flow_file);
+
+  /**
+   * Adds the response to the flow file and routes it
+   * @param request finished request
+   * @param submitted whether the request was completed
+   */
+  void processResponse(Request &request, bool submitted, const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSession> &session);
+
   /**
    * Generate a transaction ID
    * @return transaction ID string.
@@ -157,6 +190,11 @@ class InvokeHTTP : public core::Processor {
   utils::HTTPProxy proxy_;
   bool follow_redirects_{true};
   bool send_body_{true};
+  // number of flow files sent concurrently by a single trigger
+  uint64_t max_requests_in_flight_{1};
+  HttpVersionOption http_version_{HttpVersionOption::HTTP_2};
+  // keeps the connections open between triggers, created on schedule
+  std::unique_ptr<utils::HTTPConnectionPool> connection_pool_;
 
  private:
   std::shared_ptr<core::logging::Logger> logger_{core::logging::LoggerFactory<InvokeHTTP>::getLogger()};
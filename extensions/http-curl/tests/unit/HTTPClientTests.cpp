@@ -23,6 +23,7 @@
 #include <string>
 #include "TestBase.h"
 #include "client/HTTPClient.h"
+#include "client/HTTPConnectionPool.h"
 #include "CivetServer.h"
 
 TEST_CASE("HTTPClientTestChunkedResponse", "[basic]") {
@@ -94,3 +95,54 @@ TEST_CASE("HTTPClient escape test") {
   CHECK(client.escape("Hello Günter") == "Hello%20G%C3%BCnter");
   CHECK(client.escape("шеллы") == "%D1%88%D0%B5%D0%BB%D0%BB%D1%8B");
 }
+
+TEST_CASE("HTTPConnectionPool performs the requests concurrently and reuses the connections", "[HTTPConnectionPool]") {
+  class Responder : public CivetHandler {
+   public:
+    bool handleGet(CivetServer* /*server*/, struct mg_connection *conn) {
+      const std::string body = mg_get_request_info(conn)->local_uri;
+      mg_printf(conn, "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: %zu\r\n\r\n", body.size());
+      mg_write(conn, body.data(), body.size());
+      return true;
+    }
+  };
+
+  std::vector<std::string> options{"enable_keep_alive", "yes", "keep_alive_timeout_ms", "15000", "num_threads", "4", "listening_ports", "0"};
+  CivetServer server(options);
+  Responder responder;
+  server.addHandler("**", responder);
+  const std::string base_url = "http://localhost:" + std::to_string(server.getListeningPorts().at(0)) + "/";
+
+  utils::HTTPConnectionPool pool;
+  for (int round = 0; round < 3; ++round) {
+    std::vector<std::unique_ptr<utils::HTTPClient>> clients;
+    std::vector<utils::HTTPClient*> client_pointers;
+    for (int i = 0; i < 4; ++i) {
+      clients.push_back(std::make_unique<utils::HTTPClient>(base_url + std::to_string(i)));
+      clients.back()->initialize("GET");
+      client_pointers.push_back(clients.back().get());
+    }
+
+    const auto results = pool.submit(client_pointers);
+    REQUIRE(results.size() == 4);
+    for (int i = 0; i < 4; ++i) {
+      REQUIRE(results[i]);
+      REQUIRE(clients[i]->getResponseCode() == 200);
+      const auto& body = clients[i]->getResponseBody();
+      REQUIRE(std::string(body.begin(), body.end()) == "/" + std::to_string(i));
+    }
+  }
+  REQUIRE(pool.getConnectionCount() <= 4);
+}
+
+TEST_CASE("HTTPConnectionPool reports the failed transfers", "[HTTPConnectionPool]") {
+  utils::HTTPConnectionPool pool;
+  utils::HTTPClient unreachable_client("http://localhost:1/unreachable");
+  unreachable_client.initialize("GET");
+  utils::HTTPClient client_without_url;
+  client_without_url.initialize("GET");
+
+  const auto results = pool.submit(std::vector<utils::HTTPClient*>{&unreachable_client, &client_without_url});
+  REQUIRE(results == std::vector<bool>{false, false});
+  REQUIRE(unreachable_client.getResponseResult() != CURLE_OK);
+}
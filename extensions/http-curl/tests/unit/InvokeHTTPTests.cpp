@@ -16,11 +16,16 @@
  * limitations under the License.
  */
 
+#include <array>
+#include <chrono>
 #include <memory>
 #include <utility>
 #include <string>
+#include <vector>
 #include "io/BaseStream.h"
 #include "TestBase.h"
+#include "SingleInputTestController.h"
+#include "CivetServer.h"
 #include "core/Core.h"
 #include "HTTPClient.h"
 #include "InvokeHTTP.h"
@@ -288,3 +293,121 @@ TEST_CASE("HTTPTestsPutResponseBodyinAttribute", "[httptest1]") {
 
   REQUIRE(LogTestController::getInstance().contains("Adding http response body to flow file attribute http.type"));
 }
+
+namespace {
+class EchoResponder : public CivetHandler {
+ public:
+  bool handlePost(CivetServer* /*server*/, struct mg_connection *conn) {
+    std::string body;
+    std::array<char, 4096> buffer{};
+    int read = 0;
+    while ((read = mg_read(conn, buffer.data(), buffer.size())) > 0) {
+      body.append(buffer.data(), read);
+    }
+    mg_printf(conn, "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: %zu\r\n\r\n", body.size());
+    mg_write(conn, body.data(), body.size());
+    return true;
+  }
+};
+
+class EchoServer {
+ public:
+  explicit EchoServer(int thread_count)
+      : server_({"enable_keep_alive", "yes", "keep_alive_timeout_ms", "15000", "num_threads", std::to_string(thread_count), "listening_ports", "0"}) {
+    server_.addHandler("**", responder_);
+  }
+
+  std::string getURL() const {
+    return "http://localhost:" + std::to_string(server_.getListeningPorts().at(0)) + "/echo";
+  }
+
+ private:
+  CivetServer server_;
+  EchoResponder responder_;
+};
+
+// the properties are set after the processor is added to the controller, as it is initialized there
+void configureInvokeHTTP(minifi::processors::InvokeHTTP& invokehttp, const std::string& url, uint64_t max_requests_in_flight) {
+  using minifi::processors::InvokeHTTP;
+  invokehttp.setProperty(InvokeHTTP::Method, "POST");
+  invokehttp.setProperty(InvokeHTTP::URL, url);
+  invokehttp.setProperty(InvokeHTTP::MaxRequestsInFlight, std::to_string(max_requests_in_flight));
+}
+}  // namespace
+
+TEST_CASE("InvokeHTTP sends several flow files concurrently", "[httptest1]") {
+  using minifi::processors::InvokeHTTP;
+
+  EchoServer server(4);
+  const auto invokehttp = std::make_shared<InvokeHTTP>("InvokeHTTP");
+  minifi::test::SingleInputTestController controller{invokehttp};
+  configureInvokeHTTP(*invokehttp, server.getURL(), 4);
+
+  std::vector<std::string> contents;
+  std::vector<minifi::test::InputFlowFileData> input_flow_files;
+  for (int i = 0; i < 6; ++i) {
+    contents.push_back("flow file " + std::to_string(i));
+  }
+  for (int i = 0; i < 6; ++i) {
+    input_flow_files.push_back({contents[i], {{"index", std::to_string(i)}}});
+  }
+
+  auto result = controller.trigger(input_flow_files);
+  REQUIRE(result.at(InvokeHTTP::Success).size() == 4);
+  REQUIRE(result.at(InvokeHTTP::RelResponse).size() == 4);
+  REQUIRE(result.at(InvokeHTTP::RelFailure).empty());
+
+  const auto check_responses = [&](const std::vector<std::shared_ptr<core::FlowFile>>& responses) {
+    for (const auto& response : responses) {
+      REQUIRE(response->getAttribute(InvokeHTTP::STATUS_CODE) == "200");
+      const auto index = response->getAttribute("index");
+      REQUIRE(index);
+      REQUIRE(controller.plan->getContent(response) == "flow file " + *index);
+    }
+  };
+  check_responses(result.at(InvokeHTTP::RelResponse));
+
+  // the remaining flow files are sent by the next trigger
+  result = controller.trigger(std::vector<minifi::test::InputFlowFileData>{});
+  REQUIRE(result.at(InvokeHTTP::Success).size() == 2);
+  REQUIRE(result.at(InvokeHTTP::RelResponse).size() == 2);
+  check_responses(result.at(InvokeHTTP::RelResponse));
+}
+
+TEST_CASE("InvokeHTTP routes the unreachable requests in flight to failure", "[httptest1]") {
+  using minifi::processors::InvokeHTTP;
+
+  const auto invokehttp = std::make_shared<InvokeHTTP>("InvokeHTTP");
+  minifi::test::SingleInputTestController controller{invokehttp};
+  configureInvokeHTTP(*invokehttp, "http://localhost:1/unreachable", 2);
+
+  const auto result = controller.trigger({{"first"}, {"second"}});
+  REQUIRE(result.at(InvokeHTTP::RelFailure).size() == 2);
+  REQUIRE(result.at(InvokeHTTP::Success).empty());
+}
+
+TEST_CASE("InvokeHTTP throughput with requests in flight", "[httptest1][speed]") {
+  using minifi::processors::InvokeHTTP;
+
+  EchoServer server(16);
+  const std::string content(1024, 'x');
+  const size_t flow_file_count = 400;
+  for (uint64_t max_requests_in_flight : {1, 4, 16}) {
+    const auto invokehttp = std::make_shared<InvokeHTTP>("InvokeHTTP");
+    minifi::test::SingleInputTestController controller{invokehttp};
+    configureInvokeHTTP(*invokehttp, server.getURL(), max_requests_in_flight);
+
+    std::vector<minifi::test::InputFlowFileData> input_flow_files(flow_file_count, {content});
+    const auto start = std::chrono::steady_clock::now();
+    size_t sent = controller.trigger(input_flow_files).at(InvokeHTTP::Success).size();
+    while (sent < flow_file_count) {
+      const auto sent_by_trigger = controller.trigger(std::vector<minifi::test::InputFlowFileData>{}).at(InvokeHTTP::Success).size();
+      REQUIRE(sent_by_trigger > 0);
+      sent += sent_by_trigger;
+    }
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+    std::cerr << "Sending " << flow_file_count << " flow files with " << max_requests_in_flight << " request(s) in flight took " << elapsed.count() << "ms, "
+              << (elapsed.count() == 0 ? 0 : flow_file_count * 1000 / elapsed.count()) << " requests/s" << std::endl;
+  }
+}
@@ -19,6 +19,7 @@
  */
 #include "BinFiles.h"
 #include <stdio.h>
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <vector>
@@ -141,63 +142,137 @@ void BinFiles::preprocessFlowFile(core::ProcessContext* /*context*/, core::Proce
   }
 }
 
-void BinManager::gatherReadyBins() {
-  std::lock_guard < std::mutex > lock(mutex_);
-  std::vector< std::string > emptyQueue;
-  for (std::map<std::string, std::unique_ptr<std::deque<std::unique_ptr<Bin>>> >::iterator it=groupBinMap_.begin(); it !=groupBinMap_.end(); ++it) {
-    std::unique_ptr < std::deque<std::unique_ptr<Bin>>>&queue = it->second;
-    while (!queue->empty()) {
-      std::unique_ptr<Bin> &bin = queue->front();
-      if (bin->isReadyForMerge() || (binAge_ != std::chrono::milliseconds::max() && bin->isOlderThan(binAge_))) {
-        readyBin_.push_back(std::move(bin));
-        queue->pop_front();
-        binCount_--;
-        logger_->log_debug("BinManager move bin %s to ready bins for group %s", readyBin_.back()->getUUIDStr(), readyBin_.back()->getGroupId());
-      } else {
-        break;
+void BinManager::purge() {
+  for (auto &shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.groupBinMap.clear();
+    shard.offeredGroups.clear();
+    shard.binDates.clear();
+    shard.binCount = 0;
+  }
+  binCount_ = 0;
+}
+
+const BinManager::BinDate* BinManager::getOldestBinDate(Shard &shard) {
+  while (!shard.binDates.empty()) {
+    const BinDate &oldest = shard.binDates.front();
+    auto it = shard.groupBinMap.find(oldest.group);
+    // the bins of a group are removed from the front, so the date is still in use, if it is not older than the front bin of the group
+    if (it != shard.groupBinMap.end() && !it->second.empty() && it->second.front()->getCreationDate() <= oldest.creation_date) {
+      return &oldest;
+    }
+    std::pop_heap(shard.binDates.begin(), shard.binDates.end());
+    shard.binDates.pop_back();
+  }
+  return nullptr;
+}
+
+void BinManager::addBin(Shard &shard, std::deque<std::unique_ptr<Bin>> &queue, std::unique_ptr<Bin> bin) {
+  shard.binDates.push_back(BinDate{bin->getCreationDate(), bin->getGroupId()});
+  std::push_heap(shard.binDates.begin(), shard.binDates.end());
+  queue.push_back(std::move(bin));
+  ++shard.binCount;
+  ++binCount_;
+  logger_->log_debug("BinManager add bin %s to group %s", queue.back()->getUUIDStr(), queue.back()->getGroupId());
+  if (shard.binDates.size() > 2 * shard.binCount) {
+    // too many dates of removed bins are kept, as they are only dropped when they get to the front of the heap
+    shard.binDates.clear();
+    for (const auto &group : shard.groupBinMap) {
+      for (const auto &group_bin : group.second) {
+        shard.binDates.push_back(BinDate{group_bin->getCreationDate(), group.first});
       }
     }
-    if (queue->empty()) {
-      emptyQueue.push_back(it->first);
+    std::make_heap(shard.binDates.begin(), shard.binDates.end());
+  }
+}
+
+void BinManager::addReadyBin(Shard &shard, std::deque<std::unique_ptr<Bin>> &queue, const std::string &group) {
+  std::lock_guard<std::mutex> lock(readyBinMutex_);
+  readyBin_.push_back(std::move(queue.front()));
+  queue.pop_front();
+  --shard.binCount;
+  --binCount_;
+  logger_->log_debug("BinManager move bin %s to ready bins for group %s", readyBin_.back()->getUUIDStr(), group);
+}
+
+void BinManager::gatherReadyBins(Shard &shard, const std::string &group) {
+  auto it = shard.groupBinMap.find(group);
+  if (it == shard.groupBinMap.end()) {
+    return;
+  }
+  auto &queue = it->second;
+  while (!queue.empty()) {
+    std::unique_ptr<Bin> &bin = queue.front();
+    if (bin->isReadyForMerge() || (binAge_ != std::chrono::milliseconds::max() && bin->isOlderThan(binAge_))) {
+      addReadyBin(shard, queue, group);
+    } else {
+      break;
     }
   }
-  for (auto group : emptyQueue) {
+  if (queue.empty()) {
     // erase from the map if the queue is empty for the group
-    groupBinMap_.erase(group);
+    shard.groupBinMap.erase(it);
   }
-  logger_->log_debug("BinManager groupBinMap size %d", groupBinMap_.size());
+}
+
+void BinManager::gatherReadyBins() {
+  const auto now = std::chrono::system_clock::now();
+  for (auto &shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    // only the offers can make a bin ready for merge
+    for (const auto &group : shard.offeredGroups) {
+      gatherReadyBins(shard, group);
+    }
+    shard.offeredGroups.clear();
+    if (binAge_ == std::chrono::milliseconds::max()) {
+      continue;
+    }
+    while (const BinDate* oldest = getOldestBinDate(shard)) {
+      if (now <= oldest->creation_date + binAge_) {
+        break;
+      }
+      const std::string group = oldest->group;
+      std::pop_heap(shard.binDates.begin(), shard.binDates.end());
+      shard.binDates.pop_back();
+      gatherReadyBins(shard, group);
+    }
+  }
+  logger_->log_debug("BinManager bin count %d", getBinCount());
 }
 
 void BinManager::removeOldestBin() {
-  std::lock_guard < std::mutex > lock(mutex_);
+  Shard* oldestShard = nullptr;
   std::chrono::system_clock::time_point olddate = std::chrono::system_clock::time_point::max();
-  std::unique_ptr < std::deque<std::unique_ptr<Bin>>>* oldqueue;
-  for (std::map<std::string, std::unique_ptr<std::deque<std::unique_ptr<Bin>>>>::iterator it=groupBinMap_.begin(); it !=groupBinMap_.end(); ++it) {
-    std::unique_ptr < std::deque<std::unique_ptr<Bin>>>&queue = it->second;
-    if (!queue->empty()) {
-      std::unique_ptr<Bin> &bin = queue->front();
-      if (bin->getCreationDate() < olddate) {
-        olddate = bin->getCreationDate();
-        oldqueue = &queue;
-      }
+  for (auto &shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    const BinDate* oldest = getOldestBinDate(shard);
+    if (oldest && oldest->creation_date < olddate) {
+      olddate = oldest->creation_date;
+      oldestShard = &shard;
     }
   }
-  if (olddate != std::chrono::system_clock::time_point::max()) {
-    std::unique_ptr<Bin> &remove = (*oldqueue)->front();
-    std::string group = remove->getGroupId();
-    readyBin_.push_back(std::move(remove));
-    (*oldqueue)->pop_front();
-    binCount_--;
-    logger_->log_debug("BinManager move bin %s to ready bins for group %s", readyBin_.back()->getUUIDStr(), readyBin_.back()->getGroupId());
-    if ((*oldqueue)->empty()) {
-      groupBinMap_.erase(group);
+  if (oldestShard) {
+    std::lock_guard<std::mutex> lock(oldestShard->mutex);
+    // the shard may have changed since it was checked, but its oldest bin is still among the oldest ones
+    if (const BinDate* oldest = getOldestBinDate(*oldestShard)) {
+      const std::string group = oldest->group;
+      std::pop_heap(oldestShard->binDates.begin(), oldestShard->binDates.end());
+      oldestShard->binDates.pop_back();
+      auto it = oldestShard->groupBinMap.find(group);
+      addReadyBin(*oldestShard, it->second, group);
+      if (it->second.empty()) {
+        oldestShard->groupBinMap.erase(it);
+      } else {
+        // the next bin of the group may be ready for merge already
+        oldestShard->offeredGroups.insert(group);
+      }
     }
   }
-  logger_->log_debug("BinManager groupBinMap size %d", groupBinMap_.size());
+  logger_->log_debug("BinManager bin count %d", getBinCount());
 }
 
 void BinManager::getReadyBin(std::deque<std::unique_ptr<Bin>> &retBins) {
-  std::lock_guard < std::mutex > lock(mutex_);
+  std::lock_guard<std::mutex> lock(readyBinMutex_);
   while (!readyBin_.empty()) {
     std::unique_ptr<Bin> &bin = readyBin_.front();
     retBins.push_back(std::move(bin));
@@ -205,48 +280,70 @@ void BinManager::getReadyBin(std::deque<std::unique_ptr<Bin>> &retBins) {
   }
 }
 
-bool BinManager::offer(const std::string &group, std::shared_ptr<core::FlowFile> flow) {
-  std::lock_guard < std::mutex > lock(mutex_);
+void Bin::ContentReservation::append(core::ProcessSession* session, const std::shared_ptr<core::FlowFile>& flow) {
+  std::unique_lock<std::mutex> lock(state_->mutex);
+  state_->appended.wait(lock, [this] { return state_->appended_count == index_; });
+  const auto guard = gsl::finally([this] {
+    ++state_->appended_count;
+    state_->appended.notify_all();
+  });
+  if (!state_->content) {
+    return;
+  }
+  bool appended = false;
+  try {
+    appended = session && state_->content->append(*session, flow);
+  } catch (...) {
+  }
+  if (!appended) {
+    core::logging::LoggerFactory<Bin>::getLogger()->log_warn(
+        "Could not append the content of flow file %s to its bin, the content of the bin will be built when it is complete", flow->getUUIDStr());
+    state_->content.reset();
+  }
+}
+
+std::unique_ptr<Bin> BinManager::createBin(const std::string &group) {
+  auto bin = std::make_unique<Bin>(minSize_, maxSize_, minEntries_, maxEntries_, fileCount_, group);
+  std::lock_guard<std::mutex> lock(factoryMutex_);
+  if (contentFactory_) {
+    bin->setContent(contentFactory_());
+  }
+  return bin;
+}
+
+bool BinManager::offer(const std::string &group, std::shared_ptr<core::FlowFile> flow, core::ProcessSession* session) {
   if (flow->getSize() > maxSize_) {
     // could not be added to a bin -- too large by itself, so create a separate bin for just this guy.
     std::unique_ptr<Bin> bin = std::unique_ptr < Bin > (new Bin(0, ULLONG_MAX, 1, INT_MAX, "", group));
     if (!bin->offer(flow))
       return false;
+    std::lock_guard<std::mutex> lock(readyBinMutex_);
     readyBin_.push_back(std::move(bin));
     logger_->log_debug("BinManager move bin %s to ready bins for group %s", readyBin_.back()->getUUIDStr(), group);
     return true;
   }
-  auto search = groupBinMap_.find(group);
-  if (search != groupBinMap_.end()) {
-    std::unique_ptr < std::deque<std::unique_ptr<Bin>>>&queue = search->second;
-    if (!queue->empty()) {
-      std::unique_ptr<Bin> &tail = queue->back();
-      if (!tail->offer(flow)) {
-        // last bin can not offer the flow
-        std::unique_ptr<Bin> bin = std::unique_ptr < Bin > (new Bin(minSize_, maxSize_, minEntries_, maxEntries_, fileCount_, group));
-        if (!bin->offer(flow))
-          return false;
-        queue->push_back(std::move(bin));
-        logger_->log_debug("BinManager add bin %s to group %s", queue->back()->getUUIDStr(), group);
-        binCount_++;
-      }
-    } else {
-      std::unique_ptr<Bin> bin = std::unique_ptr < Bin > (new Bin(minSize_, maxSize_, minEntries_, maxEntries_, fileCount_, group));
-      if (!bin->offer(flow))
+  std::optional<Bin::ContentReservation> reservation;
+  {
+    Shard &shard = getShard(group);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto &queue = shard.groupBinMap[group];
+    if (queue.empty() || !queue.back()->offer(flow)) {
+      // last bin can not offer the flow
+      std::unique_ptr<Bin> bin = createBin(group);
+      if (!bin->offer(flow)) {
+        if (queue.empty()) {
+          shard.groupBinMap.erase(group);
+        }
         return false;
-      queue->push_back(std::move(bin));
-      binCount_++;
-      logger_->log_debug("BinManager add bin %s to group %s", queue->back()->getUUIDStr(), group);
+      }
+      addBin(shard, queue, std::move(bin));
     }
-  } else {
-    std::unique_ptr<std::deque<std::unique_ptr<Bin>>> queue = std::unique_ptr<std::deque<std::unique_ptr<Bin>>> (new std::deque<std::unique_ptr<Bin>>());
-    std::unique_ptr<Bin> bin = std::unique_ptr < Bin > (new Bin(minSize_, maxSize_, minEntries_, maxEntries_, fileCount_, group));
-    if (!bin->offer(flow))
-      return false;
-    queue->push_back(std::move(bin));
-    logger_->log_debug("BinManager add bin %s to group %s", queue->back()->getUUIDStr(), group);
-    groupBinMap_.insert(std::make_pair(group, std::move(queue)));
-    binCount_++;
+    reservation = queue.back()->reserveContent();
+    shard.offeredGroups.insert(group);
+  }
+  // the content is appended without holding the lock, so the other flow files of the shard can be binned meanwhile
+  if (reservation) {
+    reservation->append(session, flow);
   }
 
   return true;
@@ -261,7 +358,7 @@ void BinFiles::onTrigger(const std::shared_ptr<core::ProcessContext> &context, c
     bool hadFailure = false;
     for (auto &file : flowFiles) {
       std::string groupId = getGroupId(context.get(), file);
-      bool offer = this->binManager_.offer(groupId, file);
+      bool offer = this->binManager_.offer(groupId, file, session.get());
       if (!offer) {
         session->transfer(file, Failure);
         hadFailure = true;
@@ -285,7 +382,7 @@ void BinFiles::onTrigger(const std::shared_ptr<core::ProcessContext> &context, c
     preprocessFlowFile(context.get(), session.get(), flow);
     std::string groupId = getGroupId(context.get(), flow);
 
-    bool offer = this->binManager_.offer(groupId, flow);
+    bool offer = this->binManager_.offer(groupId, flow, session.get());
     if (!offer) {
       session->transfer(flow, Failure);
       context->yield();
@@ -19,14 +19,23 @@
  */
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <cinttypes>
+#include <condition_variable>
+#include <functional>
 #include <limits>
 #include <deque>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
 #include <unordered_set>
 #include <string>
 #include <set>
 #include <map>
+#include <utility>
+#include <vector>
 #include "FlowFileRecord.h"
 #include "core/Processor.h"
 #include "core/ProcessSession.h"
@@ -42,12 +51,53 @@ namespace nifi {
 namespace minifi {
 namespace processors {
 
+// Content of a bin, which is built while the flow files are offered to the bin, instead of when the bin is complete
+class BinContent {
+ public:
+  virtual ~BinContent() = default;
+  // appends the content of the flow file offered to the bin, returns false if the content could not be appended
+  virtual bool append(core::ProcessSession& session, const std::shared_ptr<core::FlowFile>& flow) = 0;
+};
+
 // Bin Class
 class Bin {
+ private:
+  struct ContentState {
+    explicit ContentState(std::unique_ptr<BinContent> content)
+        : content(std::move(content)) {
+    }
+
+    std::mutex mutex;
+    std::condition_variable appended;
+    // reset when appending to it fails
+    std::unique_ptr<BinContent> content;
+    uint64_t reserved_count{0};
+    uint64_t appended_count{0};
+  };
+
  public:
+  // The place of a flow file in the content of the bin. It is reserved under the lock of the bin manager, and the content of the
+  // flow file is appended after the lock is released, in the order of the reservations.
+  class ContentReservation {
+   public:
+    // waits for the earlier reservations to be appended, then appends the content of the flow file using the session
+    void append(core::ProcessSession* session, const std::shared_ptr<core::FlowFile>& flow);
+
+   private:
+    friend class Bin;
+
+    ContentReservation(std::shared_ptr<ContentState> state, uint64_t index)
+        : state_(std::move(state)),
+          index_(index) {
+    }
+
+    std::shared_ptr<ContentState> state_;
+    uint64_t index_;
+  };
+
   // Constructor
   /*!
-   * Create a new Bin. Note: this object is not thread safe
+   * Create a new Bin. Note: this object is not thread safe, except for appending to its content through the reservations
    */
   explicit Bin(const uint64_t &minSize, const uint64_t &maxSize, const size_t &minEntries, const size_t & maxEntries, const std::string &fileCount, const std::string &groupId)
       : minSize_(minSize),
@@ -79,7 +129,7 @@ class Bin {
   std::deque<std::shared_ptr<core::FlowFile>>& getFlowFile() {
     return queue_;
   }
-  // offer the flowfile to the bin
+  // offer the flowfile to the bin, if the bin has content, the place of the flowfile in it has to be reserved right after
   bool offer(std::shared_ptr<core::FlowFile> flow) {
     if (!fileCount_.empty()) {
       std::string value;
@@ -103,6 +153,14 @@ class Bin {
 
     return true;
   }
+  // reserves the place of the last offered flowfile in the content of the bin, returns nothing if the bin has no content
+  std::optional<ContentReservation> reserveContent() {
+    if (!content_) {
+      return std::nullopt;
+    }
+    std::lock_guard<std::mutex> lock(content_->mutex);
+    return ContentReservation(content_, content_->reserved_count++);
+  }
   // getBinAge
   [[nodiscard]] std::chrono::system_clock::time_point getCreationDate() const {
     return creation_dated_;
@@ -119,6 +177,22 @@ class Bin {
     return groupId_;
   }
 
+  // the content must be set before the first flow file is offered to the bin
+  void setContent(std::unique_ptr<BinContent> content) {
+    content_ = std::make_shared<ContentState>(std::move(content));
+  }
+
+  // the content of the bin, or nullptr if it has none, or appending to it has failed
+  // waits for the reserved flowfiles to be appended, so the bin must not be offered to any more
+  [[nodiscard]] BinContent* getContent() const {
+    if (!content_) {
+      return nullptr;
+    }
+    std::unique_lock<std::mutex> lock(content_->mutex);
+    content_->appended.wait(lock, [this] { return content_->appended_count == content_->reserved_count; });
+    return content_->content.get();
+  }
+
  private:
   uint64_t minSize_;
   uint64_t maxSize_;
@@ -131,12 +205,19 @@ class Bin {
   std::chrono::system_clock::time_point creation_dated_;
   std::string fileCount_;
   std::string groupId_;
+  // shared with the reservations, which may still be appending to it after the bin is gone
+  std::shared_ptr<ContentState> content_;
   std::shared_ptr<core::logging::Logger> logger_ = core::logging::LoggerFactory<Bin>::getLogger();
   // A global unique identifier
   utils::Identifier uuid_;
 };
 
 // BinManager Class
+/*!
+ * The bins are sharded by their group, each shard has its own lock, so flow files of different groups can be binned concurrently.
+ * Only the groups offered to since the last gathering and the bins whose age has expired (found through a heap of bin creation
+ * dates) are checked when gathering the ready bins, so gathering does not depend on the number of groups.
+ */
 class BinManager {
  public:
   virtual ~BinManager() {
@@ -163,13 +244,15 @@ class BinManager {
   void setFileCount(const std::string &value) {
     fileCount_ = value;
   }
-  void purge() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    groupBinMap_.clear();
-    binCount_ = 0;
+  // the content of the bins created from now on is built by the factory while the flow files are offered
+  void setContentFactory(std::function<std::unique_ptr<BinContent>()> factory) {
+    std::lock_guard<std::mutex> lock(factoryMutex_);
+    contentFactory_ = std::move(factory);
   }
+  void purge();
   // Adds the given flowFile to the first available bin in which it fits for the given group or creates a new bin in the specified group if necessary.
-  bool offer(const std::string &group, std::shared_ptr<core::FlowFile> flow);
+  // The session is used to read the content of the flowFile, if the bins have content. It is appended after the lock of the group is released.
+  bool offer(const std::string &group, std::shared_ptr<core::FlowFile> flow, core::ProcessSession* session = nullptr);
   // gather ready bins once the bin are full enough or exceed bin age
   void gatherReadyBins();
   // marks oldest bin as ready
@@ -178,16 +261,50 @@ class BinManager {
   void getReadyBin(std::deque<std::unique_ptr<Bin>> &retBins);
 
  private:
-  std::mutex mutex_;
+  static constexpr size_t SHARD_COUNT = 16;
+
+  struct BinDate {
+    std::chrono::system_clock::time_point creation_date;
+    std::string group;
+    // the heap is ordered by the oldest date first
+    bool operator<(const BinDate& other) const {
+      return creation_date > other.creation_date;
+    }
+  };
+
+  struct Shard {
+    std::mutex mutex;
+    std::unordered_map<std::string, std::deque<std::unique_ptr<Bin>>> groupBinMap;
+    // the groups which were offered to since the last gathering
+    std::unordered_set<std::string> offeredGroups;
+    // heap of the creation dates of the bins, it may contain the dates of bins which are no longer in the shard
+    std::vector<BinDate> binDates;
+    size_t binCount{0};
+  };
+
+  Shard& getShard(const std::string &group) {
+    return shards_[std::hash<std::string>{}(group) % SHARD_COUNT];
+  }
+  std::unique_ptr<Bin> createBin(const std::string &group);
+  void addBin(Shard &shard, std::deque<std::unique_ptr<Bin>> &queue, std::unique_ptr<Bin> bin);
+  void addReadyBin(Shard &shard, std::deque<std::unique_ptr<Bin>> &queue, const std::string &group);
+  // moves the ready and expired bins from the front of the group to the ready bins
+  void gatherReadyBins(Shard &shard, const std::string &group);
+  // returns the front of the heap, after dropping the dates of the bins which are no longer in the shard
+  static const BinDate* getOldestBinDate(Shard &shard);
+
   uint64_t minSize_{0};
   uint64_t maxSize_{std::numeric_limits<decltype(maxSize_)>::max()};
   uint32_t maxEntries_{std::numeric_limits<decltype(maxEntries_)>::max()};
   uint32_t minEntries_{1};
   std::string fileCount_;
   std::chrono::milliseconds binAge_{std::chrono::milliseconds::max()};
-  std::map<std::string, std::unique_ptr<std::deque<std::unique_ptr<Bin>>> >groupBinMap_;
+  std::mutex factoryMutex_;
+  std::function<std::unique_ptr<BinContent>()> contentFactory_;
+  std::array<Shard, SHARD_COUNT> shards_;
+  std::mutex readyBinMutex_;
   std::deque<std::unique_ptr<Bin>> readyBin_;
-  int binCount_{0};
+  std::atomic<int> binCount_{0};
   std::shared_ptr<core::logging::Logger> logger_{core::logging::LoggerFactory<BinManager>::getLogger()};
 };
 
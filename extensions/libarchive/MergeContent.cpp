@@ -75,6 +75,13 @@ core::Property MergeContent::AttributeStrategy(
                     "only the attributes that exist on all FlowFiles in the bundle, with the same value, will be preserved.")
   ->withAllowableValues<std::string>({merge_content_options::ATTRIBUTE_STRATEGY_KEEP_COMMON, merge_content_options::ATTRIBUTE_STRATEGY_KEEP_ALL_UNIQUE})
   ->withDefaultValue(merge_content_options::ATTRIBUTE_STRATEGY_KEEP_COMMON)->build());
+core::Property MergeContent::StreamingMerge(
+  core::PropertyBuilder::createProperty("Streaming Merge")
+  ->withDescription("If true, the content of each FlowFile is appended to the merged content of its bin when it is added to the bin, "
+                    "so completing a bin only has to finish the merged content, instead of reading the content of all of its FlowFiles. "
+                    "Only used with the Bin-Packing Algorithm Merge Strategy, as the fragments have to be sorted when using the Defragment strategy. "
+                    "At most 64 bins keep their merged content open at a time, the content of the least recently used ones is closed and reopened for append.")
+  ->withDefaultValue(false)->build());
 core::Relationship MergeContent::Merge("merged", "The FlowFile containing the merged content");
 
 void MergeContent::initialize() {
@@ -96,6 +103,7 @@ void MergeContent::initialize() {
   properties.insert(Demarcator);
   properties.insert(KeepPath);
   properties.insert(AttributeStrategy);
+  properties.insert(StreamingMerge);
   setSupportedProperties(properties);
   // Set the supported relationships
   std::set<core::Relationship> relationships;
@@ -130,6 +138,7 @@ void MergeContent::onSchedule(core::ProcessContext *context, core::ProcessSessio
   context->getProperty(Demarcator.getName(), demarcator_);
   context->getProperty(KeepPath.getName(), keepPath_);
   context->getProperty(AttributeStrategy.getName(), attributeStrategy_);
+  context->getProperty(StreamingMerge.getName(), streamingMerge_);
 
   validatePropertyOptions();
 
@@ -167,6 +176,19 @@ void MergeContent::onSchedule(core::ProcessContext *context, core::ProcessSessio
     footerContent_ = footer_;
     demarcatorContent_ = demarcator_;
   }
+
+  if (streamingMerge_ && mergeStrategy_ == merge_content_options::MERGE_STRATEGY_DEFRAGMENT) {
+    logger_->log_warn("Streaming Merge is not supported with the Defragment strategy, the bins are merged when they are complete");
+    streamingMerge_ = false;
+  }
+  if (streamingMerge_) {
+    binManager_.setContentFactory([content_repo = context->getContentRepository(), open_streams = std::make_shared<OpenMergeStreams>(MAX_OPEN_MERGE_STREAMS),
+                                   merge_format = mergeFormat_, header = headerContent_, footer = footerContent_, demarcator = demarcatorContent_]() -> std::unique_ptr<BinContent> {
+      return std::make_unique<StreamingMergeContent>(content_repo, open_streams, merge_format, header, footer, demarcator);
+    });
+  } else {
+    binManager_.setContentFactory(nullptr);
+  }
 }
 
 void MergeContent::validatePropertyOptions() {
@@ -321,9 +343,16 @@ bool MergeContent::processBin(core::ProcessContext *context, core::ProcessSessio
     return false;
   }
 
-  std::shared_ptr<core::FlowFile> mergeFlow;
   try {
-    mergeBin->merge(context, session, bin->getFlowFile(), *serializer, merge_flow);
+    auto* streamed_content = dynamic_cast<StreamingMergeContent*>(bin->getContent());
+    std::shared_ptr<ResourceClaim> claim = streamed_content ? streamed_content->finish() : nullptr;
+    if (claim) {
+      // the content was merged while the flows were added to the bin
+      session->attachContent(merge_flow, claim, streamed_content->getSize());
+      mergeBin->setMergedFileName(session, bin->getFlowFile(), merge_flow);
+    } else {
+      mergeBin->merge(context, session, bin->getFlowFile(), *serializer, merge_flow);
+    }
     session->putAttribute(merge_flow, core::SpecialFlowAttribute::MIME_TYPE, mimeType);
   } catch (...) {
     logger_->log_error("Merge Content merge catch exception");
@@ -351,6 +380,11 @@ void BinaryConcatenationMerge::merge(core::ProcessContext* /*context*/, core::Pr
     std::deque<std::shared_ptr<core::FlowFile>> &flows, FlowFileSerializer& serializer, const std::shared_ptr<core::FlowFile>& merge_flow) {
   BinaryConcatenationMerge::WriteCallback callback(header_, footer_, demarcator_, flows, serializer);
   session->write(merge_flow, &callback);
+  setMergedFileName(session, flows, merge_flow);
+}
+
+void BinaryConcatenationMerge::setMergedFileName(core::ProcessSession *session, const std::deque<std::shared_ptr<core::FlowFile>> &flows,
+    const std::shared_ptr<core::FlowFile>& merge_flow) {
   std::string fileName;
   if (flows.size() == 1) {
     flows.front()->getAttribute(core::SpecialFlowAttribute::FILENAME, fileName);
@@ -361,10 +395,38 @@ void BinaryConcatenationMerge::merge(core::ProcessContext* /*context*/, core::Pr
     session->putAttribute(merge_flow, core::SpecialFlowAttribute::FILENAME, fileName);
 }
 
+int64_t ArchiveMerge::writeEntry(struct archive *arch, const std::string &merge_type, const std::shared_ptr<core::FlowFile> &flow, FlowFileSerializer& serializer) {
+  struct archive_entry *entry = archive_entry_new();
+  std::string fileName;
+  flow->getAttribute(core::SpecialFlowAttribute::FILENAME, fileName);
+  archive_entry_set_pathname(entry, fileName.c_str());
+  archive_entry_set_size(entry, flow->getSize());
+  archive_entry_set_mode(entry, S_IFREG | 0755);
+  if (merge_type == merge_content_options::MERGE_FORMAT_TAR_VALUE) {
+    std::string perm;
+    int permInt;
+    if (flow->getAttribute(BinFiles::TAR_PERMISSIONS_ATTRIBUTE, perm)) {
+      try {
+        permInt = std::stoi(perm);
+        core::logging::LoggerFactory<ArchiveMerge>::getLogger()->log_debug("Merge Tar File %s permission %s", fileName, perm);
+        archive_entry_set_perm(entry, (mode_t) permInt);
+      } catch (...) {
+      }
+    }
+  }
+  const auto ret = serializer.serialize(flow, std::make_shared<ArchiveWriter>(arch, entry));
+  archive_entry_free(entry);
+  return ret;
+}
+
 void TarMerge::merge(core::ProcessContext* /*context*/, core::ProcessSession *session,
     std::deque<std::shared_ptr<core::FlowFile>> &flows, FlowFileSerializer& serializer, const std::shared_ptr<core::FlowFile>& merge_flow) {
   ArchiveMerge::WriteCallback callback(std::string(merge_content_options::MERGE_FORMAT_TAR_VALUE), flows, serializer);
   session->write(merge_flow, &callback);
+  setMergedFileName(session, flows, merge_flow);
+}
+
+void TarMerge::setMergedFileName(core::ProcessSession *session, const std::deque<std::shared_ptr<core::FlowFile>> &flows, const std::shared_ptr<core::FlowFile>& merge_flow) {
   std::string fileName;
   merge_flow->getAttribute(core::SpecialFlowAttribute::FILENAME, fileName);
   if (flows.size() == 1) {
@@ -382,6 +444,10 @@ void ZipMerge::merge(core::ProcessContext* /*context*/, core::ProcessSession *se
     std::deque<std::shared_ptr<core::FlowFile>> &flows, FlowFileSerializer& serializer, const std::shared_ptr<core::FlowFile>& merge_flow) {
   ArchiveMerge::WriteCallback callback(std::string(merge_content_options::MERGE_FORMAT_ZIP_VALUE), flows, serializer);
   session->write(merge_flow, &callback);
+  setMergedFileName(session, flows, merge_flow);
+}
+
+void ZipMerge::setMergedFileName(core::ProcessSession *session, const std::deque<std::shared_ptr<core::FlowFile>> &flows, const std::shared_ptr<core::FlowFile>& merge_flow) {
   std::string fileName;
   merge_flow->getAttribute(core::SpecialFlowAttribute::FILENAME, fileName);
   if (flows.size() == 1) {
@@ -395,6 +461,183 @@ void ZipMerge::merge(core::ProcessContext* /*context*/, core::ProcessSession *se
   }
 }
 
+void OpenMergeStreams::touch(StreamingMergeContent* content) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  open_contents_.remove(content);
+  open_contents_.push_front(content);
+  for (auto it = open_contents_.end(); open_contents_.size() > max_open_streams_ && it != std::next(open_contents_.begin());) {
+    --it;
+    // the contents in use are skipped, so the limit may be exceeded while they are being written
+    if ((*it)->tryCloseStream()) {
+      it = open_contents_.erase(it);
+    }
+  }
+}
+
+void OpenMergeStreams::remove(StreamingMergeContent* content) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  open_contents_.remove(content);
+}
+
+StreamingMergeContent::StreamingMergeContent(std::shared_ptr<core::ContentRepository> content_repo, std::shared_ptr<OpenMergeStreams> open_streams,
+    std::string merge_format, std::string header, std::string footer, std::string demarcator)
+  : content_repo_(std::move(content_repo)),
+    open_streams_(std::move(open_streams)),
+    merge_format_(std::move(merge_format)) {
+  // header, footer and demarcator are only used by the Binary Concatenation format
+  if (merge_format_ == merge_content_options::MERGE_FORMAT_CONCAT_VALUE) {
+    header_ = std::move(header);
+    footer_ = std::move(footer);
+    demarcator_ = std::move(demarcator);
+  }
+  claim_ = std::make_shared<ResourceClaim>(content_repo_);
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!openStream()) {
+    closed_ = true;
+    return;
+  }
+  if (merge_format_ == merge_content_options::MERGE_FORMAT_TAR_VALUE || merge_format_ == merge_content_options::MERGE_FORMAT_ZIP_VALUE) {
+    archive_ = archive_write_new();
+    if (merge_format_ == merge_content_options::MERGE_FORMAT_TAR_VALUE) {
+      archive_write_set_format_pax_restricted(archive_);  // tar format
+    } else {
+      archive_write_set_format_zip(archive_);  // zip format
+    }
+    archive_write_set_bytes_per_block(archive_, 0);
+    archive_write_add_filter_none(archive_);
+    archive_write_open(archive_, this, nullptr, archive_write, nullptr);
+  }
+}
+
+StreamingMergeContent::~StreamingMergeContent() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  // the content is discarded, the end of the archive is not written
+  closed_ = true;
+  if (archive_) {
+    archive_write_free(archive_);
+  }
+  open_streams_->remove(this);
+  closeStream();
+}
+
+bool StreamingMergeContent::openStream() {
+  if (closed_) {
+    return false;
+  }
+  if (stream_) {
+    open_streams_->touch(this);
+    return true;
+  }
+  stream_ = content_repo_->write(*claim_, opened_);
+  if (!stream_) {
+    logger_->log_error("Failed to open %s for writing the merged content", claim_->getContentFullPath());
+    return false;
+  }
+  opened_ = true;
+  open_streams_->touch(this);
+  return true;
+}
+
+void StreamingMergeContent::closeStream() {
+  if (stream_) {
+    stream_->close();
+    stream_.reset();
+  }
+}
+
+bool StreamingMergeContent::tryCloseStream() {
+  std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    return false;
+  }
+  closeStream();
+  return true;
+}
+
+la_ssize_t StreamingMergeContent::archive_write(struct archive* /*arch*/, void *context, const void *buff, size_t size) {
+  // called by libarchive while the content is being written, with mutex_ held
+  auto* content = reinterpret_cast<StreamingMergeContent*>(context);
+  if (!content->openStream()) {
+    return -1;
+  }
+  const auto ret = content->stream_->write(reinterpret_cast<const uint8_t*>(buff), size);
+  if (io::isError(ret)) {
+    // libarchive expects us to return -1 on error
+    return -1;
+  }
+  content->size_ += ret;
+  return gsl::narrow<la_ssize_t>(ret);
+}
+
+bool StreamingMergeContent::write(const std::string& data) {
+  if (data.empty()) {
+    return true;
+  }
+  if (!openStream()) {
+    return false;
+  }
+  const auto ret = stream_->write(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+  if (io::isError(ret) || ret != data.size()) {
+    return false;
+  }
+  size_ += ret;
+  return true;
+}
+
+bool StreamingMergeContent::append(core::ProcessSession& session, const std::shared_ptr<core::FlowFile>& flow) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (closed_) {
+    return false;
+  }
+  auto flowFileReader = [&session] (const std::shared_ptr<core::FlowFile>& ff, InputStreamCallback* cb) {
+    return session.read(ff, cb);
+  };
+  try {
+    if (archive_) {
+      PayloadSerializer serializer(flowFileReader);
+      return ArchiveMerge::writeEntry(archive_, merge_format_, flow, serializer) >= 0;
+    }
+    if (!write(empty_ ? header_ : demarcator_) || !openStream()) {
+      return false;
+    }
+    empty_ = false;
+    std::unique_ptr<minifi::FlowFileSerializer> serializer;
+    if (merge_format_ == merge_content_options::MERGE_FORMAT_FLOWFILE_STREAM_V3_VALUE) {
+      serializer = std::make_unique<FlowFileV3Serializer>(flowFileReader);
+    } else {
+      serializer = std::make_unique<PayloadSerializer>(flowFileReader);
+    }
+    const auto len = serializer->serialize(flow, stream_);
+    if (len < 0) {
+      return false;
+    }
+    size_ += gsl::narrow<uint64_t>(len);
+    return true;
+  } catch (const std::exception& exception) {
+    logger_->log_error("Failed to append flow file %s to the merged content: %s", flow->getUUIDStr(), exception.what());
+    return false;
+  }
+}
+
+std::shared_ptr<ResourceClaim> StreamingMergeContent::finish() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (closed_) {
+    return nullptr;
+  }
+  bool success = true;
+  if (archive_) {
+    success = archive_write_close(archive_) == ARCHIVE_OK;
+    archive_write_free(archive_);
+    archive_ = nullptr;
+  } else {
+    success = write(footer_);
+  }
+  closed_ = true;
+  open_streams_->remove(this);
+  closeStream();
+  return success ? claim_ : nullptr;
+}
+
 void AttributeMerger::mergeAttributes(core::ProcessSession *session, const std::shared_ptr<core::FlowFile> &merge_flow) {
   for (const auto& pair : getMergedAttributes()) {
     session->putAttribute(merge_flow, pair.first, pair.second);
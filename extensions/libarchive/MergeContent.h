@@ -20,7 +20,9 @@
 #pragma once
 
 #include <deque>
+#include <list>
 #include <map>
+#include <mutex>
 #include <vector>
 #include <memory>
 #include <string>
@@ -29,7 +31,9 @@
 #include "BinFiles.h"
 #include "archive_entry.h"
 #include "archive.h"
+#include "core/ContentRepository.h"
 #include "core/logging/LoggerConfiguration.h"
+#include "ResourceClaim.h"
 #include "serialization/FlowFileSerializer.h"
 #include "utils/gsl.h"
 #include "utils/Export.h"
@@ -62,6 +66,8 @@ class MergeBin {
   // merge the flows in the bin
   virtual void merge(core::ProcessContext *context, core::ProcessSession *session,
       std::deque<std::shared_ptr<core::FlowFile>> &flows, FlowFileSerializer& serializer, const std::shared_ptr<core::FlowFile> &flowFile) = 0;
+  // set the filename of the merged flow
+  virtual void setMergedFileName(core::ProcessSession *session, const std::deque<std::shared_ptr<core::FlowFile>> &flows, const std::shared_ptr<core::FlowFile> &merge_flow) = 0;
 };
 
 // BinaryConcatenationMerge Class
@@ -71,6 +77,7 @@ class BinaryConcatenationMerge : public MergeBin {
 
   void merge(core::ProcessContext *context, core::ProcessSession *session,
       std::deque<std::shared_ptr<core::FlowFile>> &flows, FlowFileSerializer& serializer, const std::shared_ptr<core::FlowFile> &flowFile) override;
+  void setMergedFileName(core::ProcessSession *session, const std::deque<std::shared_ptr<core::FlowFile>> &flows, const std::shared_ptr<core::FlowFile> &merge_flow) override;
   // Nest Callback Class for write stream
   class WriteCallback: public OutputStreamCallback {
    public:
@@ -127,6 +134,9 @@ class BinaryConcatenationMerge : public MergeBin {
 // Archive Class
 class ArchiveMerge {
  public:
+  // write the flow as the next entry of the archive
+  static int64_t writeEntry(struct archive *arch, const std::string &merge_type, const std::shared_ptr<core::FlowFile> &flow, FlowFileSerializer& serializer);
+
   class ArchiveWriter : public io::OutputStream {
    public:
     ArchiveWriter(struct archive *arch, struct archive_entry *entry) : arch_(arch), entry_(entry) {}
@@ -215,29 +225,10 @@ class ArchiveMerge {
       archive_write_open(arch, this, NULL, archive_write, NULL);
 
       for (auto flow : flows_) {
-        struct archive_entry *entry = archive_entry_new();
-        std::string fileName;
-        flow->getAttribute(core::SpecialFlowAttribute::FILENAME, fileName);
-        archive_entry_set_pathname(entry, fileName.c_str());
-        archive_entry_set_size(entry, flow->getSize());
-        archive_entry_set_mode(entry, S_IFREG | 0755);
-        if (merge_type_ == merge_content_options::MERGE_FORMAT_TAR_VALUE) {
-          std::string perm;
-          int permInt;
-          if (flow->getAttribute(BinFiles::TAR_PERMISSIONS_ATTRIBUTE, perm)) {
-            try {
-              permInt = std::stoi(perm);
-              logger_->log_debug("Merge Tar File %s permission %s", fileName, perm);
-              archive_entry_set_perm(entry, (mode_t) permInt);
-            } catch (...) {
-            }
-          }
-        }
-        const auto ret = serializer_.serialize(flow, std::make_shared<ArchiveWriter>(arch, entry));
+        const auto ret = writeEntry(arch, merge_type_, flow, serializer_);
         if (ret < 0) {
           return ret;
         }
-        archive_entry_free(entry);
       }
 
       archive_write_close(arch);
@@ -252,6 +243,7 @@ class TarMerge: public ArchiveMerge, public MergeBin {
  public:
   void merge(core::ProcessContext *context, core::ProcessSession *session, std::deque<std::shared_ptr<core::FlowFile>> &flows,
              FlowFileSerializer& serializer, const std::shared_ptr<core::FlowFile> &merge_flow) override;
+  void setMergedFileName(core::ProcessSession *session, const std::deque<std::shared_ptr<core::FlowFile>> &flows, const std::shared_ptr<core::FlowFile> &merge_flow) override;
 };
 
 // ZipMerge Class
@@ -259,6 +251,72 @@ class ZipMerge: public ArchiveMerge, public MergeBin {
  public:
   void merge(core::ProcessContext *context, core::ProcessSession *session, std::deque<std::shared_ptr<core::FlowFile>> &flows,
              FlowFileSerializer& serializer, const std::shared_ptr<core::FlowFile> &merge_flow) override;
+  void setMergedFileName(core::ProcessSession *session, const std::deque<std::shared_ptr<core::FlowFile>> &flows, const std::shared_ptr<core::FlowFile> &merge_flow) override;
+};
+
+class StreamingMergeContent;
+
+// Limits the number of streaming merge contents keeping their content stream open, as each of them would hold a file descriptor
+class OpenMergeStreams {
+ public:
+  explicit OpenMergeStreams(size_t max_open_streams)
+      : max_open_streams_(max_open_streams) {
+  }
+
+  // the content has opened or used its stream, the streams of the least recently used contents above the limit are closed
+  void touch(StreamingMergeContent* content);
+  // the content has closed its stream
+  void remove(StreamingMergeContent* content);
+
+ private:
+  size_t max_open_streams_;
+  std::mutex mutex_;
+  // the contents with an open stream, the most recently used first
+  std::list<StreamingMergeContent*> open_contents_;
+};
+
+// Merges the flows of a bin as they are offered to the bin, into a content claim which is kept open until the bin is complete.
+// When more contents are open than the limit of the shared OpenMergeStreams, the stream is closed and later reopened for append.
+class StreamingMergeContent : public BinContent {
+ public:
+  StreamingMergeContent(std::shared_ptr<core::ContentRepository> content_repo, std::shared_ptr<OpenMergeStreams> open_streams, std::string merge_format,
+                        std::string header, std::string footer, std::string demarcator);
+  ~StreamingMergeContent() override;
+
+  bool append(core::ProcessSession& session, const std::shared_ptr<core::FlowFile>& flow) override;
+  // write the end of the merged content, returns the claim holding it, or nullptr on failure
+  std::shared_ptr<ResourceClaim> finish();
+  uint64_t getSize() const {
+    return size_;
+  }
+
+  // closes the stream unless it is in use, returns false if it is in use
+  bool tryCloseStream();
+
+ private:
+  static la_ssize_t archive_write(struct archive *arch, void *context, const void *buff, size_t size);
+  // these must be called with mutex_ held
+  bool write(const std::string& data);
+  bool openStream();
+  void closeStream();
+
+  std::shared_ptr<core::ContentRepository> content_repo_;
+  std::shared_ptr<OpenMergeStreams> open_streams_;
+  std::string merge_format_;
+  std::string header_;
+  std::string footer_;
+  std::string demarcator_;
+  std::shared_ptr<ResourceClaim> claim_;
+  std::mutex mutex_;
+  std::shared_ptr<io::BaseStream> stream_;
+  // once written to, the claim is reopened for append
+  bool opened_{false};
+  // set when the content is finished or discarded, nothing can be written to it from then on
+  bool closed_{false};
+  struct archive *archive_{nullptr};
+  uint64_t size_{0};
+  bool empty_{true};
+  std::shared_ptr<core::logging::Logger> logger_ = core::logging::LoggerFactory<StreamingMergeContent>::getLogger();
 };
 
 class AttributeMerger {
@@ -325,10 +383,14 @@ class MergeContent : public processors::BinFiles {
   EXTENSIONAPI static core::Property Footer;
   EXTENSIONAPI static core::Property Demarcator;
   EXTENSIONAPI static core::Property AttributeStrategy;
+  EXTENSIONAPI static core::Property StreamingMerge;
 
   // Supported Relationships
   EXTENSIONAPI static core::Relationship Merge;
 
+  // the number of bins with Streaming Merge keeping their merged content open, the others are reopened for append
+  static constexpr size_t MAX_OPEN_MERGE_STREAMS = 64;
+
  public:
   /**
    * Function that's executed when the processor is scheduled.
@@ -369,6 +431,7 @@ class MergeContent : public processors::BinFiles {
   std::string footerContent_;
   std::string demarcatorContent_;
   std::string attributeStrategy_;
+  bool streamingMerge_{false};
   // readContent
   std::string readContent(std::string path);
 };
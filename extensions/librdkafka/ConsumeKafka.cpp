@@ -19,9 +19,12 @@
 
 #include <algorithm>
 #include <limits>
+#include <map>
 
+#include "KafkaRecordIndex.h"
 #include "core/PropertyValidation.h"
 #include "core/Resource.h"
+#include "io/StreamPipe.h"
 #include "utils/ProcessorConfigUtils.h"
 #include "utils/gsl.h"
 
@@ -116,6 +119,15 @@ core::Property ConsumeKafka::MessageDemarcator(core::PropertyBuilder::createProp
   ->supportsExpressionLanguage(true)
   ->build());
 
+core::Property ConsumeKafka::OutputStrategy(core::PropertyBuilder::createProperty("Output Strategy")
+  ->withDescription("With \"FlowFile per Message\" each Kafka message results in its own FlowFile (or multiple ones, if it is split by the Message Demarcator). "
+      "With \"FlowFile per Partition Batch\" the messages polled from the same topic and partition are written into a single FlowFile, separated by the Message Demarcator "
+      "(if any). The offset, length, key and headers of each message are stored in the kafka.record.index attribute, so the messages can be processed without splitting the "
+      "FlowFile. Headers listed in Headers To Add As Attributes are stored in the index instead of being added as attributes.")
+  ->withAllowableValues<std::string>({OUTPUT_STRATEGY_MESSAGE, OUTPUT_STRATEGY_BATCH})
+  ->withDefaultValue(OUTPUT_STRATEGY_MESSAGE)
+  ->build());
+
 core::Property ConsumeKafka::MessageHeaderEncoding(core::PropertyBuilder::createProperty("Message Header Encoding")
   ->withDescription("Any message header that is found on a Kafka message will be added to the outbound FlowFile as an attribute. This property indicates the Character Encoding "
       "to use for deserializing the headers.")
@@ -180,6 +192,7 @@ void ConsumeKafka::initialize() {
     OffsetReset,
     KeyAttributeEncoding,
     MessageDemarcator,
+    OutputStrategy,
     MessageHeaderEncoding,
     HeadersToAddAsAttributes,
     DuplicateHeaderHandling,
@@ -207,6 +220,8 @@ void ConsumeKafka::onSchedule(core::ProcessContext* context, core::ProcessSessio
 
   // Optional properties
   context->getProperty(MessageDemarcator.getName(), message_demarcator_);
+  output_strategy_ = OUTPUT_STRATEGY_MESSAGE;
+  context->getProperty(OutputStrategy.getName(), output_strategy_);
   context->getProperty(MessageHeaderEncoding.getName(), message_header_encoding_);
   context->getProperty(DuplicateHeaderHandling.getName(), duplicate_header_handling_);
 
@@ -335,6 +350,7 @@ void ConsumeKafka::configure_new_connection(core::ProcessContext& context) {
   extend_config_from_dynamic_properties(context);
 
   std::array<char, 512U> errstr{};
+  consumer_queue_.reset();
   consumer_ = { rd_kafka_new(RD_KAFKA_CONSUMER, conf_.release(), errstr.data(), errstr.size()), utils::rd_kafka_consumer_deleter() };
   if (consumer_ == nullptr) {
     const std::string error_msg { errstr.data() };
@@ -358,6 +374,8 @@ void ConsumeKafka::configure_new_connection(core::ProcessContext& context) {
   if (RD_KAFKA_RESP_ERR_NO_ERROR != poll_set_consumer_response) {
     logger_->log_error("rd_kafka_poll_set_consumer error %d: %s", poll_set_consumer_response, rd_kafka_err2str(poll_set_consumer_response));
   }
+  // After rd_kafka_poll_set_consumer, the consumer queue also serves the rebalance callbacks
+  consumer_queue_ = { rd_kafka_queue_get_consumer(consumer_.get()), utils::rd_kafka_queue_deleter() };
 }
 
 std::string ConsumeKafka::extract_message(const rd_kafka_message_t& rkmessage) const {
@@ -370,21 +388,31 @@ std::string ConsumeKafka::extract_message(const rd_kafka_message_t& rkmessage) c
 std::vector<std::unique_ptr<rd_kafka_message_t, utils::rd_kafka_message_deleter>> ConsumeKafka::poll_kafka_messages() {
   std::vector<std::unique_ptr<rd_kafka_message_t, utils::rd_kafka_message_deleter>> messages;
   messages.reserve(max_poll_records_);
+  std::vector<rd_kafka_message_t*> batch(max_poll_records_);
   const auto start = std::chrono::steady_clock::now();
   auto elapsed = std::chrono::steady_clock::now() - start;
   while (messages.size() < max_poll_records_ && elapsed < max_poll_time_milliseconds_) {
     logger_->log_debug("Polling for new messages for %d milliseconds...", max_poll_time_milliseconds_.count());
-    std::unique_ptr<rd_kafka_message_t, utils::rd_kafka_message_deleter>
-      message { rd_kafka_consumer_poll(consumer_.get(), std::chrono::duration_cast<std::chrono::milliseconds>(max_poll_time_milliseconds_ - elapsed).count()), utils::rd_kafka_message_deleter() };
-    if (!message) {
+    // returns when the batch is full or the timeout elapses
+    const auto received = rd_kafka_consume_batch_queue(consumer_queue_.get(), gsl::narrow<int>(std::chrono::duration_cast<std::chrono::milliseconds>(max_poll_time_milliseconds_ - elapsed).count()),
+        batch.data(), max_poll_records_ - messages.size());
+    if (received < 0) {
+      logger_->log_error("Polling the consumer queue failed: %s", rd_kafka_err2str(rd_kafka_last_error()));
       break;
     }
-    if (RD_KAFKA_RESP_ERR_NO_ERROR != message->err) {
-      logger_->log_error("Received message with error %d: %s", message->err, rd_kafka_err2str(message->err));
+    if (received == 0) {
       break;
     }
-    utils::print_kafka_message(*message, *logger_);
-    messages.emplace_back(std::move(message));
+    for (size_t i = 0; i < gsl::narrow<size_t>(received); ++i) {
+      std::unique_ptr<rd_kafka_message_t, utils::rd_kafka_message_deleter> message{ batch[i], utils::rd_kafka_message_deleter() };
+      if (RD_KAFKA_RESP_ERR_NO_ERROR != message->err) {
+        // the rest of the batch is kept, otherwise its messages would be skipped until the next rebalance
+        logger_->log_error("Received message with error %d: %s", message->err, rd_kafka_err2str(message->err));
+        continue;
+      }
+      utils::print_kafka_message(*message, *logger_);
+      messages.emplace_back(std::move(message));
+    }
     elapsed = std::chrono::steady_clock::now() - start;
   }
   return messages;
@@ -462,8 +490,18 @@ std::vector<std::pair<std::string, std::string>> ConsumeKafka::get_flowfile_attr
   return attributes_from_headers;
 }
 
+std::vector<std::pair<std::string, std::string>> ConsumeKafka::get_indexed_headers(const rd_kafka_message_t& message) const {
+  // the index is binary, so the headers are stored without encoding and duplicates are kept
+  std::vector<std::pair<std::string, std::string>> indexed_headers;
+  for (const std::string& header_name : headers_to_add_as_attributes_) {
+    for (auto& value : get_matching_headers(message, header_name)) {
+      indexed_headers.emplace_back(header_name, std::move(value));
+    }
+  }
+  return indexed_headers;
+}
+
 void ConsumeKafka::add_kafka_attributes_to_flowfile(std::shared_ptr<FlowFileRecord>& flow_file, const rd_kafka_message_t& message) const {
-  // We do not currently support batching messages into a single flowfile
   flow_file->setAttribute(KAFKA_COUNT_ATTR, "1");
   const std::optional<std::string> message_key = utils::get_encoded_message_key(message, key_attr_encoding_attr_to_enum());
   if (message_key) {
@@ -502,9 +540,76 @@ std::optional<std::vector<std::shared_ptr<FlowFileRecord>>> ConsumeKafka::transf
   return { flow_files_created };
 }
 
+std::optional<std::vector<std::shared_ptr<FlowFileRecord>>> ConsumeKafka::transform_pending_messages_into_batches(core::ProcessSession& session) const {
+  // The messages of a partition are polled in offset order, so the records of a batch have increasing offsets
+  std::map<std::pair<std::string, int32_t>, std::vector<const rd_kafka_message_t*>> partition_batches;
+  for (const auto& message : pending_messages_) {
+    partition_batches[{rd_kafka_topic_name(message->rkt), message->partition}].push_back(message.get());
+  }
+
+  std::vector<std::shared_ptr<FlowFileRecord>> flow_files_created;
+  for (const auto& [topic_partition, messages] : partition_batches) {
+    std::shared_ptr<FlowFileRecord> flow_file = std::static_pointer_cast<FlowFileRecord>(session.create());
+    if (flow_file == nullptr) {
+      logger_->log_error("Failed to create flowfile.");
+      // Either transform all flowfiles or none
+      return {};
+    }
+
+    KafkaRecordIndex record_index(gsl::narrow<uint32_t>(message_demarcator_.size()));
+    for (const auto* message : messages) {
+      std::optional<std::string> key;
+      if (message->key) {
+        key.emplace(static_cast<const char*>(message->key), message->key_len);
+      }
+      record_index.add(message->offset, message->len, std::move(key), get_indexed_headers(*message));
+    }
+
+    session.write(flow_file, FunctionOutputStreamCallback([&](const std::shared_ptr<io::OutputStream>& stream) -> int64_t {
+      int64_t written = 0;
+      for (const auto* message : messages) {
+        if (message != messages.front() && !message_demarcator_.empty()) {
+          const auto demarcator_ret = stream->write(reinterpret_cast<const uint8_t*>(message_demarcator_.data()), message_demarcator_.size());
+          if (io::isError(demarcator_ret)) return -1;
+          written += gsl::narrow<int64_t>(demarcator_ret);
+        }
+        if (message->len == 0) continue;
+        const auto write_ret = stream->write(static_cast<const uint8_t*>(message->payload), message->len);
+        if (io::isError(write_ret)) return -1;
+        written += gsl::narrow<int64_t>(write_ret);
+      }
+      return written;
+    }));
+    flow_file->setAttribute(KAFKA_COUNT_ATTR, std::to_string(messages.size()));
+    flow_file->setAttribute(KAFKA_OFFSET_ATTR, std::to_string(messages.front()->offset));
+    flow_file->setAttribute(KAFKA_PARTITION_ATTR, std::to_string(topic_partition.second));
+    flow_file->setAttribute(KAFKA_TOPIC_ATTR, topic_partition.first);
+    flow_file->setAttribute(KAFKA_RECORD_INDEX_ATTR, record_index.serialize());
+    flow_files_created.emplace_back(std::move(flow_file));
+  }
+  return { flow_files_created };
+}
+
+void ConsumeKafka::commit_pending_offsets() {
+  // Commit the offset following the latest message of each partition
+  std::unique_ptr<rd_kafka_topic_partition_list_t, utils::rd_kafka_topic_partition_list_deleter> offsets{ rd_kafka_topic_partition_list_new(1), utils::rd_kafka_topic_partition_list_deleter() };
+  for (const auto& message : pending_messages_) {
+    const char* const topic_name = rd_kafka_topic_name(message->rkt);
+    rd_kafka_topic_partition_t* partition = rd_kafka_topic_partition_list_find(offsets.get(), topic_name, message->partition);
+    if (partition == nullptr) {
+      partition = rd_kafka_topic_partition_list_add(offsets.get(), topic_name, message->partition);
+    }
+    partition->offset = std::max(partition->offset, message->offset + 1);
+  }
+  if (RD_KAFKA_RESP_ERR_NO_ERROR != rd_kafka_commit(consumer_.get(), offsets.get(), /* async = */ 0)) {
+    logger_->log_error("Committing offset failed.");
+  }
+}
 
 void ConsumeKafka::process_pending_messages(core::ProcessSession& session) {
-  std::optional<std::vector<std::shared_ptr<FlowFileRecord>>> flow_files_created = transform_pending_messages_into_flowfiles(session);
+  std::optional<std::vector<std::shared_ptr<FlowFileRecord>>> flow_files_created = output_strategy_ == OUTPUT_STRATEGY_BATCH ?
+      transform_pending_messages_into_batches(session) :
+      transform_pending_messages_into_flowfiles(session);
   if (!flow_files_created) {
     return;
   }
@@ -512,10 +617,7 @@ void ConsumeKafka::process_pending_messages(core::ProcessSession& session) {
     session.transfer(flow_file, Success);
   }
   session.commit();
-  // Commit the offset from the latest message only
-  if (RD_KAFKA_RESP_ERR_NO_ERROR != rd_kafka_commit_message(consumer_.get(), pending_messages_.back().get(), /* async = */ 0)) {
-    logger_->log_error("Committing offset failed.");
-  }
+  commit_pending_offsets();
   pending_messages_.clear();
 }
 
@@ -48,6 +48,7 @@ class ConsumeKafka : public KafkaProcessorBase {
   EXTENSIONAPI static core::Property OffsetReset;
   EXTENSIONAPI static core::Property KeyAttributeEncoding;
   EXTENSIONAPI static core::Property MessageDemarcator;
+  EXTENSIONAPI static core::Property OutputStrategy;
   EXTENSIONAPI static core::Property MessageHeaderEncoding;
   EXTENSIONAPI static core::Property HeadersToAddAsAttributes;
   EXTENSIONAPI static core::Property DuplicateHeaderHandling;
@@ -79,17 +80,22 @@ class ConsumeKafka : public KafkaProcessorBase {
   static constexpr char const* MSG_HEADER_ENCODING_UTF_8 = "UTF-8";
   static constexpr char const* MSG_HEADER_ENCODING_HEX = "Hex";
 
+  // Output Strategy allowable values
+  static constexpr char const* OUTPUT_STRATEGY_MESSAGE = "FlowFile per Message";
+  static constexpr char const* OUTPUT_STRATEGY_BATCH = "FlowFile per Partition Batch";
+
   // Duplicate Header Handling allowable values
   static constexpr char const* MSG_HEADER_KEEP_FIRST = "Keep First";
   static constexpr char const* MSG_HEADER_KEEP_LATEST = "Keep Latest";
   static constexpr char const* MSG_HEADER_COMMA_SEPARATED_MERGE = "Comma-separated Merge";
 
   // Flowfile attributes written
-  static constexpr char const* KAFKA_COUNT_ATTR = "kafka.count";  // Always 1 until we start supporting merging from batches
+  static constexpr char const* KAFKA_COUNT_ATTR = "kafka.count";  // Always 1 unless the output strategy is batching
   static constexpr char const* KAFKA_MESSAGE_KEY_ATTR = "kafka.key";
   static constexpr char const* KAFKA_OFFSET_ATTR = "kafka.offset";
   static constexpr char const* KAFKA_PARTITION_ATTR = "kafka.partition";
   static constexpr char const* KAFKA_TOPIC_ATTR = "kafka.topic";
+  static constexpr char const* KAFKA_RECORD_INDEX_ATTR = "kafka.record.index";  // Only written when batching, see KafkaRecordIndex
 
   static constexpr const std::size_t DEFAULT_MAX_POLL_RECORDS{ 10000 };
   static constexpr char const* DEFAULT_MAX_POLL_TIME = "4 seconds";
@@ -133,7 +139,10 @@ class ConsumeKafka : public KafkaProcessorBase {
   std::vector<std::string> get_matching_headers(const rd_kafka_message_t& message, const std::string& header_name) const;
   std::vector<std::pair<std::string, std::string>> get_flowfile_attributes_from_message_header(const rd_kafka_message_t& message) const;
   void add_kafka_attributes_to_flowfile(std::shared_ptr<FlowFileRecord>& flow_file, const rd_kafka_message_t& message) const;
+  std::vector<std::pair<std::string, std::string>> get_indexed_headers(const rd_kafka_message_t& message) const;
   std::optional<std::vector<std::shared_ptr<FlowFileRecord>>> transform_pending_messages_into_flowfiles(core::ProcessSession& session) const;
+  std::optional<std::vector<std::shared_ptr<FlowFileRecord>>> transform_pending_messages_into_batches(core::ProcessSession& session) const;
+  void commit_pending_offsets();
   void process_pending_messages(core::ProcessSession& session);
 
  private:
@@ -160,6 +169,7 @@ class ConsumeKafka : public KafkaProcessorBase {
   std::string offset_reset_;
   std::string key_attribute_encoding_;
   std::string message_demarcator_;
+  std::string output_strategy_;
   std::string message_header_encoding_;
   std::string duplicate_header_handling_;
   std::vector<std::string> headers_to_add_as_attributes_;
@@ -168,6 +178,8 @@ class ConsumeKafka : public KafkaProcessorBase {
   std::chrono::milliseconds session_timeout_milliseconds_;
 
   std::unique_ptr<rd_kafka_t, utils::rd_kafka_consumer_deleter> consumer_;
+  // must be destroyed before consumer_
+  std::unique_ptr<rd_kafka_queue_t, utils::rd_kafka_queue_deleter> consumer_queue_;
   std::unique_ptr<rd_kafka_conf_t, utils::rd_kafka_conf_deleter> conf_;
   std::unique_ptr<rd_kafka_topic_partition_list_t, utils::rd_kafka_topic_partition_list_deleter> kf_topic_partition_list_;
 
@@ -0,0 +1,121 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "KafkaRecordIndex.h"
+
+#include "io/BufferStream.h"
+#include "utils/gsl.h"
+#include "utils/StringUtils.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace processors {
+
+void KafkaRecordIndex::add(int64_t offset, uint64_t length, std::optional<std::string> key, std::vector<std::pair<std::string, std::string>> headers) {
+  uint64_t position = 0;
+  if (!records_.empty()) {
+    position = records_.back().position + records_.back().length + demarcator_length_;
+  }
+  records_.push_back(Record{offset, position, length, std::move(key), std::move(headers)});
+}
+
+/**
+ * Layout (integers are big endian, strings are prefixed by their 32 bit length):
+ *   version (8 bits), demarcator length (32 bits), offset of the first record (64 bits), record count (32 bits)
+ *   for each record:
+ *     offset relative to the first record (32 bits), length (32 bits),
+ *     has key (8 bits), [key (string)],
+ *     header count (16 bits), header count * [name (string), value (string)]
+ */
+std::string KafkaRecordIndex::serialize() const {
+  io::BufferStream stream;
+  const int64_t first_offset = records_.empty() ? 0 : records_.front().offset;
+  stream.write(VERSION);
+  stream.write(demarcator_length_);
+  stream.write(static_cast<uint64_t>(first_offset));
+  stream.write(gsl::narrow<uint32_t>(records_.size()));
+  for (const auto& record : records_) {
+    stream.write(gsl::narrow<uint32_t>(record.offset - first_offset));
+    stream.write(gsl::narrow<uint32_t>(record.length));
+    stream.write(static_cast<uint8_t>(record.key ? 1 : 0));
+    if (record.key) {
+      stream.write(*record.key, true);
+    }
+    stream.write(gsl::narrow<uint16_t>(record.headers.size()));
+    for (const auto& header : record.headers) {
+      stream.write(header.first, true);
+      stream.write(header.second, true);
+    }
+  }
+  return utils::StringUtils::to_base64(stream.getBuffer(), stream.size());
+}
+
+std::optional<KafkaRecordIndex> KafkaRecordIndex::parse(const std::string& serialized) {
+  std::vector<uint8_t> data;
+  try {
+    data = utils::StringUtils::from_base64(serialized.data(), serialized.size());
+  } catch (const std::exception&) {
+    return std::nullopt;
+  }
+  io::BufferStream stream(data.data(), data.size());
+
+  uint8_t version = 0;
+  uint32_t demarcator_length = 0;
+  uint64_t first_offset = 0;
+  uint32_t record_count = 0;
+  if (io::isError(stream.read(version)) || version != VERSION || io::isError(stream.read(demarcator_length))
+      || io::isError(stream.read(first_offset)) || io::isError(stream.read(record_count))) {
+    return std::nullopt;
+  }
+
+  KafkaRecordIndex index(demarcator_length);
+  for (uint32_t i = 0; i < record_count; ++i) {
+    uint32_t relative_offset = 0;
+    uint32_t length = 0;
+    uint8_t has_key = 0;
+    if (io::isError(stream.read(relative_offset)) || io::isError(stream.read(length)) || io::isError(stream.read(has_key))) {
+      return std::nullopt;
+    }
+    std::optional<std::string> key;
+    if (has_key) {
+      key.emplace();
+      if (io::isError(stream.read(*key, true))) {
+        return std::nullopt;
+      }
+    }
+    uint16_t header_count = 0;
+    if (io::isError(stream.read(header_count))) {
+      return std::nullopt;
+    }
+    std::vector<std::pair<std::string, std::string>> headers(header_count);
+    for (auto& header : headers) {
+      if (io::isError(stream.read(header.first, true)) || io::isError(stream.read(header.second, true))) {
+        return std::nullopt;
+      }
+    }
+    index.add(static_cast<int64_t>(first_offset) + relative_offset, length, std::move(key), std::move(headers));
+  }
+  return index;
+}
+
+}  // namespace processors
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
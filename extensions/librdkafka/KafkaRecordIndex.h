@@ -0,0 +1,81 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace processors {
+
+/**
+ * Index of the Kafka records packed into the content of a single flow file by ConsumeKafka.
+ * The records are written back to back, separated by the message demarcator (if any), the index
+ * stores the offset, the length, the key and the headers of each of them, so the records can be
+ * iterated without splitting the content.
+ *
+ * The serialized form is a Base64 encoded binary, stored in the kafka.record.index attribute.
+ */
+class KafkaRecordIndex {
+ public:
+  struct Record {
+    int64_t offset = 0;
+    // position of the record in the flow file content
+    uint64_t position = 0;
+    uint64_t length = 0;
+    std::optional<std::string> key;
+    std::vector<std::pair<std::string, std::string>> headers;
+  };
+
+  explicit KafkaRecordIndex(uint32_t demarcator_length = 0)
+      : demarcator_length_(demarcator_length) {
+  }
+
+  /**
+   * Appends a record to the end of the content, its position is calculated from the previous records.
+   */
+  void add(int64_t offset, uint64_t length, std::optional<std::string> key, std::vector<std::pair<std::string, std::string>> headers);
+
+  const std::vector<Record>& records() const {
+    return records_;
+  }
+
+  std::string serialize() const;
+
+  /**
+   * @return the index, or nullopt if serialized is not a valid serialized index
+   */
+  static std::optional<KafkaRecordIndex> parse(const std::string& serialized);
+
+ private:
+  static constexpr uint8_t VERSION = 1;
+
+  uint32_t demarcator_length_;
+  std::vector<Record> records_;
+};
+
+}  // namespace processors
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
@@ -26,6 +26,7 @@
 #include <map>
 #include <set>
 #include <type_traits>
+#include <unordered_map>
 #include <vector>
 
 #include "utils/gsl.h"
@@ -262,16 +263,75 @@ class PublishKafka::Messages {
 };
 
 namespace {
-class ReadCallback : public InputStreamCallback {
+/**
+ * Opaque of a produced message, owning the payload buffer that librdkafka borrows until the delivery report.
+ * Allocated in ReadCallback::produce, deallocated in messageDeliveryCallback.
+ */
+struct DeliveryContext {
+  std::shared_ptr<PublishKafka::Messages> messages;
+  size_t flow_file_index;
+  size_t segment_num;
+  std::unique_ptr<unsigned char[]> payload;
+  std::shared_ptr<core::logging::Logger> logger;
+
+  void onDelivery(const rd_kafka_message_t* rkmessage) const {
+    messages->modifyResult(flow_file_index, [this, rkmessage](FlowFileResult& flow_file) {
+      auto& message = flow_file.messages.at(segment_num);
+      message.err_code = rkmessage->err;
+      message.status = message.err_code == 0 ? MessageStatus::Success : MessageStatus::Error;
+      if (message.err_code != RD_KAFKA_RESP_ERR_NO_ERROR) {
+        logger->log_warn("delivery callback, flow file #%zu/segment #%zu: %s", flow_file_index, segment_num, rd_kafka_err2str(message.err_code));
+      } else {
+        logger->log_debug("delivery callback, flow file #%zu/segment #%zu: success", flow_file_index, segment_num);
+      }
+    });
+  }
+};
+
+struct rd_kafka_headers_deleter {
+  void operator()(rd_kafka_headers_t* ptr) const noexcept {
+    rd_kafka_headers_destroy(ptr);
+  }
+};
+
+using rd_kafka_headers_unique_ptr = std::unique_ptr<rd_kafka_headers_t, rd_kafka_headers_deleter>;
+
+/**
+ * Builds the Kafka headers of the flow files of a batch. The attribute names rarely differ between the
+ * flow files of a batch, so the result of the regex match is cached per attribute name.
+ */
+class HeaderBuilder {
  public:
-  struct rd_kafka_headers_deleter {
-    void operator()(rd_kafka_headers_t* ptr) const noexcept {
-      rd_kafka_headers_destroy(ptr);
+  explicit HeaderBuilder(const std::optional<std::regex>& attribute_name_regex)
+      : attribute_name_regex_(attribute_name_regex) {
+  }
+
+  rd_kafka_headers_unique_ptr build(const core::FlowFile& flow_file) {
+    const gsl::owner<rd_kafka_headers_t*> result{ rd_kafka_headers_new(8) };
+    if (!result) { throw std::bad_alloc{}; }
+    rd_kafka_headers_unique_ptr headers{ result };
+    if (!attribute_name_regex_) {
+      return headers;
+    }
+
+    for (const auto& kv : flow_file.getAttributes()) {
+      auto match = matches_.find(kv.first);
+      if (match == matches_.end()) {
+        match = matches_.emplace(kv.first, std::regex_search(kv.first, *attribute_name_regex_)).first;
+      }
+      if (match->second) {
+        rd_kafka_header_add(headers.get(), kv.first.c_str(), kv.first.size(), kv.second.c_str(), kv.second.size());
+      }
     }
-  };
+    return headers;
+  }
 
-  using rd_kafka_headers_unique_ptr = std::unique_ptr<rd_kafka_headers_t, rd_kafka_headers_deleter>;
+ private:
+  const std::optional<std::regex>& attribute_name_regex_;
+  std::unordered_map<std::string, bool> matches_;
+};
 
+class ReadCallback : public InputStreamCallback {
  private:
   void allocate_message_object(const size_t segment_num) const {
     messages_->modifyResult(flow_file_index_, [segment_num](FlowFileResult& flow_file) {
@@ -283,46 +343,22 @@ class ReadCallback : public InputStreamCallback {
     });
   }
 
-  static rd_kafka_headers_unique_ptr make_headers(const core::FlowFile& flow_file, std::regex& attribute_name_regex) {
-    const gsl::owner<rd_kafka_headers_t*> result{ rd_kafka_headers_new(8) };
-    if (!result) { throw std::bad_alloc{}; }
-
-    for (const auto& kv : flow_file.getAttributes()) {
-      if (std::regex_search(kv.first, attribute_name_regex)) {
-        rd_kafka_header_add(result, kv.first.c_str(), kv.first.size(), kv.second.c_str(), kv.second.size());
-      }
-    }
-    return rd_kafka_headers_unique_ptr{ result };
-  }
-
-  rd_kafka_resp_err_t produce(const size_t segment_num, std::vector<unsigned char>& buffer, const size_t buflen) const {
-    const std::shared_ptr<PublishKafka::Messages> messages_ptr_copy = this->messages_;
-    const auto flow_file_index_copy = this->flow_file_index_;
-    const auto logger = logger_;
-    const auto produce_callback = [messages_ptr_copy, flow_file_index_copy, segment_num, logger](rd_kafka_t * /*rk*/, const rd_kafka_message_t *rkmessage) {
-      messages_ptr_copy->modifyResult(flow_file_index_copy, [segment_num, rkmessage, logger, flow_file_index_copy](FlowFileResult &flow_file) {
-        auto &message = flow_file.messages.at(segment_num);
-        message.err_code = rkmessage->err;
-        message.status = message.err_code == 0 ? MessageStatus::Success : MessageStatus::Error;
-        if (message.err_code != RD_KAFKA_RESP_ERR_NO_ERROR) {
-          logger->log_warn("delivery callback, flow file #%zu/segment #%zu: %s", flow_file_index_copy, segment_num, rd_kafka_err2str(message.err_code));
-        } else {
-          logger->log_debug("delivery callback, flow file #%zu/segment #%zu: success", flow_file_index_copy, segment_num);
-        }
-      });
-    };
-    // release()d below, deallocated in PublishKafka::messageDeliveryCallback
-    auto callback_ptr = std::make_unique<std::function<void(rd_kafka_t*, const rd_kafka_message_t*)>>(std::move(produce_callback));
+  rd_kafka_resp_err_t produce(const size_t segment_num, std::unique_ptr<unsigned char[]> payload, const size_t payload_size, const bool last_segment) {
+    // release()d below, deallocated in messageDeliveryCallback
+    auto delivery_context = std::make_unique<DeliveryContext>(DeliveryContext{messages_, flow_file_index_, segment_num, std::move(payload), logger_});
 
     allocate_message_object(segment_num);
 
-    const gsl::owner<rd_kafka_headers_t*> hdrs_copy = rd_kafka_headers_copy(hdrs.get());
-    const auto err = rd_kafka_producev(rk_, RD_KAFKA_V_RKT(rkt_), RD_KAFKA_V_PARTITION(RD_KAFKA_PARTITION_UA), RD_KAFKA_V_MSGFLAGS(RD_KAFKA_MSG_F_COPY), RD_KAFKA_V_VALUE(buffer.data(), buflen),
-        RD_KAFKA_V_HEADERS(hdrs_copy), RD_KAFKA_V_KEY(key_.c_str(), key_.size()), RD_KAFKA_V_OPAQUE(callback_ptr.get()), RD_KAFKA_V_END);
+    // librdkafka takes ownership of the headers, the last segment can have the original ones
+    const gsl::owner<rd_kafka_headers_t*> hdrs_copy = last_segment ? hdrs.release() : rd_kafka_headers_copy(hdrs.get());
+    // no RD_KAFKA_MSG_F_COPY: librdkafka borrows the payload of delivery_context, which is kept alive until the delivery report
+    const auto err = rd_kafka_producev(rk_, RD_KAFKA_V_RKT(rkt_), RD_KAFKA_V_PARTITION(RD_KAFKA_PARTITION_UA), RD_KAFKA_V_MSGFLAGS(0),
+        RD_KAFKA_V_VALUE(delivery_context->payload.get(), payload_size), RD_KAFKA_V_HEADERS(hdrs_copy), RD_KAFKA_V_KEY(key_.c_str(), key_.size()),
+        RD_KAFKA_V_OPAQUE(delivery_context.get()), RD_KAFKA_V_END);
     if (err == RD_KAFKA_RESP_ERR_NO_ERROR) {
-      // in case of failure, messageDeliveryCallback is not called and callback_ptr will delete the callback
-      // in case of success, messageDeliveryCallback takes ownership of the callback, so we no longer need to delete it
-      (void)callback_ptr.release();
+      // in case of failure, messageDeliveryCallback is not called and delivery_context will delete the context and the payload
+      // in case of success, messageDeliveryCallback takes ownership of the context, so we no longer need to delete it
+      (void)delivery_context.release();
     } else {
       // in case of failure, rd_kafka_producev doesn't take ownership of the headers, so we need to delete them
       rd_kafka_headers_destroy(hdrs_copy);
@@ -337,7 +373,7 @@ class ReadCallback : public InputStreamCallback {
       rd_kafka_topic_t* const rkt,
       rd_kafka_t* const rk,
       const core::FlowFile& flowFile,
-      std::regex& attributeNameRegex,
+      rd_kafka_headers_unique_ptr headers,
       std::shared_ptr<PublishKafka::Messages> messages,
       const size_t flow_file_index,
       const bool fail_empty_flow_files,
@@ -347,20 +383,18 @@ class ReadCallback : public InputStreamCallback {
       key_(std::move(key)),
       rkt_(rkt),
       rk_(rk),
-      hdrs(make_headers(flowFile, attributeNameRegex)),
+      hdrs(std::move(headers)),
       messages_(std::move(messages)),
       flow_file_index_(flow_file_index),
       fail_empty_flow_files_(fail_empty_flow_files),
-      logger_(std::move(logger))
-  { }
+      logger_(std::move(logger)) {
+    gsl_Expects(hdrs);
+  }
 
   ReadCallback(const ReadCallback&) = delete;
   ReadCallback& operator=(ReadCallback) = delete;
 
   int64_t process(const std::shared_ptr<io::BaseStream>& stream) override {
-    std::vector<unsigned char> buffer;
-
-    buffer.resize(max_seg_size_);
     read_size_ = 0;
     status_ = 0;
     called_ = true;
@@ -374,7 +408,7 @@ class ReadCallback : public InputStreamCallback {
 
     // If the flow file is empty, we still want to send the message, unless the user wants to fail_empty_flow_files_
     if (flow_size_ == 0 && !fail_empty_flow_files_) {
-      const auto err = produce(0, buffer, 0);
+      const auto err = produce(0, nullptr, 0, true);
       if (err != RD_KAFKA_RESP_ERR_NO_ERROR) {
         status_ = -1;
         error_ = rd_kafka_err2str(err);
@@ -383,7 +417,11 @@ class ReadCallback : public InputStreamCallback {
     }
 
     for (size_t segment_num = 0; read_size_ < flow_size_; ++segment_num) {
-      const auto readRet = stream->read(buffer.data(), buffer.size());
+      // every segment is read into its own buffer, which is handed over to librdkafka without copying
+      const size_t segment_size = std::min<uint64_t>(max_seg_size_, flow_size_ - read_size_);
+      // not std::make_unique, which would needlessly zero the buffer
+      std::unique_ptr<unsigned char[]> buffer{new unsigned char[segment_size]};
+      const auto readRet = stream->read(buffer.get(), segment_size);
       if (io::isError(readRet)) {
         status_ = -1;
         error_ = "Failed to read from stream";
@@ -391,7 +429,8 @@ class ReadCallback : public InputStreamCallback {
       }
       if (readRet == 0) { break; }
 
-      const auto err = produce(segment_num, buffer, readRet);
+      const bool last_segment = read_size_ + readRet >= flow_size_;
+      const auto err = produce(segment_num, std::move(buffer), readRet, last_segment);
       if (err) {
         messages_->modifyResult(flow_file_index_, [segment_num, err](FlowFileResult& flow_file) {
           auto& message = flow_file.messages.at(segment_num);
@@ -412,7 +451,7 @@ class ReadCallback : public InputStreamCallback {
   const std::string key_;
   rd_kafka_topic_t* const rkt_ = nullptr;
   rd_kafka_t* const rk_ = nullptr;
-  const rd_kafka_headers_unique_ptr hdrs;  // not null
+  rd_kafka_headers_unique_ptr hdrs;  // not null until the last segment is produced
   const std::shared_ptr<PublishKafka::Messages> messages_;
   const size_t flow_file_index_;
   int status_ = 0;
@@ -426,16 +465,15 @@ class ReadCallback : public InputStreamCallback {
 /**
  * Message delivery report callback using the richer rd_kafka_message_t object.
  */
-void messageDeliveryCallback(rd_kafka_t* rk, const rd_kafka_message_t* rkmessage, void* /*opaque*/) {
+void messageDeliveryCallback(rd_kafka_t* /*rk*/, const rd_kafka_message_t* rkmessage, void* /*opaque*/) {
   if (rkmessage->_private == nullptr) {
     return;
   }
-  // allocated in ReadCallback::produce
-  auto* const func = reinterpret_cast<std::function<void(rd_kafka_t*, const rd_kafka_message_t*)>*>(rkmessage->_private);
+  // allocated in ReadCallback::produce, owns the payload of the message
+  const std::unique_ptr<DeliveryContext> delivery_context{static_cast<DeliveryContext*>(rkmessage->_private)};
   try {
-    (*func)(rk, rkmessage);
+    delivery_context->onDelivery(rkmessage);
   } catch (...) { }
-  delete func;
 }
 }  // namespace
 
@@ -510,7 +548,7 @@ void PublishKafka::onSchedule(const std::shared_ptr<core::ProcessContext> &conte
   // Attributes to Send as Headers
   std::string value;
   if (context->getProperty(AttributeNameRegex.getName(), value) && !value.empty()) {
-    attributeNameRegex_ = std::regex(value);
+    attributeNameRegex_.emplace(value);
     logger_->log_debug("PublishKafka: AttributeNameRegex [%s]", value);
   }
 
@@ -817,6 +855,8 @@ void PublishKafka::onTrigger(const std::shared_ptr<core::ProcessContext> &contex
     messages_set_.erase(messages);
   });
 
+  HeaderBuilder header_builder(attributeNameRegex_);
+
   // Process FlowFiles
   for (auto& flowFile : flowFiles) {
     size_t flow_file_index = messages->addFlowFile();
@@ -863,7 +903,7 @@ void PublishKafka::onTrigger(const std::shared_ptr<core::ProcessContext> &contex
     context->getProperty(FailEmptyFlowFiles.getName(), failEmptyFlowFiles);
 
     ReadCallback callback(max_flow_seg_size_, kafkaKey, thisTopic->getTopic(), conn_->getConnection(), *flowFile,
-                                        attributeNameRegex_, messages, flow_file_index, failEmptyFlowFiles, logger_);
+                                        header_builder.build(*flowFile), messages, flow_file_index, failEmptyFlowFiles, logger_);
     session->read(flowFile, &callback);
 
     if (!callback.called_) {
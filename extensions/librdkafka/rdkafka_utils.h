@@ -70,6 +70,10 @@ struct rd_kafka_consumer_deleter {
   }
 };
 
+struct rd_kafka_queue_deleter {
+  void operator()(rd_kafka_queue_t* ptr) const noexcept { rd_kafka_queue_destroy(ptr); }
+};
+
 struct rd_kafka_topic_partition_list_deleter {
   void operator()(rd_kafka_topic_partition_list_t* ptr) const noexcept { rd_kafka_topic_partition_list_destroy(ptr); }
 };
@@ -0,0 +1,83 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ChunkedRocksDbStream.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "Exception.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace io {
+
+ChunkedRocksDbStream::ChunkedRocksDbStream(std::string key_prefix, gsl::not_null<minifi::internal::RocksDatabase*> db, size_t chunk_size)
+    : key_prefix_(std::move(key_prefix)),
+      db_(db),
+      chunk_size_(std::max<size_t>(chunk_size, 1)) {
+}
+
+ChunkedRocksDbStream::~ChunkedRocksDbStream() {
+  auto opendb = db_->open();
+  if (!opendb) {
+    return;
+  }
+  for (const auto& key : chunk_keys_) {
+    opendb->Delete(rocksdb::WriteOptions(), key);
+  }
+}
+
+size_t ChunkedRocksDbStream::write(const uint8_t* value, size_t len) {
+  auto opendb = db_->open();
+  if (!opendb) {
+    return STREAM_ERROR;
+  }
+  for (size_t offset = 0; offset < len; offset += chunk_size_) {
+    auto key = key_prefix_ + "." + std::to_string(next_chunk_index_++);
+    const rocksdb::Slice chunk(reinterpret_cast<const char*>(value) + offset, std::min(chunk_size_, len - offset));
+    if (!opendb->Put(rocksdb::WriteOptions(), key, chunk).ok()) {
+      return STREAM_ERROR;
+    }
+    chunk_keys_.push_back(std::move(key));
+  }
+  size_ += len;
+  return len;
+}
+
+void ChunkedRocksDbStream::appendTo(minifi::internal::OpenRocksDb& opendb, const std::string& key) {
+  for (; !chunk_keys_.empty(); chunk_keys_.pop_front()) {
+    const auto& chunk_key = chunk_keys_.front();
+    std::string chunk;
+    if (!opendb.Get(rocksdb::ReadOptions(), chunk_key, &chunk).ok()) {
+      throw Exception(REPOSITORY_EXCEPTION, "Couldn't read the staged content: " + chunk_key);
+    }
+    auto batch = opendb.createWriteBatch();
+    if (!batch.Merge(key, chunk).ok() || !batch.Delete(chunk_key).ok() || !opendb.Write(rocksdb::WriteOptions(), &batch).ok()) {
+      throw Exception(REPOSITORY_EXCEPTION, "Failed to append to resource: " + key);
+    }
+  }
+}
+
+}  // namespace io
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
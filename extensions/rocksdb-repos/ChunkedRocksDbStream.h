@@ -0,0 +1,81 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <deque>
+#include <string>
+
+#include "database/RocksDatabase.h"
+#include "io/BaseStream.h"
+#include "utils/gsl.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace io {
+
+/**
+ * Write-only stream storing its content in chunks of at most chunk_size bytes, each under its own key
+ * (<key prefix>.<index>), so that the content can be appended to another key without reading all of it into memory.
+ * The chunks not appended are deleted with the stream.
+ */
+class ChunkedRocksDbStream : public io::BaseStream {
+ public:
+  ChunkedRocksDbStream(std::string key_prefix, gsl::not_null<minifi::internal::RocksDatabase*> db, size_t chunk_size);
+
+  ~ChunkedRocksDbStream() override;
+
+  using BaseStream::write;
+  using BaseStream::read;
+
+  size_t write(const uint8_t* value, size_t len) override;
+
+  size_t read(uint8_t* /*buffer*/, size_t /*len*/) override {
+    return STREAM_ERROR;
+  }
+
+  size_t size() const override {
+    return size_;
+  }
+
+  size_t getChunkCount() const {
+    return chunk_keys_.size();
+  }
+
+  /**
+   * Merges the chunks into the end of the given key in order. Each chunk is moved in its own batch, so only a single
+   * chunk is held in memory at a time, but a failure can leave the key partially extended.
+   * @throws Exception if a chunk could not be moved
+   */
+  void appendTo(minifi::internal::OpenRocksDb& opendb, const std::string& key);
+
+ private:
+  std::string key_prefix_;
+  gsl::not_null<minifi::internal::RocksDatabase*> db_;
+  size_t chunk_size_;
+  size_t next_chunk_index_ = 0;
+  std::deque<std::string> chunk_keys_;
+  size_t size_ = 0;
+};
+
+}  // namespace io
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
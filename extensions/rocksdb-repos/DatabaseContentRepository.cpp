@@ -23,6 +23,7 @@
 #include "DatabaseContentRepository.h"
 #include "encryption/RocksDbEncryptionProvider.h"
 #include "RocksDbStream.h"
+#include "ChunkedRocksDbStream.h"
 #include "utils/gsl.h"
 #include "Exception.h"
 #include "database/StringAppender.h"
@@ -42,6 +43,7 @@ bool DatabaseContentRepository::initialize(const std::shared_ptr<minifi::Configu
   } else {
     directory_ = configuration->getHome() + "/dbcontentrepository";
   }
+  readSessionSpillThreshold(*configuration);
   const auto encrypted_env = createEncryptingEnv(utils::crypto::EncryptionManager{configuration->getHome()}, DbEncryptionOptions{directory_, ENCRYPTION_KEY_NAME});
   logger_->log_info("Using %s DatabaseContentRepository", encrypted_env ? "encrypted" : "plaintext");
 
@@ -81,10 +83,51 @@ void DatabaseContentRepository::stop() {
   db_.reset();
 }
 
-DatabaseContentRepository::Session::Session(std::shared_ptr<ContentRepository> repository) : ContentSession(std::move(repository)) {}
+// spills the appended content into chunks instead of a single pending object, which could only be read back as a whole
+class DatabaseContentRepository::Session::ExtensionStream : public StagedStream {
+ public:
+  ExtensionStream(std::shared_ptr<DatabaseContentRepository> repository, size_t spill_threshold)
+      : StagedStream(repository, nullptr, spill_threshold),
+        repository_(std::move(repository)),
+        spill_threshold_(spill_threshold) {
+  }
+
+  void appendTo(minifi::internal::OpenRocksDb& opendb, const std::string& key) {
+    flush();
+    chunks_->appendTo(opendb, key);
+  }
+
+ protected:
+  std::shared_ptr<io::BaseStream> openPendingStream() override {
+    if (!repository_->is_valid_ || !repository_->db_) {
+      return nullptr;
+    }
+    // only used to name the chunks uniquely
+    key_claim_ = std::make_shared<ResourceClaim>(repository_);
+    chunks_ = std::make_shared<io::ChunkedRocksDbStream>(key_claim_->getContentFullPath(), gsl::make_not_null<minifi::internal::RocksDatabase*>(repository_->db_.get()),
+        spill_threshold_);
+    return chunks_;
+  }
+
+ private:
+  std::shared_ptr<DatabaseContentRepository> repository_;
+  size_t spill_threshold_;
+  std::shared_ptr<ResourceClaim> key_claim_;
+  std::shared_ptr<io::ChunkedRocksDbStream> chunks_;
+};
+
+DatabaseContentRepository::Session::Session(std::shared_ptr<ContentRepository> repository, std::optional<size_t> spill_threshold)
+    : ContentSession(std::move(repository), spill_threshold) {}
+
+std::shared_ptr<ContentSession::StagedStream> DatabaseContentRepository::Session::createExtensionStream() const {
+  if (!spill_threshold_) {
+    return ContentSession::createExtensionStream();
+  }
+  return std::make_shared<ExtensionStream>(std::static_pointer_cast<DatabaseContentRepository>(repository_), *spill_threshold_);
+}
 
 std::shared_ptr<ContentSession> DatabaseContentRepository::createSession() {
-  return std::make_shared<Session>(sharedFromThis());
+  return std::make_shared<Session>(sharedFromThis(), session_spill_threshold_);
 }
 
 void DatabaseContentRepository::Session::commit() {
@@ -93,8 +136,19 @@ void DatabaseContentRepository::Session::commit() {
   if (!opendb) {
     throw Exception(REPOSITORY_EXCEPTION, "Couldn't open rocksdb database to commit content changes");
   }
+  // the spilled extensions are moved chunk by chunk, the synchronous write of the batch below also persists them
+  for (const auto& resource : extendedResources_) {
+    if (resource.second->isSpilled()) {
+      std::static_pointer_cast<ExtensionStream>(resource.second)->appendTo(*opendb, resource.first->getContentFullPath());
+    }
+  }
   auto batch = opendb->createWriteBatch();
   for (const auto& resource : managedResources_) {
+    if (resource.second->isSpilled()) {
+      // already merged into the database under the claim's key
+      resource.second->flush();
+      continue;
+    }
     auto outStream = dbContentRepository->write(*resource.first, false, &batch);
     if (outStream == nullptr) {
       throw Exception(REPOSITORY_EXCEPTION, "Couldn't open the underlying resource for write: " + resource.first->getContentFullPath());
@@ -105,6 +159,9 @@ void DatabaseContentRepository::Session::commit() {
     }
   }
   for (const auto& resource : extendedResources_) {
+    if (resource.second->isSpilled()) {
+      continue;
+    }
     auto outStream = dbContentRepository->write(*resource.first, true, &batch);
     if (outStream == nullptr) {
       throw Exception(REPOSITORY_EXCEPTION, "Couldn't open the underlying resource for append: " + resource.first->getContentFullPath());
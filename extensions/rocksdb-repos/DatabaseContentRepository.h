@@ -19,6 +19,7 @@
 
 #include <string>
 #include <memory>
+#include <optional>
 
 #include "core/Core.h"
 #include "core/Connectable.h"
@@ -42,9 +43,15 @@ namespace repository {
 class DatabaseContentRepository : public core::ContentRepository, public core::Connectable {
   class Session : public ContentSession {
    public:
-    explicit Session(std::shared_ptr<ContentRepository> repository);
+    Session(std::shared_ptr<ContentRepository> repository, std::optional<size_t> spill_threshold);
 
     void commit() override;
+
+   protected:
+    std::shared_ptr<StagedStream> createExtensionStream() const override;
+
+   private:
+    class ExtensionStream;
   };
 
  public:
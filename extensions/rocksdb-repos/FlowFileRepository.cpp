@@ -17,8 +17,8 @@
  */
 #include "FlowFileRepository.h"
 
+#include <charconv>
 #include <chrono>
-#include <list>
 #include <memory>
 #include <optional>
 #include <string>
@@ -46,83 +46,97 @@ void FlowFileRepository::flush() {
   if (!opendb) {
     return;
   }
+  const auto before = std::chrono::steady_clock::now();
   auto batch = opendb->createWriteBatch();
-  rocksdb::ReadOptions options;
 
-  std::vector<std::shared_ptr<FlowFile>> purgeList;
+  std::vector<ExpiredFlowFileInfo> flow_files;
+  std::vector<size_t> unknown_claims;  // indices of the flow_files whose record has to be read to find the claim
 
-  std::vector<rocksdb::Slice> keys;
-  std::list<std::string> keystrings;
-  std::vector<std::string> values;
-
-  while (keys_to_delete.size_approx() > 0) {
-    std::string key;
-    if (keys_to_delete.try_dequeue(key)) {
-      keystrings.push_back(std::move(key));  // rocksdb::Slice doesn't copy the string, only grabs ptrs. Hacky, but have to ensure the required lifetime of the strings.
-      keys.push_back(keystrings.back());
+  ExpiredFlowFileInfo info;
+  while (keys_to_delete.try_dequeue(info)) {
+    if (!info.content) {
+      unknown_claims.push_back(flow_files.size());
     }
+    flow_files.push_back(std::move(info));
+  }
+  if (flow_files.empty()) {
+    return;
   }
-  auto multistatus = opendb->MultiGet(options, keys, &values);
 
-  for (size_t i = 0; i < keys.size() && i < values.size() && i < multistatus.size(); ++i) {
-    if (!multistatus[i].ok()) {
-      logger_->log_error("Failed to read key from rocksdb: %s! DB is most probably in an inconsistent state!", keys[i].data());
-      keystrings.remove(keys[i].data());
-      continue;
+  if (!unknown_claims.empty()) {
+    std::vector<rocksdb::Slice> keys;
+    for (auto idx : unknown_claims) {
+      keys.push_back(flow_files[idx].key);
     }
+    std::vector<std::string> values;
+    auto multistatus = opendb->MultiGet(rocksdb::ReadOptions(), keys, &values);
+    for (size_t i = 0; i < unknown_claims.size(); ++i) {
+      auto& flow_file = flow_files[unknown_claims[i]];
+      if (i >= values.size() || i >= multistatus.size() || !multistatus[i].ok()) {
+        logger_->log_error("Failed to read key from rocksdb: %s! DB is most probably in an inconsistent state!", flow_file.key);
+        continue;
+      }
+      utils::Identifier containerId;
+      auto eventRead = FlowFileRecord::DeSerialize(reinterpret_cast<const uint8_t *>(values[i].data()), gsl::narrow<int>(values[i].size()), content_repo_, containerId, dictionary_);
+      flow_file.content = eventRead ? eventRead->getResourceClaim() : nullptr;
+    }
+  }
 
-    utils::Identifier containerId;
-    auto eventRead = FlowFileRecord::DeSerialize(reinterpret_cast<const uint8_t *>(values[i].data()), gsl::narrow<int>(values[i].size()), content_repo_, containerId);
-    if (eventRead) {
-      purgeList.push_back(eventRead);
+  for (const auto& flow_file : flow_files) {
+    if (!flow_file.content) {
+      // could not be read, leave it in the database
+      continue;
     }
-    logger_->log_debug("Issuing batch delete, including %s, Content path %s", eventRead->getUUIDStr(), eventRead->getContentFullPath());
-    batch.Delete(keys[i]);
+    logger_->log_debug("Issuing batch delete, including %s, Content path %s", flow_file.key, *flow_file.content ? (*flow_file.content)->getContentFullPath() : "null");
+    batch.Delete(flow_file.key);
   }
 
   auto operation = [&batch, &opendb]() { return opendb->Write(rocksdb::WriteOptions(), &batch); };
 
   if (!ExecuteWithRetry(operation)) {
-    for (const auto& key : keystrings) {
-      keys_to_delete.enqueue(key);  // Push back the values that we could get but couldn't delete
+    for (auto& flow_file : flow_files) {
+      if (flow_file.content) {
+        keys_to_delete.enqueue(std::move(flow_file));  // Push back the values that we could get but couldn't delete
+      }
     }
     return;  // Stop here - don't delete from content repo while we have records in FF repo
   }
 
   if (content_repo_) {
-    for (const auto &ffr : purgeList) {
-      auto claim = ffr->getResourceClaim();
-      if (claim) claim->decreaseFlowFileRecordOwnedCount();
+    for (const auto& flow_file : flow_files) {
+      if (flow_file.content && *flow_file.content) {
+        (*flow_file.content)->decreaseFlowFileRecordOwnedCount();
+      }
     }
   }
+
+  last_delete_batch_latency_us_ = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - before).count();
 }
 
-void FlowFileRepository::printStats() {
+void FlowFileRepository::refreshStorageMetrics() {
   auto opendb = db_->open();
   if (!opendb) {
     return;
   }
-  std::string key_count;
-  opendb->GetProperty("rocksdb.estimate-num-keys", &key_count);
-
-  std::string table_readers;
-  opendb->GetProperty("rocksdb.estimate-table-readers-mem", &table_readers);
-
-  std::string all_memtables;
-  opendb->GetProperty("rocksdb.cur-size-all-mem-tables", &all_memtables);
+  storage_metrics_.refresh(*opendb);
+}
 
-  logger_->log_info("Repository stats: key count: %s, table readers size: %s, all memory tables size: %s",
-      key_count, table_readers, all_memtables);
+void FlowFileRepository::printStats() {
+  const auto storage_metrics = storage_metrics_.get();
+  logger_->log_info("Repository stats: key count: %" PRIu64 ", table readers size: %" PRIu64 ", all memory tables size: %" PRIu64,
+      storage_metrics.estimated_key_count, storage_metrics.table_readers_memory, storage_metrics.memtables_memory);
 }
 
 void FlowFileRepository::run() {
   auto last = std::chrono::steady_clock::now();
   if (running_) {
     prune_stored_flowfiles();
+    refreshStorageMetrics();
   }
   while (running_) {
     std::this_thread::sleep_for(purge_period_);
     flush();
+    refreshStorageMetrics();
     auto now = std::chrono::steady_clock::now();
     if ((now-last) > std::chrono::seconds(30)) {
       printStats();
@@ -168,7 +182,7 @@ void FlowFileRepository::prune_stored_flowfiles() {
   auto it = opendb->NewIterator(rocksdb::ReadOptions());
   for (it->SeekToFirst(); it->Valid(); it->Next()) {
     utils::Identifier containerId;
-    auto eventRead = FlowFileRecord::DeSerialize(reinterpret_cast<const uint8_t *>(it->value().data()), gsl::narrow<int>(it->value().size()), content_repo_, containerId);
+    auto eventRead = FlowFileRecord::DeSerialize(reinterpret_cast<const uint8_t *>(it->value().data()), gsl::narrow<int>(it->value().size()), content_repo_, containerId, dictionary_);
     std::string key = it->key().ToString();
     if (eventRead) {
       // on behalf of the just resurrected persisted instance
@@ -190,11 +204,11 @@ void FlowFileRepository::prune_stored_flowfiles() {
         search->second->restore(eventRead);
       } else {
         logger_->log_warn("Could not find connection for %s, path %s ", containerId.to_string(), eventRead->getContentFullPath());
-        keys_to_delete.enqueue(key);
+        keys_to_delete.enqueue({std::move(key), claim});
       }
     } else {
       // failed to deserialize FlowFile, cannot clear claim
-      keys_to_delete.enqueue(key);
+      keys_to_delete.enqueue({std::move(key), nullptr});
     }
   }
 }
@@ -214,6 +228,45 @@ bool FlowFileRepository::ExecuteWithRetry(std::function<rocksdb::Status()> opera
   return false;
 }
 
+bool FlowFileRepository::loadRecordDictionary(minifi::internal::OpenRocksDb& opendb) {
+  auto it = opendb.NewIterator(rocksdb::ReadOptions());
+  for (it->SeekToFirst(); it->Valid(); it->Next()) {
+    const auto id_str = it->key().ToString();
+    uint32_t id = 0;
+    const auto result = std::from_chars(id_str.data(), id_str.data() + id_str.size(), id);
+    if (result.ec != std::errc() || result.ptr != id_str.data() + id_str.size() || !dictionary_->restore(id, it->value().ToString())) {
+      logger_->log_error("Invalid FlowFile record dictionary entry %s", it->key().ToString());
+      return false;
+    }
+  }
+  logger_->log_debug("Loaded %zu FlowFile record dictionary entries", dictionary_->size());
+  return true;
+}
+
+bool FlowFileRepository::persistRecordDictionary() {
+  const auto entries = dictionary_->getUnpersistedEntries();
+  if (entries.empty()) {
+    return true;
+  }
+  auto opendb = dictionary_db_->open();
+  if (!opendb) {
+    return false;
+  }
+  auto batch = opendb->createWriteBatch();
+  for (const auto& entry : entries) {
+    if (!batch.Put(std::to_string(entry.first), entry.second).ok()) {
+      logger_->log_error("Failed to add item to batch operation");
+      return false;
+    }
+  }
+  auto operation = [&batch, &opendb]() { return opendb->Write(rocksdb::WriteOptions(), &batch); };
+  if (!ExecuteWithRetry(operation)) {
+    return false;
+  }
+  dictionary_->markPersisted(entries);
+  return true;
+}
+
 /**
  * Returns True if there is data to interrogate.
  * @return true if our db has data stored.
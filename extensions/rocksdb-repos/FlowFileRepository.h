@@ -17,6 +17,8 @@
  */
 #pragma once
 
+#include <atomic>
+#include <optional>
 #include <utility>
 #include <vector>
 #include <string>
@@ -89,6 +91,9 @@ class FlowFileRepository : public core::Repository, public std::enable_shared_fr
 
   virtual void flush();
 
+  /**
+   * Logs the size estimates of the database as of the last refresh.
+   */
   virtual void printStats();
 
   // initialize
@@ -136,13 +141,18 @@ class FlowFileRepository : public core::Repository, public std::enable_shared_fr
       cf_opts.set<int>(&rocksdb::ColumnFamilyOptions::min_write_buffer_number_to_merge, 1);
     };
     db_ = minifi::internal::RocksDatabase::create(db_options, cf_options, directory_);
-    if (db_->open()) {
-      logger_->log_debug("NiFi FlowFile Repository database open %s success", directory_);
-      return true;
-    } else {
+    if (!db_->open()) {
       logger_->log_error("NiFi FlowFile Repository database open %s fail", directory_);
       return false;
     }
+    logger_->log_debug("NiFi FlowFile Repository database open %s success", directory_);
+    dictionary_db_ = minifi::internal::RocksDatabase::create(db_options, {}, "minifidb://" + directory_ + "/" + RECORD_DICTIONARY_COLUMN);
+    auto dictionary_db = dictionary_db_ ? dictionary_db_->open() : std::nullopt;
+    if (!dictionary_db) {
+      logger_->log_error("NiFi FlowFile Repository record dictionary open %s fail", directory_);
+      return false;
+    }
+    return loadRecordDictionary(*dictionary_db);
   }
 
   virtual void run();
@@ -153,6 +163,9 @@ class FlowFileRepository : public core::Repository, public std::enable_shared_fr
     if (!opendb) {
       return false;
     }
+    if (!persistRecordDictionary()) {
+      return false;
+    }
     rocksdb::Slice value((const char *) buf, bufLen);
     auto operation = [&key, &value, &opendb]() { return opendb->Put(rocksdb::WriteOptions(), key, value); };
     return ExecuteWithRetry(operation);
@@ -163,6 +176,9 @@ class FlowFileRepository : public core::Repository, public std::enable_shared_fr
     if (!opendb) {
       return false;
     }
+    if (!persistRecordDictionary()) {
+      return false;
+    }
     auto batch = opendb->createWriteBatch();
     for (const auto &item : data) {
       rocksdb::Slice value((const char *) item.second->getBuffer(), item.second->size());
@@ -182,9 +198,32 @@ class FlowFileRepository : public core::Repository, public std::enable_shared_fr
    * @return status of the delete operation
    */
   virtual bool Delete(std::string key) {
-    keys_to_delete.enqueue(key);
+    keys_to_delete.enqueue({std::move(key), std::nullopt});
+    return true;
+  }
+
+  /**
+   * Deletes the key without reading the record back on flush,
+   * the passed claim is released once the deletion is written.
+   * @return status of the delete operation
+   */
+  bool Delete(const std::string& key, const std::shared_ptr<ResourceClaim>& claim) override {
+    keys_to_delete.enqueue({key, claim});
     return true;
   }
+
+  std::shared_ptr<FlowFileRecordDictionary> getRecordDictionary() const override {
+    return dictionary_;
+  }
+
+  std::optional<RepositoryDeleteMetrics> getDeleteMetrics() const override {
+    return RepositoryDeleteMetrics{keys_to_delete.size_approx(), std::chrono::microseconds{last_delete_batch_latency_us_.load()}};
+  }
+
+  std::optional<RepositoryStorageMetrics> getStorageMetrics() const override {
+    return storage_metrics_.get();
+  }
+
   /**
    * Sets the value from the provided key
    * @return status of the get operation.
@@ -212,8 +251,21 @@ class FlowFileRepository : public core::Repository, public std::enable_shared_fr
   }
 
  private:
+  // the record dictionary entries are kept in their own column, so that they are not counted as FlowFile records
+  static constexpr const char* RECORD_DICTIONARY_COLUMN = "record_dictionary";
+
   bool ExecuteWithRetry(std::function<rocksdb::Status()> operation);
 
+  void refreshStorageMetrics();
+
+  bool loadRecordDictionary(minifi::internal::OpenRocksDb& opendb);
+
+  /**
+   * Stores the new dictionary entries, the records referencing them are only written afterwards,
+   * and the shared write-ahead log of the columns keeps this order on recovery.
+   */
+  bool persistRecordDictionary();
+
   /**
    * Initialize the repository
    */
@@ -230,10 +282,20 @@ class FlowFileRepository : public core::Repository, public std::enable_shared_fr
    */
   void prune_stored_flowfiles();
 
+  struct ExpiredFlowFileInfo {
+    std::string key;
+    // the claim referenced by the record, std::nullopt if it has to be read from the database
+    std::optional<std::shared_ptr<ResourceClaim>> content;
+  };
+
   std::string checkpoint_dir_;
-  moodycamel::ConcurrentQueue<std::string> keys_to_delete;
+  moodycamel::ConcurrentQueue<ExpiredFlowFileInfo> keys_to_delete;
+  std::atomic<uint64_t> last_delete_batch_latency_us_{0};
+  minifi::internal::StorageMetricsCache storage_metrics_;
+  std::shared_ptr<FlowFileRecordDictionary> dictionary_ = std::make_shared<FlowFileRecordDictionary>();
   std::shared_ptr<core::ContentRepository> content_repo_;
   std::unique_ptr<minifi::internal::RocksDatabase> db_;
+  std::unique_ptr<minifi::internal::RocksDatabase> dictionary_db_;
   std::unique_ptr<rocksdb::Checkpoint> checkpoint_;
   std::shared_ptr<logging::Logger> logger_;
   std::shared_ptr<minifi::Configure> config_;
@@ -18,9 +18,14 @@
 
 #include "ProvenanceRepository.h"
 
+#include <algorithm>
+#include <deque>
+#include <set>
 #include <string>
+#include <vector>
 
 #include "core/Resource.h"
+#include "io/BufferStream.h"
 
 namespace org {
 namespace apache {
@@ -28,31 +33,374 @@ namespace nifi {
 namespace minifi {
 namespace provenance {
 
-void ProvenanceRepository::printStats() {
-  std::string key_count;
-  db_->GetProperty("rocksdb.estimate-num-keys", &key_count);
+namespace {
 
-  std::string table_readers;
-  db_->GetProperty("rocksdb.estimate-table-readers-mem", &table_readers);
+// the number of events read from the database at once while answering a query
+constexpr size_t QUERY_BATCH_SIZE = 256;
+// upper limit of the time the repository thread waits for events, a commit may queue its events without waking it up
+constexpr auto MAX_WRITE_DELAY = std::chrono::milliseconds(100);
+constexpr auto STATS_PERIOD = std::chrono::seconds(30);
+constexpr auto STORAGE_METRICS_PERIOD = std::chrono::seconds(1);
 
-  std::string all_memtables;
-  db_->GetProperty("rocksdb.cur-size-all-mem-tables", &all_memtables);
+struct IndexedFields {
+  uint32_t event_type = 0;
+  uint64_t event_time_ms = 0;
+  std::string component_id;
+  utils::Identifier flow_file_uuid;
+};
 
-  logger_->log_info("Repository stats: key count: %s, table readers size: %s, all memory tables size: %s",
-                    key_count, table_readers, all_memtables);
+bool hasRelatedFlowFiles(uint32_t event_type) {
+  return event_type == ProvenanceEventRecord::FORK || event_type == ProvenanceEventRecord::CLONE || event_type == ProvenanceEventRecord::JOIN;
 }
 
-void ProvenanceRepository::run() {
+/**
+ * Reads the fields the events are indexed by, without parsing the rest of the serialized event.
+ * Follows the layout of ProvenanceEventRecord::Serialize.
+ */
+std::optional<IndexedFields> readIndexedFields(const uint8_t* buffer, size_t buffer_size) {
+  io::BufferStream stream(buffer, buffer_size);
+  IndexedFields fields;
+  utils::Identifier event_id;
+  uint64_t skipped_time = 0;
+  std::string component_type;
+  if (io::isError(stream.read(event_id)) || io::isError(stream.read(fields.event_type)) || io::isError(stream.read(fields.event_time_ms))) {
+    return std::nullopt;
+  }
+  // entry date, event duration and lineage start date
+  for (int i = 0; i < 3; ++i) {
+    if (io::isError(stream.read(skipped_time))) {
+      return std::nullopt;
+    }
+  }
+  if (io::isError(stream.read(fields.component_id)) || io::isError(stream.read(component_type)) || io::isError(stream.read(fields.flow_file_uuid))) {
+    return std::nullopt;
+  }
+  return fields;
+}
+
+// big endian, so that the index entries of a prefix are ordered by time
+std::string encodeTime(uint64_t time_ms) {
+  std::string encoded(sizeof(uint64_t), '\0');
+  for (size_t i = 0; i < sizeof(uint64_t); ++i) {
+    encoded[i] = static_cast<char>((time_ms >> (8 * (sizeof(uint64_t) - 1 - i))) & 0xFF);
+  }
+  return encoded;
+}
+
+uint64_t toMillis(std::chrono::system_clock::time_point time_point) {
+  const auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(time_point.time_since_epoch()).count();
+  return millis < 0 ? 0 : static_cast<uint64_t>(millis);
+}
+
+std::string componentIndexPrefix(const std::string& component_id) {
+  // the separator keeps the ids which are prefixes of each other apart
+  return component_id + '\0';
+}
+
+bool isRelatedTo(ProvenanceEventRecord& event, const utils::Identifier& flow_file_uuid) {
+  const auto contains = [&](const std::vector<utils::Identifier>& uuids) {
+    return std::find(uuids.begin(), uuids.end(), flow_file_uuid) != uuids.end();
+  };
+  return event.getFlowFileUuid() == flow_file_uuid || contains(event.getParentUuids()) || contains(event.getChildrenUuids());
+}
+
+bool matches(ProvenanceEventRecord& event, const ProvenanceQuery& query) {
+  if (query.flow_file_uuid && !isRelatedTo(event, *query.flow_file_uuid)) {
+    return false;
+  }
+  if (query.component_id && event.getComponentId() != *query.component_id) {
+    return false;
+  }
+  const auto event_time = toMillis(event.getEventTime());
+  return toMillis(query.begin) <= event_time && event_time <= toMillis(query.end);
+}
+
+}  // namespace
+
+bool ProvenanceRepository::addToBatch(rocksdb::WriteBatch& batch, const std::string& key, const uint8_t* buffer, size_t buffer_size) {
+  rocksdb::Slice value(reinterpret_cast<const char*>(buffer), buffer_size);
+  if (!batch.Put(key, value).ok()) {
+    return false;
+  }
+  const auto fields = readIndexedFields(buffer, buffer_size);
+  if (!fields) {
+    logger_->log_debug("Could not parse the provenance event %s, it is not indexed", key);
+    return true;
+  }
+  // the index entries only consist of keys: the prefix, the event time and the key of the event
+  const std::string time_and_key = encodeTime(fields->event_time_ms) + key;
+  if (!batch.Put(flow_file_index_, fields->flow_file_uuid.to_string() + time_and_key, rocksdb::Slice()).ok()
+      || !batch.Put(component_index_, componentIndexPrefix(fields->component_id) + time_and_key, rocksdb::Slice()).ok()
+      || !batch.Put(time_index_, time_and_key, rocksdb::Slice()).ok()) {
+    return false;
+  }
+  if (!hasRelatedFlowFiles(fields->event_type)) {
+    return true;
+  }
+  // the events linking FlowFiles are found from both ends, so that the lineage can be followed in both directions
+  ProvenanceEventRecord event;
+  if (!event.DeSerialize(buffer, buffer_size)) {
+    return true;
+  }
+  for (const auto& related : {event.getParentUuids(), event.getChildrenUuids()}) {
+    for (const auto& uuid : related) {
+      if (uuid != fields->flow_file_uuid && !batch.Put(flow_file_index_, uuid.to_string() + time_and_key, rocksdb::Slice()).ok()) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool ProvenanceRepository::MultiPut(const std::vector<std::pair<std::string, std::unique_ptr<minifi::io::BufferStream>>>& data) {
+  const auto write = [&] {
+    rocksdb::WriteBatch batch;
+    for (const auto &item : data) {
+      if (!addToBatch(batch, item.first, item.second->getBuffer(), item.second->size())) {
+        return false;
+      }
+    }
+    return db_->Write(rocksdb::WriteOptions(), &batch).ok();
+  };
+  if (write_queue_size_ == 0 || !running_) {
+    return write();
+  }
+
+  // the events of a commit are either all queued or all dropped
+  if (!reserveWriteQueue(data.size())) {
+    if (drop_when_write_queue_full_) {
+      dropped_event_count_ += data.size();
+      logger_->log_debug("Provenance write queue is full, dropping %zu events", data.size());
+      return false;
+    }
+    ++blocked_commit_count_;
+    bool reserved = false;
+    {
+      std::unique_lock<std::mutex> lock(wait_mutex_);
+      events_written_.wait(lock, [&] {
+        reserved = reserveWriteQueue(data.size());
+        return reserved || !running_;
+      });
+    }
+    if (!reserved) {
+      // the repository is stopping, nothing drains the queue anymore
+      writeQueuedEvents();
+      return write();
+    }
+  }
+  std::vector<PendingEvent> events;
+  events.reserve(data.size());
+  for (const auto& item : data) {
+    events.push_back({item.first, std::string(reinterpret_cast<const char*>(item.second->getBuffer()), item.second->size())});
+  }
+  write_queue_.enqueue_bulk(std::make_move_iterator(events.begin()), events.size());
+  events_queued_.notify_one();
+  if (!running_) {
+    // the repository thread may have already written its last batch
+    writeQueuedEvents();
+  }
+  return true;
+}
+
+bool ProvenanceRepository::reserveWriteQueue(size_t count) {
+  size_t queued = write_queue_count_.load();
+  do {
+    // a commit larger than the whole queue is let through once the queue is empty, otherwise it would never fit
+    if (queued != 0 && queued + count > write_queue_size_) {
+      return false;
+    }
+  } while (!write_queue_count_.compare_exchange_weak(queued, queued + count));
+  return true;
+}
+
+void ProvenanceRepository::writeQueuedEvents() {
+  std::lock_guard<std::mutex> write_lock(write_mutex_);
+  if (write_queue_.size_approx() == 0) {
+    return;
+  }
+  std::vector<PendingEvent> events(std::min(write_queue_.size_approx(), MAX_WRITE_BATCH_SIZE));
   size_t count = 0;
+  while ((count = write_queue_.try_dequeue_bulk(events.begin(), events.size())) > 0) {
+    const auto before = std::chrono::steady_clock::now();
+    rocksdb::WriteBatch batch;
+    for (size_t i = 0; i < count; ++i) {
+      if (!addToBatch(batch, events[i].key, reinterpret_cast<const uint8_t*>(events[i].value.data()), events[i].value.size())) {
+        logger_->log_error("Could not add the provenance event %s to the write batch", events[i].key);
+      }
+    }
+    const rocksdb::Status status = db_->Write(rocksdb::WriteOptions(), &batch);
+    if (!status.ok()) {
+      logger_->log_error("Failed to write %zu provenance events: %s", count, status.ToString());
+    }
+    last_write_batch_size_ = count;
+    last_write_batch_latency_us_ = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - before).count();
+    write_queue_count_ -= count;
+    {
+      // the blocked commits check the count while holding the lock, so they cannot miss the notification
+      std::lock_guard<std::mutex> lock(wait_mutex_);
+    }
+    events_written_.notify_all();
+  }
+}
+
+void ProvenanceRepository::flush() {
+  if (db_) {
+    writeQueuedEvents();
+  }
+}
+
+std::optional<core::RepositoryWriteMetrics> ProvenanceRepository::getWriteMetrics() const {
+  if (write_queue_size_ == 0) {
+    return std::nullopt;
+  }
+  core::RepositoryWriteMetrics metrics;
+  metrics.backlog = write_queue_count_.load();
+  metrics.capacity = write_queue_size_;
+  metrics.dropped = dropped_event_count_.load();
+  metrics.blocked = blocked_commit_count_.load();
+  metrics.last_batch_size = last_write_batch_size_.load();
+  metrics.last_batch_latency = std::chrono::microseconds{last_write_batch_latency_us_.load()};
+  return metrics;
+}
+
+std::optional<ProvenanceQueryResult> ProvenanceRepository::queryProvenance(const ProvenanceQuery& query) {
+  if (!db_) {
+    return std::nullopt;
+  }
+  // the events committed before the query are found even if the repository thread has not written them yet
+  writeQueuedEvents();
+  if (query.flow_file_uuid && query.include_lineage) {
+    return queryLineage(query);
+  }
+  if (query.flow_file_uuid) {
+    return queryIndex(flow_file_index_, query.flow_file_uuid->to_string(), query);
+  }
+  if (query.component_id) {
+    return queryIndex(component_index_, componentIndexPrefix(*query.component_id), query);
+  }
+  return queryIndex(time_index_, "", query);
+}
+
+ProvenanceQueryResult ProvenanceRepository::queryIndex(rocksdb::ColumnFamilyHandle* index, const std::string& prefix, const ProvenanceQuery& query) {
+  ProvenanceQueryResult result;
+  std::vector<std::string> event_keys;
+  const auto read_events = [&] {
+    std::vector<rocksdb::Slice> keys(event_keys.begin(), event_keys.end());
+    std::vector<std::string> values;
+    const auto statuses = db_->MultiGet(rocksdb::ReadOptions(), keys, &values);
+    for (size_t i = 0; i < statuses.size() && result.size() < query.max_results; ++i) {
+      // the event may have already been dropped from the repository while its index entries are still there
+      if (!statuses[i].ok()) {
+        continue;
+      }
+      auto event = std::make_shared<ProvenanceEventRecord>();
+      if (event->DeSerialize(reinterpret_cast<const uint8_t*>(values[i].data()), values[i].size()) && matches(*event, query)) {
+        result.push_back(std::move(event));
+      }
+    }
+    event_keys.clear();
+  };
+
+  // every key between the bounds starts with the prefix, as both of them do
+  const std::string lower_bound = prefix + encodeTime(toMillis(query.begin));
+  const std::string upper_bound = prefix + encodeTime(toMillis(query.end) + 1);
+  std::unique_ptr<rocksdb::Iterator> it(db_->NewIterator(rocksdb::ReadOptions(), index));
+  for (it->SeekForPrev(upper_bound); it->Valid() && result.size() < query.max_results; it->Prev()) {
+    const rocksdb::Slice index_key = it->key();
+    if (index_key.compare(lower_bound) < 0) {
+      break;
+    }
+    event_keys.emplace_back(index_key.data() + lower_bound.size(), index_key.size() - lower_bound.size());
+    if (event_keys.size() >= QUERY_BATCH_SIZE) {
+      read_events();
+    }
+  }
+  if (!event_keys.empty() && result.size() < query.max_results) {
+    read_events();
+  }
+  return result;
+}
+
+ProvenanceQueryResult ProvenanceRepository::queryLineage(const ProvenanceQuery& query) {
+  ProvenanceQueryResult result;
+  std::set<utils::Identifier> visited{*query.flow_file_uuid};
+  std::deque<utils::Identifier> pending{*query.flow_file_uuid};
+  // the events linking FlowFiles are found from both of the FlowFiles
+  std::set<utils::Identifier> found_events;
+  while (!pending.empty() && result.size() < query.max_results) {
+    // the lineage is followed through all of the events of a FlowFile, the component is only filtered on afterwards
+    ProvenanceQuery flow_file_query = query;
+    flow_file_query.flow_file_uuid = pending.front();
+    flow_file_query.include_lineage = false;
+    flow_file_query.component_id = std::nullopt;
+    pending.pop_front();
+    for (auto& event : queryIndex(flow_file_index_, flow_file_query.flow_file_uuid->to_string(), flow_file_query)) {
+      if (!found_events.insert(event->getEventId()).second) {
+        continue;
+      }
+      for (const auto& related : {std::vector<utils::Identifier>{event->getFlowFileUuid()}, event->getParentUuids(), event->getChildrenUuids()}) {
+        for (const auto& uuid : related) {
+          if (visited.insert(uuid).second) {
+            pending.push_back(uuid);
+          }
+        }
+      }
+      if (result.size() < query.max_results && (!query.component_id || event->getComponentId() == *query.component_id)) {
+        result.push_back(std::move(event));
+      }
+    }
+  }
+  std::stable_sort(result.begin(), result.end(), [](const auto& lhs, const auto& rhs) {
+    return lhs->getEventTime() > rhs->getEventTime();
+  });
+  return result;
+}
+
+void ProvenanceRepository::printStats() {
+  const auto storage_metrics = storage_metrics_.get();
+  logger_->log_info("Repository stats: key count: %" PRIu64 ", table readers size: %" PRIu64 ", all memory tables size: %" PRIu64,
+                    storage_metrics.estimated_key_count, storage_metrics.table_readers_memory, storage_metrics.memtables_memory);
+}
+
+void ProvenanceRepository::run() {
+  auto last_stats = std::chrono::steady_clock::now();
+  storage_metrics_.refresh(*db_);
+  auto last_storage_metrics = last_stats;
   while (running_) {
-    std::this_thread::sleep_for(std::chrono::seconds(1));
-    count++;
-    // Hack, to be removed in scope of https://issues.apache.org/jira/browse/MINIFICPP-1145
-    count = count % 30;
-    if (count == 0) {
+    {
+      std::unique_lock<std::mutex> lock(wait_mutex_);
+      events_queued_.wait_for(lock, MAX_WRITE_DELAY, [this] { return !running_ || write_queue_.size_approx() > 0; });
+    }
+    // the events queued while the previous batch was written are coalesced into the next one
+    writeQueuedEvents();
+    const auto now = std::chrono::steady_clock::now();
+    if (now - last_storage_metrics >= STORAGE_METRICS_PERIOD) {
+      storage_metrics_.refresh(*db_);
+      last_storage_metrics = now;
+    }
+    if (now - last_stats >= STATS_PERIOD) {
       printStats();
+      last_stats = now;
     }
   }
+  writeQueuedEvents();
+}
+
+void ProvenanceRepository::stop() {
+  if (!running_) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(wait_mutex_);
+    running_ = false;
+  }
+  events_queued_.notify_all();
+  // the blocked commits write their events themselves
+  events_written_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  logger_->log_debug("%s Repository Monitor Thread Stop", name_);
 }
 
 REGISTER_INTERNAL_RESOURCE_AS(ProvenanceRepository, ("ProvenanceRepository", "provenancerepository"));
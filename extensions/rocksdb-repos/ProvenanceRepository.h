@@ -16,11 +16,15 @@
  */
 #pragma once
 
+#include <atomic>
 #include <cinttypes>
+#include <condition_variable>
+#include <mutex>
 #include <vector>
 #include <string>
 #include <memory>
 #include <algorithm>
+#include <optional>
 #include <utility>
 
 #include "rocksdb/db.h"
@@ -29,7 +33,11 @@
 #include "core/Repository.h"
 #include "core/Core.h"
 #include "provenance/Provenance.h"
+#include "provenance/ProvenanceQuery.h"
 #include "core/logging/LoggerConfiguration.h"
+#include "utils/StringUtils.h"
+#include "concurrentqueue.h"
+#include "database/RocksDbUtils.h"
 
 namespace org {
 namespace apache {
@@ -41,6 +49,7 @@ namespace provenance {
 #define MAX_PROVENANCE_STORAGE_SIZE (10*1024*1024)  // 10M
 constexpr auto MAX_PROVENANCE_ENTRY_LIFE_TIME = std::chrono::minutes(1);
 constexpr auto PROVENANCE_PURGE_PERIOD = std::chrono::milliseconds(2500);
+constexpr size_t DEFAULT_PROVENANCE_WRITE_QUEUE_SIZE = 10000;
 
 class ProvenanceRepository : public core::Repository, public std::enable_shared_from_this<ProvenanceRepository> {
  public:
@@ -58,6 +67,9 @@ class ProvenanceRepository : public core::Repository, public std::enable_shared_
     db_ = nullptr;
   }
 
+  /**
+   * Logs the size estimates of the database as of the last refresh.
+   */
   void printStats();
 
   bool isNoop() override {
@@ -88,8 +100,25 @@ class ProvenanceRepository : public core::Repository, public std::enable_shared_
           max_partition_millis_ = *max_partition;
     }
     logger_->log_debug("MiNiFi Provenance Max Storage Time: [%" PRId64 "] ms", int64_t{max_partition_millis_.count()});
+    if (config->get(Configure::nifi_provenance_repository_write_queue_size, value)) {
+      uint64_t write_queue_size = 0;
+      if (core::Property::StringToInt(value, write_queue_size)) {
+        write_queue_size_ = gsl::narrow<size_t>(write_queue_size);
+      } else {
+        logger_->log_warn("Invalid provenance write queue size: %s, using the default of %zu", value, write_queue_size_);
+      }
+    }
+    if (config->get(Configure::nifi_provenance_repository_write_queue_full_policy, value)) {
+      if (utils::StringUtils::equalsIgnoreCase(value, "drop")) {
+        drop_when_write_queue_full_ = true;
+      } else if (!utils::StringUtils::equalsIgnoreCase(value, "block")) {
+        logger_->log_warn("Invalid provenance write queue full policy: %s, commits are blocked while the queue is full", value);
+      }
+    }
+    logger_->log_debug("MiNiFi Provenance Write Queue Size: %zu, %s events when full", write_queue_size_, drop_when_write_queue_full_ ? "dropping" : "blocking on");
     rocksdb::Options options;
     options.create_if_missing = true;
+    options.create_missing_column_families = true;
     options.use_direct_io_for_flush_and_compaction = true;
     options.use_direct_reads = true;
     // Rocksdb write buffers act as a log of database operation: grow till reaching the limit, serialized after
@@ -109,11 +138,28 @@ class ProvenanceRepository : public core::Repository, public std::enable_shared_
     logger_->log_info("Max partition bytes: %llu", max_partition_bytes_);
     logger_->log_info("Ttl: %llu", options.ttl);
 
+    // the index entries are much smaller than the events, they need less memory before being flushed
+    rocksdb::ColumnFamilyOptions index_options(options);
+    index_options.write_buffer_size = std::min(options.write_buffer_size, MAX_INDEX_WRITE_BUFFER_SIZE);
+    const std::vector<rocksdb::ColumnFamilyDescriptor> column_families{
+      {rocksdb::kDefaultColumnFamilyName, rocksdb::ColumnFamilyOptions(options)},
+      {FLOW_FILE_INDEX_COLUMN, index_options},
+      {COMPONENT_INDEX_COLUMN, index_options},
+      {TIME_INDEX_COLUMN, index_options}
+    };
+
     rocksdb::DB* db;
-    rocksdb::Status status = rocksdb::DB::Open(options, directory_, &db);
+    std::vector<rocksdb::ColumnFamilyHandle*> handles;
+    rocksdb::Status status = rocksdb::DB::Open(rocksdb::DBOptions(options), directory_, column_families, &handles, &db);
     if (status.ok()) {
       logger_->log_debug("MiNiFi Provenance Repository database open %s success", directory_);
       db_.reset(db);
+      for (auto* handle : handles) {
+        column_handles_.emplace_back(handle);
+      }
+      flow_file_index_ = handles.at(1);
+      component_index_ = handles.at(2);
+      time_index_ = handles.at(3);
     } else {
       logger_->log_error("MiNiFi Provenance Repository database open %s failed: %s", directory_, status.ToString());
       return false;
@@ -124,21 +170,20 @@ class ProvenanceRepository : public core::Repository, public std::enable_shared_
   // Put
   bool Put(std::string key, const uint8_t *buf, size_t bufLen) override {
     // persist to the DB
-    rocksdb::Slice value((const char *) buf, bufLen);
-    return db_->Put(rocksdb::WriteOptions(), key, value).ok();
-  }
-
-  bool MultiPut(const std::vector<std::pair<std::string, std::unique_ptr<minifi::io::BufferStream>>>& data) override {
     rocksdb::WriteBatch batch;
-    for (const auto &item : data) {
-      rocksdb::Slice value((const char *) item.second->getBuffer(), item.second->size());
-      if (!batch.Put(item.first, value).ok()) {
-        return false;
-      }
+    if (!addToBatch(batch, key, buf, bufLen)) {
+      return false;
     }
     return db_->Write(rocksdb::WriteOptions(), &batch).ok();
   }
 
+  /**
+   * While the repository is running and has a write queue, the events are only queued here and
+   * written by the repository thread together with the events of other commits.
+   * @return false if the events could not be written or were dropped because the queue was full
+   */
+  bool MultiPut(const std::vector<std::pair<std::string, std::unique_ptr<minifi::io::BufferStream>>>& data) override;
+
   // Delete
   bool Delete(std::string /*key*/) override {
     // The repo is cleaned up by itself, there is no need to delete items.
@@ -214,8 +259,29 @@ class ProvenanceRepository : public core::Repository, public std::enable_shared_
     return max_size > 0;
   }
 
+  /**
+   * Looks up the events in the index matching the most selective criterion of the query,
+   * the events stored before the indexes were introduced are not found.
+   */
+  std::optional<ProvenanceQueryResult> queryProvenance(const ProvenanceQuery& query) override;
+
+  std::optional<core::RepositoryWriteMetrics> getWriteMetrics() const override;
+
+  std::optional<core::RepositoryStorageMetrics> getStorageMetrics() const override {
+    return storage_metrics_.get();
+  }
+
+  /**
+   * Writes the queued events on the calling thread.
+   */
+  void flush() override;
+
+  void stop() override;
+
   // destroy
   void destroy() {
+    flow_file_index_ = component_index_ = time_index_ = nullptr;
+    column_handles_.clear();
     db_.reset();
   }
   // Run function for the thread
@@ -234,7 +300,68 @@ class ProvenanceRepository : public core::Repository, public std::enable_shared_
   ProvenanceRepository &operator=(const ProvenanceRepository &parent) = delete;
 
  private:
+  static constexpr const char* FLOW_FILE_INDEX_COLUMN = "flowfile_index";
+  static constexpr const char* COMPONENT_INDEX_COLUMN = "component_index";
+  static constexpr const char* TIME_INDEX_COLUMN = "time_index";
+  static constexpr size_t MAX_INDEX_WRITE_BUFFER_SIZE = 4 << 20;
+  // the most events written in a single batch by the repository thread
+  static constexpr size_t MAX_WRITE_BATCH_SIZE = 4096;
+
+  struct PendingEvent {
+    std::string key;
+    std::string value;
+  };
+
+  /**
+   * Reserves room for the events in the write queue.
+   * @return false if the queue doesn't have enough room left
+   */
+  bool reserveWriteQueue(size_t count);
+
+  /**
+   * Writes the queued events in batches until the queue is empty.
+   */
+  void writeQueuedEvents();
+
+  /**
+   * Adds the event and its index entries to the batch, the indexes are only
+   * written if the event can be parsed.
+   */
+  bool addToBatch(rocksdb::WriteBatch& batch, const std::string& key, const uint8_t* buffer, size_t buffer_size);
+
+  /**
+   * Collects the events found in the index under the prefix in the time range of the query, the most recent ones first.
+   */
+  ProvenanceQueryResult queryIndex(rocksdb::ColumnFamilyHandle* index, const std::string& prefix, const ProvenanceQuery& query);
+
+  ProvenanceQueryResult queryLineage(const ProvenanceQuery& query);
+
   std::unique_ptr<rocksdb::DB> db_;
+  // have to be released before the database
+  std::vector<std::unique_ptr<rocksdb::ColumnFamilyHandle>> column_handles_;
+  rocksdb::ColumnFamilyHandle* flow_file_index_ = nullptr;
+  rocksdb::ColumnFamilyHandle* component_index_ = nullptr;
+  rocksdb::ColumnFamilyHandle* time_index_ = nullptr;
+
+  // the events are queued until the repository thread writes them, 0 disables queueing
+  size_t write_queue_size_ = DEFAULT_PROVENANCE_WRITE_QUEUE_SIZE;
+  // whether the events of a commit are dropped or the commit waits for room if the queue is full
+  bool drop_when_write_queue_full_ = false;
+  moodycamel::ConcurrentQueue<PendingEvent> write_queue_;
+  // the events queued or being written, reserved before the events are queued
+  std::atomic<size_t> write_queue_count_{0};
+  // the repository thread and flush() write the queued events one at a time
+  std::mutex write_mutex_;
+  // only used for waiting, the queue itself is lock-free
+  std::mutex wait_mutex_;
+  std::condition_variable events_queued_;
+  std::condition_variable events_written_;
+  std::atomic<uint64_t> dropped_event_count_{0};
+  std::atomic<uint64_t> blocked_commit_count_{0};
+  std::atomic<uint64_t> last_write_batch_size_{0};
+  std::atomic<uint64_t> last_write_batch_latency_us_{0};
+  minifi::internal::StorageMetricsCache storage_metrics_;
+
   std::shared_ptr<core::logging::Logger> logger_ = core::logging::LoggerFactory<ProvenanceRepository>::getLogger();
 };
 
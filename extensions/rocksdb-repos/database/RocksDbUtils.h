@@ -18,9 +18,13 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdlib>
 #include <functional>
 #include <algorithm>
+#include <string>
 #include "rocksdb/db.h"
+#include "core/Repository.h"
 #include "utils/GeneralUtils.h"
 
 namespace org {
@@ -69,6 +73,38 @@ class Writable {
 using DBOptionsPatch = std::function<void(Writable<rocksdb::DBOptions>&)>;
 using ColumnFamilyOptionsPatch = std::function<void(Writable<rocksdb::ColumnFamilyOptions>&)>;
 
+/**
+ * Purpose: the size estimates of a database are refreshed by the thread of the repository,
+ * so that the metrics can be read often without querying the database.
+ */
+class StorageMetricsCache {
+ public:
+  template<typename Database>
+  void refresh(Database& db) {
+    estimated_key_count_ = getIntProperty(db, "rocksdb.estimate-num-keys");
+    table_readers_memory_ = getIntProperty(db, "rocksdb.estimate-table-readers-mem");
+    memtables_memory_ = getIntProperty(db, "rocksdb.cur-size-all-mem-tables");
+  }
+
+  core::RepositoryStorageMetrics get() const {
+    return core::RepositoryStorageMetrics{estimated_key_count_, table_readers_memory_, memtables_memory_};
+  }
+
+ private:
+  template<typename Database>
+  static uint64_t getIntProperty(Database& db, const char* property) {
+    std::string value;
+    if (!db.GetProperty(property, &value)) {
+      return 0;
+    }
+    return std::strtoull(value.c_str(), nullptr, 10);
+  }
+
+  std::atomic<uint64_t> estimated_key_count_{0};
+  std::atomic<uint64_t> table_readers_memory_{0};
+  std::atomic<uint64_t> memtables_memory_{0};
+};
+
 }  // namespace internal
 }  // namespace minifi
 }  // namespace nifi
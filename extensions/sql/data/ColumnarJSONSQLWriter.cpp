@@ -0,0 +1,125 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ColumnarJSONSQLWriter.h"
+
+#include <utility>
+
+#include "utils/gsl.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace sql {
+
+ColumnarJSONSQLWriter::ColumnarJSONSQLWriter(ColumnFilter column_filter)
+  : writer_(buffer_), column_filter_(std::move(column_filter)) {
+}
+
+void ColumnarJSONSQLWriter::beginProcessBatch() {
+  columns_.clear();
+}
+
+void ColumnarJSONSQLWriter::endProcessBatch() {
+  buffer_.Clear();
+  writer_.Reset(buffer_);
+  writer_.StartObject();
+  for (const auto& column : columns_) {
+    if (!column) {
+      continue;
+    }
+    column->writer.EndArray();
+    writer_.Key(column->name.c_str(), gsl::narrow<rapidjson::SizeType>(column->name.size()));
+    writer_.RawValue(column->buffer.GetString(), column->buffer.GetSize(), rapidjson::kArrayType);
+  }
+  writer_.EndObject();
+  columns_.clear();
+}
+
+void ColumnarJSONSQLWriter::beginProcessRow() {
+  column_index_ = 0;
+}
+
+void ColumnarJSONSQLWriter::endProcessRow() {}
+
+void ColumnarJSONSQLWriter::finishProcessing() {}
+
+void ColumnarJSONSQLWriter::processColumnNames(const std::vector<std::string>& names) {
+  columns_.clear();
+  for (const auto& name : names) {
+    if (!column_filter_(name)) {
+      columns_.push_back(nullptr);
+      continue;
+    }
+    auto column = std::make_unique<Column>(name);
+    column->writer.StartArray();
+    columns_.push_back(std::move(column));
+  }
+}
+
+rapidjson::Writer<rapidjson::StringBuffer>* ColumnarJSONSQLWriter::nextColumnWriter() {
+  const auto& column = columns_.at(column_index_++);
+  return column ? &column->writer : nullptr;
+}
+
+void ColumnarJSONSQLWriter::processColumn(const std::string& /*name*/, const std::string& value) {
+  if (auto writer = nextColumnWriter()) {
+    writer->String(value.c_str(), gsl::narrow<rapidjson::SizeType>(value.size()));
+  }
+}
+
+void ColumnarJSONSQLWriter::processColumn(const std::string& /*name*/, double value) {
+  if (auto writer = nextColumnWriter()) {
+    writer->Double(value);
+  }
+}
+
+void ColumnarJSONSQLWriter::processColumn(const std::string& /*name*/, int value) {
+  if (auto writer = nextColumnWriter()) {
+    writer->Int(value);
+  }
+}
+
+void ColumnarJSONSQLWriter::processColumn(const std::string& /*name*/, long long value) {
+  if (auto writer = nextColumnWriter()) {
+    writer->Int64(gsl::narrow<int64_t>(value));
+  }
+}
+
+void ColumnarJSONSQLWriter::processColumn(const std::string& /*name*/, unsigned long long value) {
+  if (auto writer = nextColumnWriter()) {
+    writer->Uint64(gsl::narrow<uint64_t>(value));
+  }
+}
+
+void ColumnarJSONSQLWriter::processColumn(const std::string& /*name*/, const char* value) {
+  if (auto writer = nextColumnWriter()) {
+    writer->String(value);
+  }
+}
+
+std::string ColumnarJSONSQLWriter::toString() {
+  return {buffer_.GetString(), buffer_.GetSize()};
+}
+
+}  // namespace sql
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
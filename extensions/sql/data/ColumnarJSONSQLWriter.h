@@ -0,0 +1,85 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+#include "SQLWriter.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace sql {
+
+/**
+ * Writes the rows of a batch column by column, as a JSON object with a member for each column, whose value is the array of the
+ * values of the column, e.g. {"id":[1,2],"name":["one","two"]}. The column names are only written once per batch.
+ */
+class ColumnarJSONSQLWriter: public SQLWriter {
+ public:
+  explicit ColumnarJSONSQLWriter(ColumnFilter column_filter = [] (const std::string&) {return true;});
+
+  std::string toString() override;
+
+ private:
+  void beginProcessBatch() override;
+  void endProcessBatch() override;
+  void beginProcessRow() override;
+  void endProcessRow() override;
+  void finishProcessing() override;
+  void processColumnNames(const std::vector<std::string>& names) override;
+  void processColumn(const std::string& name, const std::string& value) override;
+  void processColumn(const std::string& name, double value) override;
+  void processColumn(const std::string& name, int value) override;
+  void processColumn(const std::string& name, long long value) override;
+  void processColumn(const std::string& name, unsigned long long value) override;
+  void processColumn(const std::string& name, const char* value) override;
+
+  struct Column {
+    explicit Column(std::string column_name) : name(std::move(column_name)) {}
+
+    std::string name;
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer{buffer};
+  };
+
+  // returns the writer of the values of the current column, or nullptr if the column is filtered out
+  rapidjson::Writer<rapidjson::StringBuffer>* nextColumnWriter();
+
+ private:
+  rapidjson::StringBuffer buffer_;
+  rapidjson::Writer<rapidjson::StringBuffer> writer_;
+  ColumnFilter column_filter_;
+  // the columns are processed in the same order in every row, the filtered out columns are nullptr
+  std::vector<std::unique_ptr<Column>> columns_;
+  size_t column_index_{0};
+};
+
+} /* namespace sql */
+} /* namespace minifi */
+} /* namespace nifi */
+} /* namespace apache */
+} /* namespace org */
+
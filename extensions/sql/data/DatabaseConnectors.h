@@ -71,6 +71,14 @@ class Statement {
   virtual ~Statement() = default;
   virtual std::unique_ptr<Rowset> execute(const std::vector<std::string> &args = {}) = 0;
 
+  // Executes the statement once for each of the argument lists, which must have the same size.
+  // By default the statement is executed separately for each of them, connectors supporting bulk operations should override it.
+  virtual void executeBatch(const std::vector<std::vector<std::string>> &args_batch) {
+    for (const auto& args : args_batch) {
+      execute(args);
+    }
+  }
+
  protected:
   std::string query_;
 };
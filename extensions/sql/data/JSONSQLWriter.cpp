@@ -17,9 +17,6 @@
  */
 
 #include "JSONSQLWriter.h"
-#include "rapidjson/writer.h"
-#include "rapidjson/stringbuffer.h"
-#include "rapidjson/prettywriter.h"
 #include "Exception.h"
 
 namespace org {
@@ -29,77 +26,80 @@ namespace minifi {
 namespace sql {
 
 JSONSQLWriter::JSONSQLWriter(bool pretty, ColumnFilter column_filter)
-  : pretty_(pretty), current_batch_(rapidjson::kArrayType), column_filter_(std::move(column_filter)) {
+  : pretty_(pretty), writer_(buffer_), pretty_writer_(buffer_), column_filter_(std::move(column_filter)) {
 }
 
 void JSONSQLWriter::beginProcessRow() {
-  current_row_ = rapidjson::kObjectType;
+  column_index_ = 0;
+  if (pretty_) {
+    pretty_writer_.StartObject();
+  } else {
+    writer_.StartObject();
+  }
 }
 
 void JSONSQLWriter::endProcessRow() {
-  current_batch_.PushBack(current_row_, current_batch_.GetAllocator());
+  if (pretty_) {
+    pretty_writer_.EndObject();
+  } else {
+    writer_.EndObject();
+  }
 }
 
 void JSONSQLWriter::beginProcessBatch() {
-  current_batch_ = rapidjson::Document(rapidjson::kArrayType);
+  buffer_.Clear();
+  if (pretty_) {
+    pretty_writer_.Reset(buffer_);
+    pretty_writer_.StartArray();
+  } else {
+    writer_.Reset(buffer_);
+    writer_.StartArray();
+  }
 }
 
-void JSONSQLWriter::endProcessBatch() {}
+void JSONSQLWriter::endProcessBatch() {
+  if (pretty_) {
+    pretty_writer_.EndArray();
+  } else {
+    writer_.EndArray();
+  }
+}
 
 void JSONSQLWriter::finishProcessing() {}
 
-void JSONSQLWriter::processColumnNames(const std::vector<std::string>& /*name*/) {}
+void JSONSQLWriter::processColumnNames(const std::vector<std::string>& names) {
+  included_columns_.clear();
+  for (const auto& name : names) {
+    included_columns_.push_back(column_filter_(name));
+  }
+}
 
 void JSONSQLWriter::processColumn(const std::string& name, const std::string& value) {
-  addToJSONRow(name, toJSONString(value));
+  addToJSONRow(name, [&] (auto& writer) { writer.String(value.c_str(), gsl::narrow<rapidjson::SizeType>(value.size())); });
 }
 
 void JSONSQLWriter::processColumn(const std::string& name, double value) {
-  addToJSONRow(name, rapidjson::Value(value));
+  addToJSONRow(name, [&] (auto& writer) { writer.Double(value); });
 }
 
 void JSONSQLWriter::processColumn(const std::string& name, int value) {
-  addToJSONRow(name, rapidjson::Value(value));
+  addToJSONRow(name, [&] (auto& writer) { writer.Int(value); });
 }
 
 void JSONSQLWriter::processColumn(const std::string& name, long long value) {
-  addToJSONRow(name, rapidjson::Value(gsl::narrow<int64_t>(value)));
+  addToJSONRow(name, [&] (auto& writer) { writer.Int64(gsl::narrow<int64_t>(value)); });
 }
 
 void JSONSQLWriter::processColumn(const std::string& name, unsigned long long value) {
-  addToJSONRow(name, rapidjson::Value(gsl::narrow<uint64_t>(value)));
+  addToJSONRow(name, [&] (auto& writer) { writer.Uint64(gsl::narrow<uint64_t>(value)); });
 }
 
 void JSONSQLWriter::processColumn(const std::string& name, const char* value) {
-  addToJSONRow(name, toJSONString(value));
-}
-
-void JSONSQLWriter::addToJSONRow(const std::string& column_name, rapidjson::Value&& json_value) {
-  if (!column_filter_(column_name)) {
-    return;
-  }
-  current_row_.AddMember(toJSONString(column_name), std::move(json_value), current_batch_.GetAllocator());
-}
-
-rapidjson::Value JSONSQLWriter::toJSONString(const std::string& s) {
-  rapidjson::Value jsonValue;
-  jsonValue.SetString(s.c_str(), s.size(), current_batch_.GetAllocator());
-
-  return jsonValue;
+  addToJSONRow(name, [&] (auto& writer) { writer.String(value); });
 }
 
 std::string JSONSQLWriter::toString() {
-  rapidjson::StringBuffer buffer;
-
-  if (pretty_) {
-    rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
-    current_batch_.Accept(writer);
-  } else {
-    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-    current_batch_.Accept(writer);
-  }
-
-  return {buffer.GetString(), buffer.GetSize()};
+  return {buffer_.GetString(), buffer_.GetSize()};
 }
 
 }  // namespace sql
@@ -18,11 +18,15 @@
 
 #pragma once
 
-#include <functional>
+#include <string>
+#include <vector>
 
-#include "rapidjson/document.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+#include "rapidjson/prettywriter.h"
 
 #include "SQLWriter.h"
+#include "utils/gsl.h"
 
 namespace org {
 namespace apache {
@@ -30,10 +34,11 @@ namespace nifi {
 namespace minifi {
 namespace sql {
 
+/**
+ * Writes the rows of a batch as a JSON array of objects. The JSON is written while the rows are processed, no document is built.
+ */
 class JSONSQLWriter: public SQLWriter {
  public:
-  using ColumnFilter = std::function<bool(const std::string&)>;
-
   explicit JSONSQLWriter(bool pretty, ColumnFilter column_filter = [] (const std::string&) {return true;});
 
   std::string toString() override;
@@ -44,7 +49,7 @@ private:
   void beginProcessRow() override;
   void endProcessRow() override;
   void finishProcessing() override;
-  void processColumnNames(const std::vector<std::string>& name) override;
+  void processColumnNames(const std::vector<std::string>& names) override;
   void processColumn(const std::string& name, const std::string& value) override;
   void processColumn(const std::string& name, double value) override;
   void processColumn(const std::string& name, int value) override;
@@ -52,15 +57,30 @@ private:
   void processColumn(const std::string& name, unsigned long long value) override;
   void processColumn(const std::string& name, const char* value) override;
 
-  void addToJSONRow(const std::string& columnName, rapidjson::Value&& jsonValue);
-
-  rapidjson::Value toJSONString(const std::string& s);
+  // calls the function with the writer of the format, if the current column is not filtered out
+  template<typename WriteValue>
+  void addToJSONRow(const std::string& column_name, WriteValue write_value) {
+    if (!included_columns_.at(column_index_++)) {
+      return;
+    }
+    if (pretty_) {
+      pretty_writer_.Key(column_name.c_str(), gsl::narrow<rapidjson::SizeType>(column_name.size()));
+      write_value(pretty_writer_);
+    } else {
+      writer_.Key(column_name.c_str(), gsl::narrow<rapidjson::SizeType>(column_name.size()));
+      write_value(writer_);
+    }
+  }
 
  private:
   bool pretty_;
-  rapidjson::Document current_batch_;
-  rapidjson::Value current_row_;
+  rapidjson::StringBuffer buffer_;
+  rapidjson::Writer<rapidjson::StringBuffer> writer_;
+  rapidjson::PrettyWriter<rapidjson::StringBuffer> pretty_writer_;
   ColumnFilter column_filter_;
+  // the filter is evaluated once per batch, as the columns are processed in the same order in every row
+  std::vector<bool> included_columns_;
+  size_t column_index_{0};
 };
 
 } /* namespace sql */
@@ -69,4 +89,3 @@ private:
 } /* namespace apache */
 } /* namespace org */
 
-
@@ -63,19 +63,20 @@ void SQLRowsetProcessor::addRow(const Row& row, size_t rowCount) {
     subscriber.get().beginProcessRow();
   }
 
-  if (rowCount == 0) {
-    std::vector<std::string> column_names;
-    column_names.reserve(row.size());
+  if (column_names_.empty()) {
+    column_names_.reserve(row.size());
     for (std::size_t i = 0; i != row.size(); ++i) {
-      column_names.push_back(row.getColumnName(i));
+      column_names_.push_back(row.getColumnName(i));
     }
+  }
+  if (rowCount == 0) {
     for (const auto& subscriber : row_subscribers_) {
-      subscriber.get().processColumnNames(column_names);
+      subscriber.get().processColumnNames(column_names_);
     }
   }
 
   for (std::size_t i = 0; i != row.size(); ++i) {
-    const auto& name = row.getColumnName(i);
+    const auto& name = column_names_.at(i);
 
     if (row.isNull(i)) {
       processColumn(name, "NULL");
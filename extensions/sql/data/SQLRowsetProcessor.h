@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <string>
 #include <vector>
 
 #include "SQLRowSubscriber.h"
@@ -48,6 +49,8 @@ class SQLRowsetProcessor {
  private:
   std::unique_ptr<Rowset> rowset_;
   std::vector<std::reference_wrapper<SQLRowSubscriber>> row_subscribers_;
+  // the columns are the same in every row, so their names are only queried from the first row
+  std::vector<std::string> column_names_;
 };
 
 } /* namespace sql */
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <functional>
 #include <string>
 
 #include <soci/soci.h>
@@ -31,6 +32,8 @@ namespace minifi {
 namespace sql {
 
 struct SQLWriter: public SQLRowSubscriber {
+  using ColumnFilter = std::function<bool(const std::string&)>;
+
   virtual std::string toString() = 0;
 };
 
@@ -123,6 +123,42 @@ std::unique_ptr<Rowset> SociStatement::execute(const std::vector<std::string>& a
   return std::make_unique<SociRowset>(stmt);
 }
 
+void SociStatement::executeBatch(const std::vector<std::vector<std::string>>& args_batch) {
+  if (args_batch.empty()) {
+    return;
+  }
+  const size_t arg_count = args_batch.front().size();
+  if (arg_count == 0) {
+    // there is nothing to bind, the prepared statement is executed once for each (empty) argument list
+    soci::statement stmt = (session_.prepare << query_);
+    for (size_t i = 0; i < args_batch.size(); ++i) {
+      stmt.execute(true);
+    }
+    return;
+  }
+
+  // the i-th arguments of the argument lists are bound as the i-th array, so the statement is executed for all of them at once
+  std::vector<std::vector<std::string>> bound_args(arg_count);
+  for (auto& bound_arg : bound_args) {
+    bound_arg.reserve(args_batch.size());
+  }
+  for (const auto& args : args_batch) {
+    if (args.size() != arg_count) {
+      throw minifi::Exception(PROCESSOR_EXCEPTION, "SociStatement: The number of arguments of the statement differ in the batch: " + std::to_string(args.size())
+          + " instead of " + std::to_string(arg_count));
+    }
+    for (size_t i = 0; i < arg_count; ++i) {
+      bound_args[i].push_back(args[i]);
+    }
+  }
+  auto prepared = session_.prepare << query_;
+  for (auto& bound_arg : bound_args) {
+    prepared.operator,(soci::use(bound_arg));
+  }
+  soci::statement stmt = prepared;
+  stmt.execute(true);
+}
+
 void SociSession::begin() {
   session_.begin();
 }
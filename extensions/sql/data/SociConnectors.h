@@ -20,6 +20,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 #include <ctime>
 
 #include "Exception.h"
@@ -77,6 +78,8 @@ class SociStatement : public Statement {
 
   std::unique_ptr<Rowset> execute(const std::vector<std::string>& args = {}) override;
 
+  void executeBatch(const std::vector<std::vector<std::string>>& args_batch) override;
+
  protected:
   soci::session& session_;
 };
@@ -31,7 +31,6 @@
 #include "core/ProcessSession.h"
 #include "core/Resource.h"
 #include "Exception.h"
-#include "data/JSONSQLWriter.h"
 #include "data/SQLRowsetProcessor.h"
 
 namespace org {
@@ -99,9 +98,9 @@ void ExecuteSQL::processOnTrigger(core::ProcessContext& context, core::ProcessSe
 
   auto row_set = connection_->prepareStatement(query)->execute(collectArguments(input_flow_file));
 
-  sql::JSONSQLWriter json_writer{output_format_ == OutputType::JSONPretty};
-  FlowFileGenerator flow_file_creator{session, json_writer};
-  sql::SQLRowsetProcessor sql_rowset_processor(std::move(row_set), {json_writer, flow_file_creator});
+  const auto sql_writer = createSQLWriter();
+  FlowFileGenerator flow_file_creator{session, *sql_writer};
+  sql::SQLRowsetProcessor sql_rowset_processor(std::move(row_set), {*sql_writer, flow_file_creator});
 
   // Process rowset.
   while (size_t row_count = sql_rowset_processor.process(max_rows_)) {
@@ -19,6 +19,7 @@
 
 #include "FlowFile.h"
 #include "data/JSONSQLWriter.h"
+#include "data/ColumnarJSONSQLWriter.h"
 
 namespace org {
 namespace apache {
@@ -32,7 +33,7 @@ const core::Property FlowFileSource::OutputFormat(
   ->supportsExpressionLanguage(true)
   ->withDefaultValue(toString(OutputType::JSONPretty))
   ->withAllowableValues<std::string>(OutputType::values())
-  ->withDescription("Set the output format type.")->build());
+  ->withDescription("Set the output format type. JSON-Columnar writes an object with an array of values for each column, instead of an object for each row.")->build());
 
 const core::Property FlowFileSource::MaxRowsPerFlowFile(
   core::PropertyBuilder::createProperty("Max Rows Per Flow File")
@@ -47,13 +48,20 @@ const std::string FlowFileSource::FRAGMENT_IDENTIFIER = "fragment.identifier";
 const std::string FlowFileSource::FRAGMENT_COUNT = "fragment.count";
 const std::string FlowFileSource::FRAGMENT_INDEX = "fragment.index";
 
+std::unique_ptr<sql::SQLWriter> FlowFileSource::createSQLWriter(sql::SQLWriter::ColumnFilter column_filter) const {
+  if (output_format_ == OutputType::JSONColumnar) {
+    return std::make_unique<sql::ColumnarJSONSQLWriter>(std::move(column_filter));
+  }
+  return std::make_unique<sql::JSONSQLWriter>(output_format_ == OutputType::JSONPretty, std::move(column_filter));
+}
+
 void FlowFileSource::FlowFileGenerator::endProcessBatch() {
   if (current_batch_size_ == 0) {
     // do not create flow files with no rows
     return;
   }
 
-  OutputStreamPipe writer{std::make_shared<io::BufferStream>(json_writer_.toString())};
+  OutputStreamPipe writer{std::make_shared<io::BufferStream>(sql_writer_.toString())};
   auto new_flow = session_.create();
   new_flow->addAttribute(FRAGMENT_INDEX, std::to_string(flow_files_.size()));
   new_flow->addAttribute(FRAGMENT_IDENTIFIER, batch_id_.to_string());
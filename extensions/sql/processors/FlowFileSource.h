@@ -25,7 +25,7 @@
 #include "utils/Enum.h"
 #include "data/SQLRowsetProcessor.h"
 #include "ProcessSession.h"
-#include "data/JSONSQLWriter.h"
+#include "data/SQLWriter.h"
 
 namespace org {
 namespace apache {
@@ -44,15 +44,16 @@ class FlowFileSource {
 
   SMART_ENUM(OutputType,
     (JSON, "JSON"),
-    (JSONPretty, "JSON-Pretty")
+    (JSONPretty, "JSON-Pretty"),
+    (JSONColumnar, "JSON-Columnar")
   )
 
  protected:
   class FlowFileGenerator : public sql::SQLRowSubscriber {
    public:
-    FlowFileGenerator(core::ProcessSession& session, sql::JSONSQLWriter& json_writer)
+    FlowFileGenerator(core::ProcessSession& session, sql::SQLWriter& sql_writer)
       : session_(session),
-        json_writer_(json_writer) {}
+        sql_writer_(sql_writer) {}
 
     void beginProcessBatch() override {
       current_batch_size_ = 0;
@@ -86,12 +87,15 @@ class FlowFileSource {
 
    private:
     core::ProcessSession& session_;
-    sql::JSONSQLWriter& json_writer_;
+    sql::SQLWriter& sql_writer_;
     const utils::Identifier batch_id_{utils::IdGenerator::getIdGenerator()->generate()};
     size_t current_batch_size_{0};
     std::vector<std::shared_ptr<core::FlowFile>> flow_files_;
   };
 
+  // creates the writer of the rows in the configured output format
+  std::unique_ptr<sql::SQLWriter> createSQLWriter(sql::SQLWriter::ColumnFilter column_filter = [] (const std::string&) {return true;}) const;
+
   OutputType output_format_;
   size_t max_rows_{0};
 };
@@ -23,6 +23,8 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <unordered_map>
+#include <utility>
 
 #include <soci/soci.h>
 
@@ -33,7 +35,6 @@
 #include "core/Resource.h"
 #include "Exception.h"
 #include "data/DatabaseConnectors.h"
-#include "data/JSONSQLWriter.h"
 
 namespace org {
 namespace apache {
@@ -52,7 +53,19 @@ const core::Property PutSQL::SQLStatement(
       "the incoming flow file is expected to contain a valid SQL statement, to be issued by the processor to the database.")
   ->supportsExpressionLanguage(true)->build());
 
+const core::Property PutSQL::BatchSize(
+  core::PropertyBuilder::createProperty("Batch Size")
+  ->isRequired(true)
+  ->withDefaultValue<uint64_t>(1)
+  ->withDescription(
+      "The maximum number of flow files to put to the database in a single transaction. The flow files having the same SQL statement are executed "
+      "as a single prepared statement, with their arguments bound as arrays. If the transaction fails, the statements are retried separately, "
+      "and only the flow files whose statement fails are routed to failure. With a batch size of 1 a failing statement is not routed to failure, "
+      "the session is rolled back instead, so the flow file is retried.")->build());
+
 const core::Relationship PutSQL::Success("success", "Database is successfully updated.");
+const core::Relationship PutSQL::Failure("failure", "Failed to execute the SQL statement of the flow file, e.g. the statement is empty or invalid. "
+    "Only used if the Batch Size is greater than 1.");
 
 PutSQL::PutSQL(const std::string& name, const utils::Identifier& uuid)
   : SQLProcessor(name, uuid, core::logging::LoggerFactory<PutSQL>::getLogger()) {
@@ -60,22 +73,84 @@ PutSQL::PutSQL(const std::string& name, const utils::Identifier& uuid)
 
 void PutSQL::initialize() {
   //! Set the supported properties
-  setSupportedProperties({ DBControllerService, SQLStatement });
+  setSupportedProperties({ DBControllerService, SQLStatement, BatchSize });
 
   //! Set the supported relationships
-  setSupportedRelationships({ Success });
+  setSupportedRelationships({ Success, Failure });
 }
 
-void PutSQL::processOnSchedule(core::ProcessContext& /*context*/) {}
+void PutSQL::processOnSchedule(core::ProcessContext& context) {
+  context.getProperty(BatchSize.getName(), batch_size_);
+  if (batch_size_ == 0) {
+    batch_size_ = 1;
+  }
+}
 
 void PutSQL::processOnTrigger(core::ProcessContext& context, core::ProcessSession& session) {
+  if (batch_size_ == 1) {
+    processSingleFlowFile(context, session);
+    return;
+  }
+
+  std::vector<StatementBatch> batches;
+  std::unordered_map<std::string, size_t> batch_indices;
+  uint64_t flow_file_count = 0;
+  for (; flow_file_count < batch_size_; ++flow_file_count) {
+    auto flow_file = session.get();
+    if (!flow_file) {
+      break;
+    }
+    std::string sql_statement = getSQLStatement(context, session, flow_file);
+    if (sql_statement.empty()) {
+      logger_->log_error("Empty SQL statement in flow file %s", flow_file->getUUIDStr());
+      session.transfer(flow_file, Failure);
+      continue;
+    }
+    const auto [batch_index, inserted] = batch_indices.emplace(sql_statement, batches.size());
+    if (inserted) {
+      batches.push_back(StatementBatch{std::move(sql_statement), {}, {}});
+    }
+    auto& batch = batches[batch_index->second];
+    batch.arguments.push_back(collectArguments(flow_file));
+    batch.flow_files.push_back(std::move(flow_file));
+  }
+  if (flow_file_count == 0) {
+    context.yield();
+    return;
+  }
+  if (batches.empty()) {
+    return;
+  }
+
+  if (executeInTransaction(batches)) {
+    for (const auto& batch : batches) {
+      for (const auto& flow_file : batch.flow_files) {
+        session.transfer(flow_file, Success);
+      }
+    }
+    return;
+  }
+  executeSeparately(batches, session);
+}
+
+void PutSQL::processSingleFlowFile(core::ProcessContext& context, core::ProcessSession& session) {
   auto flow_file = session.get();
   if (!flow_file) {
     context.yield();
     return;
   }
+
+  const std::string sql_statement = getSQLStatement(context, session, flow_file);
+  if (sql_statement.empty()) {
+    throw Exception(PROCESSOR_EXCEPTION, "Empty SQL statement");
+  }
+
+  // the exception rolls back the session, the flow file stays in the incoming queue
+  connection_->prepareStatement(sql_statement)->execute(collectArguments(flow_file));
   session.transfer(flow_file, Success);
+}
 
+std::string PutSQL::getSQLStatement(core::ProcessContext& context, core::ProcessSession& session, const std::shared_ptr<core::FlowFile>& flow_file) const {
   std::string sql_statement;
   if (!context.getProperty(SQLStatement, sql_statement, flow_file)) {
     logger_->log_debug("Using the contents of the flow file as the SQL statement");
@@ -84,11 +159,50 @@ void PutSQL::processOnTrigger(core::ProcessContext& context, core::ProcessSessio
     session.read(flow_file, &read_callback);
     sql_statement = std::string{reinterpret_cast<const char*>(buffer->getBuffer()), buffer->size()};
   }
-  if (sql_statement.empty()) {
-    throw Exception(PROCESSOR_EXCEPTION, "Empty SQL statement");
+  return sql_statement;
+}
+
+bool PutSQL::executeInTransaction(gsl::span<const StatementBatch> batches) {
+  auto db_session = connection_->getSession();
+  db_session->begin();
+  try {
+    for (const auto& batch : batches) {
+      connection_->prepareStatement(batch.sql_statement)->executeBatch(batch.arguments);
+    }
+    db_session->commit();
+    return true;
+  } catch (const std::exception& e) {
+    db_session->rollback();
+    std::string exception;
+    if (!connection_->connected(exception)) {
+      // nothing has been committed, the flow files are processed again after reconnecting
+      throw;
+    }
+    logger_->log_warn("Failed to execute the SQL statements, the transaction was rolled back: %s", e.what());
+    return false;
   }
+}
 
-  connection_->prepareStatement(sql_statement)->execute(collectArguments(flow_file));
+void PutSQL::executeSeparately(const std::vector<StatementBatch>& batches, core::ProcessSession& session) {
+  for (const auto& batch : batches) {
+    // a single batch has already failed on its own
+    if (batches.size() > 1 && executeInTransaction(gsl::make_span(&batch, 1))) {
+      for (const auto& flow_file : batch.flow_files) {
+        session.transfer(flow_file, Success);
+      }
+      continue;
+    }
+    for (size_t i = 0; i < batch.flow_files.size(); ++i) {
+      const auto& flow_file = batch.flow_files[i];
+      const StatementBatch single_statement{batch.sql_statement, {flow_file}, {batch.arguments[i]}};
+      if (batch.flow_files.size() > 1 && executeInTransaction(gsl::make_span(&single_statement, 1))) {
+        session.transfer(flow_file, Success);
+      } else {
+        logger_->log_error("Failed to execute the SQL statement of flow file %s", flow_file->getUUIDStr());
+        session.transfer(flow_file, Failure);
+      }
+    }
+  }
 }
 
 REGISTER_RESOURCE(PutSQL, "PutSQL to execute SQL command via ODBC.");
@@ -20,9 +20,12 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "core/ProcessSession.h"
+#include "utils/gsl.h"
 #include "SQLProcessor.h"
 
 namespace org {
@@ -45,8 +48,28 @@ class PutSQL: public SQLProcessor {
   void initialize() override;
 
   EXTENSIONAPI static const core::Property SQLStatement;
+  EXTENSIONAPI static const core::Property BatchSize;
 
   EXTENSIONAPI static const core::Relationship Success;
+  EXTENSIONAPI static const core::Relationship Failure;
+
+ private:
+  // the flow files having the same SQL statement, executed as a single prepared statement
+  struct StatementBatch {
+    std::string sql_statement;
+    std::vector<std::shared_ptr<core::FlowFile>> flow_files;
+    std::vector<std::vector<std::string>> arguments;
+  };
+
+  // executes the statement of a single flow file, a failure rolls back the session
+  void processSingleFlowFile(core::ProcessContext& context, core::ProcessSession& session);
+  std::string getSQLStatement(core::ProcessContext& context, core::ProcessSession& session, const std::shared_ptr<core::FlowFile>& flow_file) const;
+  // executes the batches in a single transaction, returns false if it failed and was rolled back
+  bool executeInTransaction(gsl::span<const StatementBatch> batches);
+  // executes each batch in a separate transaction, and the flow files of the failed batches one by one
+  void executeSeparately(const std::vector<StatementBatch>& batches, core::ProcessSession& session);
+
+  uint64_t batch_size_{1};
 };
 
 }  // namespace processors
@@ -32,7 +32,6 @@
 #include "core/ProcessSession.h"
 #include "core/Resource.h"
 #include "Exception.h"
-#include "data/JSONSQLWriter.h"
 #include "data/SQLRowsetProcessor.h"
 #include "data/MaxCollector.h"
 #include "utils/StringUtils.h"
@@ -160,9 +159,9 @@ void QueryDatabaseTable::processOnTrigger(core::ProcessContext& /*context*/, cor
   auto column_filter = [&] (const std::string& column_name) {
     return return_columns_.empty() || return_columns_.count(sql::SQLColumnIdentifier(column_name)) != 0;
   };
-  sql::JSONSQLWriter json_writer{output_format_ == OutputType::JSONPretty, column_filter};
-  FlowFileGenerator flow_file_creator{session, json_writer};
-  sql::SQLRowsetProcessor sql_rowset_processor(std::move(rowset), {json_writer, maxCollector, flow_file_creator});
+  const auto sql_writer = createSQLWriter(column_filter);
+  FlowFileGenerator flow_file_creator{session, *sql_writer};
+  sql::SQLRowsetProcessor sql_rowset_processor(std::move(rowset), {*sql_writer, maxCollector, flow_file_creator});
 
   while (size_t row_count = sql_rowset_processor.process(max_rows_)) {
     auto new_file = flow_file_creator.getLastFlowFile();
@@ -69,6 +69,10 @@ class AttributesToJSON : public core::Processor {
     return core::annotation::Input::INPUT_REQUIRED;
   }
 
+  bool supportsBatching() const override {
+    return true;
+  }
+
  private:
   class WriteCallback : public OutputStreamCallback {
    public:
@@ -86,6 +86,10 @@ class ExtractText : public core::Processor {
     return core::annotation::Input::INPUT_REQUIRED;
   }
 
+  bool supportsBatching() const override {
+    return true;
+  }
+
   //! Logger
   std::shared_ptr<core::logging::Logger> logger_ = core::logging::LoggerFactory<ExtractText>::getLogger();
 };
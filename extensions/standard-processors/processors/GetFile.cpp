@@ -20,7 +20,9 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 
+#include <algorithm>
 #include <cstring>
+#include <filesystem>
 #include <vector>
 #include <queue>
 #include <map>
@@ -28,6 +30,7 @@
 #include <set>
 #include <string>
 #include <regex>
+#include <utility>
 
 #include "utils/StringUtils.h"
 #include "utils/file/FileUtils.h"
@@ -37,6 +40,7 @@
 #include "core/Resource.h"
 #include "core/TypedValues.h"
 #include "utils/FileReaderCallback.h"
+#include "utils/ProcessorConfigUtils.h"
 
 using namespace std::literals::chrono_literals;
 
@@ -86,6 +90,18 @@ core::Property GetFile::Recurse(
 core::Property GetFile::FileFilter(
     core::PropertyBuilder::createProperty("File Filter")->withDescription("Only files whose names match the given regular expression will be picked up")->withDefaultValue("[^\\.].*")->build());
 
+core::Property GetFile::ListingStrategy(
+    core::PropertyBuilder::createProperty("Listing Strategy")
+        ->withDescription("Full Listing: every listing walks the whole Input Directory and checks every file. "
+                          "Incremental Listing: after the first listing, only the files created or modified since are checked, using file system "
+                          "notifications where supported, or else skipping the directories whose contents have not changed since they were listed. "
+                          "Each file is picked up once (again only if it is modified, when notifications are supported), and the state of the listing "
+                          "is stored, so if Keep Source File is true, the files picked up before a restart are not picked up again. After a restart the "
+                          "stored state skips every kept file which is not newer than the files picked up before, even if it was added later.")
+        ->withDefaultValue(toString(ListingStrategyOption::FULL_LISTING))
+        ->withAllowableValues(ListingStrategyOption::values())
+        ->build());
+
 core::Relationship GetFile::Success("success", "All files are routed to success");
 
 void GetFile::initialize() {
@@ -102,6 +118,7 @@ void GetFile::initialize() {
   properties.insert(PollInterval);
   properties.insert(Recurse);
   properties.insert(FileFilter);
+  properties.insert(ListingStrategy);
   setSupportedProperties(properties);
   // Set the supported relationships
   std::set<core::Relationship> relationships;
@@ -142,6 +159,7 @@ void GetFile::onSchedule(core::ProcessContext *context, core::ProcessSessionFact
   if (context->getProperty(FileFilter.getName(), value)) {
     request_.fileFilter = value;
   }
+  file_filter_ = std::regex(request_.fileFilter);
 
   if (!context->getProperty(Directory.getName(), value)) {
     throw Exception(PROCESS_SCHEDULE_EXCEPTION, "Input Directory property is missing");
@@ -150,6 +168,27 @@ void GetFile::onSchedule(core::ProcessContext *context, core::ProcessSessionFact
     throw Exception(PROCESS_SCHEDULE_EXCEPTION, "Input Directory \"" + value + "\" is not a directory");
   }
   request_.inputDirectory = value;
+
+  listing_strategy_ = utils::parseEnumProperty<ListingStrategyOption>(*context, ListingStrategy);
+  std::lock_guard<std::mutex> listing_lock(listing_mutex_);
+  initial_listing_done_ = false;
+  listed_directories_.clear();
+  candidate_files_.clear();
+  file_watcher_.reset();
+  state_manager_.reset();
+  if (listing_strategy_ == ListingStrategyOption::INCREMENTAL_LISTING) {
+    auto state_manager = context->getStateManager();
+    if (state_manager == nullptr) {
+      throw Exception(PROCESSOR_EXCEPTION, "Failed to get StateManager");
+    }
+    state_manager_ = std::make_unique<utils::ListingStateManager>(state_manager);
+    restored_listing_state_ = state_manager_->getCurrentState();
+    stored_listing_state_ = restored_listing_state_;
+    file_watcher_ = std::make_unique<utils::file::FileWatcher>();
+    std::lock_guard<std::mutex> lock(directory_listing_mutex_);
+    picked_up_listing_state_ = restored_listing_state_;
+    failed_files_.clear();
+  }
 }
 
 void GetFile::onTrigger(core::ProcessContext* /*context*/, core::ProcessSession* session) {
@@ -159,8 +198,16 @@ void GetFile::onTrigger(core::ProcessContext* /*context*/, core::ProcessSession*
   logger_->log_debug("Listing is %s before polling directory", is_dir_empty_before_poll ? "empty" : "not empty");
   if (is_dir_empty_before_poll) {
     if (request_.pollInterval == 0ms || (std::chrono::system_clock::now() - last_listing_time_.load()) > request_.pollInterval) {
-      performListing(request_);
-      last_listing_time_.store(std::chrono::system_clock::now());
+      // if another task is listing the directory, this one only consumes the files listed so far
+      std::unique_lock<std::mutex> listing_lock(listing_mutex_, std::try_to_lock);
+      if (listing_lock.owns_lock()) {
+        if (listing_strategy_ == ListingStrategyOption::INCREMENTAL_LISTING) {
+          performIncrementalListing(request_);
+        } else {
+          performListing(request_);
+        }
+        last_listing_time_.store(std::chrono::system_clock::now());
+      }
     }
   }
 
@@ -171,15 +218,20 @@ void GetFile::onTrigger(core::ProcessContext* /*context*/, core::ProcessSession*
     return;
   }
 
-  std::queue<std::string> list_of_file_names = pollListing(request_.batchSize);
-  while (!list_of_file_names.empty()) {
-    std::string file_name = list_of_file_names.front();
-    list_of_file_names.pop();
-    getSingleFile(*session, file_name);
+  for (const auto& listed_file : pollListing(request_.batchSize)) {
+    const bool picked_up = getSingleFile(*session, listed_file.fullPath());
+    finishListing(listed_file, picked_up);
+  }
+
+  if (listing_strategy_ == ListingStrategyOption::INCREMENTAL_LISTING) {
+    std::unique_lock<std::mutex> listing_lock(listing_mutex_, std::try_to_lock);
+    if (listing_lock.owns_lock()) {
+      storeListingState();
+    }
   }
 }
 
-void GetFile::getSingleFile(core::ProcessSession& session, const std::string& file_name) const {
+bool GetFile::getSingleFile(core::ProcessSession& session, const std::string& file_name) const {
   logger_->log_info("GetFile process %s", file_name);
   auto flow_file = session.create();
   gsl_Expects(flow_file);
@@ -203,7 +255,13 @@ void GetFile::getSingleFile(core::ProcessSession& session, const std::string& fi
   } catch (const utils::FileReaderCallbackIOError& io_error) {
     logger_->log_error("IO error while processing file '%s': %s", file_name, io_error.what());
     flow_file->setDeleted(true);
+    return false;
   }
+  return true;
+}
+
+std::string GetFile::ListedFile::fullPath() const {
+  return directory + utils::file::FileUtils::get_separator() + file_name;
 }
 
 bool GetFile::isListingEmpty() const {
@@ -212,78 +270,282 @@ bool GetFile::isListingEmpty() const {
   return directory_listing_.empty();
 }
 
-void GetFile::putListing(std::string fileName) {
-  logger_->log_trace("Adding file to queue: %s", fileName);
+bool GetFile::putListing(ListedFile file) {
+  logger_->log_trace("Adding file to queue: %s", file.fullPath());
 
   std::lock_guard<std::mutex> lock(directory_listing_mutex_);
 
-  directory_listing_.push(fileName);
+  if (!pending_files_.insert(file.fullPath()).second) {
+    return false;
+  }
+  metrics_->input_bytes_ += file.size;
+  metrics_->accepted_files_++;
+  directory_listing_.push(std::move(file));
+  return true;
 }
 
-std::queue<std::string> GetFile::pollListing(uint64_t batch_size) {
+std::vector<GetFile::ListedFile> GetFile::pollListing(uint64_t batch_size) {
   std::lock_guard<std::mutex> lock(directory_listing_mutex_);
 
-  std::queue<std::string> list;
+  std::vector<ListedFile> list;
   while (!directory_listing_.empty() && (batch_size == 0 || list.size() < batch_size)) {
-    list.push(directory_listing_.front());
+    list.push_back(std::move(directory_listing_.front()));
     directory_listing_.pop();
   }
   return list;
 }
 
-bool GetFile::fileMatchesRequestCriteria(std::string fullName, std::string name, const GetFileRequest &request) {
-  logger_->log_trace("Checking file: %s", fullName);
+namespace {
+class ListedFileObject : public utils::ListedObject {
+ public:
+  ListedFileObject(std::string path, std::chrono::system_clock::time_point last_modified)
+      : path_(std::move(path)), last_modified_(last_modified) {
+  }
+
+  std::chrono::time_point<std::chrono::system_clock> getLastModified() const override {
+    return last_modified_;
+  }
+
+  std::string getKey() const override {
+    return path_;
+  }
+
+ private:
+  std::string path_;
+  std::chrono::system_clock::time_point last_modified_;
+};
+}  // namespace
+
+void GetFile::finishListing(const ListedFile& file, bool picked_up) {
+  std::lock_guard<std::mutex> lock(directory_listing_mutex_);
+
+  pending_files_.erase(file.fullPath());
+  if (listing_strategy_ != ListingStrategyOption::INCREMENTAL_LISTING) {
+    return;
+  }
+  if (picked_up) {
+    picked_up_listing_state_.updateState(ListedFileObject{file.fullPath(), file.last_modified});
+  } else {
+    failed_files_.push_back(file);
+  }
+}
+
+GetFile::FileCheckResult GetFile::checkFile(const std::string& full_name, const std::string& name, const GetFileRequest &request, ListedFile& listed_file) const {
+  logger_->log_trace("Checking file: %s", full_name);
+
+  // the name is checked first, as that needs no system call
+  if (!std::regex_search(name, file_filter_)) {
+    return FileCheckResult::REJECTED;
+  }
+  if (request.ignoreHiddenFile && utils::file::FileUtils::is_hidden(full_name)) {
+    return FileCheckResult::REJECTED;
+  }
 
 #ifdef WIN32
   struct _stat64 statbuf;
-  if (_stat64(fullName.c_str(), &statbuf) != 0) {
-    return false;
+  if (_stat64(full_name.c_str(), &statbuf) != 0) {
+    return FileCheckResult::REJECTED;
   }
 #else
   struct stat statbuf;
-  if (stat(fullName.c_str(), &statbuf) != 0) {
-    return false;
+  if (stat(full_name.c_str(), &statbuf) != 0) {
+    return FileCheckResult::REJECTED;
   }
 #endif
-  uint64_t file_size = gsl::narrow<uint64_t>(statbuf.st_size);
-  auto modifiedTime = std::chrono::system_clock::time_point() + std::chrono::seconds(gsl::narrow<uint64_t>(statbuf.st_mtime));
+  listed_file.size = gsl::narrow<uint64_t>(statbuf.st_size);
+  listed_file.last_modified = std::chrono::system_clock::time_point() + std::chrono::seconds(gsl::narrow<uint64_t>(statbuf.st_mtime));
 
-  if (request.minSize > 0 && file_size < request.minSize)
-    return false;
+  if (request.minSize > 0 && listed_file.size < request.minSize)
+    return FileCheckResult::NOT_YET;
 
-  if (request.maxSize > 0 && file_size > request.maxSize)
-    return false;
+  if (request.maxSize > 0 && listed_file.size > request.maxSize)
+    return FileCheckResult::REJECTED;
 
-  auto fileAge = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - modifiedTime);
+  auto fileAge = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - listed_file.last_modified);
   if (request.minAge > 0ms && fileAge < request.minAge)
-    return false;
+    return FileCheckResult::NOT_YET;
   if (request.maxAge > 0ms && fileAge > request.maxAge)
-    return false;
+    return FileCheckResult::REJECTED;
 
-  if (request.ignoreHiddenFile && utils::file::FileUtils::is_hidden(fullName))
-    return false;
-
-  std::regex rgx(request.fileFilter);
-  if (!std::regex_search(name, rgx)) {
-    return false;
-  }
-
-  metrics_->input_bytes_ += file_size;
-  metrics_->accepted_files_++;
-  return true;
+  return FileCheckResult::ACCEPTED;
 }
 
 void GetFile::performListing(const GetFileRequest &request) {
   auto callback = [this, request](const std::string& dir, const std::string& filename) -> bool {
-    std::string fullpath = dir + utils::file::FileUtils::get_separator() + filename;
-    if (fileMatchesRequestCriteria(fullpath, filename, request)) {
-      putListing(fullpath);
+    ListedFile listed_file{dir, filename, {}, 0};
+    if (checkFile(listed_file.fullPath(), filename, request, listed_file) == FileCheckResult::ACCEPTED) {
+      putListing(std::move(listed_file));
     }
     return isRunning();
   };
   utils::file::FileUtils::list_dir(request.inputDirectory, callback, logger_, request.recursive);
 }
 
+void GetFile::performIncrementalListing(const GetFileRequest &request) {
+  storeListingState();
+  {
+    std::lock_guard<std::mutex> lock(directory_listing_mutex_);
+    for (auto& failed_file : failed_files_) {
+      listed_directories_[failed_file.directory].picked_up_files.erase(failed_file.file_name);
+      candidate_files_.insert_or_assign(failed_file.fullPath(), std::move(failed_file));
+    }
+    failed_files_.clear();
+  }
+  listing_start_time_ = std::chrono::system_clock::now();
+
+  bool list_all_directories = !initial_listing_done_ || !watching_all_directories_;
+  std::vector<std::string> new_directories;
+  if (!list_all_directories) {
+    const bool complete = file_watcher_->poll([&](const utils::file::FileWatcher::Change& change) {
+      const auto path = change.directory + utils::file::FileUtils::get_separator() + change.file_name;
+      if (change.is_directory) {
+        if (change.type == utils::file::FileWatcher::ChangeType::CREATED && request.recursive) {
+          new_directories.push_back(path);
+        } else if (change.type == utils::file::FileWatcher::ChangeType::REMOVED) {
+          file_watcher_->unwatch(path);
+          listed_directories_.erase(path);
+        }
+      } else if (change.type == utils::file::FileWatcher::ChangeType::REMOVED) {
+        candidate_files_.erase(path);
+        const auto directory = listed_directories_.find(change.directory);
+        if (directory != listed_directories_.end()) {
+          directory->second.picked_up_files.erase(change.file_name);
+        }
+      } else {
+        // the modification time is checked later, until then it must not hold back the stored listing state
+        candidate_files_.try_emplace(path, ListedFile{change.directory, change.file_name, std::chrono::system_clock::time_point::max(), 0});
+      }
+    });
+    list_all_directories = !complete;
+  }
+
+  if (list_all_directories) {
+    watching_all_directories_ = file_watcher_->isAvailable();
+    listDirectoryIncrementally(request.inputDirectory, request);
+    initial_listing_done_ = true;
+  } else {
+    for (const auto& directory : new_directories) {
+      listDirectoryIncrementally(directory, request);
+    }
+  }
+
+  std::vector<ListedFile> candidates;
+  candidates.reserve(candidate_files_.size());
+  for (const auto& candidate : candidate_files_) {
+    candidates.push_back(candidate.second);
+  }
+  for (const auto& candidate : candidates) {
+    checkFileIncrementally(candidate.directory, candidate.file_name, request);
+  }
+}
+
+void GetFile::listDirectoryIncrementally(const std::string& directory, const GetFileRequest &request) {
+  // the directory is watched before it is read, so no file created meanwhile is missed
+  if (watching_all_directories_ && !file_watcher_->watch(directory)) {
+    logger_->log_warn("Skipping unchanged directories instead of watching them, as %s cannot be watched", directory);
+    watching_all_directories_ = false;
+  }
+
+  const auto directory_mtime = std::chrono::system_clock::time_point{utils::file::FileUtils::last_write_time_point(directory)};
+  auto& listed_directory = listed_directories_[directory];
+  // no file was added since the directory was checked
+  // after a restart every directory is checked once, as the modification time of a directory does not change when one
+  // of its files is modified, so an old directory can still hold files which were too young or too small before
+  const bool unchanged = listed_directory.checked_mtime == directory_mtime;
+
+  std::error_code error;
+  std::unordered_set<std::string> present_files;
+  for (std::filesystem::directory_iterator it(directory, error), end; !error && it != end; it.increment(error)) {
+    const auto file_name = it->path().filename().string();
+    std::error_code type_error;
+    if (it->is_directory(type_error)) {
+      if (request.recursive) {
+        listDirectoryIncrementally(directory + utils::file::FileUtils::get_separator() + file_name, request);
+      }
+      continue;
+    }
+    if (unchanged) {
+      continue;
+    }
+    present_files.insert(file_name);
+    if (listed_directory.picked_up_files.count(file_name) == 0) {
+      checkFileIncrementally(directory, file_name, request);
+    }
+    if (!isRunning()) {
+      return;
+    }
+  }
+  if (error) {
+    logger_->log_warn("Failed to list directory %s: %s", directory, error.message());
+    return;
+  }
+
+  if (!unchanged) {
+    auto& picked_up_files = listed_directory.picked_up_files;
+    for (auto it = picked_up_files.begin(); it != picked_up_files.end();) {
+      it = present_files.count(it->first) == 0 ? picked_up_files.erase(it) : std::next(it);
+    }
+  }
+  // files created within the same second as the last change would not change the modification time
+  listed_directory.checked_mtime = directory_mtime + 1s < listing_start_time_ ? std::optional(directory_mtime) : std::nullopt;
+}
+
+void GetFile::checkFileIncrementally(const std::string& directory, const std::string& file_name, const GetFileRequest &request) {
+  ListedFile listed_file{directory, file_name, {}, 0};
+  const auto full_path = listed_file.fullPath();
+  switch (checkFile(full_path, file_name, request, listed_file)) {
+    case FileCheckResult::REJECTED:
+      candidate_files_.erase(full_path);
+      return;
+    case FileCheckResult::NOT_YET:
+      candidate_files_.insert_or_assign(full_path, listed_file);
+      return;
+    case FileCheckResult::ACCEPTED:
+      candidate_files_.erase(full_path);
+      break;
+  }
+
+  auto& picked_up_files = listed_directories_[directory].picked_up_files;
+  const auto picked_up_file = picked_up_files.find(file_name);
+  if (picked_up_file != picked_up_files.end() && picked_up_file->second == listed_file.last_modified) {
+    return;
+  }
+  // the picked up files are deleted unless they are kept, so the restored state can only skip files which arrived with an old
+  // modification time while the processor was stopped, e.g. moved or extracted files
+  if (request.keepSourceFile && restored_listing_state_.wasObjectListedAlready(ListedFileObject{full_path, listed_file.last_modified})) {
+    picked_up_files[file_name] = listed_file.last_modified;
+    return;
+  }
+  const auto last_modified = listed_file.last_modified;
+  if (putListing(std::move(listed_file))) {
+    picked_up_files[file_name] = last_modified;
+  }
+}
+
+void GetFile::storeListingState() {
+  utils::ListingState listing_state;
+  {
+    std::lock_guard<std::mutex> lock(directory_listing_mutex_);
+    // the files still queued may be older than the ones picked up
+    if (!pending_files_.empty()) {
+      return;
+    }
+    listing_state = picked_up_listing_state_;
+  }
+  // the files not accepted yet must not be skipped after a restart
+  for (const auto& candidate : candidate_files_) {
+    if (candidate.second.last_modified <= listing_state.listed_key_timestamp) {
+      listing_state.listed_key_timestamp = candidate.second.last_modified - 1s;
+      listing_state.listed_keys.clear();
+    }
+  }
+  if (listing_state.listed_key_timestamp == stored_listing_state_.listed_key_timestamp && listing_state.listed_keys == stored_listing_state_.listed_keys) {
+    return;
+  }
+  state_manager_->storeState(listing_state);
+  stored_listing_state_ = std::move(listing_state);
+}
+
 int16_t GetFile::getMetricNodes(std::vector<std::shared_ptr<state::response::ResponseNode>> &metric_vector) {
   metric_vector.push_back(metrics_);
   return 0;
@@ -19,8 +19,13 @@
 #define EXTENSIONS_STANDARD_PROCESSORS_PROCESSORS_GETFILE_H_
 
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <queue>
+#include <regex>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <atomic>
 
@@ -30,7 +35,10 @@
 #include "core/ProcessSession.h"
 #include "core/Core.h"
 #include "core/logging/LoggerConfiguration.h"
+#include "utils/Enum.h"
 #include "utils/Export.h"
+#include "utils/ListingStateManager.h"
+#include "utils/file/FileWatcher.h"
 
 namespace org {
 namespace apache {
@@ -118,6 +126,11 @@ class GetFile : public core::Processor, public state::response::MetricsNodeSourc
   // Destructor
   ~GetFile() override = default;
 
+  SMART_ENUM(ListingStrategyOption,
+             (FULL_LISTING, "Full Listing"),
+             (INCREMENTAL_LISTING, "Incremental Listing")
+  )
+
   // Processor Name
   EXTENSIONAPI static constexpr char const* ProcessorName = "GetFile";
   // Supported Properties
@@ -132,6 +145,7 @@ class GetFile : public core::Processor, public state::response::MetricsNodeSourc
   EXTENSIONAPI static core::Property PollInterval;
   EXTENSIONAPI static core::Property BatchSize;
   EXTENSIONAPI static core::Property FileFilter;
+  EXTENSIONAPI static core::Property ListingStrategy;
   // Supported Relationships
   EXTENSIONAPI static core::Relationship Success;
 
@@ -165,16 +179,67 @@ class GetFile : public core::Processor, public state::response::MetricsNodeSourc
     return core::annotation::Input::INPUT_FORBIDDEN;
   }
 
+  struct ListedFile {
+    std::string directory;
+    std::string file_name;
+    std::chrono::system_clock::time_point last_modified;
+    uint64_t size = 0;
+
+    std::string fullPath() const;
+  };
+
+  struct ListedDirectory {
+    // the modification time of the directory when all of its entries were last checked, if it has not been changing at that time
+    std::optional<std::chrono::system_clock::time_point> checked_mtime;
+    // the modification time of the files picked up from the directory, by file name
+    std::unordered_map<std::string, std::chrono::system_clock::time_point> picked_up_files;
+  };
+
+  enum class FileCheckResult {
+    ACCEPTED,
+    REJECTED,
+    NOT_YET  // too young or too small, it may be accepted later
+  };
+
   bool isListingEmpty() const;
-  void putListing(std::string fileName);
-  std::queue<std::string> pollListing(uint64_t batch_size);
-  bool fileMatchesRequestCriteria(std::string fullName, std::string name, const GetFileRequest &request);
-  void getSingleFile(core::ProcessSession& session, const std::string& file_name) const;
+  bool putListing(ListedFile file);
+  std::vector<ListedFile> pollListing(uint64_t batch_size);
+  void finishListing(const ListedFile& file, bool picked_up);
+  FileCheckResult checkFile(const std::string& full_name, const std::string& name, const GetFileRequest &request, ListedFile& listed_file) const;
+  bool getSingleFile(core::ProcessSession& session, const std::string& file_name) const;
+
+  void performIncrementalListing(const GetFileRequest &request);
+  void listDirectoryIncrementally(const std::string& directory, const GetFileRequest &request);
+  void checkFileIncrementally(const std::string& directory, const std::string& file_name, const GetFileRequest &request);
+  void storeListingState();
 
   std::shared_ptr<GetFileMetrics> metrics_;
   GetFileRequest request_;
-  std::queue<std::string> directory_listing_;
+  ListingStrategyOption listing_strategy_ = ListingStrategyOption::FULL_LISTING;
+  std::regex file_filter_;
+  std::queue<ListedFile> directory_listing_;
+  // the files listed, but not yet picked up, so concurrent tasks do not list them again
+  std::unordered_set<std::string> pending_files_;
   mutable std::mutex directory_listing_mutex_;
+  // only one task performs a listing at a time, the others keep consuming the listing
+  std::mutex listing_mutex_;
+
+  // Incremental Listing, guarded by listing_mutex_
+  std::unique_ptr<utils::file::FileWatcher> file_watcher_;
+  bool watching_all_directories_ = false;
+  bool initial_listing_done_ = false;
+  std::chrono::system_clock::time_point listing_start_time_;
+  std::unordered_map<std::string, ListedDirectory> listed_directories_;
+  // the files which have changed or have not been accepted yet, by full path
+  std::unordered_map<std::string, ListedFile> candidate_files_;
+  std::unique_ptr<utils::ListingStateManager> state_manager_;
+  // files not newer than the restored state were picked up before the restart
+  utils::ListingState restored_listing_state_;
+  utils::ListingState stored_listing_state_;
+
+  // Incremental Listing, guarded by directory_listing_mutex_
+  utils::ListingState picked_up_listing_state_;
+  std::vector<ListedFile> failed_files_;
   std::atomic<std::chrono::time_point<std::chrono::system_clock>> last_listing_time_{};
   std::shared_ptr<core::logging::Logger> logger_ = core::logging::LoggerFactory<GetFile>::getLogger();
 };
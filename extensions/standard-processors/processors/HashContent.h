@@ -173,6 +173,10 @@ class HashContent : public core::Processor {
     return core::annotation::Input::INPUT_REQUIRED;
   }
 
+  bool supportsBatching() const override {
+    return true;
+  }
+
   //! Logger
   std::shared_ptr<core::logging::Logger> logger_ = core::logging::LoggerFactory<HashContent>::getLogger();
   std::string algoName_;
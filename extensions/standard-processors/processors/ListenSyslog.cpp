@@ -18,18 +18,34 @@
  * limitations under the License.
  */
 #include "ListenSyslog.h"
-#include <stdio.h>
+
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
 #include <memory>
+#include <set>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
 #include <vector>
-#include <set>
-#include <queue>
-#include "utils/TimeUtil.h"
-#include "utils/StringUtils.h"
+
 #include "core/ProcessContext.h"
 #include "core/ProcessSession.h"
 #include "core/TypedValues.h"
 #include "core/Resource.h"
+#include "io/StreamPipe.h"
+#include "utils/gsl.h"
 
 namespace org {
 namespace apache {
@@ -38,11 +54,12 @@ namespace minifi {
 namespace processors {
 #ifndef WIN32
 core::Property ListenSyslog::RecvBufSize(
-    core::PropertyBuilder::createProperty("Receive Buffer Size")->withDescription("The size of each buffer used to receive Syslog messages.")->
+    core::PropertyBuilder::createProperty("Receive Buffer Size")->withDescription("The size of each buffer used to receive Syslog messages. "
+                                                                                  "Longer UDP messages are truncated, longer TCP messages are split.")->
     withDefaultValue<core::DataSizeValue>("65507 B")->build());
 
 core::Property ListenSyslog::MaxSocketBufSize(
-    core::PropertyBuilder::createProperty("Max Size of Socket Buffer")->withDescription("The maximum size of the socket buffer that should be used.")->withDefaultValue<core::DataSizeValue>("1 MB")
+    core::PropertyBuilder::createProperty("Max Size of Socket Buffer")->withDescription("The maximum size of the socket buffer that should be used (SO_RCVBUF).")->withDefaultValue<core::DataSizeValue>("1 MB")
         ->build());
 
 core::Property ListenSyslog::MaxConnections(
@@ -67,6 +84,17 @@ core::Property ListenSyslog::Protocol(
 core::Property ListenSyslog::Port(
     core::PropertyBuilder::createProperty("Port")->withDescription("The port for Syslog communication")->withDefaultValue<int64_t>(514, core::StandardValidators::get().PORT_VALIDATOR)->build());
 
+core::Property ListenSyslog::MaxQueueSize(
+    core::PropertyBuilder::createProperty("Max Size of Message Queue")->withDescription("The maximum number of Syslog messages received, but not yet written to FlowFiles. "
+                                                                                        "Messages received while the queue is full are dropped.")
+        ->withDefaultValue<uint64_t>(10000)->build());
+
+core::Property ListenSyslog::ListenerThreads(
+    core::PropertyBuilder::createProperty("Listener Threads")->withDescription("The number of threads receiving Syslog messages. With more than one thread, each of them binds "
+                                                                               "its own socket to the port using SO_REUSEPORT, and the kernel distributes the datagrams and the TCP "
+                                                                               "connections between them.")
+        ->withDefaultValue<uint64_t>(1)->build());
+
 core::Relationship ListenSyslog::Success("success", "All files are routed to success");
 core::Relationship ListenSyslog::Invalid("invalid", "SysLog message format invalid");
 
@@ -81,6 +109,8 @@ void ListenSyslog::initialize() {
   properties.insert(ParseMessages);
   properties.insert(Protocol);
   properties.insert(Port);
+  properties.insert(MaxQueueSize);
+  properties.insert(ListenerThreads);
   setSupportedProperties(properties);
   // Set the supported relationships
   std::set<core::Relationship> relationships;
@@ -89,234 +119,514 @@ void ListenSyslog::initialize() {
   setSupportedRelationships(relationships);
 }
 
-void ListenSyslog::startSocketThread() {
-  if (_thread != NULL)
-    return;
+namespace {
+// number of datagrams received by a single recvmmsg call
+constexpr size_t UDP_RECEIVE_BATCH_SIZE = 16;
+// a listener publishes its arena when the messages in it grow beyond this size
+constexpr size_t ARENA_CAPACITY = 1024 * 1024;
+constexpr size_t MAX_POOLED_ARENAS = 16;
+constexpr int POLL_TIMEOUT_MS = 100;
 
-  logger_->log_trace("ListenSysLog Socket Thread Start");
-  _serverTheadRunning = true;
-  _thread = new std::thread(run, this);
-  _thread->detach();
+bool would_block(int error) {
+  return error == EAGAIN || error == EWOULDBLOCK;
 }
 
-void ListenSyslog::run(ListenSyslog *process) {
-  process->runThread();
+bool set_non_blocking(int fd) {
+  const int flags = fcntl(fd, F_GETFL, 0);
+  return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
 }
 
-void ListenSyslog::runThread() {
-  while (_serverTheadRunning) {
-    if (_resetServerSocket) {
-      _resetServerSocket = false;
-      // need to reset the socket
-      std::vector<int>::iterator it;
-      for (it = _clientSockets.begin(); it != _clientSockets.end(); ++it) {
-        int clientSocket = *it;
-        close(clientSocket);
-      }
-      _clientSockets.clear();
-      if (_serverSocket > 0) {
-        close(_serverSocket);
-        _serverSocket = 0;
-      }
+/**
+ * Waits for sockets to become readable: edge-triggered epoll on Linux, poll elsewhere.
+ * The handlers read their sockets until EAGAIN, which is correct in both modes.
+ */
+class Poller {
+ public:
+  Poller() {
+#ifdef __linux__
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+#endif
+  }
+
+  Poller(const Poller&) = delete;
+  Poller& operator=(const Poller&) = delete;
+
+  ~Poller() {
+#ifdef __linux__
+    if (epoll_fd_ >= 0) {
+      close(epoll_fd_);
     }
+#endif
+  }
 
-    if (_serverSocket <= 0) {
-      uint16_t portno = _port;
-      struct sockaddr_in serv_addr;
-      int sockfd;
-      if (_protocol == "TCP")
-        sockfd = socket(AF_INET, SOCK_STREAM, 0);
-      else
-        sockfd = socket(AF_INET, SOCK_DGRAM, 0);
-      if (sockfd < 0) {
-        logger_->log_error("ListenSysLog Server socket creation failed");
-        break;
+  bool add(int fd) {
+#ifdef __linux__
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLRDHUP | EPOLLET;
+    event.data.fd = fd;
+    return epoll_fd_ >= 0 && epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) == 0;
+#else
+    fds_.push_back(pollfd{fd, POLLIN, 0});
+    return true;
+#endif
+  }
+
+  void remove(int fd) {
+#ifdef __linux__
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+#else
+    fds_.erase(std::remove_if(fds_.begin(), fds_.end(), [fd](const pollfd& entry) { return entry.fd == fd; }), fds_.end());
+#endif
+  }
+
+  /**
+   * Calls handler with each readable (or closed) socket, the handler may remove the socket.
+   */
+  template<typename Handler>
+  void wait(int timeout_ms, Handler handler) {
+#ifdef __linux__
+    const int ready = epoll_wait(epoll_fd_, events_.data(), gsl::narrow<int>(events_.size()), timeout_ms);
+    for (int i = 0; i < ready; ++i) {
+      handler(events_[i].data.fd);
+    }
+#else
+    if (poll(fds_.data(), fds_.size(), timeout_ms) <= 0) {
+      return;
+    }
+    ready_fds_.clear();
+    for (const auto& entry : fds_) {
+      if (entry.revents != 0) {
+        ready_fds_.push_back(entry.fd);
       }
-      bzero(reinterpret_cast<char *>(&serv_addr), sizeof(serv_addr));
-      serv_addr.sin_family = AF_INET;
-      serv_addr.sin_addr.s_addr = INADDR_ANY;
-      serv_addr.sin_port = htons(portno);
-      if (bind(sockfd, (struct sockaddr *) &serv_addr, sizeof(serv_addr)) < 0) {
-        logger_->log_error("ListenSysLog Server socket bind failed");
-        break;
+    }
+    for (const int fd : ready_fds_) {
+      handler(fd);
+    }
+#endif
+  }
+
+ private:
+#ifdef __linux__
+  int epoll_fd_ = -1;
+  std::array<epoll_event, 64> events_{};
+#else
+  std::vector<pollfd> fds_;
+  std::vector<int> ready_fds_;
+#endif
+};
+}  // namespace
+
+/**
+ * Receives messages on its server socket in a thread of its own. UDP datagrams are read in batches
+ * with recvmmsg (where available), TCP streams are read in large chunks and split into lines. The
+ * messages are copied into an arena, which is published to the processor after every poll round.
+ */
+class ListenSyslog::Listener {
+ public:
+  Listener(ListenSyslog& processor, utils::net::UniqueSocketHandle server_socket)
+      : processor_(processor),
+        server_socket_(std::move(server_socket)),
+        tcp_(processor.protocol_ == "TCP"),
+        buffer_size_(gsl::narrow<size_t>(processor.recv_buffer_size_)) {
+#ifdef __linux__
+    if (!tcp_) {
+      receive_buffer_.resize(buffer_size_ * UDP_RECEIVE_BATCH_SIZE);
+      for (size_t i = 0; i < UDP_RECEIVE_BATCH_SIZE; ++i) {
+        iovecs_[i].iov_base = receive_buffer_.data() + i * buffer_size_;
+        iovecs_[i].iov_len = buffer_size_;
+        headers_[i].msg_hdr.msg_iov = &iovecs_[i];
+        headers_[i].msg_hdr.msg_iovlen = 1;
       }
-      if (_protocol == "TCP")
-        listen(sockfd, 5);
-      _serverSocket = sockfd;
-      logger_->log_info("ListenSysLog Server socket %d bind OK to port %d", _serverSocket, portno);
+      return;
     }
-    FD_ZERO(&_readfds);
-    FD_SET(_serverSocket, &_readfds);
-    _maxFds = _serverSocket;
-    std::vector<int>::iterator it;
-    for (it = _clientSockets.begin(); it != _clientSockets.end(); ++it) {
-      int clientSocket = *it;
-      if (clientSocket >= _maxFds)
-        _maxFds = clientSocket;
-      FD_SET(clientSocket, &_readfds);
+#endif
+    receive_buffer_.resize(buffer_size_);
+  }
+
+  Listener(const Listener&) = delete;
+  Listener& operator=(const Listener&) = delete;
+
+  ~Listener() {
+    stop();
+  }
+
+  void start() {
+    running_ = true;
+    thread_ = std::thread([this] { run(); });
+  }
+
+  void stop() {
+    running_ = false;
+    if (thread_.joinable()) {
+      thread_.join();
     }
-    fd_set fds;
-    struct timeval tv;
-    int retval;
-    fds = _readfds;
-    tv.tv_sec = 0;
-    // 100 msec
-    tv.tv_usec = 100000;
-    retval = select(_maxFds + 1, &fds, NULL, NULL, &tv);
-    if (retval < 0)
-      break;
-    if (retval == 0)
-      continue;
-    if (FD_ISSET(_serverSocket, &fds)) {
-      // server socket, either we have UDP datagram or TCP connection request
-      if (_protocol == "TCP") {
-        socklen_t clilen;
-        struct sockaddr_in cli_addr;
-        clilen = sizeof(cli_addr);
-        int newsockfd = accept(_serverSocket, reinterpret_cast<struct sockaddr *>(&cli_addr), &clilen);
-        if (newsockfd > 0) {
-          if (_clientSockets.size() < (uint64_t) _maxConnections) {
-            _clientSockets.push_back(newsockfd);
-            logger_->log_info("ListenSysLog new client socket %d connection", newsockfd);
-            continue;
-          } else {
-            close(newsockfd);
-          }
+  }
+
+ private:
+  struct Connection {
+    utils::net::UniqueSocketHandle socket;
+    // the beginning of a line not yet terminated
+    std::string partial_message;
+  };
+
+  void run() {
+    if (!poller_.add(server_socket_.get())) {
+      processor_.logger_->log_error("ListenSyslog failed to poll server socket %d: %s", server_socket_.get(), std::strerror(errno));
+      return;
+    }
+    arena_ = processor_.acquireArena();
+    while (running_) {
+      poller_.wait(POLL_TIMEOUT_MS, [this](int fd) {
+        if (fd != server_socket_.get()) {
+          receiveFromConnection(fd);
+        } else if (tcp_) {
+          acceptConnections();
+        } else {
+          receiveDatagrams();
         }
-      } else {
-        socklen_t clilen;
-        struct sockaddr_in cli_addr;
-        clilen = sizeof(cli_addr);
-        int recvlen = recvfrom(_serverSocket, _buffer, sizeof(_buffer), 0, (struct sockaddr *) &cli_addr, &clilen);
-        if (recvlen > 0 && (uint64_t) (recvlen + getEventQueueByteSize()) <= static_cast<uint64_t>(_recvBufSize)) {
-          uint8_t *payload = new uint8_t[recvlen];
-          memcpy(payload, _buffer, recvlen);
-          putEvent(payload, recvlen);
+      });
+      publish();
+    }
+    for (auto& connection : connections_) {
+      poller_.remove(connection.first);
+    }
+    processor_.connection_count_ -= connections_.size();
+    connections_.clear();
+  }
+
+  void acceptConnections() {
+    while (true) {
+      const int fd = accept(server_socket_.get(), nullptr, nullptr);
+      if (fd < 0) {
+        if (errno == EINTR) {
+          continue;
         }
+        if (!would_block(errno)) {
+          processor_.logger_->log_error("ListenSyslog accept failed: %s", std::strerror(errno));
+        }
+        return;
       }
+      utils::net::UniqueSocketHandle socket{fd};
+      if (processor_.connection_count_.fetch_add(1) >= processor_.max_connections_) {
+        --processor_.connection_count_;
+        processor_.logger_->log_debug("ListenSyslog rejected client socket %d, the maximum number of connections is reached", fd);
+        continue;
+      }
+      if (!set_non_blocking(fd) || !poller_.add(fd)) {
+        --processor_.connection_count_;
+        processor_.logger_->log_error("ListenSyslog failed to set up client socket %d: %s", fd, std::strerror(errno));
+        continue;
+      }
+      processor_.logger_->log_info("ListenSysLog new client socket %d connection", fd);
+      connections_.emplace(fd, Connection{std::move(socket), {}});
     }
-    it = _clientSockets.begin();
-    while (it != _clientSockets.end()) {
-      int clientSocket = *it;
-      if (FD_ISSET(clientSocket, &fds)) {
-        int recvlen = readline(clientSocket, _buffer, sizeof(_buffer));
-        if (recvlen <= 0) {
-          close(clientSocket);
-          logger_->log_debug("ListenSysLog client socket %d close", clientSocket);
-          it = _clientSockets.erase(it);
-        } else {
-          if ((uint64_t) (recvlen + getEventQueueByteSize()) <= static_cast<uint64_t>(_recvBufSize)) {
-            uint8_t *payload = new uint8_t[recvlen];
-            memcpy(payload, _buffer, recvlen);
-            putEvent(payload, recvlen);
-          }
-          ++it;
-        }
+  }
+
+  void receiveFromConnection(int fd) {
+    const auto it = connections_.find(fd);
+    if (it == connections_.end()) {
+      return;
+    }
+    while (true) {
+      const auto received = recv(fd, receive_buffer_.data(), receive_buffer_.size(), 0);
+      if (received > 0) {
+        splitLines(it->second, receive_buffer_.data(), gsl::narrow<size_t>(received));
+        continue;
+      }
+      if (received < 0 && errno == EINTR) {
+        continue;
       }
+      if (received < 0 && would_block(errno)) {
+        return;
+      }
+      // the last line of a connection does not need to be terminated
+      if (!it->second.partial_message.empty()) {
+        addMessage(it->second.partial_message.data(), it->second.partial_message.size());
+      }
+      processor_.logger_->log_debug("ListenSysLog client socket %d close", fd);
+      poller_.remove(fd);
+      connections_.erase(it);
+      --processor_.connection_count_;
+      return;
     }
   }
-  return;
-}
 
-int ListenSyslog::readline(int fd, char *bufptr, size_t len) {
-  char *bufx = bufptr;
-  static char *bp;
-  static int cnt = 0;
-  static char b[2048];
-  char c;
-
-  while (--len > 0) {
-    if (--cnt <= 0) {
-      cnt = recv(fd, b, sizeof(b), 0);
-      if (cnt < 0) {
+  void splitLines(Connection& connection, const char* data, size_t size) {
+    const char* begin = data;
+    const char* const end = data + size;
+    while (const auto* newline = static_cast<const char*>(std::memchr(begin, '\n', end - begin))) {
+      if (connection.partial_message.empty()) {
+        addLine(begin, newline - begin);
+      } else {
+        connection.partial_message.append(begin, newline);
+        addLine(connection.partial_message.data(), connection.partial_message.size());
+        connection.partial_message.clear();
+      }
+      begin = newline + 1;
+    }
+    connection.partial_message.append(begin, end);
+    if (connection.partial_message.size() >= buffer_size_) {
+      addMessage(connection.partial_message.data(), connection.partial_message.size());
+      connection.partial_message.clear();
+    }
+  }
+
+  void addLine(const char* data, size_t size) {
+    if (size > 0 && data[size - 1] == '\r') {
+      --size;
+    }
+    addMessage(data, size);
+  }
+
+  void receiveDatagrams() {
+#ifdef __linux__
+    while (true) {
+      const int received = recvmmsg(server_socket_.get(), headers_.data(), gsl::narrow<unsigned int>(headers_.size()), MSG_DONTWAIT, nullptr);
+      if (received < 0) {
         if (errno == EINTR) {
-          len++; /* the while will decrement */
           continue;
         }
-        return -1;
+        if (!would_block(errno)) {
+          processor_.logger_->log_error("ListenSyslog recvmmsg failed: %s", std::strerror(errno));
+        }
+        return;
+      }
+      for (int i = 0; i < received; ++i) {
+        addMessage(static_cast<const char*>(iovecs_[i].iov_base), headers_[i].msg_len);
+      }
+      if (gsl::narrow<size_t>(received) < headers_.size()) {
+        return;
       }
-      if (cnt == 0)
-        return 0;
-      bp = b;
     }
-    c = *bp++;
-    *bufptr++ = c;
-    if (c == '\n') {
-      *bufptr = '\n';
-      return bufptr - bufx + 1;
+#else
+    while (true) {
+      const auto received = recv(server_socket_.get(), receive_buffer_.data(), receive_buffer_.size(), 0);
+      if (received < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        if (!would_block(errno)) {
+          processor_.logger_->log_error("ListenSyslog recv failed: %s", std::strerror(errno));
+        }
+        return;
+      }
+      addMessage(receive_buffer_.data(), gsl::narrow<size_t>(received));
     }
+#endif
   }
-  return -1;
+
+  void addMessage(const char* data, size_t size) {
+    if (processor_.queued_messages_.fetch_add(1) >= processor_.max_queue_size_) {
+      --processor_.queued_messages_;
+      ++dropped_messages_;
+      return;
+    }
+    arena_->data.append(data, size);
+    arena_->message_ends.push_back(arena_->data.size());
+    if (arena_->data.size() >= ARENA_CAPACITY) {
+      publish();
+    }
+  }
+
+  void publish() {
+    if (dropped_messages_ > 0) {
+      processor_.logger_->log_warn("ListenSyslog dropped %zu messages, because the message queue is full", dropped_messages_);
+      dropped_messages_ = 0;
+    }
+    if (arena_->size() == 0) {
+      return;
+    }
+    processor_.publishArena(std::move(arena_));
+    arena_ = processor_.acquireArena();
+  }
+
+  ListenSyslog& processor_;
+  const utils::net::UniqueSocketHandle server_socket_;
+  const bool tcp_;
+  const size_t buffer_size_;
+  std::vector<char> receive_buffer_;
+#ifdef __linux__
+  std::array<iovec, UDP_RECEIVE_BATCH_SIZE> iovecs_{};
+  std::array<mmsghdr, UDP_RECEIVE_BATCH_SIZE> headers_{};
+#endif
+  Poller poller_;
+  std::unordered_map<int, Connection> connections_;
+  std::unique_ptr<MessageArena> arena_;
+  size_t dropped_messages_ = 0;
+  std::atomic<bool> running_{false};
+  std::thread thread_;
+};
+
+ListenSyslog::ListenSyslog(const std::string& name,  const utils::Identifier& uuid) // NOLINT
+    : Processor(name, uuid) {
 }
 
-void ListenSyslog::onTrigger(core::ProcessContext *context, core::ProcessSession *session) {
-  std::string value;
-  bool needResetServerSocket = false;
-  if (context->getProperty(Protocol.getName(), value)) {
-    if (_protocol != value)
-      needResetServerSocket = true;
-    _protocol = value;
+ListenSyslog::~ListenSyslog() {
+  stopListeners();
+}
+
+utils::net::UniqueSocketHandle ListenSyslog::createServerSocket(bool reuse_port) const {
+  utils::net::UniqueSocketHandle server_socket{socket(AF_INET, protocol_ == "TCP" ? SOCK_STREAM : SOCK_DGRAM, 0)};
+  if (!server_socket) {
+    throw Exception(PROCESS_SCHEDULE_EXCEPTION, std::string("ListenSysLog Server socket creation failed: ") + std::strerror(errno));
   }
-  if (context->getProperty(RecvBufSize.getName(), value)) {
-    core::Property::StringToInt(value, _recvBufSize);
+  const int enable = 1;
+  setsockopt(server_socket.get(), SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+#ifdef SO_REUSEPORT
+  if (reuse_port && setsockopt(server_socket.get(), SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) != 0) {
+    throw Exception(PROCESS_SCHEDULE_EXCEPTION, std::string("ListenSysLog failed to set SO_REUSEPORT: ") + std::strerror(errno));
   }
-  if (context->getProperty(MaxSocketBufSize.getName(), value)) {
-    core::Property::StringToInt(value, _maxSocketBufSize);
+#else
+  gsl_Expects(!reuse_port);
+#endif
+  if (max_socket_buffer_size_ > 0) {
+    const int receive_buffer_size = gsl::narrow<int>(max_socket_buffer_size_);
+    if (setsockopt(server_socket.get(), SOL_SOCKET, SO_RCVBUF, &receive_buffer_size, sizeof(receive_buffer_size)) != 0) {
+      logger_->log_warn("ListenSysLog failed to set the socket buffer size to %d: %s", receive_buffer_size, std::strerror(errno));
+    }
   }
-  if (context->getProperty(MaxConnections.getName(), value)) {
-    core::Property::StringToInt(value, _maxConnections);
+  if (!set_non_blocking(server_socket.get())) {
+    throw Exception(PROCESS_SCHEDULE_EXCEPTION, std::string("ListenSysLog failed to make the server socket non-blocking: ") + std::strerror(errno));
   }
-  if (context->getProperty(MessageDelimiter.getName(), value)) {
-    _messageDelimiter = value;
+
+  sockaddr_in serv_addr{};
+  serv_addr.sin_family = AF_INET;
+  serv_addr.sin_addr.s_addr = INADDR_ANY;
+  serv_addr.sin_port = htons(gsl::narrow<uint16_t>(port_));
+  if (bind(server_socket.get(), reinterpret_cast<const sockaddr*>(&serv_addr), sizeof(serv_addr)) < 0) {
+    throw Exception(PROCESS_SCHEDULE_EXCEPTION, std::string("ListenSysLog Server socket bind failed: ") + std::strerror(errno));
   }
-  if (context->getProperty(ParseMessages.getName(), value)) {
-    _parseMessages = org::apache::nifi::minifi::utils::StringUtils::toBool(value).value_or(false);
+  if (protocol_ == "TCP" && listen(server_socket.get(), SOMAXCONN) < 0) {
+    throw Exception(PROCESS_SCHEDULE_EXCEPTION, std::string("ListenSysLog Server socket listen failed: ") + std::strerror(errno));
   }
-  if (context->getProperty(Port.getName(), value)) {
-    int64_t oldPort = _port;
-    core::Property::StringToInt(value, _port);
-    if (_port != oldPort)
-      needResetServerSocket = true;
+  logger_->log_info("ListenSysLog Server socket %d bind OK to port %d", server_socket.get(), port_);
+  return server_socket;
+}
+
+void ListenSyslog::onSchedule(core::ProcessContext *context, core::ProcessSessionFactory* /*sessionFactory*/) {
+  gsl_Expects(context);
+  stopListeners();
+
+  context->getProperty(RecvBufSize.getName(), recv_buffer_size_);
+  context->getProperty(MaxSocketBufSize.getName(), max_socket_buffer_size_);
+  context->getProperty(MaxConnections.getName(), max_connections_);
+  context->getProperty(MaxBatchSize.getName(), max_batch_size_);
+  context->getProperty(MessageDelimiter.getName(), message_delimiter_);
+  context->getProperty(Protocol.getName(), protocol_);
+  context->getProperty(Port.getName(), port_);
+  context->getProperty(MaxQueueSize.getName(), max_queue_size_);
+  uint64_t listener_threads = 1;
+  context->getProperty(ListenerThreads.getName(), listener_threads);
+  if (recv_buffer_size_ == 0) {
+    throw Exception(PROCESS_SCHEDULE_EXCEPTION, "ListenSyslog: Receive Buffer Size must be positive");
+  }
+#ifndef SO_REUSEPORT
+  if (listener_threads > 1) {
+    logger_->log_warn("SO_REUSEPORT is not supported on this platform, using a single listener thread");
+    listener_threads = 1;
+  }
+#endif
+  listener_threads = std::max<uint64_t>(listener_threads, 1);
+
+  for (uint64_t i = 0; i < listener_threads; ++i) {
+    listeners_.push_back(std::make_unique<Listener>(*this, createServerSocket(listener_threads > 1)));
   }
-  if (context->getProperty(MaxBatchSize.getName(), value)) {
-    core::Property::StringToInt(value, _maxBatchSize);
+  for (auto& listener : listeners_) {
+    listener->start();
   }
+}
 
-  if (needResetServerSocket)
-    _resetServerSocket = true;
+void ListenSyslog::notifyStop() {
+  stopListeners();
+}
 
-  startSocketThread();
+void ListenSyslog::stopListeners() {
+  for (auto& listener : listeners_) {
+    listener->stop();
+  }
+  listeners_.clear();
+}
 
-  // read from the event queue
-  if (isEventQueueEmpty()) {
+std::unique_ptr<ListenSyslog::MessageArena> ListenSyslog::acquireArena() {
+  std::lock_guard<std::mutex> lock(arenas_mutex_);
+  if (free_arenas_.empty()) {
+    return std::make_unique<MessageArena>();
+  }
+  auto arena = std::move(free_arenas_.back());
+  free_arenas_.pop_back();
+  return arena;
+}
+
+void ListenSyslog::publishArena(std::unique_ptr<MessageArena> arena) {
+  std::lock_guard<std::mutex> lock(arenas_mutex_);
+  published_arenas_.push_back(std::move(arena));
+}
+
+std::deque<std::unique_ptr<ListenSyslog::MessageArena>> ListenSyslog::takePublishedArenas() {
+  std::lock_guard<std::mutex> lock(arenas_mutex_);
+  return std::exchange(published_arenas_, {});
+}
+
+void ListenSyslog::releaseArenas(std::deque<std::unique_ptr<MessageArena>> arenas) {
+  std::lock_guard<std::mutex> lock(arenas_mutex_);
+  for (auto& arena : arenas) {
+    if (free_arenas_.size() >= MAX_POOLED_ARENAS) {
+      break;
+    }
+    // the capacity of the buffers is kept
+    arena->data.clear();
+    arena->message_ends.clear();
+    free_arenas_.push_back(std::move(arena));
+  }
+}
+
+void ListenSyslog::onTrigger(core::ProcessContext *context, core::ProcessSession *session) {
+  auto arenas = takePublishedArenas();
+  if (arenas.empty()) {
     context->yield();
     return;
   }
 
-  std::queue<SysLogEvent> eventQueue;
-  pollEvent(eventQueue, _maxBatchSize);
-  bool firstEvent = true;
-  std::shared_ptr<core::FlowFile> flowFile = NULL;
-  while (!eventQueue.empty()) {
-    SysLogEvent event = eventQueue.front();
-    eventQueue.pop();
-    if (firstEvent) {
-      flowFile = session->create();
-      if (!flowFile)
-        return;
-      ListenSyslog::WriteCallback callback(event.payload, event.len);
-      session->write(flowFile, &callback);
-      delete[] event.payload;
-      firstEvent = false;
-    } else {
-      ListenSyslog::WriteCallback callback(event.payload, event.len);
-      session->append(flowFile, &callback);
-      delete[] event.payload;
+  std::vector<std::string_view> messages;
+  for (const auto& arena : arenas) {
+    for (size_t i = 0; i < arena->size(); ++i) {
+      messages.push_back(arena->message(i));
+    }
+  }
+  const auto release = gsl::finally([&] {
+    queued_messages_ -= messages.size();
+    releaseArenas(std::move(arenas));
+  });
+
+  const size_t batch_size = max_batch_size_ == 0 ? messages.size() : gsl::narrow<size_t>(max_batch_size_);
+  std::string batch_content;
+  for (size_t first = 0; first < messages.size(); first += batch_size) {
+    const size_t last = std::min(messages.size(), first + batch_size);
+    std::string_view content = messages[first];
+    if (last - first > 1) {
+      batch_content.clear();
+      for (size_t i = first; i < last; ++i) {
+        if (i != first) {
+          batch_content.append(message_delimiter_);
+        }
+        batch_content.append(messages[i]);
+      }
+      content = batch_content;
+    }
+
+    auto flow_file = session->create();
+    if (!flow_file) {
+      return;
     }
+    session->write(flow_file, FunctionOutputStreamCallback([content](const std::shared_ptr<io::OutputStream>& stream) -> int64_t {
+      if (content.empty()) return 0;
+      const auto write_ret = stream->write(reinterpret_cast<const uint8_t*>(content.data()), content.size());
+      return io::isError(write_ret) ? -1 : gsl::narrow<int64_t>(write_ret);
+    }));
+    flow_file->addAttribute("syslog.protocol", protocol_);
+    flow_file->addAttribute("syslog.port", std::to_string(port_));
+    session->transfer(flow_file, Success);
   }
-  flowFile->addAttribute("syslog.protocol", _protocol);
-  flowFile->addAttribute("syslog.port", std::to_string(_port));
-  session->transfer(flowFile, Success);
 }
 
 REGISTER_RESOURCE(ListenSyslog, "Listens for Syslog messages being sent to a given port over TCP or UDP. Incoming messages are checked against regular expressions for RFC5424 and RFC3164 formatted messages. " // NOLINT
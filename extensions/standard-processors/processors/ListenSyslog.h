@@ -20,36 +20,21 @@
 #ifndef EXTENSIONS_STANDARD_PROCESSORS_PROCESSORS_LISTENSYSLOG_H_
 #define EXTENSIONS_STANDARD_PROCESSORS_PROCESSORS_LISTENSYSLOG_H_
 
-#include <stdio.h>
-#include <sys/types.h>
-
+#include <atomic>
+#include <cstdint>
+#include <deque>
 #include <memory>
-#include <queue>
+#include <mutex>
 #include <string>
+#include <string_view>
 #include <vector>
 
-#ifndef WIN32
-#include <arpa/inet.h>
-#include <netinet/in.h>
-#include <sys/select.h>
-#include <sys/socket.h>
-#include <sys/time.h>
-
-#else
-#include <WinSock2.h>
-
-#endif
-#include <errno.h>
-
-#include <chrono>
-#include <thread>
-
 #include "core/Core.h"
 #include "core/logging/LoggerConfiguration.h"
 #include "core/Processor.h"
 #include "core/ProcessSession.h"
 #include "FlowFileRecord.h"
-#include "utils/gsl.h"
+#include "utils/net/Socket.h"
 
 #ifndef WIN32
 
@@ -59,13 +44,6 @@ namespace nifi {
 namespace minifi {
 namespace processors {
 
-
-// SyslogEvent
-typedef struct {
-  char *payload;
-  uint64_t len;
-} SysLogEvent;
-
 // ListenSyslog Class
 class ListenSyslog : public core::Processor {
  public:
@@ -73,42 +51,9 @@ class ListenSyslog : public core::Processor {
   /*!
    * Create a new processor
    */
-  ListenSyslog(const std::string& name,  const utils::Identifier& uuid = {}) // NOLINT
-      : Processor(name, uuid) {
-    _eventQueueByteSize = 0;
-    _serverSocket = 0;
-    _recvBufSize = 65507;
-    _maxSocketBufSize = 1024 * 1024;
-    _maxConnections = 2;
-    _maxBatchSize = 1;
-    _messageDelimiter = "\n";
-    _protocol = "UDP";
-    _port = 514;
-    _parseMessages = false;
-    _serverSocket = 0;
-    _maxFds = 0;
-    FD_ZERO(&_readfds);
-    _thread = nullptr;
-    _resetServerSocket = false;
-    _serverTheadRunning = false;
-  }
+  ListenSyslog(const std::string& name,  const utils::Identifier& uuid = {}); // NOLINT
   // Destructor
-  ~ListenSyslog() override {
-    _serverTheadRunning = false;
-    delete this->_thread;
-    // need to reset the socket
-    std::vector<int>::iterator it;
-    for (it = _clientSockets.begin(); it != _clientSockets.end(); ++it) {
-      int clientSocket = *it;
-      close(clientSocket);
-    }
-    _clientSockets.clear();
-    if (_serverSocket > 0) {
-      logger_->log_debug("ListenSysLog Server socket %d close", _serverSocket);
-      close(_serverSocket);
-      _serverSocket = 0;
-    }
-  }
+  ~ListenSyslog() override;
   // Processor Name
   static constexpr char const *ProcessorName = "ListenSyslog";
   // Supported Properties
@@ -120,106 +65,76 @@ class ListenSyslog : public core::Processor {
   static core::Property ParseMessages;
   static core::Property Protocol;
   static core::Property Port;
+  static core::Property MaxQueueSize;
+  static core::Property ListenerThreads;
   // Supported Relationships
   static core::Relationship Success;
   static core::Relationship Invalid;
-  // Nest Callback Class for write stream
-  class WriteCallback : public OutputStreamCallback {
-   public:
-    WriteCallback(char *data, uint64_t size)
-        : _data(reinterpret_cast<uint8_t*>(data)),
-          _dataSize(size) {
-    }
-    uint8_t *_data;
-    uint64_t _dataSize;
-    int64_t process(const std::shared_ptr<io::BaseStream>& stream) override {
-      if (!_data || _dataSize <= 0) return 0;
-      const auto write_ret = stream->write(_data, _dataSize);
-      return io::isError(write_ret) ? -1 : gsl::narrow<int64_t>(write_ret);
-    }
-  };
 
  public:
+  void onSchedule(core::ProcessContext *context, core::ProcessSessionFactory *sessionFactory) override;
   // OnTrigger method, implemented by NiFi ListenSyslog
   void onTrigger(core::ProcessContext *context, core::ProcessSession *session) override;
   // Initialize, over write by NiFi ListenSyslog
   void initialize() override;
 
+ protected:
+  void notifyStop() override;
+
  private:
+  /**
+   * Messages received by a listener, stored back to back in a single buffer. The buffers are pooled
+   * and reused once their messages are written to flow files.
+   */
+  struct MessageArena {
+    std::string data;
+    std::vector<size_t> message_ends;
+
+    size_t size() const {
+      return message_ends.size();
+    }
+
+    std::string_view message(size_t index) const {
+      const size_t begin = index == 0 ? 0 : message_ends[index - 1];
+      return std::string_view(data).substr(begin, message_ends[index] - begin);
+    }
+  };
+
+  // Receives messages on its own server socket and thread, see ListenSyslog.cpp
+  class Listener;
+
   core::annotation::Input getInputRequirement() const override {
     return core::annotation::Input::INPUT_FORBIDDEN;
   }
 
+  utils::net::UniqueSocketHandle createServerSocket(bool reuse_port) const;
+  void stopListeners();
+
+  std::unique_ptr<MessageArena> acquireArena();
+  void publishArena(std::unique_ptr<MessageArena> arena);
+  std::deque<std::unique_ptr<MessageArena>> takePublishedArenas();
+  void releaseArenas(std::deque<std::unique_ptr<MessageArena>> arenas);
+
   // Logger
   std::shared_ptr<core::logging::Logger> logger_ = core::logging::LoggerFactory<ListenSyslog>::getLogger();
-  // Run function for the thread
-  static void run(ListenSyslog *process);
-  // Run Thread
-  void runThread();
-  // Queue for store syslog event
-  std::queue<SysLogEvent> _eventQueue;
-  // Size of Event queue in bytes
-  uint64_t _eventQueueByteSize;
-  // Get event queue size
-  uint64_t getEventQueueSize() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return _eventQueue.size();
-  }
-  // Get event queue byte size
-  uint64_t getEventQueueByteSize() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return _eventQueueByteSize;
-  }
-  // Whether the event queue  is empty
-  bool isEventQueueEmpty() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return _eventQueue.empty();
-  }
-  // Put event into directory listing
-  void putEvent(uint8_t *payload, uint64_t len) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    SysLogEvent event;
-    event.payload = reinterpret_cast<char*>(payload);
-    event.len = len;
-    _eventQueue.push(event);
-    _eventQueueByteSize += len;
-  }
-  // Read \n terminated line from TCP socket
-  int readline(int fd, char *bufptr, size_t len);
-  // start server socket and handling client socket
-  void startSocketThread();
-  // Poll event
-  void pollEvent(std::queue<SysLogEvent> &list, int maxSize) {
-    std::lock_guard<std::mutex> lock(mutex_);
-
-    while (!_eventQueue.empty() && (maxSize == 0 || list.size() < static_cast<uint32_t>(maxSize))) {
-      SysLogEvent event = _eventQueue.front();
-      _eventQueue.pop();
-      _eventQueueByteSize -= event.len;
-      list.push(event);
-    }
-    return;
-  }
-  // Mutex for protection of the directory listing
-  std::mutex mutex_;
-  int64_t _recvBufSize;
-  int64_t _maxSocketBufSize;
-  int64_t _maxConnections;
-  int64_t _maxBatchSize;
-  std::string _messageDelimiter;
-  std::string _protocol;
-  int64_t _port;
-  bool _parseMessages;
-  int _serverSocket;
-  std::vector<int> _clientSockets;
-  int _maxFds;
-  fd_set _readfds;
-  // thread
-  std::thread *_thread;
-  // whether to reset the server socket
-  bool _resetServerSocket; bool _serverTheadRunning;
-  // buffer for read socket
-  char _buffer[2048];
+
+  uint64_t recv_buffer_size_ = 65507;
+  uint64_t max_socket_buffer_size_ = 1024 * 1024;
+  uint64_t max_connections_ = 2;
+  uint64_t max_batch_size_ = 1;
+  std::string message_delimiter_ = "\n";
+  std::string protocol_ = "UDP";
+  int64_t port_ = 514;
+  uint64_t max_queue_size_ = 10000;
+
+  std::vector<std::unique_ptr<Listener>> listeners_;
+  // messages received, but not yet written to flow files
+  std::atomic<uint64_t> queued_messages_{0};
+  std::atomic<uint64_t> connection_count_{0};
+
+  std::mutex arenas_mutex_;
+  std::deque<std::unique_ptr<MessageArena>> published_arenas_;
+  std::vector<std::unique_ptr<MessageArena>> free_arenas_;
 };
 
 }  // namespace processors
@@ -67,6 +67,7 @@ class ReplaceText : public core::Processor {
 
   explicit ReplaceText(const std::string& name, const utils::Identifier& uuid = {});
   core::annotation::Input getInputRequirement() const override { return core::annotation::Input::INPUT_REQUIRED; }
+  bool supportsBatching() const override { return true; }
   void initialize() override;
   void onSchedule(const std::shared_ptr<core::ProcessContext>& context, const std::shared_ptr<core::ProcessSessionFactory>&) override;
   void onTrigger(const std::shared_ptr<core::ProcessContext>& context, const std::shared_ptr<core::ProcessSession>& session) override;
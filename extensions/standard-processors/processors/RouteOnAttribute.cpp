@@ -62,6 +62,13 @@ void RouteOnAttribute::onDynamicPropertyModified(const core::Property& /*orig_pr
   setSupportedRelationships(relationships);
 }
 
+void RouteOnAttribute::onSchedule(core::ProcessContext *context, core::ProcessSessionFactory* /*sessionFactory*/) {
+  routes_.clear();
+  for (const auto &route : route_properties_) {
+    routes_.emplace_back(context->getDynamicPropertyHandle(route.second), route_rels_[route.first]);
+  }
+}
+
 void RouteOnAttribute::onTrigger(core::ProcessContext *context, core::ProcessSession *session) {
   auto flow_file = session->get();
 
@@ -74,14 +81,14 @@ void RouteOnAttribute::onTrigger(core::ProcessContext *context, core::ProcessSes
     bool did_match = false;
 
     // Perform dynamic routing logic
-    for (const auto &route : route_properties_) {
+    for (const auto &route : routes_) {
       std::string do_route;
-      context->getDynamicProperty(route.second, do_route, flow_file);
+      context->getProperty(route.first, do_route, flow_file);
 
       if (do_route == "true") {
         did_match = true;
         auto clone = session->clone(flow_file);
-        session->transfer(clone, route_rels_[route.first]);
+        session->transfer(clone, route.second);
       }
     }
 
@@ -23,6 +23,8 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "FlowFileRecord.h"
 #include "core/Processor.h"
@@ -62,6 +64,7 @@ class RouteOnAttribute : public core::Processor {
   }
 
   void onDynamicPropertyModified(const core::Property &orig_property, const core::Property &new_property) override;
+  void onSchedule(core::ProcessContext *context, core::ProcessSessionFactory *sessionFactory) override;
   void onTrigger(core::ProcessContext *context, core::ProcessSession *session) override;
   void initialize() override;
 
@@ -70,9 +73,14 @@ class RouteOnAttribute : public core::Processor {
     return core::annotation::Input::INPUT_REQUIRED;
   }
 
+  bool supportsBatching() const override {
+    return true;
+  }
+
   std::shared_ptr<core::logging::Logger> logger_ = core::logging::LoggerFactory<RouteOnAttribute>::getLogger();
   std::map<std::string, core::Property> route_properties_;
   std::map<std::string, core::Relationship> route_rels_;
+  std::vector<std::pair<core::PropertyHandle, core::Relationship>> routes_;
 };
 
 }  // namespace processors
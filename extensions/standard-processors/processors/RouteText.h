@@ -54,6 +54,10 @@ class RouteText : public core::Processor {
     return core::annotation::Input::INPUT_REQUIRED;
   }
 
+  bool supportsBatching() const override {
+    return true;
+  }
+
   bool supportsDynamicProperties() override {
     return true;
   }
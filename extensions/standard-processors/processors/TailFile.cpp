@@ -21,6 +21,7 @@
 #include <algorithm>
 #include <cinttypes>
 #include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <limits>
 #include <map>
@@ -127,6 +128,16 @@ core::Property TailFile::InitialStartPosition(
         ->withAllowableValues(InitialStartPositions::values())
         ->build());
 
+core::Property TailFile::UseFileSystemNotifications(
+    core::PropertyBuilder::createProperty("Use File System Notifications")
+        ->withDescription("If true, the directories of the tailed files are watched for changes (using inotify, where supported), and only the files "
+                          "which have changed are checked for new data. A yielding processor is woken up as soon as a tailed file changes. Otherwise, "
+                          "or where notifications are not supported, every file is checked each time the processor runs. "
+                          "Disable it when tailing files on network file systems, where changes made by other hosts are not reported.")
+        ->isRequired(false)
+        ->withDefaultValue<bool>(true)
+        ->build());
+
 core::Relationship TailFile::Success("success", "All files are routed to success");
 
 const char *TailFile::CURRENT_STR = "CURRENT.";
@@ -183,6 +194,8 @@ std::map<std::string, TailState> update_keys_in_legacy_states(const std::map<std
 
 void openFile(const std::string &file_name, uint64_t offset, std::ifstream &input_stream, const std::shared_ptr<core::logging::Logger> &logger) {
   logger->log_debug("Opening %s", file_name);
+  // the callbacks read in large chunks into buffers of their own, the stream buffer would only add a copy
+  input_stream.rdbuf()->pubsetbuf(nullptr, 0);
   input_stream.open(file_name.c_str(), std::fstream::in | std::fstream::binary);
   if (!input_stream.is_open() || !input_stream.good()) {
     input_stream.close();
@@ -197,7 +210,7 @@ void openFile(const std::string &file_name, uint64_t offset, std::ifstream &inpu
   }
 }
 
-constexpr std::size_t BUFFER_SIZE = 4096;
+constexpr std::size_t BUFFER_SIZE = 64 * 1024;
 
 class FileReaderCallback : public OutputStreamCallback {
  public:
@@ -227,8 +240,11 @@ class FileReaderCallback : public OutputStreamCallback {
         end_ = begin_ + num_bytes_read;
       }
 
-      char *delimiter_pos = std::find(begin_, end_, input_delimiter_);
-      found_delimiter = (delimiter_pos != end_);
+      auto *delimiter_pos = static_cast<char *>(std::memchr(begin_, input_delimiter_, end_ - begin_));
+      found_delimiter = (delimiter_pos != nullptr);
+      if (!found_delimiter) {
+        delimiter_pos = end_;
+      }
 
       const auto zlen = gsl::narrow<size_t>(std::distance(begin_, delimiter_pos)) + (found_delimiter ? 1 : 0);
       crc_stream.write(reinterpret_cast<uint8_t*>(begin_), zlen);
@@ -263,7 +279,7 @@ class FileReaderCallback : public OutputStreamCallback {
   std::ifstream input_stream_;
   std::shared_ptr<core::logging::Logger> logger_ = core::logging::LoggerFactory<TailFile>::getLogger();
 
-  std::array<char, BUFFER_SIZE> buffer_;
+  std::vector<char> buffer_ = std::vector<char>(BUFFER_SIZE);
   char *begin_ = buffer_.data();
   char *end_ = buffer_.data();
 
@@ -284,7 +300,7 @@ class WholeFileReaderCallback : public OutputStreamCallback {
   }
 
   int64_t process(const std::shared_ptr<io::BaseStream>& output_stream) override {
-    std::array<char, BUFFER_SIZE> buffer;
+    std::vector<char> buffer(BUFFER_SIZE);
 
     io::CRCStream<io::BaseStream> crc_stream{gsl::make_not_null(output_stream.get()), checksum_};
 
@@ -326,6 +342,7 @@ void TailFile::initialize() {
   properties.insert(LookupFrequency);
   properties.insert(RollingFilenamePattern);
   properties.insert(InitialStartPosition);
+  properties.insert(UseFileSystemNotifications);
   setSupportedProperties(properties);
   // Set the supported relationships
   std::set<core::Relationship> relationships;
@@ -335,6 +352,8 @@ void TailFile::initialize() {
 
 void TailFile::onSchedule(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSessionFactory>& /*sessionFactory*/) {
   tail_states_.clear();
+  changed_files_.clear();
+  check_all_files_ = true;
 
   state_manager_ = context->getStateManager();
   if (state_manager_ == nullptr) {
@@ -349,6 +368,17 @@ void TailFile::onSchedule(const std::shared_ptr<core::ProcessContext> &context,
 
   context->getProperty(FileName.getName(), file_to_tail_);
 
+  context->getProperty(UseFileSystemNotifications.getName(), use_file_system_notifications_);
+  // a new watcher drops the watches of the files tailed during the previous schedule
+  file_watcher_ = use_file_system_notifications_ ? std::make_unique<utils::file::FileWatcher>() : nullptr;
+  if (file_watcher_) {
+    // wakes up the processor waiting after a yield as soon as a tailed file changes
+    file_watcher_->notifyOnChanges([this] {
+      clearYield();
+      notifyWork();
+    });
+  }
+
   std::string mode;
   context->getProperty(TailMode.getName(), mode);
 
@@ -390,6 +420,7 @@ void TailFile::onSchedule(const std::shared_ptr<core::ProcessContext> &context,
     }
 
     recoverState(context);
+    watchTailedFiles();
   }
 
   std::string rolling_filename_pattern_glob;
@@ -677,18 +708,30 @@ void TailFile::onTrigger(const std::shared_ptr<core::ProcessContext> &, const st
     }
   }
 
+  collectChangedFiles();
+
   // iterate over file states. may modify them
   for (auto &state : tail_states_) {
-    processFile(session, state.first, state.second);
+    if (check_all_files_ || changed_files_.count(state.second.fileNameWithPath()) != 0) {
+      processFile(session, state.first, state.second);
+    } else {
+      logger_->log_trace("Skipping file %s as no change of it was reported since last read", state.second.file_name_);
+    }
   }
+  check_all_files_ = !watching_all_files_;
+  changed_files_.clear();
 
-  if (!session->existsFlowFileInRelationship(Success)) {
+  if (!session->existsFlowFileInRelationship(Success) && !isWorkAvailable()) {
     yield();
   }
 
   first_trigger_ = false;
 }
 
+bool TailFile::isWorkAvailable() {
+  return file_watcher_ && file_watcher_->hasPendingChanges();
+}
+
 bool TailFile::isOldFileInitiallyRead(TailState &state) const {
   // This is our initial processing and no stored state was found
   return first_trigger_ && state.last_read_time_ == std::chrono::system_clock::time_point{};
@@ -815,9 +858,38 @@ void TailFile::updateStateAttributes(TailState &state, uint64_t size, uint64_t c
 void TailFile::doMultifileLookup() {
   checkForRemovedFiles();
   checkForNewFiles();
+  watchTailedFiles();
+  // the new files need to be read, and the lookup doubles as a safety net for missed notifications
+  check_all_files_ = true;
   last_multifile_lookup_ = std::chrono::steady_clock::now();
 }
 
+void TailFile::watchTailedFiles() {
+  watching_all_files_ = file_watcher_ && file_watcher_->isAvailable();
+  for (const auto &kv : tail_states_) {
+    // the directory is watched, so the new file is noticed when the tailed file is rolled over
+    if (watching_all_files_ && !file_watcher_->watch(kv.second.path_)) {
+      logger_->log_warn("Checking every tailed file for changes, as the directory %s cannot be watched", kv.second.path_);
+      watching_all_files_ = false;
+    }
+  }
+}
+
+void TailFile::collectChangedFiles() {
+  if (!watching_all_files_) {
+    check_all_files_ = true;
+    return;
+  }
+  const bool complete = file_watcher_->poll([this](const utils::file::FileWatcher::Change &change) {
+    if (!change.is_directory) {
+      changed_files_.insert(change.directory + utils::file::FileUtils::get_separator() + change.file_name);
+    }
+  });
+  if (!complete) {
+    check_all_files_ = true;
+  }
+}
+
 void TailFile::checkForRemovedFiles() {
   std::vector<std::string> file_names_to_remove;
 
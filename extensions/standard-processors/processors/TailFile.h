@@ -24,6 +24,7 @@
 #include <memory>
 #include <utility>
 #include <string>
+#include <unordered_set>
 #include <vector>
 #include <set>
 
@@ -34,6 +35,7 @@
 #include "core/logging/LoggerConfiguration.h"
 #include "utils/Enum.h"
 #include "utils/Export.h"
+#include "utils/file/FileWatcher.h"
 
 namespace org {
 namespace apache {
@@ -100,6 +102,7 @@ class TailFile : public core::Processor {
   EXTENSIONAPI static core::Property LookupFrequency;
   EXTENSIONAPI static core::Property RollingFilenamePattern;
   EXTENSIONAPI static core::Property InitialStartPosition;
+  EXTENSIONAPI static core::Property UseFileSystemNotifications;
 
   // Supported Relationships
   EXTENSIONAPI static core::Relationship Success;
@@ -119,6 +122,12 @@ class TailFile : public core::Processor {
   void onTrigger(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSession>  &session) override;
 
   void initialize() override;
+
+  /**
+   * @return true if the watched directories have changes which have not been checked yet
+   */
+  bool isWorkAvailable() override;
+
   bool recoverState(const std::shared_ptr<core::ProcessContext>& context);
   void logState();
   bool storeState();
@@ -163,6 +172,8 @@ class TailFile : public core::Processor {
   void doMultifileLookup();
   void checkForRemovedFiles();
   void checkForNewFiles();
+  void watchTailedFiles();
+  void collectChangedFiles();
   void updateFlowFileAttributes(const std::string &full_file_name, const TailState &state, const std::string &fileName,
                                 const std::string &baseName, const std::string &extension,
                                 std::shared_ptr<core::FlowFile> &flow_file) const;
@@ -185,6 +196,12 @@ class TailFile : public core::Processor {
   std::string rolling_filename_pattern_;
   InitialStartPositions initial_start_position_;
   bool first_trigger_{true};
+  bool use_file_system_notifications_ = true;
+  std::unique_ptr<utils::file::FileWatcher> file_watcher_;
+  // true if the directories of all tailed files are watched, so only the files in changed_files_ need to be checked
+  bool watching_all_files_ = false;
+  bool check_all_files_ = true;
+  std::unordered_set<std::string> changed_files_;
   std::shared_ptr<core::logging::Logger> logger_ = core::logging::LoggerFactory<TailFile>::getLogger();
 };
 
@@ -68,8 +68,12 @@ class UpdateAttribute : public core::Processor {
     return core::annotation::Input::INPUT_REQUIRED;
   }
 
+  bool supportsBatching() const override {
+    return true;
+  }
+
   std::shared_ptr<core::logging::Logger> logger_ = core::logging::LoggerFactory<UpdateAttribute>::getLogger();
-  std::vector<core::Property> attributes_;
+  std::vector<core::PropertyHandle> attributes_;
 };
 
 }  // namespace processors
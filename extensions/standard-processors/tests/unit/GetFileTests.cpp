@@ -26,6 +26,7 @@
 #include "GetFile.h"
 #include "utils/file/FileUtils.h"
 #include "utils/TestUtils.h"
+#include "utils/gsl.h"
 #include "unit/ProvenanceTestHelper.h"
 
 #ifdef WIN32
@@ -262,3 +263,121 @@ TEST_CASE("Test if GetFile honors PollInterval property when triggered multiple
 
   REQUIRE(std::chrono::steady_clock::now() - start_time >= 100ms);
 }
+
+TEST_CASE("GetFile with Incremental Listing picks up each file only once", "[GetFile]") {
+  GetFileTestController test_controller;
+  test_controller.setProperty(minifi::processors::GetFile::ListingStrategy, "Incremental Listing");
+  test_controller.setProperty(minifi::processors::GetFile::KeepSourceFile, "true");
+
+  test_controller.runSession();
+  REQUIRE(LogTestController::getInstance().countOccurrences("key:filename value:test.txt") == 1);
+  REQUIRE(LogTestController::getInstance().countOccurrences("key:filename value:large_file.txt") == 1);
+
+  test_controller.test_plan_->reset();
+  test_controller.runSession();
+  REQUIRE(LogTestController::getInstance().countOccurrences("key:filename value:test.txt") == 1);
+
+  utils::putFileToDir(test_controller.temp_dir_, "new_file.txt", "Jumping over the lazy dog\n");
+  test_controller.test_plan_->reset();
+  test_controller.runSession();
+  REQUIRE(LogTestController::getInstance().countOccurrences("key:filename value:new_file.txt") == 1);
+  REQUIRE(LogTestController::getInstance().countOccurrences("key:filename value:test.txt") == 1);
+
+  SECTION("The files picked up are remembered when the processor is rescheduled") {
+    test_controller.test_plan_->reset(true);
+    test_controller.runSession();
+    REQUIRE(LogTestController::getInstance().countOccurrences("key:filename value:test.txt") == 1);
+    REQUIRE(LogTestController::getInstance().countOccurrences("key:filename value:new_file.txt") == 1);
+  }
+}
+
+TEST_CASE("GetFile with Incremental Listing picks up the files which were too young before", "[GetFile]") {
+  GetFileTestController test_controller;
+  test_controller.setProperty(minifi::processors::GetFile::ListingStrategy, "Incremental Listing");
+  test_controller.setProperty(minifi::processors::GetFile::MinAge, "1 hour");
+
+  test_controller.runSession();
+  REQUIRE(LogTestController::getInstance().countOccurrences("key:filename value:test.txt") == 0);
+
+  const auto more_than_an_hour_ago = utils::file::FileUtils::last_write_time(test_controller.getInputFilePath()) - 3605;
+  REQUIRE(utils::file::FileUtils::set_last_write_time(test_controller.getInputFilePath(), more_than_an_hour_ago));
+  test_controller.test_plan_->reset();
+  test_controller.runSession();
+  REQUIRE(LogTestController::getInstance().countOccurrences("key:filename value:test.txt") == 1);
+  REQUIRE(LogTestController::getInstance().countOccurrences("key:filename value:large_file.txt") == 0);
+}
+
+TEST_CASE("GetFile with Incremental Listing picks up the files which were too young before a restart", "[GetFile]") {
+  GetFileTestController test_controller;
+  test_controller.setProperty(minifi::processors::GetFile::ListingStrategy, "Incremental Listing");
+  test_controller.setProperty(minifi::processors::GetFile::MinAge, "1 hour");
+
+  const auto to_seconds = [](std::chrono::system_clock::time_point time_point) {
+    return gsl::narrow<uint64_t>(std::chrono::duration_cast<std::chrono::seconds>(time_point.time_since_epoch()).count());
+  };
+  const auto now = std::chrono::system_clock::now();
+  REQUIRE(utils::file::FileUtils::set_last_write_time(test_controller.getInputFilePath(), to_seconds(now - 30min)));
+  REQUIRE(utils::file::FileUtils::set_last_write_time(test_controller.getFullPath(test_controller.large_input_file_name_), to_seconds(now - 2h)));
+  // e.g. the young file was appended to, which does not change the modification time of the directory
+  REQUIRE(utils::file::FileUtils::set_last_write_time(test_controller.temp_dir_, to_seconds(now - 3h)));
+
+  test_controller.runSession();
+  REQUIRE(LogTestController::getInstance().countOccurrences("key:filename value:large_file.txt") == 1);
+  REQUIRE(LogTestController::getInstance().countOccurrences("key:filename value:test.txt") == 0);
+  // the listing state is stored at the start of the next listing
+  test_controller.test_plan_->reset();
+  test_controller.runSession();
+
+  REQUIRE(utils::file::FileUtils::set_last_write_time(test_controller.getInputFilePath(), to_seconds(now - 65min)));
+  test_controller.test_plan_->reset(true);
+  test_controller.runSession();
+  REQUIRE(LogTestController::getInstance().countOccurrences("key:filename value:test.txt") == 1);
+  REQUIRE(LogTestController::getInstance().countOccurrences("key:filename value:large_file.txt") == 1);
+}
+
+TEST_CASE("GetFile with Incremental Listing picks up the files with an old modification time added during a restart", "[GetFile]") {
+  GetFileTestController test_controller;
+  test_controller.setProperty(minifi::processors::GetFile::ListingStrategy, "Incremental Listing");
+
+  test_controller.runSession();
+  REQUIRE(LogTestController::getInstance().countOccurrences("key:filename value:test.txt") == 1);
+  // the listing state is stored at the start of the next listing
+  test_controller.test_plan_->reset();
+  test_controller.runSession();
+
+  // e.g. moved or extracted into the directory while the agent was stopped
+  utils::putFileToDir(test_controller.temp_dir_, "old_file.txt", "An old file\n");
+  const auto two_hours_ago = utils::file::FileUtils::last_write_time(test_controller.getFullPath("old_file.txt")) - 7200;
+  REQUIRE(utils::file::FileUtils::set_last_write_time(test_controller.getFullPath("old_file.txt"), two_hours_ago));
+  test_controller.test_plan_->reset(true);
+  test_controller.runSession();
+  REQUIRE(LogTestController::getInstance().countOccurrences("key:filename value:old_file.txt") == 1);
+  REQUIRE(LogTestController::getInstance().countOccurrences("key:filename value:test.txt") == 1);
+}
+
+TEST_CASE("GetFile listing performance of a large directory", "[GetFile][speed]") {
+  GetFileTestController test_controller;
+  test_controller.setProperty(minifi::processors::GetFile::KeepSourceFile, "true");
+  test_controller.setProperty(minifi::processors::GetFile::BatchSize, "0");
+  LogTestController::getInstance().setInfo<minifi::processors::GetFile>();
+  LogTestController::getInstance().setInfo<minifi::processors::LogAttribute>();
+  std::string strategy;
+  SECTION("Full Listing") { strategy = "Full Listing"; }
+  SECTION("Incremental Listing") { strategy = "Incremental Listing"; }
+  test_controller.setProperty(minifi::processors::GetFile::ListingStrategy, strategy);
+
+  const int file_count = 10000;
+  for (int i = 0; i < file_count; ++i) {
+    utils::putFileToDir(test_controller.temp_dir_, "file_" + std::to_string(i) + ".txt", "content\n");
+  }
+  test_controller.runSession();
+
+  const int listing_count = 10;
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < listing_count; ++i) {
+    test_controller.test_plan_->reset();
+    test_controller.runSession();
+  }
+  const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+  std::cerr << strategy << " of a directory of " << file_count << " files " << listing_count << " times took " << elapsed.count() << "ms" << std::endl;
+}
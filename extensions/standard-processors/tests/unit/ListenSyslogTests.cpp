@@ -0,0 +1,175 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef WIN32
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "TestBase.h"
+#include "ListenSyslog.h"
+#include "utils/net/Socket.h"
+#include "utils/StringUtils.h"
+
+using ListenSyslog = org::apache::nifi::minifi::processors::ListenSyslog;
+
+namespace {
+uint16_t randomPort() {
+  auto random_engine = std::mt19937{std::random_device{}()};  // NOLINT: "Missing space before {  [whitespace/braces] [5]"
+  // most systems use ports 32768 - 65535 as ephemeral ports, so avoid binding to those
+  return std::uniform_int_distribution<uint16_t>{10000, 32768 - 1}(random_engine);
+}
+
+utils::net::UniqueSocketHandle connectToListener(int type, uint16_t port) {
+  utils::net::UniqueSocketHandle socket{::socket(AF_INET, type, 0)};
+  REQUIRE(socket);
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = htons(port);
+  REQUIRE(connect(socket.get(), reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0);
+  return socket;
+}
+
+void sendAll(const utils::net::UniqueSocketHandle& socket, const std::string& data) {
+  size_t sent = 0;
+  while (sent < data.size()) {
+    const auto result = send(socket.get(), data.data() + sent, data.size() - sent, 0);
+    REQUIRE(result > 0);
+    sent += gsl::narrow<size_t>(result);
+  }
+}
+
+struct ListenSyslogTestPlan {
+  ListenSyslogTestPlan(TestController& controller, const std::string& protocol, uint16_t port)
+      : plan(controller.createPlan()),
+        listen_syslog(plan->addProcessor("ListenSyslog", "listen_syslog")),
+        success(plan->addConnection(listen_syslog, ListenSyslog::Success, nullptr)) {
+    plan->setProperty(listen_syslog, ListenSyslog::Protocol.getName(), protocol);
+    plan->setProperty(listen_syslog, ListenSyslog::Port.getName(), std::to_string(port));
+  }
+
+  // runs the processor until the flow files produced contain at least message_count messages
+  std::vector<std::string> collect(size_t message_count, const std::string& delimiter = "\n") {
+    std::vector<std::string> messages;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (messages.size() < message_count && std::chrono::steady_clock::now() < deadline) {
+      plan->runProcessor(listen_syslog);
+      std::set<std::shared_ptr<core::FlowFile>> expired;
+      while (auto flow_file = success->poll(expired)) {
+        contents.push_back(plan->getContent(flow_file));
+        for (auto& message : utils::StringUtils::split(contents.back(), delimiter)) {
+          messages.push_back(std::move(message));
+        }
+      }
+      if (messages.size() < message_count) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      }
+    }
+    return messages;
+  }
+
+  std::shared_ptr<TestPlan> plan;
+  std::shared_ptr<core::Processor> listen_syslog;
+  std::shared_ptr<minifi::Connection> success;
+  std::vector<std::string> contents;
+};
+}  // namespace
+
+TEST_CASE("ListenSyslog receives UDP datagrams", "[ListenSyslog]") {
+  TestController controller;
+  const auto port = randomPort();
+  ListenSyslogTestPlan test_plan(controller, "UDP", port);
+  test_plan.plan->runProcessor(test_plan.listen_syslog);
+
+  const auto client = connectToListener(SOCK_DGRAM, port);
+  for (int i = 0; i < 5; ++i) {
+    sendAll(client, "<13>message " + std::to_string(i));
+  }
+
+  const auto messages = test_plan.collect(5);
+  REQUIRE(messages == std::vector<std::string>{"<13>message 0", "<13>message 1", "<13>message 2", "<13>message 3", "<13>message 4"});
+  REQUIRE(test_plan.contents.size() == 5);
+}
+
+TEST_CASE("ListenSyslog splits TCP streams into lines", "[ListenSyslog]") {
+  TestController controller;
+  const auto port = randomPort();
+  ListenSyslogTestPlan test_plan(controller, "TCP", port);
+  test_plan.plan->setProperty(test_plan.listen_syslog, ListenSyslog::MaxBatchSize.getName(), "10");
+  test_plan.plan->setProperty(test_plan.listen_syslog, ListenSyslog::MessageDelimiter.getName(), "|");
+  test_plan.plan->runProcessor(test_plan.listen_syslog);
+
+  {
+    const auto client = connectToListener(SOCK_STREAM, port);
+    sendAll(client, "<13>first\r\n<13>sec");
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    sendAll(client, "ond\n<13>unterminated");
+  }
+
+  const auto messages = test_plan.collect(3, "|");
+  REQUIRE(messages == std::vector<std::string>{"<13>first", "<13>second", "<13>unterminated"});
+}
+
+// a benchmark flooding the loopback interface, only run when selected explicitly
+TEST_CASE("ListenSyslog UDP receive throughput", "[.][ListenSyslog][speed]") {
+  TestController controller;
+  LogTestController::getInstance().setWarn<ListenSyslog>();
+  const auto port = randomPort();
+  ListenSyslogTestPlan test_plan(controller, "UDP", port);
+  test_plan.plan->setProperty(test_plan.listen_syslog, ListenSyslog::MaxBatchSize.getName(), "1000");
+  test_plan.plan->setProperty(test_plan.listen_syslog, ListenSyslog::MaxQueueSize.getName(), "1000000");
+  test_plan.plan->setProperty(test_plan.listen_syslog, ListenSyslog::MaxSocketBufSize.getName(), "8 MB");
+  test_plan.plan->runProcessor(test_plan.listen_syslog);
+
+  const size_t sender_count = 2;
+  const size_t messages_per_sender = 50000;
+  const size_t sent_count = sender_count * messages_per_sender;
+  // datagrams may be lost when the senders are faster than the listener, but no more than this share of them
+  const double max_loss_ratio = 0.1;
+  const std::string message = "<34>1 2003-10-11T22:14:15.003Z mymachine.example.com su - ID47 - 'su root' failed for lonvick on /dev/pts/8";
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> senders;
+  for (size_t i = 0; i < sender_count; ++i) {
+    senders.emplace_back([&] {
+      const auto client = connectToListener(SOCK_DGRAM, port);
+      for (size_t j = 0; j < messages_per_sender; ++j) {
+        send(client.get(), message.data(), message.size(), 0);
+      }
+    });
+  }
+  for (auto& sender : senders) {
+    sender.join();
+  }
+  const auto messages = test_plan.collect(sent_count);
+  const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+  std::cerr << "Received " << messages.size() << " of " << sent_count << " syslog messages in " << elapsed.count() << "ms, "
+            << (elapsed.count() == 0 ? 0 : messages.size() * 1000 / elapsed.count()) << " messages/s" << std::endl;
+  REQUIRE(std::all_of(messages.begin(), messages.end(), [&message](const std::string& received) { return received == message; }));
+  REQUIRE(messages.size() <= sent_count);
+  REQUIRE(messages.size() >= static_cast<size_t>(static_cast<double>(sent_count) * (1 - max_loss_ratio)));
+}
+#endif
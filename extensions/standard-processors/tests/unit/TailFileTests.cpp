@@ -16,10 +16,13 @@
  * limitations under the License.
  */
 
+#include <chrono>
+#include <condition_variable>
 #include <cstdio>
 #include <fstream>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <utility>
 #include <string>
 #include <iostream>
@@ -1747,3 +1750,138 @@ TEST_CASE("Initial Start Position is set to invalid or empty value", "[initialSt
 
   REQUIRE_THROWS_AS(testController.runSession(plan), minifi::Exception);
 }
+
+#ifdef __linux__
+TEST_CASE("TailFile only checks the files reported to be changed", "[multiple_file][notifications]") {
+  TestController testController;
+  LogTestController::getInstance().setTrace<minifi::processors::TailFile>();
+  LogTestController::getInstance().setDebug<minifi::processors::LogAttribute>();
+
+  auto dir = testController.createTempDirectory();
+  createTempFile(dir, "idle.log", "idle line\n");
+  createTempFile(dir, "active.log", "first line\n");
+
+  auto plan = testController.createPlan();
+  auto tail_file = plan->addProcessor("TailFile", "Tail");
+  plan->setProperty(tail_file, minifi::processors::TailFile::TailMode.getName(), "Multiple file");
+  plan->setProperty(tail_file, minifi::processors::TailFile::BaseDirectory.getName(), dir);
+  plan->setProperty(tail_file, minifi::processors::TailFile::FileName.getName(), ".*\\.log");
+  plan->setProperty(tail_file, minifi::processors::TailFile::Delimiter.getName(), "\n");
+  auto log_attribute = plan->addProcessor("LogAttribute", "Log", core::Relationship("success", "description"), true);
+  plan->setProperty(log_attribute, minifi::processors::LogAttribute::FlowFilesToLog.getName(), "0");
+
+  testController.runSession(plan, true);
+  REQUIRE(LogTestController::getInstance().contains("Logged 2 flow files"));
+
+  plan->reset();
+  LogTestController::getInstance().resetStream(LogTestController::getInstance().log_output);
+
+  appendTempFile(dir, "active.log", "second line\nthird line\n");
+  testController.runSession(plan, true);
+  REQUIRE(LogTestController::getInstance().contains("Logged 2 flow files"));
+  REQUIRE(LogTestController::getInstance().contains("Skipping file idle.log as no change of it was reported since last read"));
+
+  plan->reset();
+  LogTestController::getInstance().resetStream(LogTestController::getInstance().log_output);
+
+  renameTempFile(dir, "active.log", "active.log.1");
+  appendTempFile(dir, "active.log.1", "rotated line\n");
+  createTempFile(dir, "active.log", "new file line\n");
+  testController.runSession(plan, true);
+  REQUIRE(LogTestController::getInstance().contains("Logged 2 flow files"));
+}
+
+TEST_CASE("TailFile is woken up when a tailed file changes", "[multiple_file][notifications]") {
+  TestController testController;
+  LogTestController::getInstance().setTrace<minifi::processors::TailFile>();
+
+  auto dir = testController.createTempDirectory();
+  createTempFile(dir, "active.log", "first line\n");
+
+  auto plan = testController.createPlan();
+  auto tail_file = plan->addProcessor("TailFile", "Tail");
+  plan->setProperty(tail_file, minifi::processors::TailFile::TailMode.getName(), "Multiple file");
+  plan->setProperty(tail_file, minifi::processors::TailFile::BaseDirectory.getName(), dir);
+  plan->setProperty(tail_file, minifi::processors::TailFile::FileName.getName(), ".*\\.log");
+  plan->setProperty(tail_file, minifi::processors::TailFile::Delimiter.getName(), "\n");
+  plan->addProcessor("LogAttribute", "Log", core::Relationship("success", "description"), true);
+
+  testController.runSession(plan, true);
+  REQUIRE_FALSE(tail_file->isWorkAvailable());
+
+  std::mutex mutex;
+  std::condition_variable condition;
+  bool notified = false;
+  tail_file->setWorkNotificationCallback([&] {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      notified = true;
+    }
+    condition.notify_all();
+  });
+  tail_file->yield(std::chrono::hours(1));
+
+  appendTempFile(dir, "active.log", "second line\n");
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    REQUIRE(condition.wait_for(lock, std::chrono::seconds(5), [&] { return notified; }));
+  }
+  REQUIRE(tail_file->isWorkAvailable());
+  REQUIRE_FALSE(tail_file->isYield());
+  tail_file->setWorkNotificationCallback(nullptr);
+}
+
+TEST_CASE("TailFile performance of tailing a thousand files", "[multiple_file][speed]") {
+  constexpr size_t FILE_COUNT = 1000;
+  constexpr size_t ACTIVE_FILE_COUNT = 10;
+  constexpr size_t ROUNDS = 100;
+
+  for (const bool use_notifications : {false, true}) {
+    TestController testController;
+    LogTestController::getInstance().setWarn<minifi::processors::TailFile>();
+    LogTestController::getInstance().setWarn<core::ProcessSession>();
+
+    auto dir = testController.createTempDirectory();
+    std::vector<std::string> file_names;
+    for (size_t i = 0; i < FILE_COUNT; ++i) {
+      file_names.push_back("file" + std::to_string(i) + ".log");
+      createTempFile(dir, file_names.back(), "initial line\n");
+    }
+
+    auto plan = testController.createPlan();
+    auto tail_file = plan->addProcessor("TailFile", "Tail");
+    plan->setProperty(tail_file, minifi::processors::TailFile::TailMode.getName(), "Multiple file");
+    plan->setProperty(tail_file, minifi::processors::TailFile::BaseDirectory.getName(), dir);
+    plan->setProperty(tail_file, minifi::processors::TailFile::FileName.getName(), ".*\\.log");
+    plan->setProperty(tail_file, minifi::processors::TailFile::Delimiter.getName(), "\n");
+    plan->setProperty(tail_file, minifi::processors::TailFile::UseFileSystemNotifications.getName(), use_notifications ? "true" : "false");
+    auto success = plan->addConnection(tail_file, minifi::processors::TailFile::Success, nullptr);
+
+    plan->runProcessor(tail_file);
+    REQUIRE(success->getQueueSize() == FILE_COUNT);
+
+    std::mt19937 random_engine{std::random_device{}()};  // NOLINT: "Missing space before {  [whitespace/braces] [5]"
+    std::uniform_int_distribution<size_t> file_index{0, FILE_COUNT - 1};
+    std::chrono::steady_clock::duration active_duration{0};
+    std::chrono::steady_clock::duration idle_duration{0};
+    for (size_t round = 0; round < ROUNDS; ++round) {
+      for (size_t i = 0; i < ACTIVE_FILE_COUNT; ++i) {
+        appendTempFile(dir, file_names[file_index(random_engine)], "new line\n");
+      }
+      auto start = std::chrono::steady_clock::now();
+      plan->runProcessor(tail_file);
+      active_duration += std::chrono::steady_clock::now() - start;
+
+      start = std::chrono::steady_clock::now();
+      plan->runProcessor(tail_file);
+      idle_duration += std::chrono::steady_clock::now() - start;
+    }
+    REQUIRE(success->getQueueSize() == FILE_COUNT + ROUNDS * ACTIVE_FILE_COUNT);
+
+    const auto to_micros = [](std::chrono::steady_clock::duration duration) { return std::chrono::duration_cast<std::chrono::microseconds>(duration).count(); };
+    std::cerr << "Tailing " << FILE_COUNT << " files " << (use_notifications ? "with" : "without") << " file system notifications: "
+              << to_micros(active_duration) / ROUNDS << " us per run with " << ACTIVE_FILE_COUNT << " changed files, "
+              << to_micros(idle_duration) / ROUNDS << " us per run without changes" << std::endl;
+  }
+}
+#endif
@@ -112,6 +112,13 @@ TEST_CASE("Connections components are parsed from yaml", "[YamlConfiguration]")
       REQUIRE(false == yaml_connection_parser.getDropEmptyFromYaml());
     }
   }
+  SECTION("Lock free queue value is read") {
+    YAML::Node connection_node = YAML::Load(std::string {
+        "lock free queue: true\n" });
+    YamlConnectionParser yaml_connection_parser(connection_node, "test_node", parent_ptr, logger);
+    REQUIRE(true == yaml_connection_parser.getLockFreeQueueFromYaml());
+    REQUIRE(false == YamlConnectionParser(YAML::Load(std::string("drop empty: true\n")), "test_node", parent_ptr, logger).getLockFreeQueueFromYaml());
+  }
   SECTION("Errors are handled properly when configuration lines are missing") {
     const auto connection = std::make_shared<minifi::Connection>(nullptr, nullptr, "name");
     SECTION("With empty configuration") {
@@ -28,22 +28,30 @@
 #include <mutex>
 #include <atomic>
 #include <algorithm>
+#include "ConnectionMetrics.h"
 #include "core/Core.h"
 #include "core/Connectable.h"
 #include "core/logging/Logger.h"
 #include "core/Relationship.h"
 #include "core/FlowFile.h"
 #include "core/Repository.h"
+#include "utils/ConcurrentFlowFileQueue.h"
 #include "utils/FlowFileQueue.h"
 
 namespace org {
 namespace apache {
 namespace nifi {
 namespace minifi {
+
+class FlowFileSwapManager;
+
 // Connection Class
 
 class Connection : public core::Connectable, public std::enable_shared_from_this<Connection> {
  public:
+  // Capacity of the lock-free queue when there is no max queue size set
+  static constexpr uint64_t DEFAULT_LOCK_FREE_QUEUE_CAPACITY = 10000;
+
   // Constructor
   /*
    * Create a new processor
@@ -55,7 +63,7 @@ class Connection : public core::Connectable, public std::enable_shared_from_this
   explicit Connection(const std::shared_ptr<core::Repository> &flow_repository, const std::shared_ptr<core::ContentRepository> &content_repo, const std::string &name, const utils::Identifier &uuid,
                       const utils::Identifier &srcUUID, const utils::Identifier &destUUID);
   // Destructor
-  virtual ~Connection() = default;
+  ~Connection() override;
 
   // Set Source Processor UUID
   void setSourceUUID(const utils::Identifier &uuid) {
@@ -140,15 +148,43 @@ class Connection : public core::Connectable, public std::enable_shared_from_this
     return drop_empty_;
   }
 
+  /**
+   * Non-penalized flow files are passed through a bounded lock-free queue (sized by the max queue size)
+   * instead of the mutex guarded one, the penalized ones and the overflow are queued separately.
+   * Ignored for the connections swapping out their queued flow files. Has to be set before the connection is used.
+   */
+  void setLockFreeQueue(bool lock_free);
+
+  bool hasLockFreeQueue() const {
+    return lock_free_queue_ != nullptr;
+  }
+
+  // Queued FlowFiles written to swap files at once
+  static constexpr uint64_t SWAP_BATCH_SIZE = 10000;
+  static constexpr const char* DEFAULT_SWAP_DIRECTORY = "./swap";
+
+  /**
+   * Beyond the threshold the queued FlowFiles are swapped out to files in the swap directory in batches,
+   * and swapped back in FIFO order as the queue drains. Only applies to the connections not using a
+   * lock-free queue. Has to be set before the connection is used, 0 disables swapping.
+   */
+  void setSwapThreshold(uint64_t threshold, const std::string& swap_directory);
+
+  uint64_t getSwapThreshold() const {
+    return swap_threshold_;
+  }
+
+  // Number of FlowFiles in the swap files
+  uint64_t getSwappedQueueSize();
+  // Data size of the FlowFiles in the swap files
+  uint64_t getSwappedQueueDataSize();
+
   // Check whether the queue is empty
   bool isEmpty() const;
   // Check whether the queue is full to apply back pressure
   bool isFull();
   // Get queue size
-  uint64_t getQueueSize() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return queue_.size();
-  }
+  uint64_t getQueueSize();
   // Get queue data size
   uint64_t getQueueDataSize() {
     return queued_data_size_;
@@ -159,6 +195,8 @@ class Connection : public core::Connectable, public std::enable_shared_from_this
 
   // Put multiple flowfiles into the queue
   void multiPut(std::vector<std::shared_ptr<core::FlowFile>>& flows);
+  // Put back the flowfiles of a rolled back session, they are not counted as enqueued again
+  void requeue(std::vector<std::shared_ptr<core::FlowFile>>& flows);
   // Poll the flow file from queue, the expired flow file record also being returned
   std::shared_ptr<core::FlowFile> poll(std::set<std::shared_ptr<core::FlowFile>> &expiredFlowRecords);
   // Drain the flow records
@@ -166,15 +204,17 @@ class Connection : public core::Connectable, public std::enable_shared_from_this
 
   void yield() override {}
 
-  bool isWorkAvailable() override {
-    const std::lock_guard<std::mutex> lock{mutex_};
-    return queue_.isWorkAvailable();
-  }
+  bool isWorkAvailable() override;
 
   bool isRunning() override {
     return true;
   }
 
+  // the FlowFiles put into the connection and the ones polled by its destination
+  const ConnectionMetrics& getMetrics() const {
+    return metrics_;
+  }
+
  protected:
   // Source Processor UUID
   utils::Identifier src_uuid_;
@@ -203,8 +243,35 @@ class Connection : public core::Connectable, public std::enable_shared_from_this
   mutable std::mutex mutex_;
   // Queued data size
   std::atomic<uint64_t> queued_data_size_ = 0;
+  ConnectionMetrics metrics_;
   // Queue for the Flow File
   utils::FlowFileQueue queue_;
+  // Used instead of queue_ when set
+  std::unique_ptr<utils::ConcurrentFlowFileQueue> lock_free_queue_;
+
+  // Swapping state, set before the connection is used
+  uint64_t swap_threshold_ = 0;
+  std::unique_ptr<FlowFileSwapManager> swap_manager_;
+  // Guarded by mutex_: the FlowFiles queued behind the swapped out ones, waiting to fill a batch
+  std::vector<std::shared_ptr<core::FlowFile>> swap_queue_;
+  // Guarded by mutex_: the number of FlowFiles being read back from a swap file without holding the lock
+  size_t swapping_in_count_ = 0;
+
+  // A batch of FlowFiles to be written into a reserved swap file after releasing mutex_
+  struct SwapOutBatch;
+
+  // these must be called with mutex_ held
+  void enqueue(const std::shared_ptr<core::FlowFile>& flow, std::vector<SwapOutBatch>& swap_out_batches);
+  // releases mutex_ while reading the swap file, returns false if there is nothing to swap in yet
+  bool swapIn(std::unique_lock<std::mutex>& lock);
+  size_t queueSize() const;
+  // must be called without mutex_ held
+  void swapOut(std::vector<SwapOutBatch>& swap_out_batches);
+
+  void putFlowFiles(std::vector<std::shared_ptr<core::FlowFile>>& flows, bool count_as_enqueued);
+
+  // Returns the polled flow file or nullptr if it expired
+  std::shared_ptr<core::FlowFile> acceptPolledFlowFile(const std::shared_ptr<core::FlowFile>& item, std::set<std::shared_ptr<core::FlowFile>> &expiredFlowRecords);
   // flow repository
   // Logger
   std::shared_ptr<core::logging::Logger> logger_ = core::logging::LoggerFactory<Connection>::getLogger();
@@ -0,0 +1,86 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+#include "utils/LatencyHistogram.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+
+/**
+ * Counters of the FlowFiles passing through a connection, updated without locking.
+ */
+class ConnectionMetrics {
+ public:
+  void recordEnqueue(uint64_t bytes) {
+    enqueued_flow_files_.fetch_add(1, std::memory_order_relaxed);
+    enqueued_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+  }
+
+  /**
+   * @param queue_wait_time the time the FlowFile spent in the connection, if it is known
+   */
+  void recordDequeue(uint64_t bytes, std::optional<std::chrono::steady_clock::duration> queue_wait_time) {
+    dequeued_flow_files_.fetch_add(1, std::memory_order_relaxed);
+    dequeued_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+    if (queue_wait_time) {
+      queue_wait_time_.record(std::chrono::duration_cast<std::chrono::microseconds>(*queue_wait_time));
+    }
+  }
+
+  uint64_t getEnqueuedFlowFiles() const {
+    return enqueued_flow_files_.load(std::memory_order_relaxed);
+  }
+
+  uint64_t getEnqueuedBytes() const {
+    return enqueued_bytes_.load(std::memory_order_relaxed);
+  }
+
+  uint64_t getDequeuedFlowFiles() const {
+    return dequeued_flow_files_.load(std::memory_order_relaxed);
+  }
+
+  uint64_t getDequeuedBytes() const {
+    return dequeued_bytes_.load(std::memory_order_relaxed);
+  }
+
+  // the time the dequeued FlowFiles spent in the connection
+  utils::LatencyHistogram::Snapshot getQueueWaitTime() const {
+    return queue_wait_time_.getSnapshot();
+  }
+
+ private:
+  std::atomic<uint64_t> enqueued_flow_files_{0};
+  std::atomic<uint64_t> enqueued_bytes_{0};
+  std::atomic<uint64_t> dequeued_flow_files_{0};
+  std::atomic<uint64_t> dequeued_bytes_{0};
+  utils::LatencyHistogram queue_wait_time_;
+};
+
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
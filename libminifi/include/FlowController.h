@@ -26,6 +26,7 @@
 #include <memory>
 #include <mutex>
 #include <cstdio>
+#include <optional>
 #include <queue>
 #include <set>
 #include <string>
@@ -46,6 +47,7 @@
 #include "core/Relationship.h"
 #include "core/state/nodes/FlowInformation.h"
 #include "core/state/nodes/MetricsBase.h"
+#include "core/state/MetricsPublisher.h"
 #include "core/state/UpdateController.h"
 #include "c2/C2Client.h"
 #include "CronDrivenSchedulingAgent.h"
@@ -191,6 +193,8 @@ class FlowController : public core::controller::ForwardingControllerServiceProvi
 
   std::map<std::string, std::unique_ptr<io::InputStream>> getDebugInfo() override;
 
+  std::optional<provenance::ProvenanceQueryResult> queryProvenance(const provenance::ProvenanceQuery& query) override;
+
  private:
   /**
    * Loads the flow as specified in the flow config file or if not present
@@ -205,6 +209,12 @@ class FlowController : public core::controller::ForwardingControllerServiceProvi
 
   std::optional<std::chrono::milliseconds> loadShutdownTimeoutFromConfiguration();
 
+  /**
+   * Starts the metrics publisher configured by nifi.metrics.publisher.class on the first call,
+   * and hands it the metric nodes of the current flow.
+   */
+  void loadMetricsPublisher();
+
  private:
   template <typename T, typename = typename std::enable_if<std::is_base_of<SchedulingAgent, T>::value>::type>
   void conditionalReloadScheduler(std::shared_ptr<T>& scheduler, const bool condition) {
@@ -235,6 +245,8 @@ class FlowController : public core::controller::ForwardingControllerServiceProvi
   std::unique_ptr<FlowControlProtocol> protocol_;
   // metrics information
   std::chrono::steady_clock::time_point start_time_;
+  // publishes the metrics without C2, nullptr if not configured
+  std::shared_ptr<state::MetricsPublisher> metrics_publisher_;
 
  private:
   std::chrono::milliseconds shutdown_check_interval_{1000};
@@ -37,6 +37,7 @@
 #include "utils/TimeUtil.h"
 #include "core/logging/LoggerConfiguration.h"
 #include "ResourceClaim.h"
+#include "FlowFileRecordDictionary.h"
 #include "Connection.h"
 #include "io/OutputStream.h"
 #include "io/StreamPipe.h"
@@ -58,17 +59,23 @@ class FlowFileRecord : public core::FlowFile {
  public:
   FlowFileRecord();
 
-  bool Serialize(io::OutputStream &outStream);
+  /**
+   * Serializes the record, the attribute keys and the content directory are written
+   * as ids of the dictionary if one is given.
+   */
+  bool Serialize(io::OutputStream &outStream, const std::shared_ptr<FlowFileRecordDictionary>& dictionary = nullptr);
 
   //! Serialize and Persistent to the repository
   bool Persist(const std::shared_ptr<core::Repository>& flowRepository);
   //! DeSerialize
-  static std::shared_ptr<FlowFileRecord> DeSerialize(const uint8_t *buffer, int bufferSize, const std::shared_ptr<core::ContentRepository> &content_repo, utils::Identifier &container) {
+  static std::shared_ptr<FlowFileRecord> DeSerialize(const uint8_t *buffer, int bufferSize, const std::shared_ptr<core::ContentRepository> &content_repo, utils::Identifier &container,
+      const std::shared_ptr<FlowFileRecordDictionary>& dictionary = nullptr) {
     io::BufferStream inStream{buffer, gsl::narrow<unsigned int>(bufferSize)};
-    return DeSerialize(inStream, content_repo, container);
+    return DeSerialize(inStream, content_repo, container, dictionary);
   }
-  //! DeSerialize
-  static std::shared_ptr<FlowFileRecord> DeSerialize(io::InputStream &stream, const std::shared_ptr<core::ContentRepository> &content_repo, utils::Identifier &container);
+  //! DeSerialize, both the current and the legacy record format can be read
+  static std::shared_ptr<FlowFileRecord> DeSerialize(io::InputStream &stream, const std::shared_ptr<core::ContentRepository> &content_repo, utils::Identifier &container,
+      const std::shared_ptr<FlowFileRecordDictionary>& dictionary = nullptr);
   //! DeSerialize
   static std::shared_ptr<FlowFileRecord> DeSerialize(const std::string& key, const std::shared_ptr<core::Repository>& flowRepository,
       const std::shared_ptr<core::ContentRepository> &content_repo, utils::Identifier &container);
@@ -82,6 +89,17 @@ class FlowFileRecord : public core::FlowFile {
   static std::atomic<uint64_t> local_flow_seq_number_;
 
  private:
+  // legacy records start with the most significant byte of the event time, which is always 0
+  static constexpr uint8_t RECORD_FORMAT_MARKER = 0xFF;
+  static constexpr uint8_t RECORD_FORMAT_VERSION = 2;
+
+  // how the content claim is stored
+  static constexpr uint64_t CONTENT_FULL_PATH = 0;
+  static constexpr uint64_t CONTENT_CLAIM_ID = 1;
+
+  static std::shared_ptr<FlowFileRecord> DeSerializeLegacy(io::InputStream &stream, uint8_t first_byte, const std::shared_ptr<core::ContentRepository> &content_repo,
+      utils::Identifier &container);
+
   static std::shared_ptr<core::logging::Logger> logger_;
 };
 
@@ -0,0 +1,76 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+
+/**
+ * Strings shared by the serialized FlowFile records of a repository (attribute keys
+ * and content directories), so that records can refer to them by id.
+ *
+ * Entries are never removed, a record referencing an id is only readable if the entry
+ * was persisted along with (or before) the record, see getUnpersistedEntries.
+ */
+class FlowFileRecordDictionary {
+ public:
+  static constexpr uint32_t MAX_SIZE = 4096;
+
+  /**
+   * Returns the id of the string, adding it to the dictionary if it is not full yet.
+   */
+  std::optional<uint32_t> intern(const std::string& str);
+
+  std::optional<std::string> lookup(uint32_t id) const;
+
+  /**
+   * Restores an entry read back from the repository.
+   * @return false if the entry conflicts with an existing one
+   */
+  bool restore(uint32_t id, const std::string& str);
+
+  /**
+   * Entries added since they were last marked as persisted. These have to be stored
+   * together with any record serialized using this dictionary.
+   */
+  std::vector<std::pair<uint32_t, std::string>> getUnpersistedEntries() const;
+
+  void markPersisted(const std::vector<std::pair<uint32_t, std::string>>& entries);
+
+  size_t size() const;
+
+ private:
+  mutable std::shared_mutex mutex_;
+  std::unordered_map<std::string, uint32_t> ids_;
+  std::vector<std::optional<std::string>> strings_;
+  std::vector<uint32_t> unpersisted_;
+};
+
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
@@ -0,0 +1,125 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "core/FlowFile.h"
+#include "core/logging/Logger.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+
+namespace core {
+class ContentRepository;
+}  // namespace core
+
+/**
+ * Keeps batches of queued FlowFiles in swap files so that only a summary of them stays in memory.
+ * The swap files are only a memory saving measure, the swapped FlowFiles stay persisted in the
+ * FlowFile repository, which is what they are restored from after a restart.
+ *
+ * The swap files are reserved in FIFO order by the owning connection while it holds its lock,
+ * the files themselves are written and read by swapOut and swapIn without the connection lock.
+ */
+class FlowFileSwapManager {
+ public:
+  struct SwapFile {
+    std::string path;
+    size_t count = 0;
+    uint64_t data_size = 0;
+    // set once swapOut has finished, only written swap files can be swapped in
+    bool written = false;
+  };
+
+  /**
+   * @param directory the directory of the swap files
+   * @param prefix the file name prefix of the swap files. Swap files left behind with this prefix by a previous run
+   * are removed, while the ones of other managers alive in this process (e.g. before a flow reload) are left alone.
+   */
+  FlowFileSwapManager(std::string directory, std::string prefix, std::shared_ptr<core::ContentRepository> content_repo);
+
+  ~FlowFileSwapManager();
+
+  FlowFileSwapManager(const FlowFileSwapManager&) = delete;
+  FlowFileSwapManager& operator=(const FlowFileSwapManager&) = delete;
+
+  /**
+   * Reserves the next swap file for the FlowFiles, they are counted as swapped from this point on.
+   */
+  std::shared_ptr<SwapFile> reserveSwapFile(const std::vector<std::shared_ptr<core::FlowFile>>& flow_files);
+
+  /**
+   * Writes the FlowFiles that are persisted in the FlowFile repository into the reserved swap file.
+   * @return the FlowFiles that could not be swapped out
+   */
+  std::vector<std::shared_ptr<core::FlowFile>> swapOut(const std::shared_ptr<SwapFile>& swap_file, std::vector<std::shared_ptr<core::FlowFile>> flow_files);
+
+  /**
+   * Removes the oldest swap file from the swapped ones.
+   * @return the swap file, or nullptr if there is none or it is still being written
+   */
+  std::shared_ptr<SwapFile> takeOldestSwapFile();
+
+  /**
+   * Reads back and removes a swap file returned by takeOldestSwapFile.
+   */
+  std::vector<std::shared_ptr<core::FlowFile>> swapIn(const SwapFile& swap_file);
+
+  size_t getSwappedCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return swapped_count_;
+  }
+
+  uint64_t getSwappedDataSize() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return swapped_data_size_;
+  }
+
+  size_t getSwapFileCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return swap_files_.size();
+  }
+
+ private:
+  void removeAbandonedSwapFiles();
+
+  std::string directory_;
+  std::string prefix_;
+  // distinguishes the swap files of this manager from the ones of other managers of the same connection
+  std::string instance_id_;
+  std::shared_ptr<core::ContentRepository> content_repo_;
+
+  mutable std::mutex mutex_;
+  std::deque<std::shared_ptr<SwapFile>> swap_files_;
+  uint64_t next_swap_file_id_ = 0;
+  size_t swapped_count_ = 0;
+  uint64_t swapped_data_size_ = 0;
+  std::shared_ptr<core::logging::Logger> logger_;
+};
+
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
@@ -62,6 +62,12 @@ class C2Client : public core::Flow, public state::response::NodeReporter {
   bool isC2Enabled() const;
   std::optional<std::string> fetchFlow(const std::string& uri) const;
 
+  /**
+   * Instantiates the response node and connects it to the repositories, the connections and the state of the flow.
+   * Returns nullptr if no response node is registered under the class name.
+   */
+  std::shared_ptr<state::response::ResponseNode> createResponseNode(const std::string& clazz, const std::shared_ptr<state::StateMonitor>& update_sink) const;
+
  private:
   void initializeComponentMetrics();
   void loadC2ResponseConfiguration(const std::string &prefix);
@@ -19,6 +19,7 @@
 #ifndef LIBMINIFI_INCLUDE_CORE_CONNECTABLE_H_
 #define LIBMINIFI_INCLUDE_CORE_CONNECTABLE_H_
 
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
@@ -136,6 +137,13 @@ class Connectable : public CoreComponent {
 
   void notifyWork();
 
+  /**
+   * Sets the function notifyWork calls, used by the scheduling agents to wake up
+   * the tasks of this connectable when new data arrives.
+   * @param callback to call, or nullptr to remove the current one
+   */
+  void setWorkNotificationCallback(std::function<void()> callback);
+
   /**
    * Determines if work is available by this connectable
    * @return boolean if work is available.
@@ -190,6 +198,8 @@ class Connectable : public CoreComponent {
   std::atomic<SchedulingStrategy> strategy_;
   // Concurrent condition variable for whether there is incoming work to do
   std::condition_variable work_condition_;
+  // called by notifyWork, guarded by work_available_mutex_
+  std::function<void()> work_notification_callback_;
   // version under which this connectable was created.
   std::shared_ptr<state::FlowIdentifier> connectable_version_;
 
@@ -20,6 +20,7 @@
 
 #include <map>
 #include <memory>
+#include <optional>
 #include <string>
 
 #include "properties/Configure.h"
@@ -67,8 +68,16 @@ class ContentRepository : public StreamManager<minifi::ResourceClaim>, public ut
   virtual StreamState decrementStreamCount(const minifi::ResourceClaim &streamId);
 
  protected:
+  /**
+   * Reads the size above which the sessions of this repository stream the written content
+   * into the repository instead of buffering it in memory until commit.
+   */
+  void readSessionSpillThreshold(const Configure& configure);
+
   std::string directory_;
 
+  std::optional<size_t> session_spill_threshold_;
+
   std::mutex count_map_mutex_;
 
   std::map<std::string, uint32_t> count_map_;
@@ -20,8 +20,10 @@
 
 #include <map>
 #include <memory>
+#include <optional>
 #include "ResourceClaim.h"
 #include "io/BaseStream.h"
+#include "io/BufferStream.h"
 
 namespace org {
 namespace apache {
@@ -38,7 +40,11 @@ class ContentSession {
     APPEND
   };
 
-  explicit ContentSession(std::shared_ptr<ContentRepository> repository);
+  /**
+   * @param spill_threshold if set, the content of a single claim is only buffered in memory
+   * until it reaches this many bytes, after which it is streamed into a pending repository object
+   */
+  explicit ContentSession(std::shared_ptr<ContentRepository> repository, std::optional<size_t> spill_threshold = std::nullopt);
 
   std::shared_ptr<ResourceClaim> create();
 
@@ -53,9 +59,92 @@ class ContentSession {
   virtual ~ContentSession() = default;
 
  protected:
-  std::map<std::shared_ptr<ResourceClaim>, std::shared_ptr<io::BufferStream>> managedResources_;
-  std::map<std::shared_ptr<ResourceClaim>, std::shared_ptr<io::BufferStream>> extendedResources_;
+  /**
+   * Stages the writes of a single resource. Below the spill threshold the content is
+   * kept in an in-memory buffer, above it the buffered bytes are moved into a pending
+   * repository object (the claim itself for new resources, a session-owned claim for appends)
+   * so that the memory usage is bounded by the threshold instead of the content size.
+   */
+  class StagedStream : public io::BaseStream {
+   public:
+    StagedStream(std::shared_ptr<ContentRepository> repository, std::shared_ptr<ResourceClaim> pending_claim, std::optional<size_t> spill_threshold);
+
+    using BaseStream::write;
+    using BaseStream::read;
+
+    size_t write(const uint8_t* data, size_t len) override;
+
+    size_t read(uint8_t* /*buffer*/, size_t /*len*/) override {
+      return io::STREAM_ERROR;
+    }
+
+    void seek(size_t /*offset*/) override {}
+
+    size_t tell() const override {
+      return size_;
+    }
+
+    size_t size() const override {
+      return size_;
+    }
+
+    const uint8_t* getBuffer() const override {
+      return buffer_.getBuffer();
+    }
+
+    bool isSpilled() const {
+      return pending_stream_ != nullptr;
+    }
+
+    /**
+     * Writes the remaining buffered bytes into the pending repository object and closes it.
+     * Only valid for spilled streams.
+     */
+    void flush();
+
+    /**
+     * Closes and releases the pending repository object, a session-owned pending claim
+     * is removed from the repository once it is no longer referenced.
+     */
+    void discard();
+
+    const std::shared_ptr<ResourceClaim>& getPendingClaim() const {
+      return pending_claim_;
+    }
+
+   protected:
+    /**
+     * Opens the pending repository object on the first spill.
+     */
+    virtual std::shared_ptr<io::BaseStream> openPendingStream();
+
+   private:
+    bool spill();
+
+    std::shared_ptr<ContentRepository> repository_;
+    std::shared_ptr<ResourceClaim> pending_claim_;
+    std::optional<size_t> spill_threshold_;
+    std::shared_ptr<io::BaseStream> pending_stream_;
+    io::BufferStream buffer_;
+    size_t size_ = 0;
+  };
+
+  std::shared_ptr<StagedStream> createStagedStream(std::shared_ptr<ResourceClaim> pending_claim) const;
+
+  /**
+   * Creates the staged stream of the content appended to an existing resource.
+   */
+  virtual std::shared_ptr<StagedStream> createExtensionStream() const;
+
+  /**
+   * Appends the spilled content of an extension to the end of the resource.
+   */
+  void appendSpilledContent(const std::shared_ptr<ResourceClaim>& resource, StagedStream& extension) const;
+
+  std::map<std::shared_ptr<ResourceClaim>, std::shared_ptr<StagedStream>> managedResources_;
+  std::map<std::shared_ptr<ResourceClaim>, std::shared_ptr<StagedStream>> extendedResources_;
   std::shared_ptr<ContentRepository> repository_;
+  std::optional<size_t> spill_threshold_;
 };
 
 }  // namespace core
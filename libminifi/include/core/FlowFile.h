@@ -219,6 +219,17 @@ class FlowFile : public CoreComponent, public ReferenceContainer {
     return to_be_processed_after_;
   }
 
+  void setLastQueueDate(std::chrono::steady_clock::time_point date) {
+    last_queue_date_ = date;
+  }
+
+  /**
+   * Gets the time the flow file was last put into a connection, the epoch if it has not been queued yet
+   */
+  [[nodiscard]] std::chrono::steady_clock::time_point getLastQueueDate() const {
+    return last_queue_date_;
+  }
+
   /**
    * Gets the offset within the flow file
    * @return size as a uint64_t
@@ -263,7 +274,7 @@ class FlowFile : public CoreComponent, public ReferenceContainer {
   // Date at which the origin of this flow file entered the flow
   std::chrono::system_clock::time_point lineage_start_date_{};
   // Date at which the flow file was queued
-  uint64_t last_queue_date_;
+  std::chrono::steady_clock::time_point last_queue_date_{};
   // Size in bytes of the data corresponding to this flow file
   uint64_t size_;
   // A global unique identifier
@@ -38,6 +38,7 @@
 #include "core/logging/LoggerConfiguration.h"
 #include "controllers/keyvalue/AbstractAutoPersistingKeyValueStoreService.h"
 #include "ProcessorNode.h"
+#include "core/PropertyHandle.h"
 #include "core/Repository.h"
 #include "core/FlowFile.h"
 #include "core/CoreComponentState.h"
@@ -150,6 +151,31 @@ class ProcessContext : public controller::ControllerServiceLookup, public core::
   std::vector<std::string> getDynamicPropertyKeys() const {
     return processor_node_->getDynamicPropertyKeys();
   }
+  /**
+   * Called when the processor is scheduled with this context, before Processor::onSchedule.
+   * Must not be called while the processor is running.
+   */
+  virtual void onSchedule() {
+  }
+  /**
+   * Resolves a property for repeated evaluation, e.g. in onSchedule for every flow file in onTrigger.
+   * The handle is only valid as long as the processor stays scheduled with this context.
+   */
+  virtual PropertyHandle getPropertyHandle(const Property &property) {
+    return PropertyHandle(property, false);
+  }
+  virtual PropertyHandle getDynamicPropertyHandle(const Property &property) {
+    return PropertyHandle(property, true);
+  }
+  /**
+   * Evaluates a property resolved by getPropertyHandle or getDynamicPropertyHandle.
+   */
+  virtual bool getProperty(const PropertyHandle &handle, std::string &value, const std::shared_ptr<FlowFile> &flow_file) {
+    if (handle.isDynamic()) {
+      return getDynamicProperty(handle.getProperty(), value, flow_file);
+    }
+    return getProperty(handle.getProperty(), value, flow_file);
+  }
   // Sets the property value using the property's string name
   bool setProperty(const std::string &name, std::string value) {
     return processor_node_->setProperty(name, value);
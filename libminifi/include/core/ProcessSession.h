@@ -37,6 +37,7 @@
 #include "FlowFile.h"
 #include "WeakReference.h"
 #include "provenance/Provenance.h"
+#include "ProcessorMetrics.h"
 #include "utils/gsl.h"
 
 namespace org {
@@ -107,6 +108,9 @@ class ProcessSession : public ReferenceContainer {
   void write(const std::shared_ptr<core::FlowFile> &flow, OutputStreamCallback&& callback) {
     return write(flow, &callback);
   }
+  // Make the content written to the claim outside of the session (eg. over several sessions) the content of the flow
+  // file, the flow file owns the claim once the session is committed
+  void attachContent(const std::shared_ptr<core::FlowFile> &flow, const std::shared_ptr<ResourceClaim> &claim, uint64_t size);
   // Read and write the flow file at the same time (eg. for processing it line by line)
   int64_t readWrite(const std::shared_ptr<core::FlowFile> &flow, InputOutputStreamCallback *callback);
   // Replace content with buffer
@@ -150,6 +154,11 @@ class ProcessSession : public ReferenceContainer {
 
   bool existsFlowFileInRelationship(const Relationship &relationship);
 
+  // the FlowFiles moved between the connections by the commits of this session so far
+  const SessionTransferStatistics& getTransferStatistics() const {
+    return transfer_statistics_;
+  }
+
 // Prevent default copy constructor and assignment operation
 // Only support pass by reference or pointer
   ProcessSession(const ProcessSession &parent) = delete;
@@ -202,6 +211,8 @@ class ProcessSession : public ReferenceContainer {
 
   std::shared_ptr<CoreComponentStateManager> stateManager_;
 
+  SessionTransferStatistics transfer_statistics_;
+
   static std::shared_ptr<utils::IdGenerator> id_generator_;
 };
 
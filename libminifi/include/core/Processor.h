@@ -45,6 +45,7 @@
 #include "ProcessContext.h"
 #include "ProcessSession.h"
 #include "ProcessSessionFactory.h"
+#include "ProcessorMetrics.h"
 #include "Property.h"
 #include "Relationship.h"
 #include "Scheduling.h"
@@ -149,6 +150,14 @@ class Processor : public Connectable, public ConfigurableComponent, public std::
     return false;
   }
 
+  // Overriding to yield true allows the onTrigger() method to be called repeatedly with the same session for the run duration
+  // of the Processor, so that the FlowFiles of several calls are committed at once. A failing call rolls back the FlowFiles of
+  // all the previous calls, so it must only be enabled for Processors without external effects, which would be repeated.
+  // By default, Processors are triggered once per session, regardless of their run duration.
+  virtual bool supportsBatching() const {
+    return false;
+  }
+
   // Set Trigger when empty
   void setTriggerWhenEmpty(bool value) {
     _triggerWhenEmpty = value;
@@ -236,6 +245,10 @@ class Processor : public Connectable, public ConfigurableComponent, public std::
 
   std::string getInputRequirementAsString() const;
 
+  const ProcessorMetrics& getMetrics() const {
+    return metrics_;
+  }
+
  protected:
   virtual void notifyStop() {
   }
@@ -267,6 +280,8 @@ class Processor : public Connectable, public ConfigurableComponent, public std::
   // Yield Expiration
   std::atomic<std::chrono::time_point<std::chrono::system_clock>> yield_expiration_{};
 
+  ProcessorMetrics metrics_;
+
   // Prevent default copy constructor and assignment operation
   // Only support pass by reference or pointer
   Processor(const Processor &parent);
@@ -278,6 +293,12 @@ class Processor : public Connectable, public ConfigurableComponent, public std::
     return mutex;
   }
 
+  /**
+   * Decides whether onTrigger is called again with the session of the current trigger: only while the run duration
+   * has not elapsed, the processor is neither stopped nor yielding, and it has input (or it does not take any).
+   */
+  bool shouldContinueTriggering(std::chrono::steady_clock::time_point run_duration_end);
+
   // must hold the graphMutex
   void updateReachability(const std::lock_guard<std::mutex>& graph_lock, bool force = false);
 
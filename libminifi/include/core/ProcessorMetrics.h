@@ -0,0 +1,88 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "utils/LatencyHistogram.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace core {
+
+/**
+ * The FlowFiles taken from the incoming connections and put into the outgoing connections by the commits of a session.
+ */
+struct SessionTransferStatistics {
+  uint64_t incoming_flow_files = 0;
+  uint64_t incoming_bytes = 0;
+  uint64_t outgoing_flow_files = 0;
+  uint64_t outgoing_bytes = 0;
+};
+
+/**
+ * Counters of the tasks run by a processor, updated without locking by the threads running the processor.
+ */
+class ProcessorMetrics {
+ public:
+  void recordTask(std::chrono::steady_clock::duration task_time, const SessionTransferStatistics& transfers) {
+    invocations_.fetch_add(1, std::memory_order_relaxed);
+    incoming_flow_files_.fetch_add(transfers.incoming_flow_files, std::memory_order_relaxed);
+    incoming_bytes_.fetch_add(transfers.incoming_bytes, std::memory_order_relaxed);
+    outgoing_flow_files_.fetch_add(transfers.outgoing_flow_files, std::memory_order_relaxed);
+    outgoing_bytes_.fetch_add(transfers.outgoing_bytes, std::memory_order_relaxed);
+    task_time_.record(std::chrono::duration_cast<std::chrono::microseconds>(task_time));
+  }
+
+  uint64_t getInvocations() const {
+    return invocations_.load(std::memory_order_relaxed);
+  }
+
+  SessionTransferStatistics getTransfers() const {
+    SessionTransferStatistics transfers;
+    transfers.incoming_flow_files = incoming_flow_files_.load(std::memory_order_relaxed);
+    transfers.incoming_bytes = incoming_bytes_.load(std::memory_order_relaxed);
+    transfers.outgoing_flow_files = outgoing_flow_files_.load(std::memory_order_relaxed);
+    transfers.outgoing_bytes = outgoing_bytes_.load(std::memory_order_relaxed);
+    return transfers;
+  }
+
+  // the time each onTrigger took, including the commit of its session
+  utils::LatencyHistogram::Snapshot getTaskTime() const {
+    return task_time_.getSnapshot();
+  }
+
+ private:
+  std::atomic<uint64_t> invocations_{0};
+  std::atomic<uint64_t> incoming_flow_files_{0};
+  std::atomic<uint64_t> incoming_bytes_{0};
+  std::atomic<uint64_t> outgoing_flow_files_{0};
+  std::atomic<uint64_t> outgoing_bytes_{0};
+  utils::LatencyHistogram task_time_;
+};
+
+}  // namespace core
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
@@ -18,6 +18,7 @@
 #ifndef LIBMINIFI_INCLUDE_CORE_PROCESSORNODE_H_
 #define LIBMINIFI_INCLUDE_CORE_PROCESSORNODE_H_
 
+#include <map>
 #include <memory>
 #include <set>
 #include <string>
@@ -134,6 +135,19 @@ class ProcessorNode : public ConfigurableComponent, public Connectable {
     return ret;
   }
 
+  /**
+   * Gets the supported properties of the processor
+   * @return supported properties by name
+   */
+  std::map<std::string, Property> getProperties() const {
+    const auto &processor_cast = std::dynamic_pointer_cast<ConfigurableComponent>(processor_);
+    if (processor_cast) {
+      return processor_cast->getProperties();
+    } else {
+      return ConfigurableComponent::getProperties();
+    }
+  }
+
   /**
    * Gets list of dynamic property keys
    * @param name property name.
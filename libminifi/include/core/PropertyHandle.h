@@ -0,0 +1,82 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <utility>
+
+#include "Property.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace core {
+
+/**
+ * A property resolved by a ProcessContext (see ProcessContext::getPropertyHandle), usually in
+ * onSchedule. Evaluating the property through its handle spares the lookup by name for every
+ * flow file.
+ *
+ * Handles are only resolved for the context that created them, other contexts evaluate them
+ * by the name of the property.
+ */
+class PropertyHandle {
+ public:
+  PropertyHandle() = default;
+
+  PropertyHandle(Property property, bool dynamic, const void *owner = nullptr, size_t index = 0)
+      : property_(std::move(property)),
+        dynamic_(dynamic),
+        owner_(owner),
+        index_(index) {
+  }
+
+  const Property& getProperty() const {
+    return property_;
+  }
+
+  std::string getName() const {
+    return property_.getName();
+  }
+
+  bool isDynamic() const {
+    return dynamic_;
+  }
+
+  bool isResolvedBy(const void *owner) const {
+    return owner_ != nullptr && owner_ == owner;
+  }
+
+  size_t getIndex() const {
+    return index_;
+  }
+
+ private:
+  Property property_;
+  bool dynamic_ = false;
+  const void *owner_ = nullptr;
+  size_t index_ = 0;
+};
+
+}  // namespace core
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
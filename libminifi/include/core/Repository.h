@@ -23,10 +23,12 @@
 #include <memory>
 #include <utility>
 #include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <cstring>
 #include <iostream>
 #include <map>
+#include <optional>
 #include <set>
 #include <string>
 #include <thread>
@@ -37,6 +39,8 @@
 #include "core/logging/LoggerConfiguration.h"
 #include "core/Property.h"
 #include "ResourceClaim.h"
+#include "FlowFileRecordDictionary.h"
+#include "provenance/ProvenanceQuery.h"
 #include "utils/TimeUtil.h"
 #include "utils/StringUtils.h"
 #include "Core.h"
@@ -59,6 +63,44 @@ namespace core {
 constexpr auto MAX_REPOSITORY_ENTRY_LIFE_TIME = std::chrono::minutes(10);
 constexpr auto REPOSITORY_PURGE_PERIOD = std::chrono::milliseconds(2500);
 
+/**
+ * State of the deletions a repository applies asynchronously.
+ */
+struct RepositoryDeleteMetrics {
+  // deletions queued but not yet applied
+  uint64_t backlog = 0;
+  // time it took to apply the last batch of deletions
+  std::chrono::microseconds last_batch_latency{0};
+};
+
+/**
+ * State of the writes a repository applies asynchronously.
+ */
+struct RepositoryWriteMetrics {
+  // records queued but not yet written
+  uint64_t backlog = 0;
+  // the number of records which can be queued before the writers are blocked or the records are dropped
+  uint64_t capacity = 0;
+  // records dropped because the queue was full
+  uint64_t dropped = 0;
+  // writes which had to wait for room in the queue
+  uint64_t blocked = 0;
+  // the number of records written in the last batch and the time it took
+  uint64_t last_batch_size = 0;
+  std::chrono::microseconds last_batch_latency{0};
+};
+
+/**
+ * Size estimates of the database backing a repository.
+ */
+struct RepositoryStorageMetrics {
+  uint64_t estimated_key_count = 0;
+  // memory used by the readers of the files of the database
+  uint64_t table_readers_memory = 0;
+  // memory used by the write buffers not yet flushed to files
+  uint64_t memtables_memory = 0;
+};
+
 class Repository : public virtual core::SerializableComponent, public core::TraceableResource {
  public:
   /*
@@ -110,6 +152,15 @@ class Repository : public virtual core::SerializableComponent, public core::Trac
     return true;
   }
 
+  /**
+   * Deletes the key of a record referencing the given claim. Repositories releasing the claim
+   * of removed records can use it instead of reading the record back. The claim may be null
+   * if the record references no content.
+   */
+  virtual bool Delete(const std::string& key, const std::shared_ptr<ResourceClaim>& /*claim*/) {
+    return Delete(key);
+  }
+
   virtual bool Delete(std::vector<std::shared_ptr<core::SerializableComponent>> &storedValues) {
     bool found = true;
     for (auto storedValue : storedValues) {
@@ -231,6 +282,46 @@ class Repository : public virtual core::SerializableComponent, public core::Trac
 
   virtual uint64_t getRepoSize();
 
+  /**
+   * Returns the state of the deferred deletions, or std::nullopt if the repository
+   * applies its deletions synchronously.
+   */
+  virtual std::optional<RepositoryDeleteMetrics> getDeleteMetrics() const {
+    return std::nullopt;
+  }
+
+  /**
+   * Returns the state of the deferred writes, or std::nullopt if the repository
+   * applies its writes synchronously.
+   */
+  virtual std::optional<RepositoryWriteMetrics> getWriteMetrics() const {
+    return std::nullopt;
+  }
+
+  /**
+   * Returns the size estimates of the underlying database as of the last refresh by the repository thread,
+   * or std::nullopt if the repository doesn't provide them.
+   */
+  virtual std::optional<RepositoryStorageMetrics> getStorageMetrics() const {
+    return std::nullopt;
+  }
+
+  /**
+   * Returns the dictionary the FlowFile records stored in this repository are serialized with,
+   * or nullptr if the repository doesn't persist one.
+   */
+  virtual std::shared_ptr<FlowFileRecordDictionary> getRecordDictionary() const {
+    return nullptr;
+  }
+
+  /**
+   * Returns the provenance events matching the query, or std::nullopt if the repository
+   * doesn't store provenance events or cannot be queried.
+   */
+  virtual std::optional<provenance::ProvenanceQueryResult> queryProvenance(const provenance::ProvenanceQuery& /*query*/) {
+    return std::nullopt;
+  }
+
   std::string getDirectory() const {
     return directory_;
   }
@@ -18,8 +18,13 @@
 #ifndef LIBMINIFI_INCLUDE_CORE_REPOSITORY_FILESYSTEMREPOSITORY_H_
 #define LIBMINIFI_INCLUDE_CORE_REPOSITORY_FILESYSTEMREPOSITORY_H_
 
+#include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "core/Core.h"
 #include "../ContentRepository.h"
@@ -34,6 +39,13 @@ namespace repository {
 
 /**
  * FileSystemRepository is a content repository that stores data onto the local file system.
+ *
+ * By default every claim is stored in its own file. In container mode the claims are appended
+ * into rolling segment files instead, and addressed by (segment, offset, length). Each record
+ * in a segment carries the claim path and the content length so the index can be rebuilt on
+ * startup, removed records are listed in a tombstone file next to the segment. A segment is
+ * deleted once it is full and none of its claims are referenced any more. As the records are
+ * immutable, a claim appended to is moved out of its segment into its own file.
  */
 class FileSystemRepository : public core::ContentRepository, public core::CoreComponent {
  public:
@@ -59,7 +71,98 @@ class FileSystemRepository : public core::ContentRepository, public core::CoreCo
 
   virtual bool remove(const minifi::ResourceClaim &claim);
 
+  bool isContainerMode() const {
+    return max_segment_size_.has_value();
+  }
+
+  /**
+   * Number of segment files currently present in container mode
+   */
+  size_t getSegmentCount() const;
+
  private:
+  struct ClaimLocation {
+    uint64_t segment_id;
+    size_t offset;
+    size_t length;
+  };
+
+  /**
+   * The tombstone file of a segment, written without holding mutex_
+   */
+  class TombstoneFile {
+   public:
+    explicit TombstoneFile(std::string path)
+        : path_(std::move(path)) {
+    }
+
+    // appends the offset of a removed record, unless the file has been removed meanwhile
+    bool add(uint64_t offset);
+    // the offsets added later are ignored
+    void remove();
+
+   private:
+    std::mutex mutex_;
+    std::string path_;
+    bool removed_ = false;
+  };
+
+  struct Segment {
+    std::string path;
+    size_t live_claims = 0;
+    bool sealed = false;
+    // created on the first removal of a record
+    std::shared_ptr<TombstoneFile> tombstones;
+  };
+
+  // the removal of a record, written into the tombstone file of its segment after releasing mutex_
+  struct Tombstone {
+    std::shared_ptr<TombstoneFile> file;
+    uint64_t offset;
+  };
+
+  /**
+   * An unsealed segment that is exclusively used by at most one writer at a time
+   */
+  struct SegmentWriter {
+    uint64_t id;
+    std::shared_ptr<io::BaseStream> stream;
+  };
+
+  class ContainerOutputStream;
+
+  std::string getContainerDirectory() const;
+  std::string getTombstonePath(const std::string& segment_path) const;
+
+  void loadSegments();
+  void loadSegment(uint64_t segment_id, const std::string& path);
+
+  std::unique_ptr<SegmentWriter> acquireSegmentWriter();
+  void releaseSegmentWriter(std::unique_ptr<SegmentWriter> writer);
+
+  std::shared_ptr<io::BaseStream> writeToContainer(const minifi::ResourceClaim &claim, bool append);
+  std::shared_ptr<io::BaseStream> moveToOwnFile(const minifi::ResourceClaim &claim, const ClaimLocation& location);
+  void publishRecord(const std::string& claim_path, const ClaimLocation& location);
+  void discardRecord(const ClaimLocation& location);
+  std::optional<ClaimLocation> findClaim(const std::string& claim_path) const;
+  // must not hold mutex_
+  void writeTombstone(const std::optional<Tombstone>& tombstone);
+
+  // requires mutex_
+  std::optional<Tombstone> releaseRecord(const ClaimLocation& location);
+  void deleteSegment(uint64_t segment_id);
+
+  std::optional<size_t> max_segment_size_;
+
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, ClaimLocation> claim_locations_;
+  std::map<uint64_t, Segment> segments_;
+  std::vector<std::unique_ptr<SegmentWriter>> idle_writers_;
+  // streams of the writers currently owned by a ContainerOutputStream, keyed by segment id
+  std::unordered_map<uint64_t, std::shared_ptr<io::BaseStream>> busy_writers_;
+  bool stopped_ = false;
+  uint64_t next_segment_id_ = 0;
+
   std::shared_ptr<logging::Logger> logger_;
 };
 
@@ -0,0 +1,59 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/Core.h"
+#include "nodes/MetricsBase.h"
+#include "properties/Configure.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace state {
+
+/**
+ * Purpose: Exposes the metrics of the agent to a monitoring system, independently of C2.
+ * The class named by nifi.metrics.publisher.class is instantiated by the flow controller.
+ */
+class MetricsPublisher : public core::CoreComponent {
+ public:
+  explicit MetricsPublisher(const std::string& name, const utils::Identifier& uuid = {})
+      : core::CoreComponent(name, uuid) {
+  }
+
+  /**
+   * Starts publishing. Throws if the publisher cannot be started with the configuration.
+   */
+  virtual void initialize(const std::shared_ptr<Configure>& configuration) = 0;
+
+  /**
+   * Replaces the nodes the published metrics are calculated from, each time the flow is started.
+   */
+  virtual void setMetricNodes(std::vector<std::shared_ptr<response::ResponseNode>> nodes) = 0;
+};
+
+}  // namespace state
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
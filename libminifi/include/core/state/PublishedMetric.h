@@ -0,0 +1,62 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "utils/LatencyHistogram.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace state {
+
+/**
+ * A numeric value of a response node, flattened for the metrics publishers.
+ */
+struct PublishedMetric {
+  enum class Type {
+    GAUGE,
+    // monotonically increasing since the start of the agent
+    COUNTER,
+    // a sample of a distribution: a quantile, the sum or the count of the observations
+    SUMMARY
+  };
+
+  // the name of the metric family, the same for all samples of a summary
+  std::string name;
+  double value = 0.0;
+  std::map<std::string, std::string> labels;
+  Type type = Type::GAUGE;
+  // distinguishes the sum ("_sum") and the count ("_count") samples of a summary from its quantiles
+  std::string suffix;
+};
+
+/**
+ * Publishes the distribution of the durations as a summary, in seconds.
+ */
+std::vector<PublishedMetric> publishLatencyHistogram(const std::string& name, const utils::LatencyHistogram::Snapshot& histogram, const std::map<std::string, std::string>& labels);
+
+}  // namespace state
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
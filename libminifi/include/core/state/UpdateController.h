@@ -23,8 +23,10 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <optional>
 #include "utils/ThreadPool.h"
 #include "utils/BackTrace.h"
+#include "provenance/ProvenanceQuery.h"
 
 namespace org {
 namespace apache {
@@ -232,6 +234,14 @@ class StateMonitor : public StateController {
 
   virtual std::map<std::string, std::unique_ptr<io::InputStream>> getDebugInfo() = 0;
 
+  /**
+   * Queries the provenance repository.
+   * @return the matching events, or std::nullopt if the provenance repository cannot be queried.
+   */
+  virtual std::optional<provenance::ProvenanceQueryResult> queryProvenance(const provenance::ProvenanceQuery& /*query*/) {
+    return std::nullopt;
+  }
+
  protected:
   std::atomic<bool> controller_running_;
 };
@@ -222,6 +222,19 @@ class FlowInformation : public FlowMonitor {
         repoNode.children.push_back(datasizemax);
         repoNode.children.push_back(queueUUIDNode);
 
+        if (queue.second->getSwapThreshold() > 0) {
+          SerializedResponseNode swapped;
+          swapped.name = "swappedSize";
+          swapped.value = queue.second->getSwappedQueueSize();
+
+          SerializedResponseNode swappeddatasize;
+          swappeddatasize.name = "swappedDataSize";
+          swappeddatasize.value = queue.second->getSwappedQueueDataSize();
+
+          repoNode.children.push_back(swapped);
+          repoNode.children.push_back(swappeddatasize);
+        }
+
         queues.children.push_back(repoNode);
       }
       serialized.push_back(queues);
@@ -23,6 +23,7 @@
 #include <memory>
 #include <string>
 
+#include "../PublishedMetric.h"
 #include "../Value.h"
 #include "core/Core.h"
 #include "core/Connectable.h"
@@ -57,6 +58,14 @@ class ResponseNode : public core::Connectable {
 
   virtual std::vector<SerializedResponseNode> serialize() = 0;
 
+  /**
+   * Returns the numeric values of the node for the metrics publishers. Has to be cheap,
+   * as it may be called much more often than serialize. The nodes that don't override it are not published.
+   */
+  virtual std::vector<PublishedMetric> calculateMetrics() {
+    return {};
+  }
+
   virtual void yield() {
   }
   virtual bool isRunning() {
@@ -0,0 +1,129 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "../nodes/FlowInformation.h"
+#include "../nodes/StateMonitor.h"
+#include "core/Processor.h"
+#include "utils/LatencyHistogram.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace state {
+namespace response {
+
+/**
+ * Serializes the count, the sum, the maximum and the usual percentiles of the histogram, all durations in microseconds.
+ */
+SerializedResponseNode serializeLatencyHistogram(const std::string& name, const utils::LatencyHistogram::Snapshot& histogram);
+
+/**
+ * Justification and Purpose: Shows which processors of the flow take the most time, without attaching a profiler.
+ * Provides the number of tasks run by each processor, the FlowFiles and bytes they took and produced, and the
+ * distribution of their task times.
+ */
+class ProcessorPerformanceMetrics : public StateMonitorNode {
+ public:
+  ProcessorPerformanceMetrics(const std::string &name, const utils::Identifier &uuid)
+      : StateMonitorNode(name, uuid) {
+  }
+
+  ProcessorPerformanceMetrics(const std::string &name) // NOLINT
+      : StateMonitorNode(name) {
+  }
+
+  ProcessorPerformanceMetrics()
+      : StateMonitorNode("ProcessorPerformanceMetrics") {
+  }
+
+  std::string getName() const override {
+    return "processorMetrics";
+  }
+
+  void addProcessor(const std::shared_ptr<core::Processor>& processor) {
+    if (processor) {
+      processors_[processor->getUUIDStr()] = processor;
+    }
+  }
+
+  std::vector<SerializedResponseNode> serialize() override;
+
+  std::vector<PublishedMetric> calculateMetrics() override;
+
+ private:
+  std::map<std::string, std::shared_ptr<core::Processor>> getProcessors() const;
+
+  // the processors added explicitly, the ones of the state monitor are looked up on each serialization
+  std::map<std::string, std::shared_ptr<core::Processor>> processors_;
+};
+
+/**
+ * Justification and Purpose: Shows where the FlowFiles are waiting in the flow. Provides the number of FlowFiles and bytes
+ * passing through each connection, the rate of them since the previous serialization, and the distribution of the time the
+ * FlowFiles spent in the connection.
+ */
+class ConnectionPerformanceMetrics : public FlowMonitor {
+ public:
+  ConnectionPerformanceMetrics(const std::string &name, const utils::Identifier &uuid)
+      : FlowMonitor(name, uuid) {
+  }
+
+  ConnectionPerformanceMetrics(const std::string &name) // NOLINT
+      : FlowMonitor(name) {
+  }
+
+  ConnectionPerformanceMetrics()
+      : FlowMonitor("ConnectionPerformanceMetrics") {
+  }
+
+  std::string getName() const override {
+    return "connectionMetrics";
+  }
+
+  std::vector<SerializedResponseNode> serialize() override;
+
+  // the rates are left to the consumers of the published counters
+  std::vector<PublishedMetric> calculateMetrics() override;
+
+ private:
+  struct Sample {
+    std::chrono::steady_clock::time_point time;
+    uint64_t enqueued_flow_files = 0;
+    uint64_t dequeued_flow_files = 0;
+  };
+
+  std::mutex mutex_;
+  // the counters of the previous serialization by connection uuid, to calculate the rates from
+  std::map<std::string, Sample> last_samples_;
+};
+
+}  // namespace response
+}  // namespace state
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
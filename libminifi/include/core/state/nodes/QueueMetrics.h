@@ -90,11 +90,40 @@ class QueueMetrics : public ResponseNode {
       parent.children.push_back(queuesize);
       parent.children.push_back(queuesizemax);
 
+      if (connection->getSwapThreshold() > 0) {
+        SerializedResponseNode swapped;
+        swapped.name = "swapped";
+        swapped.value = connection->getSwappedQueueSize();
+
+        SerializedResponseNode swappeddatasize;
+        swappeddatasize.name = "swappeddatasize";
+        swappeddatasize.value = connection->getSwappedQueueDataSize();
+
+        parent.children.push_back(swapped);
+        parent.children.push_back(swappeddatasize);
+      }
+
       serialized.push_back(parent);
     }
     return serialized;
   }
 
+  std::vector<PublishedMetric> calculateMetrics() override {
+    std::vector<PublishedMetric> metrics;
+    for (const auto& [name, connection] : connections) {
+      const std::map<std::string, std::string> labels{{"connection_uuid", connection->getUUIDStr()}, {"connection_name", name}};
+      metrics.push_back({"connection_queued_bytes", static_cast<double>(connection->getQueueDataSize()), labels});
+      metrics.push_back({"connection_max_queued_bytes", static_cast<double>(connection->getMaxQueueDataSize()), labels});
+      metrics.push_back({"connection_queued_flow_files", static_cast<double>(connection->getQueueSize()), labels});
+      metrics.push_back({"connection_max_queued_flow_files", static_cast<double>(connection->getMaxQueueSize()), labels});
+      if (connection->getSwapThreshold() > 0) {
+        metrics.push_back({"connection_swapped_flow_files", static_cast<double>(connection->getSwappedQueueSize()), labels});
+        metrics.push_back({"connection_swapped_bytes", static_cast<double>(connection->getSwappedQueueDataSize()), labels});
+      }
+    }
+    return metrics;
+  }
+
  protected:
   std::map<std::string, std::shared_ptr<minifi::Connection>> connections;
 };
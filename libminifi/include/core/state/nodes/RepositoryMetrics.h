@@ -18,6 +18,7 @@
 #ifndef LIBMINIFI_INCLUDE_CORE_STATE_NODES_REPOSITORYMETRICS_H_
 #define LIBMINIFI_INCLUDE_CORE_STATE_NODES_REPOSITORYMETRICS_H_
 
+#include <chrono>
 #include <memory>
 #include <string>
 #include <utility>
@@ -85,11 +86,81 @@ class RepositoryMetrics : public ResponseNode {
       parent.children.push_back(datasizemax);
       parent.children.push_back(queuesize);
 
+      if (auto delete_metrics = repo->getDeleteMetrics()) {
+        SerializedResponseNode delete_backlog;
+        delete_backlog.name = "deleteBacklog";
+        delete_backlog.value = delete_metrics->backlog;
+
+        SerializedResponseNode delete_latency;
+        delete_latency.name = "deleteLatencyMicros";
+        delete_latency.value = static_cast<uint64_t>(delete_metrics->last_batch_latency.count());
+
+        parent.children.push_back(delete_backlog);
+        parent.children.push_back(delete_latency);
+      }
+
+      const auto add_child = [&parent](const char* name, uint64_t value) {
+        SerializedResponseNode child;
+        child.name = name;
+        child.value = value;
+        parent.children.push_back(child);
+      };
+
+      if (auto write_metrics = repo->getWriteMetrics()) {
+        add_child("writeBacklog", write_metrics->backlog);
+        add_child("writeQueueCapacity", write_metrics->capacity);
+        add_child("writeDropped", write_metrics->dropped);
+        add_child("writeBlocked", write_metrics->blocked);
+        add_child("writeBatchSize", write_metrics->last_batch_size);
+        add_child("writeLatencyMicros", static_cast<uint64_t>(write_metrics->last_batch_latency.count()));
+      }
+
+      if (auto storage_metrics = repo->getStorageMetrics()) {
+        add_child("estimatedKeyCount", storage_metrics->estimated_key_count);
+        add_child("tableReadersMemory", storage_metrics->table_readers_memory);
+        add_child("memTablesMemory", storage_metrics->memtables_memory);
+      }
+
       serialized.push_back(parent);
     }
     return serialized;
   }
 
+  std::vector<PublishedMetric> calculateMetrics() override {
+    const auto to_seconds = [](std::chrono::microseconds duration) {
+      return std::chrono::duration<double>(duration).count();
+    };
+
+    std::vector<PublishedMetric> metrics;
+    for (const auto& [name, repo] : repositories) {
+      const std::map<std::string, std::string> labels{{"repository_name", name}};
+      metrics.push_back({"repository_running", repo->isRunning() ? 1.0 : 0.0, labels});
+      metrics.push_back({"repository_full", repo->isFull() ? 1.0 : 0.0, labels});
+      metrics.push_back({"repository_size_bytes", static_cast<double>(repo->getRepoSize()), labels});
+
+      if (auto delete_metrics = repo->getDeleteMetrics()) {
+        metrics.push_back({"repository_delete_backlog", static_cast<double>(delete_metrics->backlog), labels});
+        metrics.push_back({"repository_delete_latency_seconds", to_seconds(delete_metrics->last_batch_latency), labels});
+      }
+
+      if (auto write_metrics = repo->getWriteMetrics()) {
+        metrics.push_back({"repository_write_backlog", static_cast<double>(write_metrics->backlog), labels});
+        metrics.push_back({"repository_write_queue_capacity", static_cast<double>(write_metrics->capacity), labels});
+        metrics.push_back({"repository_write_dropped", static_cast<double>(write_metrics->dropped), labels, PublishedMetric::Type::COUNTER});
+        metrics.push_back({"repository_write_blocked", static_cast<double>(write_metrics->blocked), labels, PublishedMetric::Type::COUNTER});
+        metrics.push_back({"repository_write_batch_size", static_cast<double>(write_metrics->last_batch_size), labels});
+        metrics.push_back({"repository_write_latency_seconds", to_seconds(write_metrics->last_batch_latency), labels});
+      }
+
+      if (auto storage_metrics = repo->getStorageMetrics()) {
+        metrics.push_back({"repository_estimated_keys", static_cast<double>(storage_metrics->estimated_key_count), labels});
+        metrics.push_back({"repository_table_readers_bytes", static_cast<double>(storage_metrics->table_readers_memory), labels});
+        metrics.push_back({"repository_memtables_bytes", static_cast<double>(storage_metrics->memtables_memory), labels});
+      }
+    }
+    return metrics;
+  }
+
  protected:
   std::map<std::string, std::shared_ptr<core::Repository>> repositories;
 };
@@ -51,6 +51,7 @@ class YamlConnectionParser {
   [[nodiscard]] utils::Identifier getDestinationUUIDFromYaml() const;
   [[nodiscard]] std::chrono::milliseconds getFlowFileExpirationFromYaml() const;
   [[nodiscard]] bool getDropEmptyFromYaml() const;
+  [[nodiscard]] bool getLockFreeQueueFromYaml() const;
 
  private:
   void addNewRelationshipToConnection(const std::string& relationship_name, const std::shared_ptr<minifi::Connection>& connection) const;
@@ -50,6 +50,10 @@ class Configuration : public Properties {
   static constexpr const char *nifi_configuration_class_name = "nifi.flow.configuration.class.name";
   static constexpr const char *nifi_flow_repository_class_name = "nifi.flowfile.repository.class.name";
   static constexpr const char *nifi_content_repository_class_name = "nifi.content.repository.class.name";
+  static constexpr const char *nifi_content_repository_session_spill_threshold = "nifi.content.repository.session.spill.threshold";
+  static constexpr const char *nifi_content_repository_container_max_size = "nifi.content.repository.container.max.size";
+  static constexpr const char *nifi_queue_swap_threshold = "nifi.queue.swap.threshold";
+  static constexpr const char *nifi_queue_swap_directory = "nifi.queue.swap.directory";
   static constexpr const char *nifi_volatile_repository_options = "nifi.volatile.repository.options.";
   static constexpr const char *nifi_provenance_repository_class_name = "nifi.provenance.repository.class.name";
   static constexpr const char *nifi_server_port = "nifi.server.port";
@@ -57,6 +61,8 @@ class Configuration : public Properties {
   static constexpr const char *nifi_provenance_repository_max_storage_size = "nifi.provenance.repository.max.storage.size";
   static constexpr const char *nifi_provenance_repository_max_storage_time = "nifi.provenance.repository.max.storage.time";
   static constexpr const char *nifi_provenance_repository_directory_default = "nifi.provenance.repository.directory.default";
+  static constexpr const char *nifi_provenance_repository_write_queue_size = "nifi.provenance.repository.write.queue.size";
+  static constexpr const char *nifi_provenance_repository_write_queue_full_policy = "nifi.provenance.repository.write.queue.full.policy";
   static constexpr const char *nifi_flowfile_repository_max_storage_size = "nifi.flowfile.repository.max.storage.size";
   static constexpr const char *nifi_flowfile_repository_max_storage_time = "nifi.flowfile.repository.max.storage.time";
   static constexpr const char *nifi_flowfile_repository_directory_default = "nifi.flowfile.repository.directory.default";
@@ -99,6 +105,12 @@ class Configuration : public Properties {
   static constexpr const char *minifi_disk_space_watchdog_interval = "minifi.disk.space.watchdog.interval";
   static constexpr const char *minifi_disk_space_watchdog_stop_threshold = "minifi.disk.space.watchdog.stop.threshold";
   static constexpr const char *minifi_disk_space_watchdog_restart_threshold = "minifi.disk.space.watchdog.restart.threshold";
+
+  // metrics publisher options
+  static constexpr const char *nifi_metrics_publisher_class = "nifi.metrics.publisher.class";
+  static constexpr const char *nifi_metrics_publisher_port = "nifi.metrics.publisher.port";
+  static constexpr const char *nifi_metrics_publisher_metrics = "nifi.metrics.publisher.metrics";
+  static constexpr const char *nifi_metrics_publisher_refresh_interval = "nifi.metrics.publisher.refresh.interval";
 };
 
 }  // namespace minifi
@@ -203,6 +203,10 @@ class ProvenanceEventRecord : public core::SerializableComponent {
   std::chrono::system_clock::time_point getEventTime() {
     return _eventTime;
   }
+  // Set Event Time
+  void setEventTime(std::chrono::system_clock::time_point event_time) {
+    _eventTime = event_time;
+  }
   // ! Get Event Duration
   std::chrono::milliseconds getEventDuration() {
     return _eventDuration;
@@ -0,0 +1,68 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "utils/Id.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace provenance {
+
+class ProvenanceEventRecord;
+
+/**
+ * Selects provenance events: an event is part of the result if it matches all of the criteria which are set.
+ */
+struct ProvenanceQuery {
+  static constexpr size_t DEFAULT_MAX_RESULTS = 1000;
+
+  // the events of this FlowFile, including the FORK, CLONE or JOIN events it was created by or took part in
+  std::optional<utils::Identifier> flow_file_uuid;
+  // only together with flow_file_uuid: also the events of the FlowFiles it was derived from and of the ones derived from it
+  bool include_lineage = false;
+  // the events emitted by this component
+  std::optional<std::string> component_id;
+  // the events which happened in this time range, both ends included
+  std::chrono::system_clock::time_point begin{};
+  std::chrono::system_clock::time_point end = std::chrono::system_clock::time_point::max();
+  // at most this many events are returned, the most recent ones first
+  size_t max_results = DEFAULT_MAX_RESULTS;
+
+  /**
+   * Creates a query from the arguments of a C2 or controller socket request:
+   *   flowFileUuid, lineage (true/false), componentId, startTime and endTime (milliseconds since the epoch), maxResults
+   * @return the query, or std::nullopt if one of the arguments is invalid
+   */
+  static std::optional<ProvenanceQuery> parse(const std::map<std::string, std::string>& arguments);
+};
+
+using ProvenanceQueryResult = std::vector<std::shared_ptr<ProvenanceEventRecord>>;
+
+}  // namespace provenance
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
@@ -0,0 +1,90 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "concurrentqueue.h"
+#include "core/FlowFile.h"
+#include "utils/FlowFileQueue.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace utils {
+
+/**
+ * Thread-safe FlowFile queue for connections with many producers and consumers.
+ * Non-penalized flow files are handed over through a bounded lock-free queue. Those not fitting
+ * into it wait in a locked FIFO overflow and refill it as it is drained, the penalized ones are
+ * kept in a FlowFileQueue ordered by their penalty expiration. The locked queues are only
+ * locked when they are not empty.
+ */
+class ConcurrentFlowFileQueue {
+ public:
+  using value_type = std::shared_ptr<core::FlowFile>;
+
+  explicit ConcurrentFlowFileQueue(size_t capacity);
+
+  void push(value_type element);
+
+  /**
+   * @return the next flow file that is not penalized, or nullptr if there is none
+   */
+  value_type tryPop();
+
+  /**
+   * Removes every flow file, including the penalized ones.
+   */
+  std::vector<value_type> popAll();
+
+  bool isWorkAvailable() const;
+  bool empty() const;
+  size_t size() const;
+
+  size_t capacity() const {
+    return capacity_;
+  }
+
+ private:
+  // requires penalized_mutex_
+  void refillFromOverflow();
+
+  const size_t capacity_;
+  moodycamel::ConcurrentQueue<value_type> queue_;
+  // number of flow files in queue_, reserved before enqueueing to keep it bounded
+  std::atomic<size_t> queue_size_{0};
+
+  // guards both the overflow and the penalized queue
+  mutable std::mutex penalized_mutex_;
+  // flow files pushed while queue_ was full, newer than the ones in queue_
+  std::deque<value_type> overflow_queue_;
+  std::atomic<size_t> overflow_queue_size_{0};
+  FlowFileQueue penalized_queue_;
+  std::atomic<size_t> penalized_queue_size_{0};
+};
+
+}  // namespace utils
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
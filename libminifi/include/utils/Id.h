@@ -86,6 +86,10 @@ class Identifier {
 
   static std::optional<Identifier> parse(const std::string& str);
 
+  const Data& getData() const {
+    return data_;
+  }
+
  private:
   static bool parseByte(Data& data, const uint8_t* input, int& charIdx, int& byteIdx);
 
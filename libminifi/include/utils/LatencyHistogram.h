@@ -0,0 +1,104 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace utils {
+
+/**
+ * Lock-free histogram of durations with microsecond resolution.
+ *
+ * Like an HDR histogram, each power of two range of durations is split into the same number of buckets,
+ * so the durations are recorded with a bounded relative error (1/8) instead of a bounded absolute one,
+ * using a fixed amount of memory. Durations above MAX_DURATION are recorded in the last bucket.
+ * Recording is wait-free, it can be done from any number of threads.
+ */
+class LatencyHistogram {
+  static constexpr unsigned SUB_BUCKET_BITS = 3;
+  static constexpr uint64_t SUB_BUCKET_COUNT = uint64_t{1} << SUB_BUCKET_BITS;
+  static constexpr unsigned MAX_EXPONENT = 36;
+
+ public:
+  // about 19 hours
+  static constexpr std::chrono::microseconds MAX_DURATION{(uint64_t{1} << MAX_EXPONENT) - 1};
+  static constexpr size_t BUCKET_COUNT = (MAX_EXPONENT - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT;
+
+  class Snapshot {
+   public:
+    uint64_t getCount() const {
+      return count_;
+    }
+
+    std::chrono::microseconds getSum() const {
+      return std::chrono::microseconds{sum_};
+    }
+
+    std::chrono::microseconds getMax() const {
+      return std::chrono::microseconds{max_};
+    }
+
+    /**
+     * @param quantile between 0 and 1
+     * @return the upper limit of the bucket containing the duration at the quantile, 0 if nothing was recorded
+     */
+    std::chrono::microseconds getQuantile(double quantile) const;
+
+    /**
+     * @return the number of durations not longer than the limit, exact if the limit is the upper limit of a bucket
+     */
+    uint64_t getCountNotAbove(std::chrono::microseconds limit) const;
+
+   private:
+    friend class LatencyHistogram;
+
+    std::array<uint64_t, BUCKET_COUNT> buckets_{};
+    uint64_t count_ = 0;
+    uint64_t sum_ = 0;
+    uint64_t max_ = 0;
+  };
+
+  void record(std::chrono::microseconds duration);
+
+  /**
+   * The buckets are read one at a time, the durations recorded meanwhile may or may not be part of the snapshot.
+   */
+  Snapshot getSnapshot() const;
+
+  static size_t getBucketIndex(uint64_t micros);
+  static uint64_t getBucketUpperLimit(size_t index);
+
+ private:
+  std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets_{};
+  std::atomic<uint64_t> sum_{0};
+  std::atomic<uint64_t> max_{0};
+};
+
+}  // namespace utils
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
@@ -48,6 +48,13 @@ class AfterExecute {
    * @return milliseconds since epoch after which we are eligible to re-run this task.
    */
   virtual std::chrono::milliseconds wait_time() = 0;
+  /**
+   * Whether the task may be re-run before its wait time elapses when it gets notified,
+   * see ThreadPool::notifyTasks.
+   */
+  virtual bool isNotifiable() {
+    return false;
+  }
 };
 
 /**
@@ -106,11 +113,12 @@ class SingleRunMonitor : public utils::AfterExecute<bool>{
 
 
 struct TaskRescheduleInfo {
-  TaskRescheduleInfo(bool result, std::chrono::milliseconds wait_time)
-    : wait_time_(wait_time), finished_(result) {}
+  TaskRescheduleInfo(bool result, std::chrono::milliseconds wait_time, bool notifiable = false)
+    : wait_time_(wait_time), finished_(result), notifiable_(notifiable) {}
 
   std::chrono::milliseconds wait_time_;
   bool finished_;
+  bool notifiable_;
 
   static TaskRescheduleInfo Done() {
     return TaskRescheduleInfo(true, std::chrono::milliseconds(0));
@@ -124,11 +132,19 @@ struct TaskRescheduleInfo {
     return TaskRescheduleInfo(false, std::chrono::milliseconds(0));
   }
 
+  /**
+   * Retry when the task gets notified (e.g. new data arrived for the processor),
+   * but no later than the given interval.
+   */
+  static TaskRescheduleInfo RetryOnNotificationOrIn(std::chrono::milliseconds interval) {
+    return TaskRescheduleInfo(false, interval, true);
+  }
+
 #if defined(WIN32)
 // https://developercommunity.visualstudio.com/content/problem/60897/c-shared-state-futuresstate-default-constructs-the.html
 // Because of this bug we need to have this object default constructible, which makes no sense otherwise. Hack.
  private:
-  TaskRescheduleInfo() : wait_time_(std::chrono::milliseconds(0)), finished_(true) {}
+  TaskRescheduleInfo() : wait_time_(std::chrono::milliseconds(0)), finished_(true), notifiable_(false) {}
   friend class std::_Associated_state<TaskRescheduleInfo>;
 #endif
 };
@@ -142,6 +158,7 @@ class ComplexMonitor : public utils::AfterExecute<TaskRescheduleInfo> {
       return true;
     }
     current_wait_.store(result.wait_time_);
+    current_notifiable_.store(result.notifiable_);
     return false;
   }
   bool isCancelled(const TaskRescheduleInfo& /*result*/) override {
@@ -155,8 +172,13 @@ class ComplexMonitor : public utils::AfterExecute<TaskRescheduleInfo> {
     return current_wait_.load();
   }
 
+  bool isNotifiable() override {
+    return current_notifiable_.load();
+  }
+
  private:
   std::atomic<std::chrono::milliseconds> current_wait_ {std::chrono::milliseconds(0)};
+  std::atomic<bool> current_notifiable_{false};
 };
 
 }  // namespace utils
@@ -26,17 +26,22 @@
 #include <iostream>
 #include <atomic>
 #include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
 #include <map>
 #include <unordered_map>
 #include <vector>
+#include <deque>
 #include <queue>
 #include <future>
 #include <thread>
 #include <functional>
+#include <optional>
 
 #include "BackTrace.h"
 #include "MinifiConcurrentQueue.h"
 #include "Monitors.h"
+#include "TimerWheel.h"
 #include "core/expect.h"
 #include "controllers/ThreadManagementService.h"
 #include "core/controller/ControllerService.h"
@@ -114,6 +119,17 @@ class Worker {
     return run_determinant_->wait_time();
   }
 
+  /**
+   * Whether the task may be run before its next execution time when it gets notified.
+   */
+  virtual bool isNotifiable() const {
+    return run_determinant_ != nullptr && run_determinant_->isNotifiable();
+  }
+
+  void setNextExecutionTime(std::chrono::steady_clock::time_point next_exec_time) {
+    next_exec_time_ = next_exec_time;
+  }
+
 
   std::shared_ptr<std::promise<T>> getPromise() const;
 
@@ -129,14 +145,6 @@ class Worker {
   std::shared_ptr<std::promise<T>> promise;
 };
 
-template<typename T>
-class DelayedTaskComparator {
- public:
-  bool operator()(Worker<T> &a, Worker<T> &b) {
-    return a.getNextExecutionTime() > b.getNextExecutionTime();
-  }
-};
-
 template<typename T>
 std::shared_ptr<std::promise<T>> Worker<T>::getPromise() const {
   return promise;
@@ -156,13 +164,18 @@ class WorkerThread {
   std::atomic<bool> is_running_;
   std::thread thread_;
   std::string name_;
+  // the run queue this thread takes its tasks from before stealing from the others
+  size_t run_queue_index_ = 0;
 };
 
 /**
  * Thread pool
  * Purpose: Provides a thread pool with basic functionality similar to
  * ThreadPoolExecutor
- * Design: Locked control over a manager thread that controls the worker threads
+ * Design: Locked control over a manager thread that controls the worker threads.
+ * Every worker thread has its own run queue, tasks rescheduled by a worker stay on
+ * its queue while idle workers steal from the others. Delayed tasks wait in a timer
+ * wheel until they are handed over to the run queues.
  */
 template<typename T>
 class ThreadPool {
@@ -179,6 +192,7 @@ class ThreadPool {
     current_workers_ = 0;
     task_count_ = 0;
     thread_manager_ = nullptr;
+    createRunQueues();
   }
 
   ThreadPool(const ThreadPool<T> &other) = delete;
@@ -207,6 +221,13 @@ class ThreadPool {
    */
   void stopTasks(const TaskId &identifier);
 
+  /**
+   * Runs the delayed notifiable tasks with the provided identifier as soon as a worker
+   * is available. Tasks being run at the moment will be rescheduled right away
+   * instead of being delayed.
+   */
+  void notifyTasks(const TaskId &identifier);
+
   /**
    * resumes work queue processing.
    */
@@ -221,11 +242,11 @@ class ThreadPool {
    * Returns true if a task is running.
    */
   bool isTaskRunning(const TaskId &identifier) {
-    std::unique_lock<std::mutex> lock(worker_queue_mutex_);
+    std::shared_lock<std::shared_mutex> lock(task_status_mutex_);
     const auto iter = task_status_.find(identifier);
     if (iter == task_status_.end())
       return false;
-    return iter->second;
+    return iter->second->running.load();
   }
 
   bool isRunning() const {
@@ -235,7 +256,7 @@ class ThreadPool {
   std::vector<BackTrace> getTraces() {
     std::vector<BackTrace> traces;
     std::lock_guard<std::recursive_mutex> lock(manager_mutex_);
-    std::unique_lock<std::mutex> wlock(worker_queue_mutex_);
+    std::unique_lock<std::mutex> wlock(thread_queue_mutex_);
     // while we may be checking if running, we don't want to
     // use the threads outside of the manager mutex's lock -- therefore we will
     // obtain a lock so we can keep the threads in memory
@@ -269,6 +290,7 @@ class ThreadPool {
       shutdown();
     }
     max_worker_threads_ = max;
+    createRunQueues();
     if (was_running)
       start();
   }
@@ -295,14 +317,37 @@ class ThreadPool {
    * Drain will notify tasks to stop following notification
    */
   void drain() {
-    worker_queue_.stop();
+    {
+      std::lock_guard<std::mutex> lock(idle_workers_mutex_);
+      work_available_.notify_all();
+    }
     while (current_workers_ > 0) {
       // The sleeping workers were waken up and stopped, but we have to wait
-      // the ones that actually worked on something when the queue was stopped.
-      // Stopping the queue guarantees that they don't get any new task.
+      // the ones that actually worked on something when the pool was stopped.
       std::this_thread::sleep_for(std::chrono::milliseconds(1));
     }
   }
+
+  /**
+   * Scheduling state shared by the tasks of an identifier, checked without locking.
+   */
+  struct TaskStatus {
+    std::atomic<bool> running{true};
+    // notified while none of the tasks were waiting in the timer wheel
+    std::atomic<bool> notified{false};
+    std::atomic<int> delayed_notifiable_tasks{0};
+  };
+
+  struct ScheduledTask {
+    Worker<T> worker;
+    std::shared_ptr<TaskStatus> status;
+  };
+
+  struct RunQueue {
+    std::mutex mutex;
+    std::deque<ScheduledTask> tasks;
+  };
+
 // determines if threads are detached
   bool daemon_threads_;
   std::atomic<int> thread_reduction_count_;
@@ -327,15 +372,30 @@ class ThreadPool {
   std::shared_ptr<controllers::ThreadManagementService> thread_manager_;
   // thread queue for the recently deceased threads.
   ConcurrentQueue<std::shared_ptr<WorkerThread>> deceased_thread_queue_;
-// worker queue of worker objects
-  ConditionConcurrentQueue<Worker<T>> worker_queue_;
-  std::priority_queue<Worker<T>, std::vector<Worker<T>>, DelayedTaskComparator<T>> delayed_worker_queue_;
-// mutex to  protect task status and delayed queue
-  std::mutex worker_queue_mutex_;
+// run queues of the worker threads, indexed by WorkerThread::run_queue_index_
+  std::vector<std::unique_ptr<RunQueue>> run_queues_;
+// guards the set of run queues against setMaxConcurrentTasks, each queue has its own mutex for its tasks
+  std::shared_mutex run_queues_mutex_;
+// round robin counter for the tasks not submitted by a worker
+  std::atomic<size_t> next_run_queue_{0};
+// number of tasks in all of the run queues
+  std::atomic<int> queued_task_count_{0};
+  std::atomic<int> idle_workers_{0};
+  std::atomic<bool> paused_{false};
+  std::mutex idle_workers_mutex_;
+  std::condition_variable work_available_;
+// delayed tasks waiting for their next execution time
+  TimerWheel<ScheduledTask> delayed_tasks_;
+  std::chrono::steady_clock::time_point delayed_scheduler_wakeup_;
+// mutex to protect the delayed tasks
+  std::mutex delayed_tasks_mutex_;
 // notification for new delayed tasks that's before the current ones
   std::condition_variable delayed_task_available_;
-// map to identify if a task should be
-  std::map<TaskId, bool> task_status_;
+// status of the tasks per identifier, the tasks hold on to their status so the map is only used on execute/stop
+  std::unordered_map<TaskId, std::shared_ptr<TaskStatus>> task_status_;
+  std::shared_mutex task_status_mutex_;
+// mutex to protect the thread queue
+  std::mutex thread_queue_mutex_;
 // manager mutex
   std::recursive_mutex manager_mutex_;
   // thread pool name
@@ -352,6 +412,29 @@ class ThreadPool {
   void run_tasks(std::shared_ptr<WorkerThread> thread);
 
   void manage_delayed_queue();
+
+  void createRunQueues();
+
+  // taken modulo the number of run queues by pushTask
+  size_t nextRunQueue() {
+    return next_run_queue_++;
+  }
+
+  void pushTask(ScheduledTask &&task, size_t run_queue);
+
+  /**
+   * Takes a task from the given run queue, or steals one from the others if it is empty.
+   */
+  std::optional<ScheduledTask> takeTask(size_t run_queue);
+
+  void waitForWork();
+
+  void reschedule(ScheduledTask &&task, size_t run_queue);
+
+  // these must be called with delayed_tasks_mutex_ held
+  void pushDelayedTask(ScheduledTask &&task);
+  void dispatchDelayedTask(ScheduledTask &&task);
+  void runNotifiedTasks(TaskStatus &status);
 };
 
 }  // namespace utils
@@ -0,0 +1,230 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace utils {
+
+/**
+ * Purpose: Hashed timing wheel holding items until their deadline elapses.
+ * Insertion is O(1), expiring the due items only visits the slots of the ticks
+ * elapsed since the last call. Items further away than a full revolution wait
+ * in their slot until the wheel comes around again.
+ * A bitmap of the occupied slots lets every lookup skip the empty slots a word at a time.
+ *
+ * Not thread-safe, the callbacks must not modify the wheel.
+ */
+template<typename T>
+class TimerWheel {
+ public:
+  using clock = std::chrono::steady_clock;
+  using time_point = clock::time_point;
+
+  explicit TimerWheel(std::chrono::milliseconds resolution = std::chrono::milliseconds(1), size_t slot_count = 1024)
+      : resolution_(resolution),
+        slots_(std::max<size_t>(slot_count, 1)),
+        occupied_((slots_.size() + BITS_PER_WORD - 1) / BITS_PER_WORD),
+        current_tick_(toTick(clock::now())) {
+  }
+
+  /**
+   * Adds an item, deadlines in the past are due on the next call to advance.
+   */
+  void insert(time_point deadline, T item) {
+    const auto tick = std::max(toTick(deadline), current_tick_);
+    const size_t index = tick % slots_.size();
+    slots_[index].push_back(Entry{deadline, std::move(item)});
+    occupied_[index / BITS_PER_WORD] |= uint64_t{1} << (index % BITS_PER_WORD);
+    ++size_;
+  }
+
+  /**
+   * Removes the items whose deadline is not later than now, handing them over to on_expired.
+   * @return the number of expired items
+   */
+  template<typename Callback>
+  size_t advance(time_point now, Callback&& on_expired) {
+    const auto now_tick = toTick(now);
+    size_t expired = 0;
+    if (size_ > 0) {
+      const auto last_tick = std::min(std::max(now_tick, current_tick_), current_tick_ + slots_.size() - 1);
+      visitOccupiedTicks(current_tick_, last_tick, [&](uint64_t tick) {
+        expired += removeFromSlot(tick % slots_.size(), [&now](const Entry& entry) { return entry.deadline <= now; }, on_expired);
+        return size_ > 0;
+      });
+    }
+    current_tick_ = std::max(current_tick_, now_tick);
+    return expired;
+  }
+
+  /**
+   * Removes the items matching the predicate regardless of their deadline, handing them over to on_removed.
+   * @return the number of removed items
+   */
+  template<typename Predicate, typename Callback>
+  size_t removeIf(Predicate&& predicate, Callback&& on_removed) {
+    size_t removed = 0;
+    if (size_ > 0) {
+      visitOccupiedTicks(current_tick_, current_tick_ + slots_.size() - 1, [&](uint64_t tick) {
+        removed += removeFromSlot(tick % slots_.size(), [&predicate](const Entry& entry) { return predicate(entry.item); }, on_removed);
+        return size_ > 0;
+      });
+    }
+    return removed;
+  }
+
+  /**
+   * The earliest time an item may become due, std::nullopt if the wheel is empty.
+   * When no item is due within a revolution, the end of the revolution is returned.
+   */
+  std::optional<time_point> nextExpiration() const {
+    if (size_ == 0) {
+      return std::nullopt;
+    }
+    std::optional<time_point> earliest;
+    visitOccupiedTicks(current_tick_, current_tick_ + slots_.size() - 1, [&](uint64_t tick) {
+      for (const auto& entry : slots_[tick % slots_.size()]) {
+        if (std::max(toTick(entry.deadline), current_tick_) == tick && (!earliest || entry.deadline < *earliest)) {
+          earliest = entry.deadline;
+        }
+      }
+      return !earliest;
+    });
+    if (earliest) {
+      return earliest;
+    }
+    return fromTick(current_tick_ + slots_.size());
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  bool empty() const {
+    return size_ == 0;
+  }
+
+  void clear() {
+    for (auto& slot : slots_) {
+      slot.clear();
+    }
+    std::fill(occupied_.begin(), occupied_.end(), 0);
+    size_ = 0;
+  }
+
+ private:
+  static constexpr size_t BITS_PER_WORD = 64;
+
+  struct Entry {
+    time_point deadline;
+    T item;
+  };
+
+  // the index of the first occupied slot not before index, or the slot count if the slots are empty up to the end of the wheel
+  size_t findOccupiedSlot(size_t index) const {
+    size_t word = index / BITS_PER_WORD;
+    uint64_t bits = occupied_[word] >> (index % BITS_PER_WORD);
+    while (bits == 0) {
+      if (++word == occupied_.size()) {
+        return slots_.size();
+      }
+      index = word * BITS_PER_WORD;
+      bits = occupied_[word];
+    }
+    for (; (bits & 1) == 0; bits >>= 1) {
+      ++index;
+    }
+    return index;
+  }
+
+  // calls visit with the ticks between first and last (less than a revolution apart) whose slot has items, while it returns true
+  template<typename Visitor>
+  void visitOccupiedTicks(uint64_t first, uint64_t last, Visitor&& visit) const {
+    for (uint64_t tick = first; tick <= last;) {
+      const size_t index = tick % slots_.size();
+      const size_t occupied_index = findOccupiedSlot(index);
+      tick += occupied_index - index;
+      if (occupied_index == slots_.size()) {
+        // continue from the beginning of the wheel
+        continue;
+      }
+      if (tick > last || !visit(tick)) {
+        return;
+      }
+      ++tick;
+    }
+  }
+
+  template<typename Predicate, typename Callback>
+  size_t removeFromSlot(size_t index, Predicate&& predicate, Callback&& callback) {
+    auto& slot = slots_[index];
+    if (slot.empty()) {
+      return 0;
+    }
+    size_t removed = 0;
+    for (size_t i = 0; i < slot.size();) {
+      if (predicate(slot[i])) {
+        T item = std::move(slot[i].item);
+        if (i != slot.size() - 1) {
+          slot[i] = std::move(slot.back());
+        }
+        slot.pop_back();
+        --size_;
+        ++removed;
+        callback(std::move(item));
+      } else {
+        ++i;
+      }
+    }
+    if (slot.empty()) {
+      occupied_[index / BITS_PER_WORD] &= ~(uint64_t{1} << (index % BITS_PER_WORD));
+    }
+    return removed;
+  }
+
+  uint64_t toTick(time_point time) const {
+    return static_cast<uint64_t>(std::max(time.time_since_epoch() / resolution_, decltype(time.time_since_epoch() / resolution_){0}));
+  }
+
+  time_point fromTick(uint64_t tick) const {
+    return time_point(std::chrono::duration_cast<clock::duration>(resolution_ * static_cast<int64_t>(tick)));
+  }
+
+  std::chrono::milliseconds resolution_;
+  std::vector<std::vector<Entry>> slots_;
+  // one bit per slot, set if the slot has items
+  std::vector<uint64_t> occupied_;
+  uint64_t current_tick_;
+  size_t size_ = 0;
+};
+
+}  // namespace utils
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
@@ -0,0 +1,120 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "core/logging/Logger.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace utils {
+namespace file {
+
+/**
+ * Collects the changes of the entries in a set of watched directories, using inotify on Linux.
+ *
+ * On other platforms (or if the watch could not be set up) the watcher is not available, and poll()
+ * always reports that the changes are unknown, so callers fall back to checking every file.
+ * A directory watched under several names (e.g. through a symlink) reports its changes under each of them.
+ */
+class FileWatcher {
+ public:
+  enum class ChangeType {
+    MODIFIED,  // content was written or truncated
+    CREATED,   // created in, or moved into the directory
+    REMOVED    // deleted from, or moved out of the directory
+  };
+
+  struct Change {
+    std::string directory;
+    std::string file_name;
+    ChangeType type;
+    bool is_directory;
+  };
+
+  FileWatcher();
+  ~FileWatcher();
+
+  FileWatcher(const FileWatcher&) = delete;
+  FileWatcher& operator=(const FileWatcher&) = delete;
+
+  bool isAvailable() const {
+    return fd_ >= 0;
+  }
+
+  /**
+   * Starts watching the entries of the directory (not recursively). Watching a directory again has no effect.
+   * @return false if the directory cannot be watched
+   */
+  bool watch(const std::string& directory);
+
+  void unwatch(const std::string& directory);
+
+  /**
+   * Drains the changes collected since the last call without blocking.
+   * @return false if some changes may have been missed (e.g. the kernel queue overflowed, or the watcher
+   * is not available); the caller has to assume that anything in the watched directories may have changed
+   */
+  bool poll(const std::function<void(const Change&)>& on_change);
+
+  /**
+   * @return true if there are changes which have not been drained by poll() yet
+   */
+  bool hasPendingChanges() const;
+
+  /**
+   * Starts a background thread which calls on_changes when changes arrive, so that the caller does not have to
+   * poll periodically. It is called at most once between two calls of poll(). Can only be called once.
+   */
+  void notifyOnChanges(std::function<void()> on_changes);
+
+ private:
+  void runNotifications();
+
+  int fd_ = -1;
+  // the same directory under different names gets the same watch descriptor
+  std::unordered_map<int, std::vector<std::string>> directories_by_watch_;
+  std::unordered_map<std::string, int> watches_by_directory_;
+  std::vector<char> buffer_;
+
+  std::function<void()> on_changes_;
+  std::thread notification_thread_;
+  int stop_fd_ = -1;  // wakes up the notification thread on destruction
+  std::mutex notification_mutex_;
+  std::condition_variable notification_condition_;
+  bool notified_ = false;  // guarded by notification_mutex_, reset by poll()
+  bool stopping_ = false;  // guarded by notification_mutex_
+  std::shared_ptr<core::logging::Logger> logger_;
+};
+
+}  // namespace file
+}  // namespace utils
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
@@ -38,6 +38,10 @@ constexpr const char *Configuration::nifi_server_name;
 constexpr const char *Configuration::nifi_configuration_class_name;
 constexpr const char *Configuration::nifi_flow_repository_class_name;
 constexpr const char *Configuration::nifi_content_repository_class_name;
+constexpr const char *Configuration::nifi_content_repository_session_spill_threshold;
+constexpr const char *Configuration::nifi_content_repository_container_max_size;
+constexpr const char *Configuration::nifi_queue_swap_threshold;
+constexpr const char *Configuration::nifi_queue_swap_directory;
 constexpr const char *Configuration::nifi_volatile_repository_options;
 constexpr const char *Configuration::nifi_provenance_repository_class_name;
 constexpr const char *Configuration::nifi_server_port;
@@ -45,6 +49,8 @@ constexpr const char *Configuration::nifi_server_report_interval;
 constexpr const char *Configuration::nifi_provenance_repository_max_storage_size;
 constexpr const char *Configuration::nifi_provenance_repository_max_storage_time;
 constexpr const char *Configuration::nifi_provenance_repository_directory_default;
+constexpr const char *Configuration::nifi_provenance_repository_write_queue_size;
+constexpr const char *Configuration::nifi_provenance_repository_write_queue_full_policy;
 constexpr const char *Configuration::nifi_flowfile_repository_max_storage_size;
 constexpr const char *Configuration::nifi_flowfile_repository_max_storage_time;
 constexpr const char *Configuration::nifi_flowfile_repository_directory_default;
@@ -76,6 +82,10 @@ constexpr const char *Configuration::minifi_disk_space_watchdog_enable;
 constexpr const char *Configuration::minifi_disk_space_watchdog_interval;
 constexpr const char *Configuration::minifi_disk_space_watchdog_stop_threshold;
 constexpr const char *Configuration::minifi_disk_space_watchdog_restart_threshold;
+constexpr const char *Configuration::nifi_metrics_publisher_class;
+constexpr const char *Configuration::nifi_metrics_publisher_port;
+constexpr const char *Configuration::nifi_metrics_publisher_metrics;
+constexpr const char *Configuration::nifi_metrics_publisher_refresh_interval;
 
 } /* namespace minifi */
 } /* namespace nifi */
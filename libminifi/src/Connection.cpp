@@ -31,7 +31,9 @@
 #include <list>
 #include "core/FlowFile.h"
 #include "core/Processor.h"
+#include "FlowFileSwapManager.h"
 #include "core/logging/LoggerConfiguration.h"
+#include "utils/gsl.h"
 
 using namespace std::literals::chrono_literals;
 
@@ -74,20 +76,144 @@ Connection::Connection(const std::shared_ptr<core::Repository> &flow_repository,
   logger_->log_debug("Connection %s created", name_);
 }
 
-bool Connection::isEmpty() const {
+Connection::~Connection() = default;
+
+void Connection::setLockFreeQueue(bool lock_free) {
+  if (!lock_free) {
+    lock_free_queue_.reset();
+    return;
+  }
+  if (swap_manager_) {
+    logger_->log_warn("Connection %s swaps out its queued flow files, it cannot use a lock-free queue", name_);
+    return;
+  }
+  const uint64_t capacity = max_queue_size_ > 0 ? max_queue_size_.load() : DEFAULT_LOCK_FREE_QUEUE_CAPACITY;
+  lock_free_queue_ = std::make_unique<utils::ConcurrentFlowFileQueue>(gsl::narrow<size_t>(capacity));
+  logger_->log_debug("Connection %s uses a lock-free queue with a capacity of %zu", name_, lock_free_queue_->capacity());
+}
+
+void Connection::setSwapThreshold(uint64_t threshold, const std::string& swap_directory) {
   std::lock_guard<std::mutex> lock(mutex_);
+  if (threshold == 0) {
+    swap_manager_.reset();
+    swap_threshold_ = 0;
+    return;
+  }
+  if (lock_free_queue_) {
+    logger_->log_warn("Connection %s uses a lock-free queue, its queued flow files are not swapped out", name_);
+    return;
+  }
+  swap_threshold_ = threshold;
+  swap_manager_ = std::make_unique<FlowFileSwapManager>(swap_directory, std::string{getUUIDStr()}, content_repo_);
+}
 
-  return queue_.empty();
+uint64_t Connection::getSwappedQueueSize() {
+  return swap_manager_ ? swap_manager_->getSwappedCount() : 0;
 }
 
-bool Connection::isFull() {
+uint64_t Connection::getSwappedQueueDataSize() {
+  return swap_manager_ ? swap_manager_->getSwappedDataSize() : 0;
+}
+
+uint64_t Connection::getQueueSize() {
+  if (lock_free_queue_) {
+    return lock_free_queue_->size();
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  return queueSize();
+}
+
+size_t Connection::queueSize() const {
+  if (!swap_manager_) {
+    return queue_.size();
+  }
+  return queue_.size() + swap_queue_.size() + swapping_in_count_ + swap_manager_->getSwappedCount();
+}
+
+bool Connection::isWorkAvailable() {
+  if (lock_free_queue_) {
+    return lock_free_queue_->isWorkAvailable();
+  }
+  const std::lock_guard<std::mutex> lock{mutex_};
+  return queue_.isWorkAvailable() || !swap_queue_.empty() || swapping_in_count_ > 0 || (swap_manager_ && swap_manager_->getSwappedCount() > 0);
+}
+
+bool Connection::isEmpty() const {
+  if (lock_free_queue_) {
+    return lock_free_queue_->empty();
+  }
   std::lock_guard<std::mutex> lock(mutex_);
 
+  return queueSize() == 0;
+}
+
+struct Connection::SwapOutBatch {
+  std::shared_ptr<FlowFileSwapManager::SwapFile> swap_file;
+  std::vector<std::shared_ptr<core::FlowFile>> flow_files;
+};
+
+void Connection::enqueue(const std::shared_ptr<core::FlowFile>& flow, std::vector<SwapOutBatch>& swap_out_batches) {
+  if (!swap_manager_ || (queue_.size() < swap_threshold_ && swap_queue_.empty() && swapping_in_count_ == 0 && swap_manager_->getSwappedCount() == 0)) {
+    queue_.push(flow);
+    return;
+  }
+  // keeping the FIFO order, the FlowFiles are queued behind the swapped out ones
+  swap_queue_.push_back(flow);
+  if (swap_queue_.size() >= std::min(SWAP_BATCH_SIZE, swap_threshold_)) {
+    // the swap file is reserved here to keep its place in the order, it is written after releasing the lock
+    auto swap_file = swap_manager_->reserveSwapFile(swap_queue_);
+    swap_out_batches.push_back(SwapOutBatch{std::move(swap_file), std::move(swap_queue_)});
+    swap_queue_.clear();
+  }
+}
+
+void Connection::swapOut(std::vector<SwapOutBatch>& swap_out_batches) {
+  for (auto& batch : swap_out_batches) {
+    auto not_swapped = swap_manager_->swapOut(batch.swap_file, std::move(batch.flow_files));
+    if (not_swapped.empty()) {
+      continue;
+    }
+    // the ones that can't be swapped out (not persisted yet) have to stay in memory
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& flow_file : not_swapped) {
+      queue_.push(std::move(flow_file));
+    }
+  }
+}
+
+bool Connection::swapIn(std::unique_lock<std::mutex>& lock) {
+  if (swapping_in_count_ > 0) {
+    // the FlowFiles queued after the ones being swapped in have to wait for them
+    return false;
+  }
+  if (auto swap_file = swap_manager_->takeOldestSwapFile()) {
+    swapping_in_count_ = swap_file->count;
+    lock.unlock();
+    auto flow_files = swap_manager_->swapIn(*swap_file);
+    lock.lock();
+    swapping_in_count_ = 0;
+    for (auto& flow_file : flow_files) {
+      queue_.push(std::move(flow_file));
+    }
+    return true;
+  }
+  if (swap_manager_->getSwappedCount() > 0 || swap_queue_.empty()) {
+    // the oldest swap file is still being written
+    return false;
+  }
+  for (auto& flow_file : swap_queue_) {
+    queue_.push(std::move(flow_file));
+  }
+  swap_queue_.clear();
+  return true;
+}
+
+bool Connection::isFull() {
   if (max_queue_size_ <= 0 && max_data_queue_size_ <= 0)
     // No back pressure setting
     return false;
 
-  if (max_queue_size_ > 0 && queue_.size() >= max_queue_size_)
+  if (max_queue_size_ > 0 && getQueueSize() >= max_queue_size_)
     return true;
 
   if (max_data_queue_size_ > 0 && queued_data_size_ >= max_data_queue_size_)
@@ -101,14 +227,25 @@ void Connection::put(const std::shared_ptr<core::FlowFile>& flow) {
     logger_->log_info("Dropping empty flow file: %s", flow->getUUIDStr());
     return;
   }
-  {
-    std::lock_guard<std::mutex> lock(mutex_);
-
-    queue_.push(flow);
-
+  flow->setLastQueueDate(std::chrono::steady_clock::now());
+  metrics_.recordEnqueue(flow->getSize());
+  if (lock_free_queue_) {
     queued_data_size_ += flow->getSize();
+    lock_free_queue_->push(flow);
 
     logger_->log_debug("Enqueue flow file UUID %s to connection %s", flow->getUUIDStr(), name_);
+  } else {
+    std::vector<SwapOutBatch> swap_out_batches;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+
+      enqueue(flow, swap_out_batches);
+
+      queued_data_size_ += flow->getSize();
+
+      logger_->log_debug("Enqueue flow file UUID %s to connection %s", flow->getUUIDStr(), name_);
+    }
+    swapOut(swap_out_batches);
   }
 
   // Notify receiving processor that work may be available
@@ -119,20 +256,53 @@ void Connection::put(const std::shared_ptr<core::FlowFile>& flow) {
 }
 
 void Connection::multiPut(std::vector<std::shared_ptr<core::FlowFile>>& flows) {
-  {
-    std::lock_guard<std::mutex> lock(mutex_);
+  putFlowFiles(flows, true);
+}
 
+void Connection::requeue(std::vector<std::shared_ptr<core::FlowFile>>& flows) {
+  putFlowFiles(flows, false);
+}
+
+void Connection::putFlowFiles(std::vector<std::shared_ptr<core::FlowFile>>& flows, bool count_as_enqueued) {
+  const auto now = std::chrono::steady_clock::now();
+  if (lock_free_queue_) {
     for (auto &ff : flows) {
       if (drop_empty_ && ff->getSize() == 0) {
         logger_->log_info("Dropping empty flow file: %s", ff->getUUIDStr());
         continue;
       }
 
-      queue_.push(ff);
+      ff->setLastQueueDate(now);
+      if (count_as_enqueued) {
+        metrics_.recordEnqueue(ff->getSize());
+      }
       queued_data_size_ += ff->getSize();
+      lock_free_queue_->push(ff);
 
       logger_->log_debug("Enqueue flow file UUID %s to connection %s", ff->getUUIDStr(), name_);
     }
+  } else {
+    std::vector<SwapOutBatch> swap_out_batches;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+
+      for (auto &ff : flows) {
+        if (drop_empty_ && ff->getSize() == 0) {
+          logger_->log_info("Dropping empty flow file: %s", ff->getUUIDStr());
+          continue;
+        }
+
+        ff->setLastQueueDate(now);
+        if (count_as_enqueued) {
+          metrics_.recordEnqueue(ff->getSize());
+        }
+        enqueue(ff, swap_out_batches);
+        queued_data_size_ += ff->getSize();
+
+        logger_->log_debug("Enqueue flow file UUID %s to connection %s", ff->getUUIDStr(), name_);
+      }
+    }
+    swapOut(swap_out_batches);
   }
 
   if (dest_connectable_) {
@@ -142,48 +312,76 @@ void Connection::multiPut(std::vector<std::shared_ptr<core::FlowFile>>& flows) {
 }
 
 std::shared_ptr<core::FlowFile> Connection::poll(std::set<std::shared_ptr<core::FlowFile>> &expiredFlowRecords) {
-  std::lock_guard<std::mutex> lock(mutex_);
+  if (lock_free_queue_) {
+    while (auto item = lock_free_queue_->tryPop()) {
+      queued_data_size_ -= item->getSize();
+      if (auto polled = acceptPolledFlowFile(item, expiredFlowRecords)) {
+        return polled;
+      }
+    }
+    return nullptr;
+  }
 
-  while (queue_.isWorkAvailable()) {
-    std::shared_ptr<core::FlowFile> item = queue_.pop();
-    queued_data_size_ -= item->getSize();
+  std::unique_lock<std::mutex> lock(mutex_);
 
-    if (expired_duration_.load() > 0ms) {
-      // We need to check for flow expiration
-      if (std::chrono::system_clock::now() > (item->getEntryDate() + expired_duration_.load())) {
-        // Flow record expired
-        expiredFlowRecords.insert(item);
-        logger_->log_debug("Delete flow file UUID %s from connection %s, because it expired", item->getUUIDStr(), name_);
-      } else {
-        std::shared_ptr<Connectable> connectable = std::static_pointer_cast<Connectable>(shared_from_this());
-        item->setConnection(connectable);
-        logger_->log_debug("Dequeue flow file UUID %s from connection %s", item->getUUIDStr(), name_);
-        return item;
+  while (queue_.isWorkAvailable() || (swap_manager_ && queueSize() > queue_.size())) {
+    if (!queue_.isWorkAvailable()) {
+      if (!swapIn(lock)) {
+        break;
       }
-    } else {
-      std::shared_ptr<Connectable> connectable = std::static_pointer_cast<Connectable>(shared_from_this());
-      item->setConnection(connectable);
-      logger_->log_debug("Dequeue flow file UUID %s from connection %s", item->getUUIDStr(), name_);
-      return item;
+      continue;
+    }
+    std::shared_ptr<core::FlowFile> item = queue_.pop();
+    queued_data_size_ -= item->getSize();
+    if (auto polled = acceptPolledFlowFile(item, expiredFlowRecords)) {
+      return polled;
     }
   }
 
   return NULL;
 }
 
+std::shared_ptr<core::FlowFile> Connection::acceptPolledFlowFile(const std::shared_ptr<core::FlowFile>& item, std::set<std::shared_ptr<core::FlowFile>> &expiredFlowRecords) {
+  if (expired_duration_.load() > 0ms) {
+    // We need to check for flow expiration
+    if (std::chrono::system_clock::now() > (item->getEntryDate() + expired_duration_.load())) {
+      // Flow record expired
+      expiredFlowRecords.insert(item);
+      logger_->log_debug("Delete flow file UUID %s from connection %s, because it expired", item->getUUIDStr(), name_);
+      return nullptr;
+    }
+  }
+  // the FlowFiles swapped in from a file lost their queue date
+  const auto queue_date = item->getLastQueueDate();
+  metrics_.recordDequeue(item->getSize(), queue_date == std::chrono::steady_clock::time_point{}
+      ? std::nullopt : std::optional<std::chrono::steady_clock::duration>(std::chrono::steady_clock::now() - queue_date));
+  std::shared_ptr<Connectable> connectable = std::static_pointer_cast<Connectable>(shared_from_this());
+  item->setConnection(connectable);
+  logger_->log_debug("Dequeue flow file UUID %s from connection %s", item->getUUIDStr(), name_);
+  return item;
+}
+
 void Connection::drain(bool delete_permanently) {
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::unique_lock<std::mutex> lock(mutex_);
 
-  while (!queue_.empty()) {
-    std::shared_ptr<core::FlowFile> item = queue_.pop();
+  const auto delete_flow_file = [&](const std::shared_ptr<core::FlowFile>& item) {
     logger_->log_debug("Delete flow file UUID %s from connection %s, because it expired", item->getUUIDStr(), name_);
     if (delete_permanently) {
-      if (item->isStored() && flow_repository_->Delete(item->getUUIDStr())) {
+      if (item->isStored() && flow_repository_->Delete(item->getUUIDStr(), item->getResourceClaim())) {
         item->setStoredToRepository(false);
-        auto claim = item->getResourceClaim();
-        if (claim) claim->decreaseFlowFileRecordOwnedCount();
       }
     }
+  };
+  if (swap_manager_) {
+    while (swapIn(lock)) {}
+  }
+  while (!queue_.empty()) {
+    delete_flow_file(queue_.pop());
+  }
+  if (lock_free_queue_) {
+    for (const auto& item : lock_free_queue_->popAll()) {
+      delete_flow_file(item);
+    }
   }
   queued_data_size_ = 0;
   logger_->log_debug("Drain connection %s", name_);
@@ -46,11 +46,18 @@ utils::TaskRescheduleInfo EventDrivenSchedulingAgent::run(const std::shared_ptr<
     while (processor->isRunning() && (std::chrono::steady_clock::now() - start_time < time_slice_)) {
       bool shouldYield = this->onTrigger(processor, processContext, sessionFactory);
       if (processor->isYield()) {
-        // Honor the yield
-        return utils::TaskRescheduleInfo::RetryIn(std::chrono::milliseconds(processor->getYieldTime()));
+        // Honor the yield, a source processor may only be woken up by its own notification (e.g. TailFile by inotify)
+        return processor->hasIncomingConnections()
+            ? utils::TaskRescheduleInfo::RetryIn(std::chrono::milliseconds(processor->getYieldTime()))
+            : utils::TaskRescheduleInfo::RetryOnNotificationOrIn(std::chrono::milliseconds(processor->getYieldTime()));
       } else if (shouldYield) {
         // No work to do or need to apply back pressure
-        return utils::TaskRescheduleInfo::RetryIn(this->bored_yield_duration_ > 0ms ? this->bored_yield_duration_ : 10ms);  // No work left to do, stand by
+        const auto wait_time = this->bored_yield_duration_ > 0ms ? this->bored_yield_duration_ : 10ms;
+        if (!hasWorkToDo(processor)) {
+          // No work left to do, stand by until data arrives
+          return utils::TaskRescheduleInfo::RetryOnNotificationOrIn(wait_time);
+        }
+        return utils::TaskRescheduleInfo::RetryIn(wait_time);
       }
     }
     return utils::TaskRescheduleInfo::RetryImmediately();  // Let's continue work as soon as a thread is available
@@ -47,6 +47,7 @@
 #include "core/logging/LoggerConfiguration.h"
 #include "core/Connectable.h"
 #include "utils/file/PathUtils.h"
+#include "utils/StringUtils.h"
 #include "utils/file/FileSystem.h"
 #include "utils/HTTPClient.h"
 #include "io/NetworkPrioritizer.h"
@@ -58,6 +59,13 @@ namespace apache {
 namespace nifi {
 namespace minifi {
 
+namespace {
+
+// the metric nodes published if nifi.metrics.publisher.metrics is not set
+constexpr const char* DEFAULT_PUBLISHED_METRICS = "QueueMetrics,RepositoryMetrics,ProcessorPerformanceMetrics,ConnectionPerformanceMetrics";
+
+}  // namespace
+
 FlowController::FlowController(std::shared_ptr<core::Repository> provenance_repo, std::shared_ptr<core::Repository> flow_file_repo,
                                std::shared_ptr<Configure> configure, std::unique_ptr<core::FlowConfiguration> flow_configuration,
                                std::shared_ptr<core::ContentRepository> content_repo, const std::string /*name*/,
@@ -103,6 +111,7 @@ FlowController::~FlowController() {
   stop();
   stopC2();
   unload();
+  metrics_publisher_ = nullptr;
   // TODO(adebreceni): are these here on purpose, so they are destroyed first?
   protocol_ = nullptr;
   flow_file_repo_ = nullptr;
@@ -200,6 +209,10 @@ int16_t FlowController::stop() {
     this->provenance_repo_->stop();
     // stop the ControllerServices
     this->controller_service_provider_impl_->disableAllControllerServices();
+    // the endpoint of the publisher stays up, the nodes of the next flow are handed over on start
+    if (metrics_publisher_) {
+      metrics_publisher_->setMetricNodes({});
+    }
     running_ = false;
   }
   return 0;
@@ -371,6 +384,7 @@ int16_t FlowController::start() {
         this->root_->startProcessing(timer_scheduler_, event_scheduler_, cron_scheduler_);
       }
       C2Client::initialize(this, this, shared_from_this());
+      loadMetricsPublisher();
       running_ = true;
       this->protocol_->start();
       this->provenance_repo_->start();
@@ -382,6 +396,39 @@ int16_t FlowController::start() {
   }
 }
 
+void FlowController::loadMetricsPublisher() {
+  if (!metrics_publisher_) {
+    const auto publisher_class = configuration_->get(Configure::nifi_metrics_publisher_class);
+    if (!publisher_class) {
+      return;
+    }
+    auto publisher = core::ClassLoader::getDefaultClassLoader().instantiate<state::MetricsPublisher>(*publisher_class, *publisher_class);
+    if (!publisher) {
+      logger_->log_error("Could not instantiate metrics publisher %s", *publisher_class);
+      return;
+    }
+    try {
+      publisher->initialize(configuration_);
+    } catch (const std::exception& exception) {
+      logger_->log_error("Could not start metrics publisher %s: %s", *publisher_class, exception.what());
+      return;
+    }
+    metrics_publisher_ = std::move(publisher);
+  }
+
+  std::vector<std::shared_ptr<state::response::ResponseNode>> nodes;
+  const auto metrics_classes = configuration_->get(Configure::nifi_metrics_publisher_metrics).value_or(DEFAULT_PUBLISHED_METRICS);
+  for (const auto& clazz : utils::StringUtils::splitAndTrimRemovingEmpty(metrics_classes, ",")) {
+    auto node = createResponseNode(clazz, shared_from_this());
+    if (!node) {
+      logger_->log_error("No metric defined for %s", clazz);
+      continue;
+    }
+    nodes.push_back(std::move(node));
+  }
+  metrics_publisher_->setMetricNodes(std::move(nodes));
+}
+
 int16_t FlowController::pause() {
   std::lock_guard<std::recursive_mutex> flow_lock(mutex_);
   if (!running_) {
@@ -520,6 +567,13 @@ std::map<std::string, std::unique_ptr<io::InputStream>> FlowController::getDebug
   return debug_info;
 }
 
+std::optional<provenance::ProvenanceQueryResult> FlowController::queryProvenance(const provenance::ProvenanceQuery& query) {
+  if (!provenance_repo_) {
+    return std::nullopt;
+  }
+  return provenance_repo_->queryProvenance(query);
+}
+
 }  // namespace minifi
 }  // namespace nifi
 }  // namespace apache
@@ -27,6 +27,7 @@
 #include <iostream>
 #include <fstream>
 #include <cinttypes>
+#include <limits>
 #include "FlowFileRecord.h"
 #include "core/logging/LoggerConfiguration.h"
 #include "core/Relationship.h"
@@ -58,7 +59,7 @@ std::shared_ptr<FlowFileRecord> FlowFileRecord::DeSerialize(const std::string& k
   }
   io::BufferStream stream((const uint8_t*) value.data(), value.length());
 
-  auto record = DeSerialize(stream, content_repo, container);
+  auto record = DeSerialize(stream, content_repo, container, flowRepository->getRecordDictionary());
 
   if (record) {
     logger_->log_debug("NiFi FlowFile retrieve uuid %s size " "%" PRIu64 " connection %s success", record->getUUIDStr(), stream.size(), container.to_string());
@@ -69,87 +70,164 @@ std::shared_ptr<FlowFileRecord> FlowFileRecord::DeSerialize(const std::string& k
   return record;
 }
 
-bool FlowFileRecord::Serialize(io::OutputStream &outStream) {
-  {
-    uint64_t event_time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(event_time_.time_since_epoch()).count();
-    const auto ret = outStream.write(event_time_ms);
-    if (ret != 8) {
-      return false;
+namespace {
+
+bool writeVarint(io::OutputStream& stream, uint64_t value) {
+  uint8_t buf[10];
+  size_t len = 0;
+  do {
+    uint8_t byte = value & 0x7FU;
+    value >>= 7U;
+    if (value != 0) {
+      byte |= 0x80U;
     }
-  }
-  {
-    uint64_t entry_date_ms = std::chrono::duration_cast<std::chrono::milliseconds>(entry_date_.time_since_epoch()).count();
-    const auto ret = outStream.write(entry_date_ms);
-    if (ret != 8) {
+    buf[len++] = byte;
+  } while (value != 0);
+  return stream.write(buf, len) == len;
+}
+
+bool readVarint(io::InputStream& stream, uint64_t& value) {
+  value = 0;
+  for (unsigned shift = 0; shift < 64; shift += 7) {
+    uint8_t byte;
+    if (stream.read(byte) != 1) {
       return false;
     }
+    value |= static_cast<uint64_t>(byte & 0x7FU) << shift;
+    if ((byte & 0x80U) == 0) {
+      return true;
+    }
   }
-  {
-    uint64_t lineage_start_date_ms = std::chrono::duration_cast<std::chrono::milliseconds>(lineage_start_date_.time_since_epoch()).count();
-    const auto ret = outStream.write(lineage_start_date_ms);
-    if (ret != 8) {
-      return false;
+  return false;
+}
+
+bool writeSignedVarint(io::OutputStream& stream, int64_t value) {
+  return writeVarint(stream, (static_cast<uint64_t>(value) << 1U) ^ static_cast<uint64_t>(value >> 63));
+}
+
+bool readSignedVarint(io::InputStream& stream, int64_t& value) {
+  uint64_t encoded;
+  if (!readVarint(stream, encoded)) {
+    return false;
+  }
+  value = static_cast<int64_t>(encoded >> 1U) ^ -static_cast<int64_t>(encoded & 1U);
+  return true;
+}
+
+bool writeBytes(io::OutputStream& stream, const std::string& str) {
+  if (!writeVarint(stream, str.size())) {
+    return false;
+  }
+  return str.empty() || stream.write(reinterpret_cast<const uint8_t*>(str.data()), str.size()) == str.size();
+}
+
+bool readBytes(io::InputStream& stream, std::string& str, uint64_t len) {
+  str.resize(gsl::narrow<size_t>(len));
+  return str.empty() || stream.read(reinterpret_cast<uint8_t*>(str.data()), str.size()) == str.size();
+}
+
+bool readBytes(io::InputStream& stream, std::string& str) {
+  uint64_t len;
+  return readVarint(stream, len) && readBytes(stream, str, len);
+}
+
+// the lowest bit of the tag tells whether the string is a dictionary id or inlined
+bool writeDictionaryString(io::OutputStream& stream, const std::string& str, FlowFileRecordDictionary* dictionary) {
+  if (dictionary) {
+    if (auto id = dictionary->intern(str)) {
+      return writeVarint(stream, (uint64_t{*id} << 1U) | 1U);
     }
   }
+  return writeVarint(stream, uint64_t{str.size()} << 1U)
+      && (str.empty() || stream.write(reinterpret_cast<const uint8_t*>(str.data()), str.size()) == str.size());
+}
+
+bool readDictionaryString(io::InputStream& stream, std::string& str, const FlowFileRecordDictionary* dictionary) {
+  uint64_t tag;
+  if (!readVarint(stream, tag)) {
+    return false;
+  }
+  if ((tag & 1U) == 0) {
+    return readBytes(stream, str, tag >> 1U);
+  }
+  if (!dictionary || (tag >> 1U) > std::numeric_limits<uint32_t>::max()) {
+    return false;
+  }
+  auto entry = dictionary->lookup(gsl::narrow<uint32_t>(tag >> 1U));
+  if (!entry) {
+    return false;
+  }
+  str = std::move(*entry);
+  return true;
+}
+
+bool writeIdentifier(io::OutputStream& stream, const utils::Identifier& id) {
+  const auto& data = id.getData();
+  return stream.write(data.data(), data.size()) == data.size();
+}
+
+bool readIdentifier(io::InputStream& stream, utils::Identifier& id) {
+  utils::Identifier::Data data;
+  if (stream.read(data.data(), data.size()) != data.size()) {
+    return false;
+  }
+  id = utils::Identifier(data);
+  return true;
+}
+
+int64_t toMillis(std::chrono::system_clock::time_point time_point) {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(time_point.time_since_epoch()).count();
+}
+
+}  // namespace
+
+bool FlowFileRecord::Serialize(io::OutputStream &outStream, const std::shared_ptr<FlowFileRecordDictionary>& dictionary) {
   {
-    const auto ret = outStream.write(uuid_);
-    if (ret == 0 || io::isError(ret)) {
+    const uint8_t header[] = {RECORD_FORMAT_MARKER, RECORD_FORMAT_VERSION};
+    if (outStream.write(header, sizeof(header)) != sizeof(header)) {
       return false;
     }
   }
+  // the other timestamps are usually close to the event time
+  const int64_t event_time_ms = toMillis(event_time_);
+  if (!writeVarint(outStream, static_cast<uint64_t>(event_time_ms))
+      || !writeSignedVarint(outStream, toMillis(entry_date_) - event_time_ms)
+      || !writeSignedVarint(outStream, toMillis(lineage_start_date_) - event_time_ms)) {
+    return false;
+  }
   utils::Identifier containerId;
   if (connection_) {
     containerId = connection_->getUUID();
   }
-  {
-    const auto ret = outStream.write(containerId);
-    if (ret == 0 || io::isError(ret)) {
-      return false;
-    }
+  if (!writeIdentifier(outStream, uuid_) || !writeIdentifier(outStream, containerId)) {
+    return false;
   }
+
   // write flow attributes
-  {
-    const auto numAttributes = gsl::narrow<uint32_t>(attributes_.size());
-    const auto ret = outStream.write(numAttributes);
-    if (ret != 4) {
-      return false;
-    }
+  if (!writeVarint(outStream, attributes_.size())) {
+    return false;
   }
-
   for (auto& itAttribute : attributes_) {
-    {
-      const auto ret = outStream.write(itAttribute.first, true);
-      if (ret == 0 || io::isError(ret)) {
-        return false;
-      }
-    }
-    {
-      const auto ret = outStream.write(itAttribute.second, true);
-      if (ret == 0 || io::isError(ret)) {
-        return false;
-      }
-    }
-  }
-
-  {
-    const auto ret = outStream.write(getContentFullPath());
-    if (ret == 0 || io::isError(ret)) {
+    if (!writeDictionaryString(outStream, itAttribute.first, dictionary.get()) || !writeBytes(outStream, itAttribute.second)) {
       return false;
     }
   }
-  {
-    const auto ret = outStream.write(size_);
-    if (ret != 8) {
+
+  // the content directory is shared by the claims, only the claim id is unique to the record
+  const auto content_full_path = getContentFullPath();
+  const auto separator = content_full_path.rfind('/');
+  if (dictionary && separator != std::string::npos) {
+    if (!writeVarint(outStream, CONTENT_CLAIM_ID) || !writeDictionaryString(outStream, content_full_path.substr(0, separator), dictionary.get())
+        || !writeBytes(outStream, content_full_path.substr(separator + 1))) {
       return false;
     }
-  }
-  {
-    const auto ret = outStream.write(offset_);
-    if (ret != 8) {
+  } else {
+    if (!writeVarint(outStream, CONTENT_FULL_PATH) || !writeBytes(outStream, content_full_path)) {
       return false;
     }
   }
-  return true;
+
+  return writeVarint(outStream, size_) && writeVarint(outStream, offset_);
 }
 
 bool FlowFileRecord::Persist(const std::shared_ptr<core::Repository>& flowRepository) {
@@ -159,7 +237,7 @@ bool FlowFileRecord::Persist(const std::shared_ptr<core::Repository>& flowReposi
 
   io::BufferStream outStream;
 
-  if (!Serialize(outStream)) {
+  if (!Serialize(outStream, flowRepository->getRecordDictionary())) {
     return false;
   }
 
@@ -176,15 +254,97 @@ bool FlowFileRecord::Persist(const std::shared_ptr<core::Repository>& flowReposi
   return true;
 }
 
-std::shared_ptr<FlowFileRecord> FlowFileRecord::DeSerialize(io::InputStream& inStream, const std::shared_ptr<core::ContentRepository>& content_repo, utils::Identifier& container) {
+std::shared_ptr<FlowFileRecord> FlowFileRecord::DeSerialize(io::InputStream& inStream, const std::shared_ptr<core::ContentRepository>& content_repo, utils::Identifier& container,
+    const std::shared_ptr<FlowFileRecordDictionary>& dictionary) {
+  uint8_t marker;
+  if (inStream.read(marker) != 1) {
+    return {};
+  }
+  if (marker != RECORD_FORMAT_MARKER) {
+    return DeSerializeLegacy(inStream, marker, content_repo, container);
+  }
+  uint8_t version;
+  if (inStream.read(version) != 1 || version != RECORD_FORMAT_VERSION) {
+    logger_->log_error("Unsupported FlowFile record format version");
+    return {};
+  }
+
   auto file = std::make_shared<FlowFileRecord>();
 
   {
     uint64_t event_time_in_ms;
-    const auto ret = inStream.read(event_time_in_ms);
-    if (ret != 8) {
+    int64_t entry_date_offset_ms;
+    int64_t lineage_start_date_offset_ms;
+    if (!readVarint(inStream, event_time_in_ms) || !readSignedVarint(inStream, entry_date_offset_ms) || !readSignedVarint(inStream, lineage_start_date_offset_ms)) {
       return {};
     }
+    const auto event_time = std::chrono::system_clock::time_point() + std::chrono::milliseconds(event_time_in_ms);
+    file->event_time_ = event_time;
+    file->entry_date_ = event_time + std::chrono::milliseconds(entry_date_offset_ms);
+    file->lineage_start_date_ = event_time + std::chrono::milliseconds(lineage_start_date_offset_ms);
+  }
+
+  if (!readIdentifier(inStream, file->uuid_) || !readIdentifier(inStream, container)) {
+    return {};
+  }
+
+  // read flow attributes
+  uint64_t numAttributes;
+  if (!readVarint(inStream, numAttributes)) {
+    return {};
+  }
+  for (uint64_t i = 0; i < numAttributes; i++) {
+    std::string key;
+    std::string value;
+    if (!readDictionaryString(inStream, key, dictionary.get()) || !readBytes(inStream, value)) {
+      logger_->log_error("Couldn't read the attributes of FlowFile %s", file->getUUIDStr());
+      return {};
+    }
+    file->attributes_[key] = value;
+  }
+
+  std::string content_full_path;
+  {
+    uint64_t content_tag;
+    if (!readVarint(inStream, content_tag)) {
+      return {};
+    }
+    if (content_tag == CONTENT_CLAIM_ID) {
+      std::string directory;
+      std::string claim_id;
+      if (!readDictionaryString(inStream, directory, dictionary.get()) || !readBytes(inStream, claim_id)) {
+        return {};
+      }
+      content_full_path = directory + "/" + claim_id;
+    } else if (content_tag != CONTENT_FULL_PATH || !readBytes(inStream, content_full_path)) {
+      return {};
+    }
+  }
+
+  if (!readVarint(inStream, file->size_) || !readVarint(inStream, file->offset_)) {
+    return {};
+  }
+
+  file->claim_ = std::make_shared<ResourceClaim>(content_full_path, content_repo);
+
+  return file;
+}
+
+std::shared_ptr<FlowFileRecord> FlowFileRecord::DeSerializeLegacy(io::InputStream& inStream, uint8_t first_byte,
+    const std::shared_ptr<core::ContentRepository>& content_repo, utils::Identifier& container) {
+  auto file = std::make_shared<FlowFileRecord>();
+
+  {
+    // the first byte of the big endian event time has already been consumed
+    uint8_t buf[7];
+    const auto ret = inStream.read(buf, sizeof(buf));
+    if (ret != sizeof(buf)) {
+      return {};
+    }
+    uint64_t event_time_in_ms = first_byte;
+    for (auto byte : buf) {
+      event_time_in_ms = (event_time_in_ms << 8U) | byte;
+    }
     file->event_time_ = std::chrono::system_clock::time_point() + std::chrono::milliseconds(event_time_in_ms);
   }
 
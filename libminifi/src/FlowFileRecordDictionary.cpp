@@ -0,0 +1,105 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "FlowFileRecordDictionary.h"
+
+#include <algorithm>
+#include <mutex>
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+
+std::optional<uint32_t> FlowFileRecordDictionary::intern(const std::string& str) {
+  {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = ids_.find(str);
+    if (it != ids_.end()) {
+      return it->second;
+    }
+    if (ids_.size() >= MAX_SIZE) {
+      return std::nullopt;
+    }
+  }
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  auto it = ids_.find(str);
+  if (it != ids_.end()) {
+    return it->second;
+  }
+  if (ids_.size() >= MAX_SIZE) {
+    return std::nullopt;
+  }
+  const auto id = static_cast<uint32_t>(strings_.size());
+  strings_.emplace_back(str);
+  ids_.emplace(str, id);
+  unpersisted_.push_back(id);
+  return id;
+}
+
+std::optional<std::string> FlowFileRecordDictionary::lookup(uint32_t id) const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  if (id >= strings_.size()) {
+    return std::nullopt;
+  }
+  return strings_[id];
+}
+
+bool FlowFileRecordDictionary::restore(uint32_t id, const std::string& str) {
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  if (id >= strings_.size()) {
+    strings_.resize(id + 1);
+  }
+  if (strings_[id]) {
+    return *strings_[id] == str;
+  }
+  if (ids_.find(str) != ids_.end()) {
+    return false;
+  }
+  strings_[id] = str;
+  ids_.emplace(str, id);
+  return true;
+}
+
+std::vector<std::pair<uint32_t, std::string>> FlowFileRecordDictionary::getUnpersistedEntries() const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  std::vector<std::pair<uint32_t, std::string>> entries;
+  entries.reserve(unpersisted_.size());
+  for (auto id : unpersisted_) {
+    entries.emplace_back(id, *strings_[id]);
+  }
+  return entries;
+}
+
+void FlowFileRecordDictionary::markPersisted(const std::vector<std::pair<uint32_t, std::string>>& entries) {
+  if (entries.empty()) {
+    return;
+  }
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  unpersisted_.erase(std::remove_if(unpersisted_.begin(), unpersisted_.end(), [&] (uint32_t id) {
+    return std::any_of(entries.begin(), entries.end(), [&] (const auto& entry) { return entry.first == id; });
+  }), unpersisted_.end());
+}
+
+size_t FlowFileRecordDictionary::size() const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  return ids_.size();
+}
+
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
@@ -0,0 +1,227 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "FlowFileSwapManager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <utility>
+
+#include "FlowFileRecord.h"
+#include "core/ContentRepository.h"
+#include "core/logging/LoggerConfiguration.h"
+#include "io/BufferStream.h"
+#include "utils/Id.h"
+#include "utils/StringUtils.h"
+#include "utils/file/FileUtils.h"
+#include "utils/gsl.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+
+namespace {
+
+constexpr const char* SWAP_FILE_EXTENSION = ".swap";
+
+// the managers alive in this process, the swap files of any other manager are left over from a previous run
+std::mutex live_instances_mutex;
+std::set<std::string> live_instances;
+
+uint64_t toNanos(std::chrono::steady_clock::time_point time_point) {
+  return gsl::narrow<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(time_point.time_since_epoch()).count());
+}
+
+}  // namespace
+
+FlowFileSwapManager::FlowFileSwapManager(std::string directory, std::string prefix, std::shared_ptr<core::ContentRepository> content_repo)
+    : directory_(std::move(directory)),
+      prefix_(std::move(prefix)),
+      instance_id_(utils::IdGenerator::getIdGenerator()->generate().to_string()),
+      content_repo_(std::move(content_repo)),
+      logger_(core::logging::LoggerFactory<FlowFileSwapManager>::getLogger()) {
+  utils::file::FileUtils::create_dir(directory_);
+  removeAbandonedSwapFiles();
+}
+
+FlowFileSwapManager::~FlowFileSwapManager() {
+  {
+    std::lock_guard<std::mutex> lock(live_instances_mutex);
+    live_instances.erase(instance_id_);
+  }
+  for (const auto& swap_file : swap_files_) {
+    std::remove(swap_file->path.c_str());
+  }
+}
+
+void FlowFileSwapManager::removeAbandonedSwapFiles() {
+  std::lock_guard<std::mutex> lock(live_instances_mutex);
+  live_instances.insert(instance_id_);
+  // the swapped FlowFiles of a previous run are restored from the FlowFile repository
+  utils::file::FileUtils::list_dir(directory_, [this] (const std::string& dir, const std::string& filename) {
+    if (!utils::StringUtils::startsWith(filename, prefix_)) {
+      return true;
+    }
+    // <prefix>.<instance id>.<swap file id>.swap
+    const auto instance_end = filename.find('.', prefix_.size() + 1);
+    const bool live = filename.size() > prefix_.size() && filename[prefix_.size()] == '.' && instance_end != std::string::npos
+        && live_instances.count(filename.substr(prefix_.size() + 1, instance_end - prefix_.size() - 1)) > 0;
+    if (!live) {
+      std::remove(utils::file::FileUtils::concat_path(dir, filename).c_str());
+    }
+    return true;
+  }, logger_, false);
+}
+
+std::shared_ptr<FlowFileSwapManager::SwapFile> FlowFileSwapManager::reserveSwapFile(const std::vector<std::shared_ptr<core::FlowFile>>& flow_files) {
+  auto swap_file = std::make_shared<SwapFile>();
+  swap_file->count = flow_files.size();
+  for (const auto& flow_file : flow_files) {
+    swap_file->data_size += flow_file->getSize();
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  swap_file->path = utils::file::FileUtils::concat_path(directory_, prefix_ + "." + instance_id_ + "." + std::to_string(next_swap_file_id_++) + SWAP_FILE_EXTENSION);
+  swapped_count_ += swap_file->count;
+  swapped_data_size_ += swap_file->data_size;
+  swap_files_.push_back(swap_file);
+  return swap_file;
+}
+
+std::vector<std::shared_ptr<core::FlowFile>> FlowFileSwapManager::swapOut(const std::shared_ptr<SwapFile>& swap_file, std::vector<std::shared_ptr<core::FlowFile>> flow_files) {
+  std::vector<std::shared_ptr<core::FlowFile>> not_swapped;
+  io::BufferStream buffer;
+  for (const auto& flow_file : flow_files) {
+    auto record = std::dynamic_pointer_cast<FlowFileRecord>(flow_file);
+    // the content of a FlowFile that is not persisted would be removed along with the last in-memory reference to its claim
+    if (!record || !record->isStored()) {
+      not_swapped.push_back(flow_file);
+      continue;
+    }
+    io::BufferStream record_buffer;
+    if (!record->Serialize(record_buffer)) {
+      not_swapped.push_back(flow_file);
+      continue;
+    }
+    // the record format leaves out the in-memory state of the queued FlowFile
+    const auto& lineage = record->getlineageIdentifiers();
+    buffer.write(gsl::narrow<uint32_t>(record_buffer.size()));
+    buffer.write(record_buffer.getBuffer(), record_buffer.size());
+    buffer.write(toNanos(record->getPenaltyExpiration()));
+    buffer.write(gsl::narrow<uint32_t>(lineage.size()));
+    for (const auto& lineage_id : lineage) {
+      buffer.write(lineage_id);
+    }
+  }
+
+  bool written = true;
+  if (not_swapped.size() < flow_files.size()) {
+    std::ofstream file(swap_file->path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(buffer.getBuffer()), gsl::narrow<std::streamsize>(buffer.size()));
+    file.close();
+    if (!file) {
+      logger_->log_error("Could not write swap file %s, keeping the FlowFiles in memory", swap_file->path);
+      std::remove(swap_file->path.c_str());
+      written = false;
+    }
+  }
+  if (!written) {
+    not_swapped = std::move(flow_files);
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& flow_file : not_swapped) {
+    --swap_file->count;
+    swap_file->data_size -= flow_file->getSize();
+    --swapped_count_;
+    swapped_data_size_ -= flow_file->getSize();
+  }
+  swap_file->written = true;
+  if (swap_file->count == 0) {
+    swap_files_.erase(std::remove(swap_files_.begin(), swap_files_.end(), swap_file), swap_files_.end());
+  } else {
+    logger_->log_debug("Swapped out %zu FlowFiles to %s", swap_file->count, swap_file->path);
+  }
+  return not_swapped;
+}
+
+std::shared_ptr<FlowFileSwapManager::SwapFile> FlowFileSwapManager::takeOldestSwapFile() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (swap_files_.empty() || !swap_files_.front()->written) {
+    return nullptr;
+  }
+  auto swap_file = std::move(swap_files_.front());
+  swap_files_.pop_front();
+  swapped_count_ -= swap_file->count;
+  swapped_data_size_ -= swap_file->data_size;
+  return swap_file;
+}
+
+std::vector<std::shared_ptr<core::FlowFile>> FlowFileSwapManager::swapIn(const SwapFile& swap_file) {
+  std::vector<std::shared_ptr<core::FlowFile>> flow_files;
+  std::ifstream file(swap_file.path, std::ios::binary);
+  const std::vector<uint8_t> content{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+  file.close();
+  std::remove(swap_file.path.c_str());
+
+  io::BufferStream buffer(content.data(), content.size());
+  flow_files.reserve(swap_file.count);
+  const auto now = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < swap_file.count; ++i) {
+    uint32_t record_size = 0;
+    if (buffer.read(record_size) != sizeof(record_size) || buffer.tell() + record_size > content.size()) {
+      break;
+    }
+    utils::Identifier container;
+    auto record = FlowFileRecord::DeSerialize(content.data() + buffer.tell(), gsl::narrow<int>(record_size), content_repo_, container);
+    buffer.seek(buffer.tell() + record_size);
+    uint64_t penalty_expiration_ns = 0;
+    uint32_t lineage_size = 0;
+    if (buffer.read(penalty_expiration_ns) != sizeof(penalty_expiration_ns) || buffer.read(lineage_size) != sizeof(lineage_size)) {
+      break;
+    }
+    std::vector<utils::Identifier> lineage(lineage_size);
+    for (auto& lineage_id : lineage) {
+      buffer.read(lineage_id);
+    }
+    if (!record) {
+      continue;
+    }
+    const auto penalty_expiration = std::chrono::steady_clock::time_point{std::chrono::nanoseconds{gsl::narrow<std::chrono::nanoseconds::rep>(penalty_expiration_ns)}};
+    if (penalty_expiration > now) {
+      record->penalize(penalty_expiration - now);
+    }
+    record->setLineageIdentifiers(lineage);
+    record->setStoredToRepository(true);
+    flow_files.push_back(std::move(record));
+  }
+  if (flow_files.size() != swap_file.count) {
+    logger_->log_error("Could only read back %zu of the %zu FlowFiles swapped out to %s, the rest will be restored from the FlowFile repository on restart",
+        flow_files.size(), swap_file.count, swap_file.path);
+  } else {
+    logger_->log_debug("Swapped in %zu FlowFiles from %s", flow_files.size(), swap_file.path);
+  }
+  return flow_files;
+}
+
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
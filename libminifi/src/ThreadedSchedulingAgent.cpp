@@ -90,6 +90,7 @@ void ThreadedSchedulingAgent::schedule(std::shared_ptr<core::Processor> processo
 
   auto sessionFactory = std::make_shared<core::ProcessSessionFactory>(processContext);
 
+  processContext->onSchedule();
   processor->onSchedule(processContext, sessionFactory);
 
   std::vector<std::thread *> threads;
@@ -110,6 +111,9 @@ void ThreadedSchedulingAgent::schedule(std::shared_ptr<core::Processor> processo
     std::future<utils::TaskRescheduleInfo> future;
     thread_pool_.execute(std::move(functor), future);
   }
+  processor->setWorkNotificationCallback([&thread_pool = thread_pool_, processor_id = utils::TaskId{processor->getUUIDStr()}] {
+    thread_pool.notifyTasks(processor_id);
+  });
   logger_->log_debug("Scheduled thread %d concurrent workers for for process %s", processor->getMaxConcurrentTasks(), processor->getName());
   processors_running_.insert(processor->getUUID());
 }
@@ -132,6 +136,7 @@ void ThreadedSchedulingAgent::unschedule(std::shared_ptr<core::Processor> proces
     return;
   }
 
+  processor->setWorkNotificationCallback(nullptr);
   thread_pool_.stopTasks(processor->getUUIDStr());
 
   processor->clearActiveTask();
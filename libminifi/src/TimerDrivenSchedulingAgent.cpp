@@ -36,13 +36,19 @@ utils::TaskRescheduleInfo TimerDrivenSchedulingAgent::run(const std::shared_ptr<
   if (this->running_ && processor->isRunning()) {
     bool shouldYield = this->onTrigger(processor, processContext, sessionFactory);
     if (processor->isYield()) {
-      // Honor the yield
-      return utils::TaskRescheduleInfo::RetryIn(processor->getYieldTime());
-    } else if (shouldYield && this->bored_yield_duration_ > 0ms) {
-      // No work to do or need to apply back pressure
-      return utils::TaskRescheduleInfo::RetryIn(this->bored_yield_duration_);
+      // Honor the yield, a source processor may only be woken up by its own notification (e.g. TailFile by inotify)
+      return processor->hasIncomingConnections()
+          ? utils::TaskRescheduleInfo::RetryIn(processor->getYieldTime())
+          : utils::TaskRescheduleInfo::RetryOnNotificationOrIn(processor->getYieldTime());
     }
-    return utils::TaskRescheduleInfo::RetryIn(std::chrono::duration_cast<std::chrono::milliseconds>(processor->getSchedulingPeriodNano()));
+    const auto wait_time = shouldYield && this->bored_yield_duration_ > 0ms
+        ? this->bored_yield_duration_  // No work to do or need to apply back pressure
+        : std::chrono::duration_cast<std::chrono::milliseconds>(processor->getSchedulingPeriodNano());
+    if (shouldYield && wait_time > 0ms && !hasWorkToDo(processor)) {
+      // Data arriving on the incoming connections wakes the processor up
+      return utils::TaskRescheduleInfo::RetryOnNotificationOrIn(wait_time);
+    }
+    return utils::TaskRescheduleInfo::RetryIn(wait_time);
   }
   return utils::TaskRescheduleInfo::Done();
 }
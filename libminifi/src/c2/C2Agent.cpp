@@ -18,6 +18,7 @@
 
 #include "c2/C2Agent.h"
 
+#include <algorithm>
 #include <cinttypes>
 #include <cstdio>
 #include <csignal>
@@ -35,6 +36,7 @@
 #include "core/state/UpdateController.h"
 #include "core/logging/Logger.h"
 #include "core/logging/LoggerConfiguration.h"
+#include "provenance/Provenance.h"
 #include "utils/file/FileUtils.h"
 #include "utils/file/FileManager.h"
 #include "utils/file/FileSystem.h"
@@ -551,6 +553,52 @@ void C2Agent::handle_describe(const C2ContentResponse &resp) {
     response.addPayload(std::move(states));
     enqueue_c2_response(std::move(response));
     return;
+  } else if (resp.name == "provenance") {
+    C2Payload response(Operation::ACKNOWLEDGE, resp.ident, true);
+    response.setLabel("provenance");
+    C2Payload events(Operation::ACKNOWLEDGE, resp.ident, true);
+    events.setLabel("provenance");
+    std::map<std::string, std::string> arguments;
+    for (const auto& argument : resp.operation_arguments) {
+      arguments[argument.first] = argument.second.to_string();
+    }
+    const auto query = provenance::ProvenanceQuery::parse(arguments);
+    const auto result = query ? update_sink_->queryProvenance(*query) : std::nullopt;
+    if (!query) {
+      logger_->log_error("Invalid arguments of the provenance query");
+    } else if (!result) {
+      logger_->log_error("The provenance repository cannot be queried");
+    } else {
+      for (const auto& event : *result) {
+        C2Payload event_payload(Operation::ACKNOWLEDGE, resp.ident, true);
+        event_payload.setLabel(event->getEventId().to_string());
+        const auto join_uuids = [](const std::vector<utils::Identifier>& uuids) {
+          std::vector<std::string> strings;
+          std::transform(uuids.begin(), uuids.end(), std::back_inserter(strings), [](const utils::Identifier& uuid) { return std::string(uuid.to_string()); });
+          return utils::StringUtils::join(",", strings);
+        };
+        const std::map<std::string, std::string> fields{
+          {"eventType", provenance::ProvenanceEventRecord::ProvenanceEventTypeStr[event->getEventType()]},
+          {"eventTime", std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(event->getEventTime().time_since_epoch()).count())},
+          {"componentId", event->getComponentId()},
+          {"componentType", event->getComponentType()},
+          {"flowFileUuid", event->getFlowFileUuid().to_string()},
+          {"details", event->getDetails()},
+          {"parentUuids", join_uuids(event->getParentUuids())},
+          {"childUuids", join_uuids(event->getChildrenUuids())}
+        };
+        for (const auto& field : fields) {
+          C2ContentResponse entry(Operation::ACKNOWLEDGE);
+          entry.name = field.first;
+          entry.operation_arguments[field.first] = field.second;
+          event_payload.addContent(std::move(entry));
+        }
+        events.addPayload(std::move(event_payload));
+      }
+    }
+    response.addPayload(std::move(events));
+    enqueue_c2_response(std::move(response));
+    return;
   }
   C2Payload response(Operation::ACKNOWLEDGE, resp.ident, true);
   enqueue_c2_response(std::move(response));
@@ -76,44 +76,16 @@ void C2Client::initialize(core::controller::ControllerServiceProvider *controlle
 
   // root_response_nodes_ was not cleared before, it is unclear if that was intentional
 
-  std::map<std::string, std::shared_ptr<Connection>> connections;
-  if (root_ != nullptr) {
-    root_->getConnections(connections);
-  }
-
   std::string class_csv;
   if (configuration_->get("nifi.c2.root.classes", class_csv)) {
     std::vector<std::string> classes = utils::StringUtils::split(class_csv, ",");
 
     for (const std::string& clazz : classes) {
-      auto response_node = std::dynamic_pointer_cast<state::response::ResponseNode>(core::ClassLoader::getDefaultClassLoader().instantiate(clazz, clazz));
+      auto response_node = createResponseNode(clazz, update_sink);
       if (nullptr == response_node) {
         logger_->log_error("No metric defined for %s", clazz);
         continue;
       }
-      auto identifier = std::dynamic_pointer_cast<state::response::AgentIdentifier>(response_node);
-      if (identifier != nullptr) {
-        identifier->setAgentIdentificationProvider(configuration_);
-      }
-      auto monitor = std::dynamic_pointer_cast<state::response::AgentMonitor>(response_node);
-      if (monitor != nullptr) {
-        monitor->addRepository(provenance_repo_);
-        monitor->addRepository(flow_file_repo_);
-        monitor->setStateMonitor(update_sink);
-      }
-      auto configuration_checksums = std::dynamic_pointer_cast<state::response::ConfigurationChecksums>(response_node);
-      if (configuration_checksums) {
-        configuration_checksums->addChecksumCalculator(configuration_->getChecksumCalculator());
-        configuration_checksums->addChecksumCalculator(flow_configuration_->getChecksumCalculator());
-      }
-      auto flowMonitor = std::dynamic_pointer_cast<state::response::FlowMonitor>(response_node);
-      if (flowMonitor != nullptr) {
-        for (auto &con : connections) {
-          flowMonitor->addConnection(con.second);
-        }
-        flowMonitor->setStateMonitor(update_sink);
-        flowMonitor->setFlowVersion(flow_configuration_->getFlowVersion());
-      }
       std::lock_guard<std::mutex> guard(metrics_mutex_);
       root_response_nodes_[response_node->getName()] = response_node;
     }
@@ -132,6 +104,57 @@ void C2Client::initialize(core::controller::ControllerServiceProvider *controlle
   }
 }
 
+std::shared_ptr<state::response::ResponseNode> C2Client::createResponseNode(const std::string& clazz, const std::shared_ptr<state::StateMonitor>& update_sink) const {
+  auto response_node = std::dynamic_pointer_cast<state::response::ResponseNode>(core::ClassLoader::getDefaultClassLoader().instantiate(clazz, clazz));
+  if (nullptr == response_node) {
+    return nullptr;
+  }
+
+  std::map<std::string, std::shared_ptr<Connection>> connections;
+  if (root_ != nullptr) {
+    root_->getConnections(connections);
+  }
+
+  auto identifier = std::dynamic_pointer_cast<state::response::AgentIdentifier>(response_node);
+  if (identifier != nullptr) {
+    identifier->setAgentIdentificationProvider(configuration_);
+  }
+  auto monitor = std::dynamic_pointer_cast<state::response::AgentMonitor>(response_node);
+  if (monitor != nullptr) {
+    monitor->addRepository(provenance_repo_);
+    monitor->addRepository(flow_file_repo_);
+    monitor->setStateMonitor(update_sink);
+  }
+  auto configuration_checksums = std::dynamic_pointer_cast<state::response::ConfigurationChecksums>(response_node);
+  if (configuration_checksums) {
+    configuration_checksums->addChecksumCalculator(configuration_->getChecksumCalculator());
+    configuration_checksums->addChecksumCalculator(flow_configuration_->getChecksumCalculator());
+  }
+  auto state_monitor_node = std::dynamic_pointer_cast<state::response::StateMonitorNode>(response_node);
+  if (state_monitor_node != nullptr) {
+    state_monitor_node->setStateMonitor(update_sink);
+  }
+  auto flowMonitor = std::dynamic_pointer_cast<state::response::FlowMonitor>(response_node);
+  if (flowMonitor != nullptr) {
+    for (auto &con : connections) {
+      flowMonitor->addConnection(con.second);
+    }
+    flowMonitor->setFlowVersion(flow_configuration_->getFlowVersion());
+  }
+  auto queue_metrics = std::dynamic_pointer_cast<state::response::QueueMetrics>(response_node);
+  if (queue_metrics != nullptr) {
+    for (auto &con : connections) {
+      queue_metrics->addConnection(con.second);
+    }
+  }
+  auto repository_metrics = std::dynamic_pointer_cast<state::response::RepositoryMetrics>(response_node);
+  if (repository_metrics != nullptr) {
+    repository_metrics->addRepository(provenance_repo_);
+    repository_metrics->addRepository(flow_file_repo_);
+  }
+  return response_node;
+}
+
 std::optional<std::string> C2Client::fetchFlow(const std::string& uri) const {
   if (!c2_agent_) {
     return {};
@@ -19,11 +19,13 @@
 #include "c2/ControllerSocketProtocol.h"
 
 #include <fstream>
+#include <map>
 #include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "provenance/Provenance.h"
 #include "utils/gsl.h"
 #include "utils/StringUtils.h"
 #include "core/Resource.h"
@@ -232,6 +234,46 @@ void ControllerSocketProtocol::initialize(core::controller::ControllerServicePro
               resp.write(conn);
             }
             stream->write(resp.getBuffer(), resp.size());
+          } else if (what == "provenance") {
+            uint16_t argument_count = 0;
+            if (io::isError(stream->read(argument_count))) {
+              logger_->log_debug("Connection broke");
+              break;
+            }
+            std::map<std::string, std::string> arguments;
+            bool broken = false;
+            for (uint16_t i = 0; i < argument_count && !broken; ++i) {
+              std::string name;
+              std::string value;
+              broken = io::isError(stream->read(name)) || io::isError(stream->read(value));
+              arguments[name] = value;
+            }
+            if (broken) {
+              logger_->log_debug("Connection broke");
+              break;
+            }
+            const auto query = provenance::ProvenanceQuery::parse(arguments);
+            const auto result = query ? update_sink_->queryProvenance(*query) : std::nullopt;
+            io::BufferStream resp;
+            resp.write(&head, 1);
+            if (!query) {
+              resp.write("Invalid arguments of the provenance query");
+            } else if (!result) {
+              resp.write("The provenance repository cannot be queried");
+            } else {
+              resp.write("");
+              resp.write(static_cast<uint64_t>(result->size()));
+              for (const auto& event : *result) {
+                resp.write(event->getEventId());
+                resp.write(provenance::ProvenanceEventRecord::ProvenanceEventTypeStr[event->getEventType()]);
+                resp.write(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(event->getEventTime().time_since_epoch()).count()));
+                resp.write(event->getComponentId());
+                resp.write(event->getComponentType());
+                resp.write(event->getFlowFileUuid());
+                resp.write(event->getDetails());
+              }
+            }
+            stream->write(resp.getBuffer(), resp.size());
           }
         }
         break;
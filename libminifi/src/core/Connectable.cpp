@@ -127,20 +127,33 @@ void Connectable::waitForWork(uint64_t timeoutMs) {
 }
 
 void Connectable::notifyWork() {
-  // Do nothing if we are not event-driven
+  std::function<void()> work_notification_callback;
+  {
+    std::lock_guard<std::mutex> lock(work_available_mutex_);
+    work_notification_callback = work_notification_callback_;
+  }
+  // called without holding the lock, as it runs on every put into an incoming connection
+  if (work_notification_callback) {
+    work_notification_callback();
+  }
+
+  // Do nothing else if we are not event-driven
   if (strategy_ != EVENT_DRIVEN) {
     return;
   }
 
-  {
-    has_work_.store(isWorkAvailable());
-
-    if (has_work_.load()) {
-      work_condition_.notify_one();
-    }
+  const bool has_work = isWorkAvailable();
+  has_work_.store(has_work);
+  if (has_work) {
+    work_condition_.notify_one();
   }
 }
 
+void Connectable::setWorkNotificationCallback(std::function<void()> callback) {
+  std::lock_guard<std::mutex> lock(work_available_mutex_);
+  work_notification_callback_ = std::move(callback);
+}
+
 std::set<std::shared_ptr<Connectable>> Connectable::getOutGoingConnections(const std::string &relationship) const {
   std::set<std::shared_ptr<Connectable>> empty;
 
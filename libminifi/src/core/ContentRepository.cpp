@@ -22,6 +22,9 @@
 
 #include "core/ContentRepository.h"
 #include "core/ContentSession.h"
+#include "core/Property.h"
+#include "Exception.h"
+#include "utils/gsl.h"
 
 namespace org {
 namespace apache {
@@ -39,7 +42,20 @@ void ContentRepository::reset() {
 }
 
 std::shared_ptr<ContentSession> ContentRepository::createSession() {
-  return std::make_shared<ContentSession>(sharedFromThis());
+  return std::make_shared<ContentSession>(sharedFromThis(), session_spill_threshold_);
+}
+
+void ContentRepository::readSessionSpillThreshold(const Configure& configure) {
+  session_spill_threshold_.reset();
+  std::string value;
+  if (!configure.get(Configure::nifi_content_repository_session_spill_threshold, value)) {
+    return;
+  }
+  uint64_t threshold = 0;
+  if (!core::Property::StringToInt(value, threshold)) {
+    throw Exception(REPOSITORY_EXCEPTION, "Invalid content session spill threshold: " + value);
+  }
+  session_spill_threshold_ = gsl::narrow<size_t>(threshold);
 }
 
 uint32_t ContentRepository::getStreamCount(const minifi::ResourceClaim &streamId) {
@@ -17,10 +17,12 @@
  */
 
 #include <memory>
+#include <utility>
 #include "core/ContentRepository.h"
 #include "core/ContentSession.h"
 #include "ResourceClaim.h"
 #include "io/BaseStream.h"
+#include "io/StreamPipe.h"
 #include "Exception.h"
 #include "utils/gsl.h"
 
@@ -30,11 +32,78 @@ namespace nifi {
 namespace minifi {
 namespace core {
 
-ContentSession::ContentSession(std::shared_ptr<ContentRepository> repository) : repository_(std::move(repository)) {}
+ContentSession::ContentSession(std::shared_ptr<ContentRepository> repository, std::optional<size_t> spill_threshold)
+    : repository_(std::move(repository)),
+      spill_threshold_(spill_threshold) {}
+
+ContentSession::StagedStream::StagedStream(std::shared_ptr<ContentRepository> repository, std::shared_ptr<ResourceClaim> pending_claim, std::optional<size_t> spill_threshold)
+    : repository_(std::move(repository)),
+      pending_claim_(std::move(pending_claim)),
+      spill_threshold_(spill_threshold) {}
+
+size_t ContentSession::StagedStream::write(const uint8_t* data, size_t len) {
+  if (spill_threshold_ && buffer_.size() + len >= *spill_threshold_) {
+    if (!spill() || pending_stream_->write(data, len) != len) {
+      return io::STREAM_ERROR;
+    }
+  } else {
+    buffer_.write(data, len);
+  }
+  size_ += len;
+  return len;
+}
+
+bool ContentSession::StagedStream::spill() {
+  if (!pending_stream_) {
+    pending_stream_ = openPendingStream();
+    if (!pending_stream_) {
+      return false;
+    }
+  }
+  const auto size = buffer_.size();
+  if (size > 0 && pending_stream_->write(buffer_.getBuffer(), size) != size) {
+    return false;
+  }
+  // keeps the capacity, the buffer never grows beyond the spill threshold
+  buffer_.initialize();
+  return true;
+}
+
+std::shared_ptr<io::BaseStream> ContentSession::StagedStream::openPendingStream() {
+  if (!pending_claim_) {
+    pending_claim_ = std::make_shared<ResourceClaim>(repository_);
+  }
+  return repository_->write(*pending_claim_);
+}
+
+void ContentSession::StagedStream::flush() {
+  gsl_Expects(pending_stream_);
+  if (!spill()) {
+    throw Exception(REPOSITORY_EXCEPTION, "Failed to write staged content: " + pending_claim_->getContentFullPath());
+  }
+  pending_stream_->close();
+}
+
+void ContentSession::StagedStream::discard() {
+  if (pending_stream_) {
+    pending_stream_->close();
+    pending_stream_.reset();
+  }
+  buffer_.initialize();
+  pending_claim_.reset();
+}
+
+std::shared_ptr<ContentSession::StagedStream> ContentSession::createStagedStream(std::shared_ptr<ResourceClaim> pending_claim) const {
+  return std::make_shared<StagedStream>(repository_, std::move(pending_claim), spill_threshold_);
+}
+
+std::shared_ptr<ContentSession::StagedStream> ContentSession::createExtensionStream() const {
+  return createStagedStream(nullptr);
+}
 
 std::shared_ptr<ResourceClaim> ContentSession::create() {
   std::shared_ptr<ResourceClaim> claim = std::make_shared<ResourceClaim>(repository_);
-  managedResources_[claim] = std::make_shared<io::BufferStream>();
+  managedResources_[claim] = createStagedStream(claim);
   return claim;
 }
 
@@ -46,12 +115,18 @@ std::shared_ptr<io::BaseStream> ContentSession::write(const std::shared_ptr<Reso
     }
     auto& extension = extendedResources_[resourceId];
     if (!extension) {
-      extension = std::make_shared<io::BufferStream>();
+      // appended content is spilled into a separate claim, the original one
+      // must remain untouched until the session is committed
+      extension = createExtensionStream();
     }
     return extension;
   }
   if (mode == WriteMode::OVERWRITE) {
-    it->second = std::make_shared<io::BufferStream>();
+    if (it->second->isSpilled()) {
+      it->second->discard();
+      repository_->remove(*resourceId);
+    }
+    it->second = createStagedStream(resourceId);
   }
   return it->second;
 }
@@ -66,8 +141,30 @@ std::shared_ptr<io::BaseStream> ContentSession::read(const std::shared_ptr<Resou
   return repository_->read(*resourceId);
 }
 
+void ContentSession::appendSpilledContent(const std::shared_ptr<ResourceClaim>& resource, StagedStream& extension) const {
+  extension.flush();
+  auto outStream = repository_->write(*resource, true);
+  if (outStream == nullptr) {
+    throw Exception(REPOSITORY_EXCEPTION, "Couldn't open the underlying resource for append: " + resource->getContentFullPath());
+  }
+  auto inStream = repository_->read(*extension.getPendingClaim());
+  if (inStream == nullptr) {
+    throw Exception(REPOSITORY_EXCEPTION, "Couldn't open the staged content: " + extension.getPendingClaim()->getContentFullPath());
+  }
+  if (minifi::internal::pipe(inStream, outStream) != gsl::narrow<int64_t>(extension.size())) {
+    throw Exception(REPOSITORY_EXCEPTION, "Failed to append to resource: " + resource->getContentFullPath());
+  }
+  // the session-owned claim is removed from the repository once released
+  extension.discard();
+}
+
 void ContentSession::commit() {
   for (const auto& resource : managedResources_) {
+    if (resource.second->isSpilled()) {
+      // the content has already been streamed into the claim, it only needs to be completed
+      resource.second->flush();
+      continue;
+    }
     auto outStream = repository_->write(*resource.first);
     if (outStream == nullptr) {
       throw Exception(REPOSITORY_EXCEPTION, "Couldn't open the underlying resource for write: " + resource.first->getContentFullPath());
@@ -79,6 +176,10 @@ void ContentSession::commit() {
     }
   }
   for (const auto& resource : extendedResources_) {
+    if (resource.second->isSpilled()) {
+      appendSpilledContent(resource.first, *resource.second);
+      continue;
+    }
     auto outStream = repository_->write(*resource.first, true);
     if (outStream == nullptr) {
       throw Exception(REPOSITORY_EXCEPTION, "Couldn't open the underlying resource for append: " + resource.first->getContentFullPath());
@@ -95,6 +196,15 @@ void ContentSession::commit() {
 }
 
 void ContentSession::rollback() {
+  for (const auto& resource : managedResources_) {
+    if (resource.second->isSpilled()) {
+      resource.second->discard();
+      repository_->remove(*resource.first);
+    }
+  }
+  for (const auto& resource : extendedResources_) {
+    resource.second->discard();
+  }
   managedResources_.clear();
   extendedResources_.clear();
 }
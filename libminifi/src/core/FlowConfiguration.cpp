@@ -160,7 +160,17 @@ std::unique_ptr<core::ProcessGroup> FlowConfiguration::createRemoteProcessGroup(
 }
 
 std::shared_ptr<minifi::Connection> FlowConfiguration::createConnection(const std::string& name, const utils::Identifier& uuid) const {
-  return std::make_shared<minifi::Connection>(flow_file_repo_, content_repo_, name, uuid);
+  auto connection = std::make_shared<minifi::Connection>(flow_file_repo_, content_repo_, name, uuid);
+  std::string swap_threshold_str;
+  if (configuration_ && configuration_->get(minifi::Configure::nifi_queue_swap_threshold, swap_threshold_str)) {
+    uint64_t swap_threshold = 0;
+    if (!core::Property::StringToInt(swap_threshold_str, swap_threshold)) {
+      logger_->log_warn("Invalid queue swap threshold: %s, queued flow files are not swapped out", swap_threshold_str);
+    } else if (swap_threshold > 0) {
+      connection->setSwapThreshold(swap_threshold, configuration_->get(minifi::Configure::nifi_queue_swap_directory).value_or(minifi::Connection::DEFAULT_SWAP_DIRECTORY));
+    }
+  }
+  return connection;
 }
 
 std::shared_ptr<core::controller::ControllerServiceNode> FlowConfiguration::createControllerService(const std::string &class_name, const std::string &full_class_name, const std::string &name,
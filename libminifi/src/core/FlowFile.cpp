@@ -40,7 +40,6 @@ FlowFile::FlowFile()
     : CoreComponent("FlowFile"),
       stored(false),
       marked_delete_(false),
-      last_queue_date_(0),
       size_(0),
       id_(0),
       offset_(0),
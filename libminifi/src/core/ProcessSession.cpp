@@ -268,6 +268,20 @@ void ProcessSession::write(const std::shared_ptr<core::FlowFile> &flow, OutputSt
   }
 }
 
+void ProcessSession::attachContent(const std::shared_ptr<core::FlowFile> &flow, const std::shared_ptr<ResourceClaim> &claim, uint64_t size) {
+  auto flow_file_equality_checker = [&flow](const auto& flow_file) { return flow == flow_file; };
+  gsl_ExpectsAudit(_updatedFlowFiles.contains(flow->getUUID())
+      || _addedFlowFiles.contains(flow->getUUID())
+      || std::any_of(_clonedFlowFiles.begin(), _clonedFlowFiles.end(), flow_file_equality_checker));
+
+  flow->setSize(size);
+  flow->setOffset(0);
+  flow->setResourceClaim(claim);
+
+  std::string details = process_context_->getProcessorNode()->getName() + " modify flow record content " + flow->getUUIDStr();
+  provenance_report_->modifyContent(flow, details, std::chrono::milliseconds(0));
+}
+
 void ProcessSession::writeBuffer(const std::shared_ptr<core::FlowFile>& flow_file, gsl::span<const char> buffer) {
   struct BufferOutputStreamCallback : OutputStreamCallback {
     explicit BufferOutputStreamCallback(gsl::span<const char> buffer) :buffer{buffer} {}
@@ -852,7 +866,15 @@ void ProcessSession::commit() {
       if (!record->isDeleted()) {
         continue;
       }
-      if (record->isStored() && process_context_->getFlowFileRepository()->Delete(record->getUUIDStr())) {
+      if (!record->isStored()) {
+        continue;
+      }
+      // the persisted record references the claim of the snapshot taken when the FlowFile was acquired
+      auto snapshotIt = _updatedFlowFiles.find(record->getUUID());
+      const bool deleted = snapshotIt != _updatedFlowFiles.end()
+          ? process_context_->getFlowFileRepository()->Delete(record->getUUIDStr(), snapshotIt->second.snapshot->getResourceClaim())
+          : process_context_->getFlowFileRepository()->Delete(record->getUUIDStr());
+      if (deleted) {
         // mark for deletion in the flowFileRepository
         record->setStoredToRepository(false);
       }
@@ -879,6 +901,18 @@ void ProcessSession::commit() {
       }
     }
 
+    // all of the updated FlowFiles were taken from the incoming connections
+    for (const auto& it : _updatedFlowFiles) {
+      ++transfer_statistics_.incoming_flow_files;
+      transfer_statistics_.incoming_bytes += it.second.snapshot->getSize();
+    }
+    for (const auto& cq : connectionQueues) {
+      for (const auto& record : cq.second) {
+        ++transfer_statistics_.outgoing_flow_files;
+        transfer_statistics_.outgoing_bytes += record->getSize();
+      }
+    }
+
     // All done
     _updatedFlowFiles.clear();
     _addedFlowFiles.clear();
@@ -925,7 +959,7 @@ void ProcessSession::rollback() {
     for (auto& cq : connectionQueues) {
       auto connection = std::dynamic_pointer_cast<Connection>(cq.first);
       if (connection) {
-        connection->multiPut(cq.second);
+        connection->requeue(cq.second);
       } else {
         for (auto& flow : cq.second) {
           cq.first->put(flow);
@@ -961,6 +995,7 @@ void ProcessSession::persistFlowFilesBeforeTransfer(
 
   auto flowFileRepo = process_context_->getFlowFileRepository();
   auto contentRepo = process_context_->getContentRepository();
+  auto recordDictionary = flowFileRepo->getRecordDictionary();
 
   for (auto& transaction : transactionMap) {
     const std::shared_ptr<Connectable>& target = transaction.first;
@@ -974,7 +1009,7 @@ void ProcessSession::persistFlowFilesBeforeTransfer(
       }
 
       std::unique_ptr<io::BufferStream> stream(new io::BufferStream());
-      std::static_pointer_cast<FlowFileRecord>(ff)->Serialize(*stream);
+      std::static_pointer_cast<FlowFileRecord>(ff)->Serialize(*stream, recordDictionary);
 
       flowData.emplace_back(ff->getUUIDStr(), std::move(stream));
     }
@@ -996,9 +1031,9 @@ void ProcessSession::persistFlowFilesBeforeTransfer(
       auto original = snapshotIt != modifiedFlowFiles.end() ? snapshotIt->second.snapshot : nullptr;
       if (shouldDropEmptyFiles && ff->getSize() == 0) {
         // the receiver promised to drop this FF, no need for it anymore
-        if (ff->isStored() && flowFileRepo->Delete(ff->getUUIDStr())) {
-          // original must be non-null since this flowFile is already stored in the repos ->
-          // must have come from a session->get()
+        // original must be non-null since this flowFile is already stored in the repos ->
+        // must have come from a session->get()
+        if (ff->isStored() && flowFileRepo->Delete(ff->getUUIDStr(), original ? original->getResourceClaim() : nullptr)) {
           assert(original);
           ff->setStoredToRepository(false);
         }
@@ -1052,7 +1087,7 @@ std::shared_ptr<core::FlowFile> ProcessSession::get() {
         details << process_context_->getProcessorNode()->getName() << " expire flow record " << record->getUUIDStr();
         provenance_report_->expire(record, details.str());
         // there is no rolling back expired FlowFiles
-        if (record->isStored() && process_context_->getFlowFileRepository()->Delete(record->getUUIDStr())) {
+        if (record->isStored() && process_context_->getFlowFileRepository()->Delete(record->getUUIDStr(), record->getResourceClaim())) {
           record->setStoredToRepository(false);
         }
       }
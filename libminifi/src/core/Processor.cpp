@@ -219,10 +219,19 @@ bool Processor::flowFilesOutGoingFull() const {
 
 void Processor::onTrigger(ProcessContext *context, ProcessSessionFactory *sessionFactory) {
   auto session = sessionFactory->createSession();
+  const auto start = std::chrono::steady_clock::now();
+  const auto run_duration_end = start + getRunDurationNano();
+  // the failed tasks are measured as well, with the FlowFiles committed by their session before failing
+  const auto record_task = gsl::finally([&] {
+    metrics_.recordTask(std::chrono::steady_clock::now() - start, session->getTransferStatistics());
+  });
 
   try {
-    // Call the virtual trigger function
-    onTrigger(context, session.get());
+    // Call the virtual trigger function, repeatedly with the same session until the run duration elapses if the processor
+    // supports batching, so that the cost of the commit is shared by the flow files of several triggers
+    do {
+      onTrigger(context, session.get());
+    } while (shouldContinueTriggering(run_duration_end));
     session->commit();
   } catch (std::exception &exception) {
     logger_->log_warn("Caught \"%s\" (%s) during Processor::onTrigger of processor: %s (%s)",
@@ -238,10 +247,19 @@ void Processor::onTrigger(ProcessContext *context, ProcessSessionFactory *sessio
 
 void Processor::onTrigger(const std::shared_ptr<ProcessContext> &context, const std::shared_ptr<ProcessSessionFactory> &sessionFactory) {
   auto session = sessionFactory->createSession();
+  const auto start = std::chrono::steady_clock::now();
+  const auto run_duration_end = start + getRunDurationNano();
+  // the failed tasks are measured as well, with the FlowFiles committed by their session before failing
+  const auto record_task = gsl::finally([&] {
+    metrics_.recordTask(std::chrono::steady_clock::now() - start, session->getTransferStatistics());
+  });
 
   try {
-    // Call the virtual trigger function
-    onTrigger(context, session);
+    // Call the virtual trigger function, repeatedly with the same session until the run duration elapses if the processor
+    // supports batching, so that the cost of the commit is shared by the flow files of several triggers
+    do {
+      onTrigger(context, session);
+    } while (shouldContinueTriggering(run_duration_end));
     session->commit();
   } catch (std::exception &exception) {
     logger_->log_warn("Caught \"%s\" (%s) during Processor::onTrigger of processor: %s (%s)",
@@ -255,6 +273,20 @@ void Processor::onTrigger(const std::shared_ptr<ProcessContext> &context, const
   }
 }
 
+bool Processor::shouldContinueTriggering(std::chrono::steady_clock::time_point run_duration_end) {
+  if (!supportsBatching() || getRunDurationNano() == 0ns || std::chrono::steady_clock::now() >= run_duration_end) {
+    return false;
+  }
+  if (!isRunning() || isYield()) {
+    return false;
+  }
+  // the flow files transferred by the session only reach the outgoing connections on commit, this only stops on backpressure which was already there
+  if (isThrottledByBackpressure()) {
+    return false;
+  }
+  return !hasIncomingConnections() || isWorkAvailable();
+}
+
 bool Processor::isWorkAvailable() {
   // We have work if any incoming connection has work
   std::lock_guard<std::mutex> lock(mutex_);
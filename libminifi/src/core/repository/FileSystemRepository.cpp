@@ -17,10 +17,22 @@
  */
 
 #include "core/repository/FileSystemRepository.h"
+#include <algorithm>
+#include <charconv>
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+#include <limits>
 #include <memory>
+#include <set>
 #include <string>
+#include <utility>
+#include <vector>
+#include "core/Property.h"
 #include "io/FileStream.h"
+#include "io/StreamPipe.h"
 #include "utils/file/FileUtils.h"
+#include "utils/gsl.h"
 
 namespace org {
 namespace apache {
@@ -29,6 +41,152 @@ namespace minifi {
 namespace core {
 namespace repository {
 
+namespace {
+
+constexpr uint64_t UNFINISHED_RECORD = std::numeric_limits<uint64_t>::max();
+
+std::optional<uint64_t> parseSegmentId(const std::string& filename) {
+  uint64_t segment_id = 0;
+  const auto result = std::from_chars(filename.data(), filename.data() + filename.size(), segment_id);
+  if (result.ec != std::errc() || result.ptr != filename.data() + filename.size()) {
+    return std::nullopt;
+  }
+  return segment_id;
+}
+
+/**
+ * Read-only view of a single claim inside a segment file
+ */
+class ClaimSliceStream : public io::BaseStream {
+ public:
+  ClaimSliceStream(std::shared_ptr<io::BaseStream> stream, size_t offset, size_t length)
+      : stream_(std::move(stream)),
+        offset_(offset),
+        length_(length) {
+    stream_->seek(offset_);
+  }
+
+  using BaseStream::read;
+  using BaseStream::write;
+
+  size_t read(uint8_t* buf, size_t buflen) override {
+    const size_t max_size = std::min(buflen, length_ - tell());
+    if (max_size == 0) {
+      return 0;
+    }
+    return stream_->read(buf, max_size);
+  }
+
+  size_t write(const uint8_t* /*value*/, size_t /*size*/) override {
+    return io::STREAM_ERROR;
+  }
+
+  void seek(size_t offset) override {
+    stream_->seek(offset_ + std::min(offset, length_));
+  }
+
+  size_t tell() const override {
+    return stream_->tell() - offset_;
+  }
+
+  size_t size() const override {
+    return length_;
+  }
+
+  void close() override {
+    stream_->close();
+  }
+
+ private:
+  std::shared_ptr<io::BaseStream> stream_;
+  size_t offset_;
+  size_t length_;
+};
+
+}  // namespace
+
+/**
+ * Writes a single record into a segment, the record is published when the stream is closed
+ */
+class FileSystemRepository::ContainerOutputStream : public io::BaseStream {
+ public:
+  ContainerOutputStream(std::shared_ptr<FileSystemRepository> repository, std::unique_ptr<SegmentWriter> writer, std::string claim_path)
+      : repository_(std::move(repository)),
+        writer_(std::move(writer)),
+        claim_path_(std::move(claim_path)) {
+    const auto& stream = writer_->stream;
+    const bool header_written = !io::isError(stream->write(claim_path_, true));
+    length_position_ = stream->tell();
+    failed_ = !header_written || stream->write(UNFINISHED_RECORD) != sizeof(uint64_t);
+    content_offset_ = stream->tell();
+  }
+
+  ~ContainerOutputStream() override {
+    close();
+  }
+
+  using BaseStream::read;
+  using BaseStream::write;
+
+  size_t write(const uint8_t* value, size_t size) override {
+    if (!writer_ || failed_) {
+      return io::STREAM_ERROR;
+    }
+    if (size == 0) {
+      return 0;
+    }
+    const auto ret = writer_->stream->write(value, size);
+    if (ret != size) {
+      failed_ = true;
+      return io::STREAM_ERROR;
+    }
+    length_ += size;
+    return size;
+  }
+
+  size_t read(uint8_t* /*buf*/, size_t /*buflen*/) override {
+    return io::STREAM_ERROR;
+  }
+
+  void seek(size_t /*offset*/) override {}
+
+  size_t tell() const override {
+    return length_;
+  }
+
+  size_t size() const override {
+    return length_;
+  }
+
+  void close() override {
+    if (!writer_) {
+      return;
+    }
+    const auto& stream = writer_->stream;
+    // the length is always filled in so that the records following this one can still be loaded
+    stream->seek(length_position_);
+    const bool length_written = stream->write(static_cast<uint64_t>(length_)) == sizeof(uint64_t);
+    stream->seek(content_offset_ + length_);
+    const ClaimLocation location{writer_->id, content_offset_, length_};
+    // published before the writer is released, so that a full segment is not deleted as unused
+    if (failed_ || !length_written) {
+      repository_->discardRecord(location);
+    } else {
+      repository_->publishRecord(claim_path_, location);
+    }
+    repository_->releaseSegmentWriter(std::move(writer_));
+  }
+
+ private:
+  std::shared_ptr<FileSystemRepository> repository_;
+  std::unique_ptr<SegmentWriter> writer_;
+  std::string claim_path_;
+  size_t length_position_ = 0;
+  size_t content_offset_ = 0;
+  size_t length_ = 0;
+  bool failed_ = false;
+};
+
 bool FileSystemRepository::initialize(const std::shared_ptr<minifi::Configure> &configuration) {
   std::string value;
   if (configuration->get(Configure::nifi_dbcontent_repository_directory_default, value)) {
@@ -37,26 +195,353 @@ bool FileSystemRepository::initialize(const std::shared_ptr<minifi::Configure> &
     directory_ = configuration->getHome();
   }
   utils::file::FileUtils::create_dir(directory_);
+  readSessionSpillThreshold(*configuration);
+
+  max_segment_size_.reset();
+  if (configuration->get(Configure::nifi_content_repository_container_max_size, value)) {
+    uint64_t max_segment_size = 0;
+    if (!core::Property::StringToInt(value, max_segment_size) || max_segment_size == 0) {
+      logger_->log_error("Invalid content container size %s, storing each claim in its own file", value);
+    } else {
+      max_segment_size_ = gsl::narrow<size_t>(max_segment_size);
+    }
+  }
+  if (isContainerMode()) {
+    logger_->log_info("Appending claims into content containers of %zu bytes", *max_segment_size_);
+    utils::file::FileUtils::create_dir(getContainerDirectory());
+    loadSegments();
+  }
   return true;
 }
+
 void FileSystemRepository::stop() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  stopped_ = true;
+  for (const auto& writer : idle_writers_) {
+    writer->stream->close();
+  }
+  idle_writers_.clear();
+  // the records being written fail and are discarded, their segments are closed when the writers are released
+  for (const auto& writer : busy_writers_) {
+    writer.second->close();
+  }
+}
+
+std::string FileSystemRepository::getContainerDirectory() const {
+  return utils::file::FileUtils::concat_path(directory_, "containers");
+}
+
+std::string FileSystemRepository::getTombstonePath(const std::string& segment_path) const {
+  return segment_path + ".removed";
+}
+
+void FileSystemRepository::loadSegments() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  claim_locations_.clear();
+  segments_.clear();
+  idle_writers_.clear();
+  busy_writers_.clear();
+  stopped_ = false;
+  next_segment_id_ = 0;
+  utils::file::FileUtils::list_dir(getContainerDirectory(), [this] (const std::string& dir, const std::string& filename) {
+    const auto segment_id = parseSegmentId(filename);
+    if (!segment_id) {
+      // tombstones and unrelated files
+      return true;
+    }
+    loadSegment(*segment_id, utils::file::FileUtils::concat_path(dir, filename));
+    next_segment_id_ = std::max(next_segment_id_, *segment_id + 1);
+    return true;
+  }, logger_, false);
+
+  std::vector<uint64_t> unused_segments;
+  for (const auto& segment : segments_) {
+    if (segment.second.live_claims == 0) {
+      unused_segments.push_back(segment.first);
+    }
+  }
+  for (const auto segment_id : unused_segments) {
+    deleteSegment(segment_id);
+  }
+  logger_->log_debug("Loaded %zu claims from %zu content containers", claim_locations_.size(), segments_.size());
+}
+
+void FileSystemRepository::loadSegment(uint64_t segment_id, const std::string& path) {
+  std::set<uint64_t> removed_offsets;
+  const auto tombstone_path = getTombstonePath(path);
+  if (utils::file::FileUtils::exists(tombstone_path)) {
+    io::FileStream tombstones(tombstone_path, 0, false);
+    uint64_t offset = 0;
+    while (tombstones.read(offset) == sizeof(offset)) {
+      removed_offsets.insert(offset);
+    }
+  }
+
+  // segments of a previous run are never appended to again
+  Segment& segment = segments_[segment_id];
+  segment.path = path;
+  segment.sealed = true;
+
+  io::FileStream stream(path, 0, false);
+  const auto file_size = stream.size();
+  while (stream.tell() < file_size) {
+    std::string claim_path;
+    uint64_t length = 0;
+    if (io::isError(stream.read(claim_path, true)) || stream.read(length) != sizeof(length) || length == UNFINISHED_RECORD) {
+      logger_->log_warn("Content container %s has an incomplete record at its end", path);
+      break;
+    }
+    const auto content_offset = stream.tell();
+    if (content_offset + length > file_size) {
+      logger_->log_warn("Content container %s has a truncated record at its end", path);
+      break;
+    }
+    stream.seek(gsl::narrow<size_t>(content_offset + length));
+    if (removed_offsets.count(content_offset) > 0) {
+      continue;
+    }
+    const ClaimLocation location{segment_id, content_offset, gsl::narrow<size_t>(length)};
+    auto previous = claim_locations_.find(claim_path);
+    if (previous != claim_locations_.end()) {
+      // the claim has been rewritten without its removal being recorded, the latest record wins,
+      // unused segments are deleted after all of them have been loaded
+      --segments_[previous->second.segment_id].live_claims;
+      previous->second = location;
+    } else {
+      claim_locations_.emplace(claim_path, location);
+    }
+    ++segment.live_claims;
+  }
+}
+
+std::unique_ptr<FileSystemRepository::SegmentWriter> FileSystemRepository::acquireSegmentWriter() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!idle_writers_.empty()) {
+    auto writer = std::move(idle_writers_.back());
+    idle_writers_.pop_back();
+    busy_writers_.emplace(writer->id, writer->stream);
+    return writer;
+  }
+  const uint64_t segment_id = next_segment_id_++;
+  const auto path = utils::file::FileUtils::concat_path(getContainerDirectory(), std::to_string(segment_id));
+  {
+    std::ofstream create(path, std::ios::binary);
+  }
+  auto stream = std::make_shared<io::FileStream>(path, 0, true);
+  segments_[segment_id].path = path;
+  busy_writers_.emplace(segment_id, stream);
+  return std::make_unique<SegmentWriter>(SegmentWriter{segment_id, std::move(stream)});
+}
+
+void FileSystemRepository::releaseSegmentWriter(std::unique_ptr<SegmentWriter> writer) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  busy_writers_.erase(writer->id);
+  if (!stopped_ && writer->stream->size() < *max_segment_size_) {
+    idle_writers_.push_back(std::move(writer));
+    return;
+  }
+  auto segment = segments_.find(writer->id);
+  writer->stream->close();
+  if (segment == segments_.end()) {
+    return;
+  }
+  segment->second.sealed = true;
+  logger_->log_debug("Content container %s is full", segment->second.path);
+  if (segment->second.live_claims == 0) {
+    deleteSegment(writer->id);
+  }
+}
+
+std::shared_ptr<io::BaseStream> FileSystemRepository::writeToContainer(const minifi::ResourceClaim &claim, bool append) {
+  const auto claim_path = claim.getContentFullPath();
+  const auto existing_location = append ? findClaim(claim_path) : std::nullopt;
+  if (append && !existing_location && utils::file::FileUtils::exists(claim_path)) {
+    // a claim stored in its own file before switching to container mode
+    return std::make_shared<io::FileStream>(claim_path, true);
+  }
+  if (existing_location) {
+    return moveToOwnFile(claim, *existing_location);
+  }
+  return std::make_shared<ContainerOutputStream>(std::static_pointer_cast<FileSystemRepository>(sharedFromThis()), acquireSegmentWriter(), claim_path);
+}
+
+std::shared_ptr<io::BaseStream> FileSystemRepository::moveToOwnFile(const minifi::ResourceClaim &claim, const ClaimLocation& location) {
+  // records are immutable, so instead of relocating the claim within the containers on every append,
+  // which would copy its whole content each time, it is moved into its own file and appended to there
+  const auto claim_path = claim.getContentFullPath();
+  auto previous_content = read(claim);
+  auto stream = std::make_shared<io::FileStream>(claim_path, false);
+  if (!previous_content || minifi::internal::pipe(previous_content, stream) != gsl::narrow<int64_t>(location.length)) {
+    logger_->log_error("Failed to move %s out of its content container for append", claim_path);
+    stream->close();
+    std::remove(claim_path.c_str());
+    return nullptr;
+  }
+  std::optional<Tombstone> tombstone;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = claim_locations_.find(claim_path);
+    if (it != claim_locations_.end()) {
+      const auto moved = it->second;
+      claim_locations_.erase(it);
+      tombstone = releaseRecord(moved);
+    }
+  }
+  writeTombstone(tombstone);
+  return stream;
+}
+
+void FileSystemRepository::publishRecord(const std::string& claim_path, const ClaimLocation& location) {
+  std::optional<Tombstone> tombstone;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++segments_[location.segment_id].live_claims;
+    auto it = claim_locations_.find(claim_path);
+    if (it == claim_locations_.end()) {
+      claim_locations_.emplace(claim_path, location);
+      return;
+    }
+    const auto previous = std::exchange(it->second, location);
+    tombstone = releaseRecord(previous);
+  }
+  writeTombstone(tombstone);
+}
+
+void FileSystemRepository::discardRecord(const ClaimLocation& location) {
+  std::optional<Tombstone> tombstone;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++segments_[location.segment_id].live_claims;
+    tombstone = releaseRecord(location);
+  }
+  writeTombstone(tombstone);
+}
+
+std::optional<FileSystemRepository::Tombstone> FileSystemRepository::releaseRecord(const ClaimLocation& location) {
+  auto segment = segments_.find(location.segment_id);
+  if (segment == segments_.end()) {
+    return std::nullopt;
+  }
+  if (--segment->second.live_claims == 0 && segment->second.sealed) {
+    deleteSegment(location.segment_id);
+    return std::nullopt;
+  }
+  if (!segment->second.tombstones) {
+    segment->second.tombstones = std::make_shared<TombstoneFile>(getTombstonePath(segment->second.path));
+  }
+  return Tombstone{segment->second.tombstones, location.offset};
+}
+
+void FileSystemRepository::writeTombstone(const std::optional<Tombstone>& tombstone) {
+  if (tombstone && !tombstone->file->add(tombstone->offset)) {
+    logger_->log_error("Failed to record the removal of a claim at offset %" PRIu64, tombstone->offset);
+  }
+}
+
+void FileSystemRepository::deleteSegment(uint64_t segment_id) {
+  auto segment = segments_.find(segment_id);
+  if (segment == segments_.end()) {
+    return;
+  }
+  logger_->log_debug("Deleting content container %s", segment->second.path);
+  std::remove(segment->second.path.c_str());
+  if (segment->second.tombstones) {
+    // the removals still being recorded must not recreate the file
+    segment->second.tombstones->remove();
+  } else {
+    std::remove(getTombstonePath(segment->second.path).c_str());
+  }
+  segments_.erase(segment);
+}
+
+bool FileSystemRepository::TombstoneFile::add(uint64_t offset) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (removed_) {
+    return true;
+  }
+  io::FileStream stream(path_, true);
+  return stream.write(offset) == sizeof(uint64_t);
+}
+
+void FileSystemRepository::TombstoneFile::remove() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  removed_ = true;
+  std::remove(path_.c_str());
+}
+
+std::optional<FileSystemRepository::ClaimLocation> FileSystemRepository::findClaim(const std::string& claim_path) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = claim_locations_.find(claim_path);
+  if (it == claim_locations_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+size_t FileSystemRepository::getSegmentCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return segments_.size();
 }
 
 std::shared_ptr<io::BaseStream> FileSystemRepository::write(const minifi::ResourceClaim &claim, bool append) {
+  if (isContainerMode()) {
+    return writeToContainer(claim, append);
+  }
   return std::make_shared<io::FileStream>(claim.getContentFullPath(), append);
 }
 
 bool FileSystemRepository::exists(const minifi::ResourceClaim &streamId) {
+  if (isContainerMode() && findClaim(streamId.getContentFullPath())) {
+    return true;
+  }
   std::ifstream file(streamId.getContentFullPath());
   return file.good();
 }
 
 std::shared_ptr<io::BaseStream> FileSystemRepository::read(const minifi::ResourceClaim &claim) {
+  if (isContainerMode()) {
+    std::optional<ClaimLocation> location;
+    std::string segment_path;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = claim_locations_.find(claim.getContentFullPath());
+      if (it != claim_locations_.end()) {
+        location = it->second;
+        auto segment = segments_.find(location->segment_id);
+        if (segment == segments_.end()) {
+          logger_->log_error("The content container of %s has already been deleted", claim.getContentFullPath());
+          return nullptr;
+        }
+        segment_path = segment->second.path;
+      }
+    }
+    if (location) {
+      return std::make_shared<ClaimSliceStream>(std::make_shared<io::FileStream>(segment_path, 0, false), location->offset, location->length);
+    }
+  }
   return std::make_shared<io::FileStream>(claim.getContentFullPath(), 0, false);
 }
 
 bool FileSystemRepository::remove(const minifi::ResourceClaim &claim) {
   logger_->log_debug("Deleting resource %s", claim.getContentFullPath());
+  if (isContainerMode()) {
+    bool in_container = false;
+    std::optional<Tombstone> tombstone;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = claim_locations_.find(claim.getContentFullPath());
+      if (it != claim_locations_.end()) {
+        in_container = true;
+        const auto location = it->second;
+        claim_locations_.erase(it);
+        tombstone = releaseRecord(location);
+      }
+    }
+    if (in_container) {
+      writeTombstone(tombstone);
+      return true;
+    }
+  }
   std::remove(claim.getContentFullPath().c_str());
   return true;
 }
@@ -0,0 +1,148 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "core/state/OpenMetrics.h"
+
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <limits>
+#include <locale>
+#include <map>
+#include <sstream>
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace state {
+
+namespace {
+
+constexpr const char* METRIC_NAME_PREFIX = "minifi_";
+
+bool isNameCharacter(char c, bool first, bool allow_colon) {
+  const bool letter = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || (allow_colon && c == ':');
+  return letter || (!first && c >= '0' && c <= '9');
+}
+
+// metric names may contain colons, label names may not
+std::string sanitizeName(const std::string& name, bool allow_colon) {
+  std::string sanitized = name;
+  for (size_t i = 0; i < sanitized.size(); ++i) {
+    if (!isNameCharacter(sanitized[i], i == 0, allow_colon)) {
+      sanitized[i] = '_';
+    }
+  }
+  return sanitized.empty() ? "_" : sanitized;
+}
+
+void writeLabelValue(std::ostream& output, const std::string& value) {
+  for (const char c : value) {
+    switch (c) {
+      case '\\': output << "\\\\"; break;
+      case '"': output << "\\\""; break;
+      case '\n': output << "\\n"; break;
+      default: output << c;
+    }
+  }
+}
+
+void writeValue(std::ostream& output, double value) {
+  if (std::isnan(value)) {
+    output << "NaN";
+  } else if (std::isinf(value)) {
+    output << (value > 0 ? "+Inf" : "-Inf");
+  } else if (value == std::floor(value) && std::fabs(value) < 9007199254740992.0) {
+    // the counters and sizes are integers, which are written exactly
+    output << static_cast<int64_t>(value);
+  } else {
+    output << std::setprecision(std::numeric_limits<double>::digits10) << value;
+  }
+}
+
+const char* getTypeName(PublishedMetric::Type type) {
+  switch (type) {
+    case PublishedMetric::Type::COUNTER: return "counter";
+    case PublishedMetric::Type::SUMMARY: return "summary";
+    case PublishedMetric::Type::GAUGE: break;
+  }
+  return "gauge";
+}
+
+std::string getSampleSuffix(const PublishedMetric& metric) {
+  switch (metric.type) {
+    case PublishedMetric::Type::COUNTER: return "_total";
+    case PublishedMetric::Type::SUMMARY: return metric.suffix;
+    case PublishedMetric::Type::GAUGE: break;
+  }
+  return "";
+}
+
+struct MetricFamily {
+  PublishedMetric::Type type;
+  std::vector<const PublishedMetric*> samples;
+};
+
+}  // namespace
+
+std::string serializeOpenMetrics(const std::vector<PublishedMetric>& metrics) {
+  // the samples of a family have to be written next to each other
+  std::map<std::string, MetricFamily> families;
+  for (const auto& metric : metrics) {
+    const auto name = METRIC_NAME_PREFIX + sanitizeName(metric.name, true);
+    auto family = families.try_emplace(name, MetricFamily{metric.type, {}}).first;
+    if (family->second.type == metric.type) {
+      family->second.samples.push_back(&metric);
+    }
+  }
+
+  std::ostringstream output;
+  output.imbue(std::locale::classic());
+  for (const auto& [name, family] : families) {
+    output << "# TYPE " << name << ' ' << getTypeName(family.type) << '\n';
+    for (const auto* sample : family.samples) {
+      output << name << getSampleSuffix(*sample);
+      if (!sample->labels.empty()) {
+        output << '{';
+        bool first = true;
+        for (const auto& [label_name, label_value] : sample->labels) {
+          if (!first) {
+            output << ',';
+          }
+          first = false;
+          output << sanitizeName(label_name, false) << "=\"";
+          writeLabelValue(output, label_value);
+          output << '"';
+        }
+        output << '}';
+      }
+      output << ' ';
+      writeValue(output, sample->value);
+      output << '\n';
+    }
+  }
+  output << "# EOF\n";
+  return output.str();
+}
+
+}  // namespace state
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
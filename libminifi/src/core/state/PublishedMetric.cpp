@@ -0,0 +1,49 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "core/state/PublishedMetric.h"
+
+#include <chrono>
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace state {
+
+std::vector<PublishedMetric> publishLatencyHistogram(const std::string& name, const utils::LatencyHistogram::Snapshot& histogram, const std::map<std::string, std::string>& labels) {
+  const auto to_seconds = [](std::chrono::microseconds duration) {
+    return std::chrono::duration<double>(duration).count();
+  };
+
+  std::vector<PublishedMetric> metrics;
+  for (const auto& [quantile, quantile_label] : {std::pair{0.5, "0.5"}, {0.9, "0.9"}, {0.99, "0.99"}, {0.999, "0.999"}}) {
+    PublishedMetric metric{name, to_seconds(histogram.getQuantile(quantile)), labels, PublishedMetric::Type::SUMMARY};
+    metric.labels["quantile"] = quantile_label;
+    metrics.push_back(std::move(metric));
+  }
+  metrics.push_back({name, to_seconds(histogram.getSum()), labels, PublishedMetric::Type::SUMMARY, "_sum"});
+  metrics.push_back({name, static_cast<double>(histogram.getCount()), labels, PublishedMetric::Type::SUMMARY, "_count"});
+  return metrics;
+}
+
+}  // namespace state
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
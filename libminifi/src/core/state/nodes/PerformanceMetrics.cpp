@@ -0,0 +1,191 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "core/state/nodes/PerformanceMetrics.h"
+
+#include "core/Resource.h"
+#include "core/state/ProcessorController.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace state {
+namespace response {
+
+namespace {
+
+SerializedResponseNode createNode(const std::string& name, uint64_t value) {
+  SerializedResponseNode node;
+  node.name = name;
+  node.value = value;
+  return node;
+}
+
+SerializedResponseNode createNode(const std::string& name, double value) {
+  SerializedResponseNode node;
+  node.name = name;
+  node.value = value;
+  return node;
+}
+
+uint64_t toMicros(std::chrono::microseconds duration) {
+  return static_cast<uint64_t>(duration.count());
+}
+
+}  // namespace
+
+SerializedResponseNode serializeLatencyHistogram(const std::string& name, const utils::LatencyHistogram::Snapshot& histogram) {
+  SerializedResponseNode histogram_node;
+  histogram_node.name = name;
+  histogram_node.children.push_back(createNode("count", histogram.getCount()));
+  histogram_node.children.push_back(createNode("sumMicros", toMicros(histogram.getSum())));
+  histogram_node.children.push_back(createNode("maxMicros", toMicros(histogram.getMax())));
+  histogram_node.children.push_back(createNode("p50Micros", toMicros(histogram.getQuantile(0.5))));
+  histogram_node.children.push_back(createNode("p90Micros", toMicros(histogram.getQuantile(0.9))));
+  histogram_node.children.push_back(createNode("p99Micros", toMicros(histogram.getQuantile(0.99))));
+  histogram_node.children.push_back(createNode("p999Micros", toMicros(histogram.getQuantile(0.999))));
+  return histogram_node;
+}
+
+std::map<std::string, std::shared_ptr<core::Processor>> ProcessorPerformanceMetrics::getProcessors() const {
+  auto processors = processors_;
+  if (monitor_) {
+    for (const auto& component : monitor_->getAllComponents()) {
+      if (auto processor_controller = std::dynamic_pointer_cast<state::ProcessorController>(component)) {
+        const auto processor = processor_controller->getProcessor();
+        processors.emplace(processor->getUUIDStr(), processor);
+      }
+    }
+  }
+  return processors;
+}
+
+std::vector<SerializedResponseNode> ProcessorPerformanceMetrics::serialize() {
+  std::vector<SerializedResponseNode> serialized;
+  for (const auto& [uuid, processor] : getProcessors()) {
+    const core::ProcessorMetrics& metrics = processor->getMetrics();
+    const auto transfers = metrics.getTransfers();
+
+    SerializedResponseNode processor_node;
+    processor_node.name = processor->getName();
+
+    SerializedResponseNode uuid_node;
+    uuid_node.name = "uuid";
+    uuid_node.value = uuid;
+
+    processor_node.children.push_back(uuid_node);
+    processor_node.children.push_back(createNode("invocations", metrics.getInvocations()));
+    processor_node.children.push_back(createNode("flowFilesIn", transfers.incoming_flow_files));
+    processor_node.children.push_back(createNode("bytesIn", transfers.incoming_bytes));
+    processor_node.children.push_back(createNode("flowFilesOut", transfers.outgoing_flow_files));
+    processor_node.children.push_back(createNode("bytesOut", transfers.outgoing_bytes));
+    processor_node.children.push_back(serializeLatencyHistogram("taskTime", metrics.getTaskTime()));
+    serialized.push_back(processor_node);
+  }
+  return serialized;
+}
+
+std::vector<PublishedMetric> ProcessorPerformanceMetrics::calculateMetrics() {
+  std::vector<PublishedMetric> metrics;
+  for (const auto& [uuid, processor] : getProcessors()) {
+    const core::ProcessorMetrics& processor_metrics = processor->getMetrics();
+    const auto transfers = processor_metrics.getTransfers();
+    const std::map<std::string, std::string> labels{{"processor_uuid", uuid}, {"processor_name", processor->getName()}};
+    const auto add_counter = [&](const char* name, uint64_t value) {
+      metrics.push_back({name, static_cast<double>(value), labels, PublishedMetric::Type::COUNTER});
+    };
+    add_counter("processor_invocations", processor_metrics.getInvocations());
+    add_counter("processor_incoming_flow_files", transfers.incoming_flow_files);
+    add_counter("processor_incoming_bytes", transfers.incoming_bytes);
+    add_counter("processor_outgoing_flow_files", transfers.outgoing_flow_files);
+    add_counter("processor_outgoing_bytes", transfers.outgoing_bytes);
+    auto task_time = publishLatencyHistogram("processor_task_time_seconds", processor_metrics.getTaskTime(), labels);
+    metrics.insert(metrics.end(), task_time.begin(), task_time.end());
+  }
+  return metrics;
+}
+
+std::vector<SerializedResponseNode> ConnectionPerformanceMetrics::serialize() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto now = std::chrono::steady_clock::now();
+  std::vector<SerializedResponseNode> serialized;
+  for (const auto& [uuid, connection] : connections_) {
+    const ConnectionMetrics& metrics = connection->getMetrics();
+    Sample sample{now, metrics.getEnqueuedFlowFiles(), metrics.getDequeuedFlowFiles()};
+
+    // the rates are only known from the second serialization on
+    double enqueue_rate = 0.0;
+    double dequeue_rate = 0.0;
+    const auto last_sample = last_samples_.find(uuid);
+    if (last_sample != last_samples_.end()) {
+      const double elapsed_seconds = std::chrono::duration<double>(now - last_sample->second.time).count();
+      if (elapsed_seconds > 0.0) {
+        enqueue_rate = static_cast<double>(sample.enqueued_flow_files - last_sample->second.enqueued_flow_files) / elapsed_seconds;
+        dequeue_rate = static_cast<double>(sample.dequeued_flow_files - last_sample->second.dequeued_flow_files) / elapsed_seconds;
+      }
+    }
+    last_samples_[uuid] = sample;
+
+    SerializedResponseNode connection_node;
+    connection_node.name = connection->getName();
+
+    SerializedResponseNode uuid_node;
+    uuid_node.name = "uuid";
+    uuid_node.value = uuid;
+
+    connection_node.children.push_back(uuid_node);
+    connection_node.children.push_back(createNode("flowFilesEnqueued", sample.enqueued_flow_files));
+    connection_node.children.push_back(createNode("bytesEnqueued", metrics.getEnqueuedBytes()));
+    connection_node.children.push_back(createNode("flowFilesDequeued", sample.dequeued_flow_files));
+    connection_node.children.push_back(createNode("bytesDequeued", metrics.getDequeuedBytes()));
+    connection_node.children.push_back(createNode("enqueuedPerSecond", enqueue_rate));
+    connection_node.children.push_back(createNode("dequeuedPerSecond", dequeue_rate));
+    connection_node.children.push_back(serializeLatencyHistogram("queueWaitTime", metrics.getQueueWaitTime()));
+    serialized.push_back(connection_node);
+  }
+  return serialized;
+}
+
+std::vector<PublishedMetric> ConnectionPerformanceMetrics::calculateMetrics() {
+  std::vector<PublishedMetric> metrics;
+  for (const auto& [uuid, connection] : connections_) {
+    const ConnectionMetrics& connection_metrics = connection->getMetrics();
+    const std::map<std::string, std::string> labels{{"connection_uuid", uuid}, {"connection_name", connection->getName()}};
+    const auto add_counter = [&](const char* name, uint64_t value) {
+      metrics.push_back({name, static_cast<double>(value), labels, PublishedMetric::Type::COUNTER});
+    };
+    add_counter("connection_enqueued_flow_files", connection_metrics.getEnqueuedFlowFiles());
+    add_counter("connection_enqueued_bytes", connection_metrics.getEnqueuedBytes());
+    add_counter("connection_dequeued_flow_files", connection_metrics.getDequeuedFlowFiles());
+    add_counter("connection_dequeued_bytes", connection_metrics.getDequeuedBytes());
+    auto queue_wait_time = publishLatencyHistogram("connection_queue_wait_time_seconds", connection_metrics.getQueueWaitTime(), labels);
+    metrics.insert(metrics.end(), queue_wait_time.begin(), queue_wait_time.end());
+  }
+  return metrics;
+}
+
+REGISTER_RESOURCE(ProcessorPerformanceMetrics, "Node part of an AST that defines the number of tasks, the transferred FlowFiles and the task time distribution of each processor");
+REGISTER_RESOURCE(ConnectionPerformanceMetrics, "Node part of an AST that defines the FlowFile rates and the queue wait time distribution of each connection");
+
+}  // namespace response
+}  // namespace state
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
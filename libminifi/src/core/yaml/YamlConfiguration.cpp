@@ -582,6 +582,7 @@ void YamlConfiguration::parseConnectionYaml(const YAML::Node& connectionsNode, c
     connection->setDestinationUUID(connectionParser.getDestinationUUIDFromYaml());
     connection->setFlowExpirationDuration(connectionParser.getFlowFileExpirationFromYaml());
     connection->setDropEmptyFlowFiles(connectionParser.getDropEmptyFromYaml());
+    connection->setLockFreeQueue(connectionParser.getLockFreeQueueFromYaml());
 
     parent->addConnection(connection);
   }
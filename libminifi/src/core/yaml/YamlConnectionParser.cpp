@@ -197,6 +197,14 @@ bool YamlConnectionParser::getDropEmptyFromYaml() const {
   return false;
 }
 
+bool YamlConnectionParser::getLockFreeQueueFromYaml() const {
+  const YAML::Node lock_free_queue_node = connectionNode_["lock free queue"];
+  if (lock_free_queue_node) {
+    return utils::StringUtils::toBool(lock_free_queue_node.as<std::string>()).value_or(false);
+  }
+  return false;
+}
+
 }  // namespace yaml
 }  // namespace core
 }  // namespace minifi
@@ -0,0 +1,88 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "provenance/ProvenanceQuery.h"
+
+#include <stdexcept>
+
+#include "utils/gsl.h"
+#include "utils/StringUtils.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace provenance {
+
+namespace {
+
+std::optional<uint64_t> parseUnsigned(const std::string& value) {
+  const std::string trimmed = utils::StringUtils::trim(value);
+  if (trimmed.empty() || trimmed.find_first_not_of("0123456789") != std::string::npos) {
+    return std::nullopt;
+  }
+  try {
+    return std::stoull(trimmed);
+  } catch (const std::out_of_range&) {
+    return std::nullopt;
+  }
+}
+
+}  // namespace
+
+std::optional<ProvenanceQuery> ProvenanceQuery::parse(const std::map<std::string, std::string>& arguments) {
+  ProvenanceQuery query;
+  for (const auto& [name, value] : arguments) {
+    if (name == "flowFileUuid") {
+      query.flow_file_uuid = utils::Identifier::parse(utils::StringUtils::trim(value));
+      if (!query.flow_file_uuid) {
+        return std::nullopt;
+      }
+    } else if (name == "lineage") {
+      const auto lineage = utils::StringUtils::toBool(value);
+      if (!lineage) {
+        return std::nullopt;
+      }
+      query.include_lineage = *lineage;
+    } else if (name == "componentId") {
+      query.component_id = utils::StringUtils::trim(value);
+    } else if (name == "startTime" || name == "endTime") {
+      const auto millis = parseUnsigned(value);
+      if (!millis || *millis > static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::duration::max()).count())) {
+        return std::nullopt;
+      }
+      const auto time = std::chrono::system_clock::time_point{std::chrono::milliseconds{*millis}};
+      (name == "startTime" ? query.begin : query.end) = time;
+    } else if (name == "maxResults") {
+      const auto max_results = parseUnsigned(value);
+      if (!max_results || *max_results == 0) {
+        return std::nullopt;
+      }
+      query.max_results = gsl::narrow_cast<size_t>(*max_results);
+    }
+  }
+  if (query.include_lineage && !query.flow_file_uuid) {
+    return std::nullopt;
+  }
+  return query;
+}
+
+}  // namespace provenance
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
@@ -0,0 +1,137 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "utils/ConcurrentFlowFileQueue.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace utils {
+
+ConcurrentFlowFileQueue::ConcurrentFlowFileQueue(size_t capacity)
+    : capacity_(std::max<size_t>(capacity, 1)) {
+}
+
+void ConcurrentFlowFileQueue::push(value_type element) {
+  if (element->isPenalized()) {
+    std::lock_guard<std::mutex> lock(penalized_mutex_);
+    penalized_queue_.push(std::move(element));
+    ++penalized_queue_size_;
+    return;
+  }
+  // while there is an overflow, new flow files have to queue up behind it
+  if (overflow_queue_size_.load() == 0) {
+    if (queue_size_.fetch_add(1) < capacity_) {
+      queue_.enqueue(std::move(element));
+      return;
+    }
+    --queue_size_;
+  }
+  std::lock_guard<std::mutex> lock(penalized_mutex_);
+  overflow_queue_.push_back(std::move(element));
+  ++overflow_queue_size_;
+}
+
+ConcurrentFlowFileQueue::value_type ConcurrentFlowFileQueue::tryPop() {
+  // the flow files whose penalty has expired have been waiting the longest
+  if (penalized_queue_size_.load() > 0) {
+    std::lock_guard<std::mutex> lock(penalized_mutex_);
+    if (penalized_queue_.isWorkAvailable()) {
+      --penalized_queue_size_;
+      return penalized_queue_.pop();
+    }
+  }
+  value_type element;
+  if (queue_size_.load() > 0 && queue_.try_dequeue(element)) {
+    --queue_size_;
+    if (overflow_queue_size_.load() > 0) {
+      std::lock_guard<std::mutex> lock(penalized_mutex_);
+      refillFromOverflow();
+    }
+    return element;
+  }
+  if (overflow_queue_size_.load() > 0) {
+    std::lock_guard<std::mutex> lock(penalized_mutex_);
+    if (!overflow_queue_.empty()) {
+      element = std::move(overflow_queue_.front());
+      overflow_queue_.pop_front();
+      --overflow_queue_size_;
+      return element;
+    }
+  }
+  return nullptr;
+}
+
+void ConcurrentFlowFileQueue::refillFromOverflow() {
+  while (!overflow_queue_.empty()) {
+    if (queue_size_.fetch_add(1) >= capacity_) {
+      --queue_size_;
+      return;
+    }
+    queue_.enqueue(std::move(overflow_queue_.front()));
+    overflow_queue_.pop_front();
+    --overflow_queue_size_;
+  }
+}
+
+std::vector<ConcurrentFlowFileQueue::value_type> ConcurrentFlowFileQueue::popAll() {
+  std::vector<value_type> elements;
+  value_type element;
+  while (queue_.try_dequeue(element)) {
+    --queue_size_;
+    elements.push_back(std::move(element));
+  }
+  std::lock_guard<std::mutex> lock(penalized_mutex_);
+  for (auto& overflow_element : overflow_queue_) {
+    elements.push_back(std::move(overflow_element));
+  }
+  overflow_queue_.clear();
+  overflow_queue_size_ = 0;
+  while (!penalized_queue_.empty()) {
+    --penalized_queue_size_;
+    elements.push_back(penalized_queue_.pop());
+  }
+  return elements;
+}
+
+bool ConcurrentFlowFileQueue::isWorkAvailable() const {
+  if (queue_size_.load() > 0 || overflow_queue_size_.load() > 0) {
+    return true;
+  }
+  if (penalized_queue_size_.load() == 0) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(penalized_mutex_);
+  return penalized_queue_.isWorkAvailable();
+}
+
+bool ConcurrentFlowFileQueue::empty() const {
+  return size() == 0;
+}
+
+size_t ConcurrentFlowFileQueue::size() const {
+  return queue_size_.load() + overflow_queue_size_.load() + penalized_queue_size_.load();
+}
+
+}  // namespace utils
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
@@ -0,0 +1,103 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utils/LatencyHistogram.h"
+
+#include <algorithm>
+#include <bit>  // NOLINT
+#include <cmath>
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace utils {
+
+size_t LatencyHistogram::getBucketIndex(uint64_t micros) {
+  micros = std::min(micros, static_cast<uint64_t>(MAX_DURATION.count()));
+  if (micros < SUB_BUCKET_COUNT) {
+    return static_cast<size_t>(micros);
+  }
+  // the highest bit selects the range, the next SUB_BUCKET_BITS bits the bucket within the range
+  const unsigned exponent = std::bit_width(micros) - 1;
+  const uint64_t sub_bucket = (micros >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKET_COUNT - 1);
+  return static_cast<size_t>((exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT + sub_bucket);
+}
+
+uint64_t LatencyHistogram::getBucketUpperLimit(size_t index) {
+  if (index < SUB_BUCKET_COUNT) {
+    return index;
+  }
+  const unsigned exponent = static_cast<unsigned>(index / SUB_BUCKET_COUNT) + SUB_BUCKET_BITS - 1;
+  const uint64_t sub_bucket = index % SUB_BUCKET_COUNT;
+  const uint64_t width = uint64_t{1} << (exponent - SUB_BUCKET_BITS);
+  return ((SUB_BUCKET_COUNT + sub_bucket) << (exponent - SUB_BUCKET_BITS)) + width - 1;
+}
+
+void LatencyHistogram::record(std::chrono::microseconds duration) {
+  const uint64_t micros = duration.count() < 0 ? 0 : static_cast<uint64_t>(duration.count());
+  buckets_[getBucketIndex(micros)].fetch_add(1, std::memory_order_relaxed);
+  sum_.fetch_add(micros, std::memory_order_relaxed);
+  uint64_t max = max_.load(std::memory_order_relaxed);
+  while (micros > max && !max_.compare_exchange_weak(max, micros, std::memory_order_relaxed)) {
+  }
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::getSnapshot() const {
+  Snapshot snapshot;
+  for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+    snapshot.buckets_[i] = buckets_[i].load(std::memory_order_relaxed);
+    snapshot.count_ += snapshot.buckets_[i];
+  }
+  snapshot.sum_ = sum_.load(std::memory_order_relaxed);
+  snapshot.max_ = max_.load(std::memory_order_relaxed);
+  return snapshot;
+}
+
+std::chrono::microseconds LatencyHistogram::Snapshot::getQuantile(double quantile) const {
+  if (count_ == 0) {
+    return std::chrono::microseconds{0};
+  }
+  const auto rank = std::max(uint64_t{1}, static_cast<uint64_t>(std::ceil(std::clamp(quantile, 0.0, 1.0) * static_cast<double>(count_))));
+  uint64_t seen = 0;
+  for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+    seen += buckets_[i];
+    if (seen >= rank) {
+      // the real durations of the bucket are not known, but none of them is above the maximum
+      return std::chrono::microseconds{std::min(getBucketUpperLimit(i), max_)};
+    }
+  }
+  return std::chrono::microseconds{max_};
+}
+
+uint64_t LatencyHistogram::Snapshot::getCountNotAbove(std::chrono::microseconds limit) const {
+  if (limit.count() < 0) {
+    return 0;
+  }
+  uint64_t count = 0;
+  for (size_t i = 0; i < BUCKET_COUNT && getBucketUpperLimit(i) <= static_cast<uint64_t>(limit.count()); ++i) {
+    count += buckets_[i];
+  }
+  return count;
+}
+
+}  // namespace utils
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
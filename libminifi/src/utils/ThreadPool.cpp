@@ -16,7 +16,12 @@
  */
 
 #include "utils/ThreadPool.h"
+
+#include <algorithm>
+#include <iterator>
+
 #include "core/state/UpdateController.h"
+#include "utils/gsl.h"
 
 namespace org {
 namespace apache {
@@ -27,6 +32,7 @@ namespace utils {
 template<typename T>
 void ThreadPool<T>::run_tasks(std::shared_ptr<WorkerThread> thread) {
   thread->is_running_ = true;
+  const size_t own_queue = thread->run_queue_index_;
   while (running_.load()) {
     if (UNLIKELY(thread_reduction_count_ > 0)) {
       if (--thread_reduction_count_ >= 0) {
@@ -38,76 +44,213 @@ void ThreadPool<T>::run_tasks(std::shared_ptr<WorkerThread> thread) {
       }
     }
 
-    Worker<T> task;
-    if (worker_queue_.dequeueWait(task)) {
-      {
-        std::unique_lock<std::mutex> lock(worker_queue_mutex_);
-        if (!task_status_[task.getIdentifier()]) {
-          continue;
-        } else if (!worker_queue_.isRunning()) {
-          worker_queue_.enqueue(std::move(task));
-          continue;
-        }
-      }
-      if (task.run()) {
-        if (task.getNextExecutionTime() <= std::chrono::steady_clock::now()) {
-          // it can be rescheduled again as soon as there is a worker available
-          worker_queue_.enqueue(std::move(task));
-          continue;
-        }
-        // Task will be put to the delayed queue as next exec time is in the future
-        std::unique_lock<std::mutex> lock(worker_queue_mutex_);
-        bool need_to_notify =
-            delayed_worker_queue_.empty() ||
-                task.getNextExecutionTime() < delayed_worker_queue_.top().getNextExecutionTime();
-
-        delayed_worker_queue_.push(std::move(task));
-        if (need_to_notify) {
-          delayed_task_available_.notify_all();
-        }
-      }
-    } else {
-      // The threadpool is running, but the ConcurrentQueue is stopped -> shouldn't happen during normal conditions
-      // Might happen during startup or shutdown for a very short time
-      if (running_.load()) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
-      }
+    if (paused_.load()) {
+      waitForWork();
+      continue;
+    }
+    auto task = takeTask(own_queue);
+    if (!task) {
+      waitForWork();
+      continue;
+    }
+    if (!task->status->running.load()) {
+      continue;
+    } else if (paused_.load()) {
+      pushTask(std::move(*task), own_queue);
+      continue;
+    }
+    if (task->worker.run()) {
+      reschedule(std::move(*task), own_queue);
     }
   }
   current_workers_--;
 }
 
+template<typename T>
+void ThreadPool<T>::createRunQueues() {
+  std::unique_lock<std::shared_mutex> run_queues_lock(run_queues_mutex_);
+  std::vector<ScheduledTask> queued_tasks;
+  for (auto &run_queue : run_queues_) {
+    std::lock_guard<std::mutex> lock(run_queue->mutex);
+    std::move(run_queue->tasks.begin(), run_queue->tasks.end(), std::back_inserter(queued_tasks));
+  }
+  run_queues_.clear();
+  for (int i = 0; i < std::max(max_worker_threads_, 1); ++i) {
+    run_queues_.push_back(std::make_unique<RunQueue>());
+  }
+  for (size_t i = 0; i < queued_tasks.size(); ++i) {
+    run_queues_[i % run_queues_.size()]->tasks.push_back(std::move(queued_tasks[i]));
+  }
+}
+
+template<typename T>
+void ThreadPool<T>::pushTask(ScheduledTask &&task, size_t run_queue) {
+  {
+    std::shared_lock<std::shared_mutex> run_queues_lock(run_queues_mutex_);
+    auto &queue = *run_queues_[run_queue % run_queues_.size()];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.tasks.push_back(std::move(task));
+  }
+  ++queued_task_count_;
+  // the idle workers register themselves before checking the task count, so either they see the new task or we see them
+  if (idle_workers_.load() > 0) {
+    std::lock_guard<std::mutex> lock(idle_workers_mutex_);
+    work_available_.notify_one();
+  }
+}
+
+template<typename T>
+std::optional<typename ThreadPool<T>::ScheduledTask> ThreadPool<T>::takeTask(size_t run_queue) {
+  if (queued_task_count_.load() <= 0) {
+    return std::nullopt;
+  }
+  std::shared_lock<std::shared_mutex> run_queues_lock(run_queues_mutex_);
+  // the number of queues might have changed since the worker was started
+  run_queue %= run_queues_.size();
+  {
+    auto &own_queue = *run_queues_[run_queue];
+    std::lock_guard<std::mutex> lock(own_queue.mutex);
+    if (!own_queue.tasks.empty()) {
+      ScheduledTask task = std::move(own_queue.tasks.front());
+      own_queue.tasks.pop_front();
+      --queued_task_count_;
+      return task;
+    }
+  }
+  // steal from the back of the other queues, the owners work on the front
+  for (size_t i = 1; i < run_queues_.size(); ++i) {
+    auto &victim = *run_queues_[(run_queue + i) % run_queues_.size()];
+    std::unique_lock<std::mutex> lock(victim.mutex, std::try_to_lock);
+    if (!lock.owns_lock() || victim.tasks.empty()) {
+      continue;
+    }
+    ScheduledTask task = std::move(victim.tasks.back());
+    victim.tasks.pop_back();
+    --queued_task_count_;
+    return task;
+  }
+  return std::nullopt;
+}
+
+template<typename T>
+void ThreadPool<T>::waitForWork() {
+  std::unique_lock<std::mutex> lock(idle_workers_mutex_);
+  ++idle_workers_;
+  // the timeout lets idle workers notice the thread reductions
+  work_available_.wait_for(lock, std::chrono::milliseconds(100), [this] {
+    return !running_.load() || (!paused_.load() && queued_task_count_.load() > 0);
+  });
+  --idle_workers_;
+}
+
+template<typename T>
+void ThreadPool<T>::reschedule(ScheduledTask &&task, size_t run_queue) {
+  if (task.worker.getNextExecutionTime() <= std::chrono::steady_clock::now()) {
+    // it can be rescheduled again as soon as there is a worker available
+    pushTask(std::move(task), run_queue);
+    return;
+  }
+  // Task will be put to the delayed tasks as next exec time is in the future
+  const bool notifiable = task.worker.isNotifiable();
+  auto status = task.status;
+  std::lock_guard<std::mutex> lock(delayed_tasks_mutex_);
+  pushDelayedTask(std::move(task));
+  if (notifiable && status->notified.load()) {
+    // got notified while running, don't wait
+    runNotifiedTasks(*status);
+  }
+}
+
 template<typename T>
 void ThreadPool<T>::manage_delayed_queue() {
+  std::unique_lock<std::mutex> lock(delayed_tasks_mutex_);
   while (running_) {
-    std::unique_lock<std::mutex> lock(worker_queue_mutex_);
-
-    // Put the tasks ready to run in the worker queue
-    while (!delayed_worker_queue_.empty() &&
-        delayed_worker_queue_.top().getNextExecutionTime() <= std::chrono::steady_clock::now()) {
-      // I'm very sorry for this - committee must has been seriously drunk when the interface of prio queue was submitted.
-      Worker<T> task = std::move(const_cast<Worker<T>&>(delayed_worker_queue_.top()));
-      delayed_worker_queue_.pop();
-      worker_queue_.enqueue(std::move(task));
-    }
-    if (delayed_worker_queue_.empty()) {
+    // Put the tasks ready to run in the run queues
+    delayed_tasks_.advance(std::chrono::steady_clock::now(), [this](ScheduledTask &&task) {
+      dispatchDelayedTask(std::move(task));
+    });
+    const auto next_expiration = delayed_tasks_.nextExpiration();
+    if (!next_expiration) {
+      delayed_scheduler_wakeup_ = std::chrono::steady_clock::time_point::max();
       delayed_task_available_.wait(lock);
     } else {
-      auto wait_time = std::chrono::duration_cast<std::chrono::milliseconds>(
-          delayed_worker_queue_.top().getNextExecutionTime() - std::chrono::steady_clock::now());
-      delayed_task_available_.wait_for(lock, std::max(wait_time, std::chrono::milliseconds(1)));
+      delayed_scheduler_wakeup_ = *next_expiration;
+      delayed_task_available_.wait_until(lock, *next_expiration);
+    }
+  }
+}
+
+template<typename T>
+void ThreadPool<T>::pushDelayedTask(ScheduledTask &&task) {
+  if (task.worker.isNotifiable()) {
+    ++task.status->delayed_notifiable_tasks;
+  }
+  const auto next_exec_time = task.worker.getNextExecutionTime();
+  delayed_tasks_.insert(next_exec_time, std::move(task));
+  if (next_exec_time < delayed_scheduler_wakeup_) {
+    delayed_scheduler_wakeup_ = next_exec_time;
+    delayed_task_available_.notify_all();
+  }
+}
+
+template<typename T>
+void ThreadPool<T>::dispatchDelayedTask(ScheduledTask &&task) {
+  if (task.worker.isNotifiable()) {
+    --task.status->delayed_notifiable_tasks;
+  }
+  if (!task.status->running.load()) {
+    return;
+  }
+  pushTask(std::move(task), nextRunQueue());
+}
+
+template<typename T>
+void ThreadPool<T>::runNotifiedTasks(TaskStatus &status) {
+  if (!status.notified.exchange(false)) {
+    return;
+  }
+  const auto now = std::chrono::steady_clock::now();
+  delayed_tasks_.removeIf([&status](const ScheduledTask &task) {
+    return task.status.get() == &status && task.worker.isNotifiable();
+  }, [this, now](ScheduledTask &&task) {
+    task.worker.setNextExecutionTime(now);
+    dispatchDelayedTask(std::move(task));
+  });
+}
+
+template<typename T>
+void ThreadPool<T>::notifyTasks(const TaskId &identifier) {
+  std::shared_ptr<TaskStatus> status;
+  {
+    std::shared_lock<std::shared_mutex> lock(task_status_mutex_);
+    const auto it = task_status_.find(identifier);
+    if (it == task_status_.end()) {
+      return;
     }
+    status = it->second;
+  }
+  // the tasks are either running or already waiting for a worker unless they are delayed,
+  // those getting delayed after this point see the flag when they are parked
+  status->notified = true;
+  if (status->delayed_notifiable_tasks.load() > 0) {
+    std::lock_guard<std::mutex> lock(delayed_tasks_mutex_);
+    runNotifiedTasks(*status);
   }
 }
 
 template<typename T>
 bool ThreadPool<T>::execute(Worker<T> &&task, std::future<T> &future) {
+  std::shared_ptr<TaskStatus> status;
   {
-    std::unique_lock<std::mutex> lock(worker_queue_mutex_);
-    task_status_[task.getIdentifier()] = true;
+    std::unique_lock<std::shared_mutex> lock(task_status_mutex_);
+    auto &task_status = task_status_[task.getIdentifier()];
+    if (!task_status) {
+      task_status = std::make_shared<TaskStatus>();
+    }
+    status = task_status;
   }
   future = std::move(task.getPromise()->get_future());
-  worker_queue_.enqueue(std::move(task));
+  pushTask(ScheduledTask{std::move(task), std::move(status)}, nextRunQueue());
 
   task_count_++;
 
@@ -120,6 +263,7 @@ void ThreadPool<T>::manageWorkers() {
     std::stringstream thread_name;
     thread_name << name_ << " #" << i;
     auto worker_thread = std::make_shared<WorkerThread>(thread_name.str());
+    worker_thread->run_queue_index_ = gsl::narrow<size_t>(i);
     worker_thread->thread_ = createThread(std::bind(&ThreadPool::run_tasks, this, worker_thread));
     thread_queue_.push_back(worker_thread);
     current_workers_++;
@@ -149,18 +293,30 @@ void ThreadPool<T>::manageWorkers() {
             thread_reduction_count_++;
           thread_manager_->reduce();
         } else if (thread_manager_->canIncrease() && max_worker_threads_ > current_workers_) {  // increase slowly
-          std::unique_lock<std::mutex> lock(worker_queue_mutex_);
-          auto worker_thread = std::make_shared<WorkerThread>();
-          worker_thread->thread_ = createThread(std::bind(&ThreadPool::run_tasks, this, worker_thread));
-          if (daemon_threads_) {
-            worker_thread->thread_.detach();
+          std::unique_lock<std::mutex> lock(thread_queue_mutex_);
+          std::shared_lock<std::shared_mutex> run_queues_lock(run_queues_mutex_);
+          // the run queue of a reduced thread is drained by stealing until a new thread takes it over
+          std::vector<bool> owned_run_queues(run_queues_.size(), false);
+          for (const auto &thread : thread_queue_) {
+            if (thread->run_queue_index_ < owned_run_queues.size()) {
+              owned_run_queues[thread->run_queue_index_] = true;
+            }
+          }
+          const auto free_run_queue = std::find(owned_run_queues.begin(), owned_run_queues.end(), false);
+          if (free_run_queue != owned_run_queues.end()) {
+            auto worker_thread = std::make_shared<WorkerThread>();
+            worker_thread->run_queue_index_ = gsl::narrow<size_t>(std::distance(owned_run_queues.begin(), free_run_queue));
+            worker_thread->thread_ = createThread(std::bind(&ThreadPool::run_tasks, this, worker_thread));
+            if (daemon_threads_) {
+              worker_thread->thread_.detach();
+            }
+            thread_queue_.push_back(worker_thread);
+            current_workers_++;
           }
-          thread_queue_.push_back(worker_thread);
-          current_workers_++;
         }
         std::shared_ptr<WorkerThread> thread_ref;
         while (deceased_thread_queue_.tryDequeue(thread_ref)) {
-          std::unique_lock<std::mutex> lock(worker_queue_mutex_);
+          std::unique_lock<std::mutex> lock(thread_queue_mutex_);
           if (thread_ref->thread_.joinable())
             thread_ref->thread_.join();
           thread_queue_.erase(std::remove(thread_queue_.begin(), thread_queue_.end(), thread_ref), thread_queue_.end());
@@ -188,32 +344,46 @@ void ThreadPool<T>::start() {
   std::lock_guard<std::recursive_mutex> lock(manager_mutex_);
   if (!running_) {
     running_ = true;
-    worker_queue_.start();
+    paused_ = false;
     manager_thread_ = std::thread(&ThreadPool::manageWorkers, this);
 
-    std::lock_guard<std::mutex> quee_lock(worker_queue_mutex_);
+    std::lock_guard<std::mutex> delayed_lock(delayed_tasks_mutex_);
+    delayed_scheduler_wakeup_ = std::chrono::steady_clock::time_point::max();
     delayed_scheduler_thread_ = std::thread(&ThreadPool<T>::manage_delayed_queue, this);
   }
 }
 
 template<typename T>
 void ThreadPool<T>::stopTasks(const TaskId &identifier) {
-  std::unique_lock<std::mutex> lock(worker_queue_mutex_);
-  task_status_[identifier] = false;
+  std::shared_ptr<TaskStatus> status;
+  {
+    std::unique_lock<std::shared_mutex> lock(task_status_mutex_);
+    const auto it = task_status_.find(identifier);
+    if (it == task_status_.end()) {
+      return;
+    }
+    status = std::move(it->second);
+    task_status_.erase(it);
+  }
+  // the queued and running tasks are dropped by the workers, the delayed ones can go right away
+  status->running = false;
+  std::lock_guard<std::mutex> lock(delayed_tasks_mutex_);
+  delayed_tasks_.removeIf([&status](const ScheduledTask &task) {
+    return task.status == status;
+  }, [](ScheduledTask&&) {});
 }
 
 template<typename T>
 void ThreadPool<T>::resume() {
-  if (!worker_queue_.isRunning()) {
-    worker_queue_.start();
+  if (paused_.exchange(false)) {
+    std::lock_guard<std::mutex> lock(idle_workers_mutex_);
+    work_available_.notify_all();
   }
 }
 
 template<typename T>
 void ThreadPool<T>::pause() {
-  if (worker_queue_.isRunning()) {
-    worker_queue_.stop();
-  }
+  paused_ = true;
 }
 
 template<typename T>
@@ -224,12 +394,18 @@ void ThreadPool<T>::shutdown() {
 
     drain();
 
-    task_status_.clear();
+    {
+      std::unique_lock<std::shared_mutex> status_lock(task_status_mutex_);
+      task_status_.clear();
+    }
     if (manager_thread_.joinable()) {
       manager_thread_.join();
     }
 
-    delayed_task_available_.notify_all();
+    {
+      std::lock_guard<std::mutex> delayed_lock(delayed_tasks_mutex_);
+      delayed_task_available_.notify_all();
+    }
     if (delayed_scheduler_thread_.joinable()) {
       delayed_scheduler_thread_.join();
     }
@@ -241,11 +417,13 @@ void ThreadPool<T>::shutdown() {
 
     thread_queue_.clear();
     current_workers_ = 0;
-    while (!delayed_worker_queue_.empty()) {
-      delayed_worker_queue_.pop();
-    }
+    delayed_tasks_.clear();
 
-    worker_queue_.clear();
+    for (auto &run_queue : run_queues_) {
+      std::lock_guard<std::mutex> queue_lock(run_queue->mutex);
+      run_queue->tasks.clear();
+    }
+    queued_task_count_ = 0;
   }
 }
 
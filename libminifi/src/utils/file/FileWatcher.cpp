@@ -0,0 +1,262 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utils/file/FileWatcher.h"
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#include "core/logging/LoggerConfiguration.h"
+#include "utils/gsl.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace utils {
+namespace file {
+
+#ifdef __linux__
+
+namespace {
+constexpr size_t EVENT_BUFFER_SIZE = 64 * 1024;
+constexpr uint32_t WATCHED_EVENTS = IN_MODIFY | IN_CREATE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE | IN_ONLYDIR;
+}  // namespace
+
+FileWatcher::FileWatcher()
+    : fd_(inotify_init1(IN_NONBLOCK | IN_CLOEXEC)),
+      buffer_(EVENT_BUFFER_SIZE),
+      logger_(core::logging::LoggerFactory<FileWatcher>::getLogger()) {
+  if (fd_ < 0) {
+    logger_->log_warn("Could not initialize inotify, changes of the files are not watched: %s", std::strerror(errno));
+  }
+}
+
+FileWatcher::~FileWatcher() {
+  if (notification_thread_.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(notification_mutex_);
+      stopping_ = true;
+    }
+    notification_condition_.notify_one();
+    const uint64_t stop = 1;
+    if (write(stop_fd_, &stop, sizeof(stop)) < 0) {
+      logger_->log_error("Could not stop the inotify notification thread: %s", std::strerror(errno));
+    }
+    notification_thread_.join();
+  }
+  if (stop_fd_ >= 0) {
+    close(stop_fd_);
+  }
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+}
+
+bool FileWatcher::watch(const std::string& directory) {
+  if (fd_ < 0) {
+    return false;
+  }
+  if (watches_by_directory_.find(directory) != watches_by_directory_.end()) {
+    return true;
+  }
+  const int watch_descriptor = inotify_add_watch(fd_, directory.c_str(), WATCHED_EVENTS);
+  if (watch_descriptor < 0) {
+    logger_->log_warn("Could not watch directory %s: %s", directory, std::strerror(errno));
+    return false;
+  }
+  directories_by_watch_[watch_descriptor].push_back(directory);
+  watches_by_directory_[directory] = watch_descriptor;
+  return true;
+}
+
+void FileWatcher::unwatch(const std::string& directory) {
+  const auto it = watches_by_directory_.find(directory);
+  if (it == watches_by_directory_.end()) {
+    return;
+  }
+  auto& directories = directories_by_watch_[it->second];
+  directories.erase(std::remove(directories.begin(), directories.end(), directory), directories.end());
+  if (directories.empty()) {
+    // the watch is shared by the other names of the directory
+    inotify_rm_watch(fd_, it->second);
+    directories_by_watch_.erase(it->second);
+  }
+  watches_by_directory_.erase(it);
+}
+
+bool FileWatcher::poll(const std::function<void(const Change&)>& on_change) {
+  if (fd_ < 0) {
+    return false;
+  }
+  bool complete = true;
+  while (true) {
+    const auto length = read(fd_, buffer_.data(), buffer_.size());
+    if (length < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno != EAGAIN) {
+        logger_->log_error("Reading inotify events failed: %s", std::strerror(errno));
+        complete = false;
+      }
+      // the changes arriving from now on are notified again
+      {
+        std::lock_guard<std::mutex> lock(notification_mutex_);
+        notified_ = false;
+      }
+      notification_condition_.notify_one();
+      return complete;
+    }
+    for (size_t offset = 0; offset < gsl::narrow<size_t>(length);) {
+      inotify_event event{};
+      std::memcpy(&event, buffer_.data() + offset, sizeof(event));
+      const char* const name = buffer_.data() + offset + sizeof(event);
+      offset += sizeof(event) + event.len;
+
+      if (event.mask & IN_Q_OVERFLOW) {
+        logger_->log_warn("The inotify event queue overflowed, some changes were missed");
+        complete = false;
+        continue;
+      }
+      const auto directory = directories_by_watch_.find(event.wd);
+      if (directory == directories_by_watch_.end()) {
+        continue;
+      }
+      if (event.mask & IN_IGNORED) {
+        // the directory was removed or unmounted
+        for (const auto& name : directory->second) {
+          watches_by_directory_.erase(name);
+        }
+        directories_by_watch_.erase(directory);
+        continue;
+      }
+      if (event.len == 0) {
+        continue;
+      }
+      ChangeType type = ChangeType::MODIFIED;
+      if (event.mask & (IN_CREATE | IN_MOVED_TO)) {
+        type = ChangeType::CREATED;
+      } else if (event.mask & (IN_DELETE | IN_MOVED_FROM)) {
+        type = ChangeType::REMOVED;
+      }
+      for (const auto& name_of_directory : directory->second) {
+        on_change(Change{name_of_directory, std::string(name), type, (event.mask & IN_ISDIR) != 0});
+      }
+    }
+  }
+}
+
+bool FileWatcher::hasPendingChanges() const {
+  int pending_bytes = 0;
+  return fd_ >= 0 && ioctl(fd_, FIONREAD, &pending_bytes) == 0 && pending_bytes > 0;
+}
+
+void FileWatcher::notifyOnChanges(std::function<void()> on_changes) {
+  if (fd_ < 0 || notification_thread_.joinable()) {
+    return;
+  }
+  stop_fd_ = eventfd(0, EFD_CLOEXEC);
+  if (stop_fd_ < 0) {
+    logger_->log_warn("Could not start the inotify notification thread: %s", std::strerror(errno));
+    return;
+  }
+  on_changes_ = std::move(on_changes);
+  notification_thread_ = std::thread([this] { runNotifications(); });
+}
+
+void FileWatcher::runNotifications() {
+  std::unique_lock<std::mutex> lock(notification_mutex_);
+  while (true) {
+    // the pending changes have been notified already, wait until they are drained
+    notification_condition_.wait(lock, [this] { return stopping_ || !notified_; });
+    if (stopping_) {
+      return;
+    }
+    lock.unlock();
+    pollfd fds[] = {{fd_, POLLIN, 0}, {stop_fd_, POLLIN, 0}};
+    const int result = ::poll(fds, 2, -1);
+    lock.lock();
+    if (result < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      logger_->log_error("Waiting for inotify events failed: %s", std::strerror(errno));
+      return;
+    }
+    if (stopping_ || (fds[1].revents & POLLIN)) {
+      return;
+    }
+    if (fds[0].revents & POLLIN) {
+      notified_ = true;
+      lock.unlock();
+      on_changes_();
+      lock.lock();
+    } else if (fds[0].revents != 0) {
+      logger_->log_error("Waiting for inotify events failed, changes are not notified any more");
+      return;
+    }
+  }
+}
+
+#else
+
+FileWatcher::FileWatcher()
+    : logger_(core::logging::LoggerFactory<FileWatcher>::getLogger()) {
+}
+
+FileWatcher::~FileWatcher() = default;
+
+bool FileWatcher::watch(const std::string&) {
+  return false;
+}
+
+void FileWatcher::unwatch(const std::string&) {
+}
+
+bool FileWatcher::poll(const std::function<void(const Change&)>&) {
+  return false;
+}
+
+bool FileWatcher::hasPendingChanges() const {
+  return false;
+}
+
+void FileWatcher::notifyOnChanges(std::function<void()>) {
+}
+
+void FileWatcher::runNotifications() {
+}
+
+#endif
+
+}  // namespace file
+}  // namespace utils
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
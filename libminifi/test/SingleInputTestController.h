@@ -27,6 +27,11 @@
 #include "core/Processor.h"
 
 namespace org::apache::nifi::minifi::test {
+struct InputFlowFileData {
+  std::string_view content;
+  std::unordered_map<std::string, std::string> attributes = {};
+};
+
 class SingleInputTestController : public TestController {
  public:
   explicit SingleInputTestController(const std::shared_ptr<core::Processor>& processor)
@@ -35,8 +40,17 @@ class SingleInputTestController : public TestController {
 
   std::unordered_map<core::Relationship, std::vector<std::shared_ptr<core::FlowFile>>>
   trigger(const std::string_view input_flow_file_content, std::unordered_map<std::string, std::string> input_flow_file_attributes = {}) {
-    const auto new_flow_file = createFlowFile(input_flow_file_content, std::move(input_flow_file_attributes));
-    input_->put(new_flow_file);
+    return trigger(std::vector<InputFlowFileData>{{input_flow_file_content, std::move(input_flow_file_attributes)}});
+  }
+
+  /**
+   * Queues all of the input flow files, then triggers the processor once
+   */
+  std::unordered_map<core::Relationship, std::vector<std::shared_ptr<core::FlowFile>>>
+  trigger(std::vector<InputFlowFileData> input_flow_files) {
+    for (auto& input_flow_file : input_flow_files) {
+      input_->put(createFlowFile(input_flow_file.content, std::move(input_flow_file.attributes)));
+    }
     plan->runProcessor(processor_);
     std::unordered_map<core::Relationship, std::vector<std::shared_ptr<core::FlowFile>>> result;
     for (const auto& [relationship, connection]: outgoing_connections_) {
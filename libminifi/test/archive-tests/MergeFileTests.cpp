@@ -16,7 +16,10 @@
  * limitations under the License.
  */
 
+#include <chrono>
 #include <fstream>
+#include <functional>
+#include <future>
 #include <iostream>
 #include <map>
 #include <memory>
@@ -24,6 +27,8 @@
 #include <set>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "core/Core.h"
 #include "core/Processor.h"
@@ -31,6 +36,7 @@
 #include "core/ProcessorNode.h"
 #include "core/ProcessSession.h"
 #include "FlowController.h"
+#include "core/repository/FileSystemRepository.h"
 #include "../../include/core/FlowFile.h"
 #include "MergeContent.h"
 #include "processors/LogAttribute.h"
@@ -138,7 +144,7 @@ std::vector<FixedBuffer> read_archives(const FixedBuffer& input) {
 
 class MergeTestController : public TestController {
  public:
-  MergeTestController() {
+  explicit MergeTestController(std::shared_ptr<core::ContentRepository> content_repo = nullptr) {
     init_file_paths();
     LogTestController::getInstance().setTrace<minifi::processors::MergeContent>();
     LogTestController::getInstance().setTrace<minifi::processors::LogAttribute>();
@@ -151,8 +157,10 @@ class MergeTestController : public TestController {
     LogTestController::getInstance().setTrace<minifi::core::Connectable>();
 
     std::shared_ptr<TestRepository> repo = std::make_shared<TestRepository>();
-    auto content_repo = std::make_shared<core::repository::VolatileContentRepository>();
-    content_repo->initialize(std::make_shared<minifi::Configure>());
+    if (!content_repo) {
+      content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+      content_repo->initialize(std::make_shared<minifi::Configure>());
+    }
 
     processor = std::make_shared<minifi::processors::MergeContent>("mergecontent");
     processor->initialize();
@@ -819,3 +827,400 @@ TEST_CASE_METHOD(MergeTestController, "Batch Size", "[testMergeFileBatchSize]")
     REQUIRE(callback.to_string() == expected[1]);
   }
 }
+
+TEST_CASE_METHOD(MergeTestController, "Streaming Merge", "[testMergeFileStreaming]") {
+  context->setProperty(minifi::processors::MergeContent::MergeStrategy, minifi::processors::merge_content_options::MERGE_STRATEGY_BIN_PACK);
+  context->setProperty(minifi::processors::MergeContent::DelimiterStrategy, minifi::processors::merge_content_options::DELIMITER_STRATEGY_TEXT);
+  context->setProperty(minifi::processors::MergeContent::StreamingMerge, "true");
+  context->setProperty(minifi::processors::BinFiles::MinEntries, "3");
+  context->setProperty(minifi::processors::BinFiles::MaxEntries, "3");
+  context->setProperty(minifi::processors::MergeContent::CorrelationAttributeName, "tag");
+
+  bool is_archive = false;
+  std::string expected[2];
+  SECTION("Binary Concatenation") {
+    context->setProperty(minifi::processors::MergeContent::MergeFormat, minifi::processors::merge_content_options::MERGE_FORMAT_CONCAT_VALUE);
+    context->setProperty(minifi::processors::MergeContent::Header, "header");
+    context->setProperty(minifi::processors::MergeContent::Footer, "footer");
+    context->setProperty(minifi::processors::MergeContent::Demarcator, "demarcator");
+    expected[0] = "header" + flowFileContents[0] + "demarcator" + flowFileContents[2] + "demarcator" + flowFileContents[4] + "footer";
+    expected[1] = "header" + flowFileContents[1] + "demarcator" + flowFileContents[3] + "demarcator" + flowFileContents[5] + "footer";
+  }
+  SECTION("TAR") {
+    context->setProperty(minifi::processors::MergeContent::MergeFormat, minifi::processors::merge_content_options::MERGE_FORMAT_TAR_VALUE);
+    is_archive = true;
+  }
+  SECTION("ZIP") {
+    context->setProperty(minifi::processors::MergeContent::MergeFormat, minifi::processors::merge_content_options::MERGE_FORMAT_ZIP_VALUE);
+    is_archive = true;
+  }
+
+  core::ProcessSession sessionGenFlowFile(context);
+  // the flow files with even and odd indices are merged into separate bins
+  for (const int i : {0, 1, 2, 3, 4, 5}) {
+    const auto flow = sessionGenFlowFile.create();
+    sessionGenFlowFile.importFrom(minifi::io::BufferStream(flowFileContents[i]), flow);
+    flow->setAttribute("tag", std::to_string(i % 2));
+    sessionGenFlowFile.flushContent();
+    input->put(flow);
+  }
+
+  auto factory = std::make_shared<core::ProcessSessionFactory>(context);
+  processor->onSchedule(context, factory);
+  for (int i = 0; i < 6; i++) {
+    auto session = std::make_shared<core::ProcessSession>(context);
+    processor->onTrigger(context, session);
+    session->commit();
+  }
+
+  std::set<std::shared_ptr<core::FlowFile>> expiredFlowRecords;
+  std::map<std::string, std::shared_ptr<core::FlowFile>> merged_flows;
+  while (auto flow = output->poll(expiredFlowRecords)) {
+    merged_flows[flow->getAttribute("tag").value()] = flow;
+  }
+  REQUIRE(merged_flows.size() == 2);
+  for (int bin = 0; bin < 2; ++bin) {
+    const auto& flow = merged_flows.at(std::to_string(bin));
+    REQUIRE(flow->getSize() > 0);
+    FixedBuffer callback(gsl::narrow<size_t>(flow->getSize()));
+    sessionGenFlowFile.read(flow, &callback);
+    if (is_archive) {
+      auto archives = read_archives(callback);
+      REQUIRE(archives.size() == 3);
+      for (int i = 0; i < 3; i++) {
+        REQUIRE(archives[i].to_string() == flowFileContents[2 * i + bin]);
+      }
+    } else {
+      REQUIRE(callback.to_string() == expected[bin]);
+    }
+  }
+}
+
+TEST_CASE_METHOD(MergeTestController, "Streaming Merge closes and reopens the merged contents above the open stream limit", "[testMergeFileStreaming]") {
+  std::string merge_format;
+  bool is_archive = false;
+  SECTION("Binary Concatenation") {
+    merge_format = minifi::processors::merge_content_options::MERGE_FORMAT_CONCAT_VALUE;
+  }
+  SECTION("TAR") {
+    merge_format = minifi::processors::merge_content_options::MERGE_FORMAT_TAR_VALUE;
+    is_archive = true;
+  }
+
+  const auto content_repo = context->getContentRepository();
+  const auto open_streams = std::make_shared<minifi::processors::OpenMergeStreams>(1);
+  minifi::processors::StreamingMergeContent contents[2] = {
+    {content_repo, open_streams, merge_format, "header", "footer", "demarcator"},
+    {content_repo, open_streams, merge_format, "header", "footer", "demarcator"}
+  };
+
+  core::ProcessSession session(context);
+  // the two contents are appended to alternately, so each append has to reopen the content
+  for (const int i : {0, 1, 2, 3, 4, 5}) {
+    const auto flow = session.create();
+    session.importFrom(minifi::io::BufferStream(flowFileContents[i]), flow);
+    flow->setAttribute(core::SpecialFlowAttribute::FILENAME, std::to_string(i));
+    session.flushContent();
+    REQUIRE(contents[i % 2].append(session, flow));
+  }
+
+  for (int bin = 0; bin < 2; ++bin) {
+    const auto claim = contents[bin].finish();
+    REQUIRE(claim);
+    FixedBuffer buffer(gsl::narrow<size_t>(contents[bin].getSize()));
+    REQUIRE(buffer.write(*content_repo->read(*claim), buffer.capacity()) == gsl::narrow<int>(contents[bin].getSize()));
+    if (is_archive) {
+      auto archives = read_archives(buffer);
+      REQUIRE(archives.size() == 3);
+      for (int i = 0; i < 3; i++) {
+        REQUIRE(archives[i].to_string() == flowFileContents[2 * i + bin]);
+      }
+    } else {
+      REQUIRE(buffer.to_string() == "header" + flowFileContents[bin] + "demarcator" + flowFileContents[2 + bin] + "demarcator" + flowFileContents[4 + bin] + "footer");
+    }
+  }
+}
+
+namespace {
+void benchmarkMerge(const std::string& format, bool streaming) {
+  TestController test_controller;
+  auto configuration = std::make_shared<minifi::Configure>();
+  configuration->set(minifi::Configure::nifi_dbcontent_repository_directory_default, test_controller.createTempDirectory());
+  auto content_repo = std::make_shared<core::repository::FileSystemRepository>();
+  REQUIRE(content_repo->initialize(configuration));
+  MergeTestController controller(content_repo);
+  LogTestController::getInstance().setInfo<minifi::processors::MergeContent>();
+  LogTestController::getInstance().setInfo<core::ProcessSession>();
+  LogTestController::getInstance().setInfo<minifi::processors::BinFiles>();
+  LogTestController::getInstance().setInfo<minifi::processors::Bin>();
+  LogTestController::getInstance().setInfo<minifi::processors::BinManager>();
+  LogTestController::getInstance().setInfo<minifi::Connection>();
+  LogTestController::getInstance().setInfo<minifi::core::Connectable>();
+  auto context = controller.context;
+
+  const int bin_size = 10000;
+  const int batch_size = 1000;
+  const int bin_count = 3;
+  context->setProperty(minifi::processors::MergeContent::MergeStrategy, minifi::processors::merge_content_options::MERGE_STRATEGY_BIN_PACK);
+  context->setProperty(minifi::processors::MergeContent::MergeFormat, format);
+  context->setProperty(minifi::processors::MergeContent::StreamingMerge, streaming ? "true" : "false");
+  context->setProperty(minifi::processors::BinFiles::MinEntries, std::to_string(bin_size));
+  context->setProperty(minifi::processors::BinFiles::MaxEntries, std::to_string(bin_size));
+  context->setProperty(minifi::processors::BinFiles::BatchSize, std::to_string(batch_size));
+
+  const std::string content(1024, 'x');
+  core::ProcessSession sessionGenFlowFile(context);
+  for (int i = 0; i < bin_count * bin_size; ++i) {
+    const auto flow = sessionGenFlowFile.create();
+    sessionGenFlowFile.importFrom(minifi::io::BufferStream(content), flow);
+    sessionGenFlowFile.flushContent();
+    controller.input->put(flow);
+  }
+
+  auto factory = std::make_shared<core::ProcessSessionFactory>(context);
+  controller.processor->onSchedule(context, factory);
+  std::chrono::steady_clock::duration max_trigger_duration{};
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < bin_count * bin_size / batch_size; ++i) {
+    const auto trigger_start = std::chrono::steady_clock::now();
+    auto session = std::make_shared<core::ProcessSession>(context);
+    controller.processor->onTrigger(context, session);
+    session->commit();
+    max_trigger_duration = std::max(max_trigger_duration, std::chrono::steady_clock::now() - trigger_start);
+  }
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+
+  std::set<std::shared_ptr<core::FlowFile>> expiredFlowRecords;
+  int merged_count = 0;
+  while (auto flow = controller.output->poll(expiredFlowRecords)) {
+    REQUIRE(flow->getSize() >= gsl::narrow<uint64_t>(bin_size) * content.size());
+    ++merged_count;
+  }
+  REQUIRE(merged_count == bin_count);
+
+  using std::chrono::duration_cast;
+  using std::chrono::milliseconds;
+  std::cerr << format << (streaming ? " with" : " without") << " Streaming Merge: merging " << bin_count << " bins of " << bin_size << " flow files took "
+            << duration_cast<milliseconds>(elapsed).count() << " ms, the slowest trigger took " << duration_cast<milliseconds>(max_trigger_duration).count() << " ms" << std::endl;
+}
+}  // namespace
+
+TEST_CASE("Merging bins of 10000 flow files", "[testMergeFileStreaming][speed]") {
+  for (const auto* format : {minifi::processors::merge_content_options::MERGE_FORMAT_CONCAT_VALUE, minifi::processors::merge_content_options::MERGE_FORMAT_TAR_VALUE}) {
+    benchmarkMerge(format, false);
+    benchmarkMerge(format, true);
+  }
+}
+
+namespace {
+std::shared_ptr<core::FlowFile> createBinnedFlowFile(const std::string& fragment_count = "") {
+  auto flow = std::make_shared<core::FlowFile>();
+  if (!fragment_count.empty()) {
+    flow->setAttribute(minifi::processors::BinFiles::FRAGMENT_COUNT_ATTRIBUTE, fragment_count);
+  }
+  return flow;
+}
+
+size_t countReadyFlowFiles(minifi::processors::BinManager& bin_manager, std::deque<std::unique_ptr<minifi::processors::Bin>>& ready_bins) {
+  bin_manager.getReadyBin(ready_bins);
+  size_t flow_file_count = 0;
+  for (const auto& bin : ready_bins) {
+    flow_file_count += bin->getFlowFile().size();
+  }
+  return flow_file_count;
+}
+
+class RecordingBinContent : public minifi::processors::BinContent {
+ public:
+  explicit RecordingBinContent(std::function<void()> on_append = {})
+      : on_append_(std::move(on_append)) {
+  }
+
+  bool append(core::ProcessSession&, const std::shared_ptr<core::FlowFile>& flow) override {
+    if (on_append_) {
+      on_append_();
+    }
+    appended_.push_back(flow);
+    return true;
+  }
+
+  std::vector<std::shared_ptr<core::FlowFile>> appended_;
+
+ private:
+  std::function<void()> on_append_;
+};
+
+class BinContentFixture {
+ public:
+  BinContentFixture() {
+    plan_->addProcessor("LogAttribute", "log");
+    plan_->runNextProcessor();
+    session_ = std::make_unique<core::ProcessSession>(plan_->getCurrentContext());
+  }
+
+  core::ProcessSession* session() {
+    return session_.get();
+  }
+
+ private:
+  TestController test_controller_;
+  std::shared_ptr<TestPlan> plan_ = test_controller_.createPlan();
+  std::unique_ptr<core::ProcessSession> session_;
+};
+}  // namespace
+
+TEST_CASE("BinManager gathers the ready and the expired bins of many groups", "[BinManager]") {
+  minifi::processors::BinManager bin_manager;
+  bin_manager.setMinEntries(2);
+  bin_manager.setMaxEntries(2);
+  for (int i = 0; i < 1000; ++i) {
+    REQUIRE(bin_manager.offer(std::to_string(i), createBinnedFlowFile()));
+  }
+  REQUIRE(bin_manager.offer("full", createBinnedFlowFile()));
+  REQUIRE(bin_manager.offer("full", createBinnedFlowFile()));
+  REQUIRE(bin_manager.offer("full", createBinnedFlowFile()));
+  REQUIRE(bin_manager.getBinCount() == 1002);
+
+  std::deque<std::unique_ptr<minifi::processors::Bin>> ready_bins;
+  bin_manager.gatherReadyBins();
+  REQUIRE(countReadyFlowFiles(bin_manager, ready_bins) == 2);
+  REQUIRE(ready_bins.size() == 1);
+  REQUIRE(ready_bins.front()->getGroupId() == "full");
+  REQUIRE(bin_manager.getBinCount() == 1001);
+
+  ready_bins.clear();
+  bin_manager.removeOldestBin();
+  REQUIRE(countReadyFlowFiles(bin_manager, ready_bins) == 1);
+  REQUIRE(ready_bins.front()->getGroupId() == "0");
+  REQUIRE(bin_manager.getBinCount() == 1000);
+
+  ready_bins.clear();
+  bin_manager.setBinAge(std::chrono::milliseconds(1));
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  bin_manager.gatherReadyBins();
+  REQUIRE(countReadyFlowFiles(bin_manager, ready_bins) == 1000);
+  REQUIRE(bin_manager.getBinCount() == 0);
+
+  ready_bins.clear();
+  bin_manager.gatherReadyBins();
+  bin_manager.removeOldestBin();
+  REQUIRE(countReadyFlowFiles(bin_manager, ready_bins) == 0);
+}
+
+TEST_CASE("BinManager bins the flow files of different groups concurrently", "[BinManager]") {
+  minifi::processors::BinManager bin_manager;
+  bin_manager.setFileCount(minifi::processors::BinFiles::FRAGMENT_COUNT_ATTRIBUTE);
+
+  const int thread_count = 4;
+  const int group_count = 1000;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < thread_count; ++i) {
+    threads.emplace_back([&bin_manager, i] {
+      for (int fragment = 0; fragment < 3; ++fragment) {
+        for (int group = 0; group < group_count; ++group) {
+          bin_manager.offer(std::to_string(i) + "-" + std::to_string(group), createBinnedFlowFile("3"));
+        }
+        bin_manager.gatherReadyBins();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  bin_manager.gatherReadyBins();
+
+  std::deque<std::unique_ptr<minifi::processors::Bin>> ready_bins;
+  REQUIRE(countReadyFlowFiles(bin_manager, ready_bins) == 3 * thread_count * group_count);
+  REQUIRE(ready_bins.size() == thread_count * group_count);
+  REQUIRE(bin_manager.getBinCount() == 0);
+}
+
+TEST_CASE("BinManager appends the content of the flow files without holding the lock of their group", "[BinManager]") {
+  BinContentFixture fixture;
+  minifi::processors::BinManager bin_manager;
+  bin_manager.setMinEntries(3);
+  bin_manager.setMaxEntries(3);
+  RecordingBinContent* content = nullptr;
+  bin_manager.setContentFactory([&] {
+    auto new_content = std::make_unique<RecordingBinContent>([&bin_manager] {
+      // gathering needs the lock of the group, so it would wait for the append if the content was appended holding it
+      auto gathering = std::async(std::launch::async, [&bin_manager] { bin_manager.gatherReadyBins(); });
+      REQUIRE(gathering.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+    });
+    content = new_content.get();
+    return new_content;
+  });
+
+  for (int i = 0; i < 3; ++i) {
+    REQUIRE(bin_manager.offer("group", createBinnedFlowFile(), fixture.session()));
+  }
+  bin_manager.gatherReadyBins();
+
+  std::deque<std::unique_ptr<minifi::processors::Bin>> ready_bins;
+  REQUIRE(countReadyFlowFiles(bin_manager, ready_bins) == 3);
+  REQUIRE(ready_bins.front()->getContent() == content);
+  const auto& binned = ready_bins.front()->getFlowFile();
+  REQUIRE(content->appended_ == std::vector<std::shared_ptr<core::FlowFile>>(binned.begin(), binned.end()));
+}
+
+TEST_CASE("BinManager appends the content of the flow files binned concurrently in the order of the bin", "[BinManager]") {
+  BinContentFixture fixture;
+  minifi::processors::BinManager bin_manager;
+  RecordingBinContent* content = nullptr;
+  bin_manager.setContentFactory([&] {
+    auto new_content = std::make_unique<RecordingBinContent>();
+    content = new_content.get();
+    return new_content;
+  });
+
+  const int thread_count = 4;
+  const int flow_file_count = 1000;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < thread_count; ++i) {
+    threads.emplace_back([&bin_manager, &fixture] {
+      for (int j = 0; j < flow_file_count; ++j) {
+        // the content does not use the session, so it can be shared by the threads
+        bin_manager.offer("group", createBinnedFlowFile(), fixture.session());
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  bin_manager.removeOldestBin();
+
+  std::deque<std::unique_ptr<minifi::processors::Bin>> ready_bins;
+  REQUIRE(countReadyFlowFiles(bin_manager, ready_bins) == thread_count * flow_file_count);
+  REQUIRE(ready_bins.front()->getContent() == content);
+  const auto& binned = ready_bins.front()->getFlowFile();
+  REQUIRE(content->appended_ == std::vector<std::shared_ptr<core::FlowFile>>(binned.begin(), binned.end()));
+}
+
+TEST_CASE("BinManager offer and gathering with many groups", "[BinManager][speed]") {
+  LogTestController::getInstance().setInfo<minifi::processors::Bin>();
+  LogTestController::getInstance().setInfo<minifi::processors::BinManager>();
+  minifi::processors::BinManager bin_manager;
+  bin_manager.setFileCount(minifi::processors::BinFiles::FRAGMENT_COUNT_ATTRIBUTE);
+  bin_manager.setBinAge(std::chrono::hours(1));
+
+  // every group is completed by its last fragment, while the other groups are waiting for fragments
+  const int group_count = 10000;
+  const int fragment_count = 10;
+  const int batch_size = 100;
+  std::deque<std::unique_ptr<minifi::processors::Bin>> ready_bins;
+  const auto start = std::chrono::steady_clock::now();
+  for (int fragment = 0; fragment < fragment_count; ++fragment) {
+    for (int group = 0; group < group_count; ++group) {
+      REQUIRE(bin_manager.offer(std::to_string(group), createBinnedFlowFile(std::to_string(fragment_count))));
+      if (group % batch_size == 0) {
+        bin_manager.gatherReadyBins();
+      }
+    }
+  }
+  bin_manager.gatherReadyBins();
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+
+  REQUIRE(countReadyFlowFiles(bin_manager, ready_bins) == group_count * fragment_count);
+  std::cerr << "Binning " << fragment_count << " fragments of " << group_count << " groups, gathering the ready bins after every " << batch_size
+            << " flow files took " << std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() << " ms" << std::endl;
+}
@@ -0,0 +1,178 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <memory>
+#include <set>
+#include <string>
+
+#include "../TestBase.h"
+#include "core/Processor.h"
+#include "core/ProcessSession.h"
+#include "core/ProcessSessionFactory.h"
+#include "FlowFileRecord.h"
+
+using namespace std::literals::chrono_literals;
+
+namespace {
+
+class PassThroughProcessor : public core::Processor {
+ public:
+  using core::Processor::Processor;
+  using core::Processor::onTrigger;
+
+  static const core::Relationship Success;
+
+  void initialize() override {
+    setSupportedRelationships({Success});
+  }
+
+  void onTrigger(const std::shared_ptr<core::ProcessContext>& /*context*/, const std::shared_ptr<core::ProcessSession>& session) override {
+    ++trigger_count_;
+    const auto flow_file = session->get();
+    if (!flow_file) {
+      return;
+    }
+    session->transfer(flow_file, Success);
+    if (yield_after_ != 0 && trigger_count_ == yield_after_) {
+      yield(10s);
+    }
+  }
+
+  bool supportsBatching() const override {
+    return supports_batching_;
+  }
+
+  size_t trigger_count_ = 0;
+  size_t yield_after_ = 0;
+  bool supports_batching_ = true;
+};
+
+const core::Relationship PassThroughProcessor::Success{"success", "everything is passed through"};
+
+class RunDurationFixture {
+ public:
+  RunDurationFixture() {
+    processor_->setScheduledState(core::ScheduledState::RUNNING);
+    processor_->incrementActiveTasks();
+  }
+
+  void enqueue(size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+      input_->put(std::make_shared<minifi::FlowFileRecord>());
+    }
+  }
+
+  void trigger() {
+    processor_->onTrigger(context_, session_factory_);
+  }
+
+  size_t inputSize() const {
+    return input_->getQueueSize();
+  }
+
+  size_t outputSize() const {
+    return output_->getQueueSize();
+  }
+
+  PassThroughProcessor& processor() {
+    return *processor_;
+  }
+
+ private:
+  TestController test_controller_;
+  std::shared_ptr<TestPlan> plan_ = test_controller_.createPlan();
+  std::shared_ptr<PassThroughProcessor> processor_ = [this] {
+    auto processor = std::make_shared<PassThroughProcessor>("pass_through");
+    plan_->addProcessor(processor, processor->getName());
+    return processor;
+  }();
+  std::shared_ptr<minifi::Connection> input_ = plan_->addConnection(nullptr, PassThroughProcessor::Success, processor_);
+  std::shared_ptr<minifi::Connection> output_ = plan_->addConnection(processor_, PassThroughProcessor::Success, nullptr);
+  std::shared_ptr<core::ProcessContext> context_ = plan_->getProcessContextForProcessor(processor_);
+  std::shared_ptr<core::ProcessSessionFactory> session_factory_ = std::make_shared<core::ProcessSessionFactory>(context_);
+};
+
+}  // namespace
+
+TEST_CASE("Without a run duration the processor is triggered once per scheduling", "[RunDuration]") {
+  RunDurationFixture fixture;
+  fixture.enqueue(10);
+
+  fixture.trigger();
+  REQUIRE(fixture.processor().trigger_count_ == 1);
+  REQUIRE(fixture.outputSize() == 1);
+  REQUIRE(fixture.inputSize() == 9);
+}
+
+TEST_CASE("With a run duration the processor is triggered until its input runs dry", "[RunDuration]") {
+  RunDurationFixture fixture;
+  fixture.processor().setRunDurationNano(10s);
+  fixture.enqueue(100);
+
+  fixture.trigger();
+  REQUIRE(fixture.processor().trigger_count_ == 100);
+  REQUIRE(fixture.outputSize() == 100);
+  REQUIRE(fixture.inputSize() == 0);
+}
+
+TEST_CASE("A processor not supporting batching is triggered once per scheduling despite its run duration", "[RunDuration]") {
+  RunDurationFixture fixture;
+  fixture.processor().setRunDurationNano(10s);
+  fixture.processor().supports_batching_ = false;
+  fixture.enqueue(10);
+
+  fixture.trigger();
+  REQUIRE(fixture.processor().trigger_count_ == 1);
+  REQUIRE(fixture.outputSize() == 1);
+  REQUIRE(fixture.inputSize() == 9);
+}
+
+TEST_CASE("With a run duration the processor stops being triggered when it yields", "[RunDuration]") {
+  RunDurationFixture fixture;
+  fixture.processor().setRunDurationNano(10s);
+  fixture.processor().yield_after_ = 5;
+  fixture.enqueue(100);
+
+  fixture.trigger();
+  REQUIRE(fixture.processor().trigger_count_ == 5);
+  REQUIRE(fixture.outputSize() == 5);
+  REQUIRE(fixture.inputSize() == 95);
+}
+
+TEST_CASE("Throughput of the processor depending on the run duration", "[RunDuration][speed]") {
+  // stays below the default backpressure threshold of the output connection
+  const size_t flow_file_count = 5000;
+  for (const auto run_duration : {0ms, 1ms, 10ms, 100ms}) {
+    RunDurationFixture fixture;
+    fixture.processor().setRunDurationNano(run_duration);
+    fixture.enqueue(flow_file_count);
+
+    size_t commit_count = 0;
+    const auto start = std::chrono::steady_clock::now();
+    while (fixture.inputSize() > 0) {
+      fixture.trigger();
+      ++commit_count;
+    }
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    REQUIRE(fixture.outputSize() == flow_file_count);
+
+    std::cerr << "Passing " << flow_file_count << " flow files through with a run duration of " << run_duration.count() << "ms took " << elapsed.count() << "ms in "
+              << commit_count << " commits, " << (elapsed.count() == 0 ? 0 : flow_file_count * 1000 / elapsed.count()) << " flow files/s" << std::endl;
+  }
+}
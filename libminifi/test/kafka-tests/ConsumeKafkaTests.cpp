@@ -0,0 +1,139 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <array>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "SingleInputTestController.h"
+#include "ConsumeKafka.h"
+#include "KafkaRecordIndex.h"
+#include "rdkafka.h"
+#include "rdkafka_mock.h"
+#include "rdkafka_utils.h"
+#include "utils/gsl.h"
+
+namespace org::apache::nifi::minifi::processors {
+
+namespace {
+constexpr const char* TOPIC = "test-topic";
+
+// a mock cluster of librdkafka, the messages are produced by the client owning it and consumed through its bootstrap servers
+class MockKafkaCluster {
+ public:
+  MockKafkaCluster() {
+    std::array<char, 512> errstr{};
+    rd_kafka_conf_t* conf = rd_kafka_conf_new();
+    REQUIRE(RD_KAFKA_CONF_OK == rd_kafka_conf_set(conf, "test.mock.num.brokers", "1", errstr.data(), errstr.size()));
+    // the producer takes the ownership of the configuration
+    producer_ = std::unique_ptr<rd_kafka_t, utils::rd_kafka_producer_deleter>(rd_kafka_new(RD_KAFKA_PRODUCER, conf, errstr.data(), errstr.size()));
+    REQUIRE(producer_);
+    cluster_ = rd_kafka_handle_mock_cluster(producer_.get());
+    REQUIRE(cluster_);
+    REQUIRE(RD_KAFKA_RESP_ERR_NO_ERROR == rd_kafka_mock_topic_create(cluster_, TOPIC, 1, 1));
+  }
+
+  MockKafkaCluster(const MockKafkaCluster&) = delete;
+  MockKafkaCluster& operator=(const MockKafkaCluster&) = delete;
+
+  std::string getBootstrapServers() const {
+    return rd_kafka_mock_cluster_bootstraps(cluster_);
+  }
+
+  void produce(const std::string& message, const std::string& key, const std::string& header_value) {
+    REQUIRE(RD_KAFKA_RESP_ERR_NO_ERROR == rd_kafka_producev(producer_.get(),
+        RD_KAFKA_V_TOPIC(TOPIC),
+        RD_KAFKA_V_PARTITION(0),
+        RD_KAFKA_V_MSGFLAGS(RD_KAFKA_MSG_F_COPY),
+        RD_KAFKA_V_VALUE(const_cast<char*>(message.data()), message.size()),
+        RD_KAFKA_V_KEY(key.data(), key.size()),
+        RD_KAFKA_V_HEADER("header", header_value.data(), gsl::narrow<ssize_t>(header_value.size())),
+        RD_KAFKA_V_END));
+  }
+
+  void flush() {
+    REQUIRE(RD_KAFKA_RESP_ERR_NO_ERROR == rd_kafka_flush(producer_.get(), 10000));
+  }
+
+ private:
+  std::unique_ptr<rd_kafka_t, utils::rd_kafka_producer_deleter> producer_;
+  // owned by the producer
+  rd_kafka_mock_cluster_t* cluster_ = nullptr;
+};
+}  // namespace
+
+TEST_CASE("ConsumeKafka writes the messages of a partition into batches", "[ConsumeKafka]") {
+  MockKafkaCluster cluster;
+  const std::vector<std::string> messages{"first", "", "third message", "fourth", "fifth"};
+  for (size_t i = 0; i < messages.size(); ++i) {
+    cluster.produce(messages[i], "key" + std::to_string(i), "value" + std::to_string(i));
+  }
+  cluster.flush();
+
+  const auto consume_kafka = std::make_shared<ConsumeKafka>("ConsumeKafka");
+  test::SingleInputTestController controller{consume_kafka};
+  consume_kafka->setProperty(ConsumeKafka::KafkaBrokers, cluster.getBootstrapServers());
+  consume_kafka->setProperty(ConsumeKafka::TopicNames, TOPIC);
+  consume_kafka->setProperty(ConsumeKafka::GroupID, "test-group");
+  consume_kafka->setProperty(ConsumeKafka::OffsetReset, ConsumeKafka::OFFSET_RESET_EARLIEST);
+  consume_kafka->setProperty(ConsumeKafka::OutputStrategy, ConsumeKafka::OUTPUT_STRATEGY_BATCH);
+  consume_kafka->setProperty(ConsumeKafka::MessageDemarcator, "|");
+  consume_kafka->setProperty(ConsumeKafka::HeadersToAddAsAttributes, "header");
+  consume_kafka->setProperty(ConsumeKafka::MaxPollRecords, "2");
+  consume_kafka->setProperty(ConsumeKafka::MaxPollTime, "1 sec");
+
+  std::vector<std::string> consumed_messages;
+  int64_t next_offset = 0;
+  // the first triggers may return nothing until the consumer joins the group
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{30};
+  while (consumed_messages.size() < messages.size() && std::chrono::steady_clock::now() < deadline) {
+    const auto result = controller.trigger(std::vector<test::InputFlowFileData>{});
+    for (const auto& flow_file : result.at(ConsumeKafka::Success)) {
+      const auto count = std::stoul(*flow_file->getAttribute(ConsumeKafka::KAFKA_COUNT_ATTR));
+      REQUIRE(count >= 1);
+      REQUIRE(count <= 2);
+      REQUIRE(flow_file->getAttribute(ConsumeKafka::KAFKA_OFFSET_ATTR) == std::to_string(next_offset));
+      REQUIRE(flow_file->getAttribute(ConsumeKafka::KAFKA_PARTITION_ATTR) == "0");
+      REQUIRE(flow_file->getAttribute(ConsumeKafka::KAFKA_TOPIC_ATTR) == TOPIC);
+
+      const auto index = KafkaRecordIndex::parse(*flow_file->getAttribute(ConsumeKafka::KAFKA_RECORD_INDEX_ATTR));
+      REQUIRE(index);
+      REQUIRE(index->records().size() == count);
+      const auto content = controller.plan->getContent(flow_file);
+      for (const auto& record : index->records()) {
+        REQUIRE(record.offset == next_offset);
+        REQUIRE(record.key == "key" + std::to_string(next_offset));
+        REQUIRE(record.headers == std::vector<std::pair<std::string, std::string>>{{"header", "value" + std::to_string(next_offset)}});
+        REQUIRE(record.position + record.length <= content.size());
+        if (&record != &index->records().back()) {
+          REQUIRE(content.substr(record.position + record.length, 1) == "|");
+        } else {
+          REQUIRE(record.position + record.length == content.size());
+        }
+        consumed_messages.push_back(content.substr(record.position, record.length));
+        ++next_offset;
+      }
+    }
+  }
+  REQUIRE(consumed_messages == messages);
+}
+
+}  // namespace org::apache::nifi::minifi::processors
@@ -0,0 +1,78 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "TestBase.h"
+#include "KafkaRecordIndex.h"
+
+using org::apache::nifi::minifi::processors::KafkaRecordIndex;
+
+TEST_CASE("KafkaRecordIndex calculates the positions of the records", "[KafkaRecordIndex]") {
+  KafkaRecordIndex index(2);
+  index.add(100, 5, std::string("key"), {});
+  index.add(101, 0, std::nullopt, {});
+  index.add(103, 7, std::nullopt, {{"header", "value"}});
+
+  const auto& records = index.records();
+  REQUIRE(records.size() == 3);
+  REQUIRE(records[0].position == 0);
+  REQUIRE(records[1].position == 7);
+  REQUIRE(records[2].position == 9);
+}
+
+TEST_CASE("KafkaRecordIndex can be serialized and parsed", "[KafkaRecordIndex]") {
+  KafkaRecordIndex index;
+  index.add(42, 10, std::string("key\0with null", 13), {{"header", "first"}, {"header", "second"}});
+  index.add(45, 3, std::nullopt, {});
+  index.add(46, 0, std::string(), {{"empty", ""}});
+
+  const auto parsed = KafkaRecordIndex::parse(index.serialize());
+  REQUIRE(parsed);
+  const auto& records = parsed->records();
+  REQUIRE(records.size() == 3);
+
+  REQUIRE(records[0].offset == 42);
+  REQUIRE(records[0].position == 0);
+  REQUIRE(records[0].length == 10);
+  REQUIRE(records[0].key == std::string("key\0with null", 13));
+  REQUIRE(records[0].headers == std::vector<std::pair<std::string, std::string>>{{"header", "first"}, {"header", "second"}});
+
+  REQUIRE(records[1].offset == 45);
+  REQUIRE(records[1].position == 10);
+  REQUIRE_FALSE(records[1].key);
+  REQUIRE(records[1].headers.empty());
+
+  REQUIRE(records[2].offset == 46);
+  REQUIRE(records[2].position == 13);
+  REQUIRE(records[2].length == 0);
+  REQUIRE(records[2].key == std::string());
+  REQUIRE(records[2].headers == std::vector<std::pair<std::string, std::string>>{{"empty", ""}});
+}
+
+TEST_CASE("KafkaRecordIndex rejects invalid input", "[KafkaRecordIndex]") {
+  REQUIRE_FALSE(KafkaRecordIndex::parse("not base64!"));
+  REQUIRE_FALSE(KafkaRecordIndex::parse(""));
+
+  KafkaRecordIndex index;
+  index.add(1, 1, std::string("key"), {});
+  const auto serialized = index.serialize();
+  REQUIRE_FALSE(KafkaRecordIndex::parse(serialized.substr(0, serialized.size() - 8)));
+}
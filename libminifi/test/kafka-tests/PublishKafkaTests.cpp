@@ -0,0 +1,72 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "SingleInputTestController.h"
+#include "PublishKafka.h"
+
+namespace org::apache::nifi::minifi::processors {
+
+namespace {
+// the mock cluster of librdkafka replaces the known brokers, so the tests need no running Kafka
+// the properties are set after the processor is added to the controller, as it is initialized there
+void configureMockPublishKafka(PublishKafka& publish_kafka) {
+  publish_kafka.setProperty(PublishKafka::SeedBrokers, "localhost:9092");
+  publish_kafka.setProperty(PublishKafka::ClientName, "minifi-test");
+  publish_kafka.setProperty(PublishKafka::Topic, "test-topic");
+  publish_kafka.setDynamicProperty("test.mock.num.brokers", "1");
+}
+}  // namespace
+
+TEST_CASE("PublishKafka publishes segmented flow files with headers", "[PublishKafka]") {
+  const auto publish_kafka = std::make_shared<PublishKafka>("PublishKafka");
+  test::SingleInputTestController controller{publish_kafka};
+  configureMockPublishKafka(*publish_kafka);
+  publish_kafka->setProperty(PublishKafka::MaxFlowSegSize, "10 B");
+  publish_kafka->setProperty(PublishKafka::AttributeNameRegex, "kafka\\..*");
+
+  const auto result = controller.trigger("a message longer than a single segment", {{"kafka.header", "value"}, {"other", "value"}});
+  REQUIRE(result.at(PublishKafka::Success).size() == 1);
+  REQUIRE(result.at(PublishKafka::Failure).empty());
+}
+
+TEST_CASE("PublishKafka produce throughput", "[PublishKafka][speed]") {
+  const auto publish_kafka = std::make_shared<PublishKafka>("PublishKafka");
+  test::SingleInputTestController controller{publish_kafka};
+  configureMockPublishKafka(*publish_kafka);
+  publish_kafka->setProperty(PublishKafka::MaxFlowSegSize, "16 KB");
+  publish_kafka->setProperty(PublishKafka::QueueBufferMaxSize, "64 MB");
+  publish_kafka->setProperty(PublishKafka::QueueBufferMaxMessage, "100000");
+
+  const std::string content(4 * 1024 * 1024, 'x');
+  const int flow_file_count = 25;
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < flow_file_count; ++i) {
+    const auto result = controller.trigger(content, {{"kafka.index", std::to_string(i)}});
+    REQUIRE(result.at(PublishKafka::Success).size() == 1);
+  }
+  const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+  std::cerr << "Publishing " << flow_file_count << " flow files of " << content.size() / 1024 << " KB to the mock cluster took " << elapsed.count() << "ms, "
+            << (elapsed.count() == 0 ? 0 : flow_file_count * content.size() * 1000 / elapsed.count() / (1024 * 1024)) << " MB/s" << std::endl;
+}
+
+}  // namespace org::apache::nifi::minifi::processors
@@ -30,10 +30,13 @@
 template<typename ContentRepositoryClass>
 class ContentSessionController : public TestController {
  public:
-  ContentSessionController() {
+  explicit ContentSessionController(const std::string& spill_threshold = "") {
     std::string contentRepoPath = createTempDirectory();
     auto config = std::make_shared<minifi::Configure>();
     config->set(minifi::Configure::nifi_dbcontent_repository_directory_default, contentRepoPath);
+    if (!spill_threshold.empty()) {
+      config->set(minifi::Configure::nifi_content_repository_session_spill_threshold, spill_threshold);
+    }
     contentRepository = std::make_shared<ContentRepositoryClass>();
     contentRepository->initialize(config);
   }
@@ -66,8 +69,8 @@ const std::shared_ptr<minifi::io::BaseStream>& operator>>(const std::shared_ptr<
 //  seems like the current version of Catch2 does not support templated tests
 //  we should update instead of creating make-shift macros
 template<typename ContentRepositoryClass>
-void test_template() {
-  ContentSessionController<ContentRepositoryClass> controller;
+void test_template(const std::string& spill_threshold = "") {
+  ContentSessionController<ContentRepositoryClass> controller(spill_threshold);
   std::shared_ptr<core::ContentRepository> contentRepository = controller.contentRepository;
 
 
@@ -147,3 +150,73 @@ TEST_CASE("ContentSession behavior") {
     test_template<core::repository::DatabaseContentRepository>();
   }
 }
+
+TEST_CASE("ContentSession behavior with spilling writes") {
+  SECTION("FileSystemRepository") {
+    test_template<core::repository::FileSystemRepository>("4 B");
+  }
+  SECTION("DatabaseContentRepository") {
+    test_template<core::repository::DatabaseContentRepository>("4 B");
+  }
+}
+
+TEST_CASE("ContentSession streams large content into the repository before commit") {
+  ContentSessionController<core::repository::FileSystemRepository> controller("16 B");
+  auto contentRepository = controller.contentRepository;
+
+  auto session = contentRepository->createSession();
+  auto claim = session->create();
+  auto stream = session->write(claim);
+  stream << "small";
+  REQUIRE_FALSE(contentRepository->exists(*claim));
+  stream << "-but-now-larger-than-the-threshold";
+  REQUIRE(contentRepository->exists(*claim));
+  REQUIRE(stream->size() == 39);
+
+  SECTION("Commit") {
+    session->commit();
+    std::string content;
+    contentRepository->read(*claim) >> content;
+    REQUIRE(content == "small-but-now-larger-than-the-threshold");
+  }
+
+  SECTION("Rollback") {
+    session->rollback();
+    REQUIRE_FALSE(contentRepository->exists(*claim));
+  }
+}
+
+TEST_CASE("DatabaseContentRepository appends content larger than the spill threshold") {
+  ContentSessionController<core::repository::DatabaseContentRepository> controller("16 B");
+  auto contentRepository = controller.contentRepository;
+
+  std::shared_ptr<minifi::ResourceClaim> claim;
+  {
+    auto session = contentRepository->createSession();
+    claim = session->create();
+    session->write(claim) << "data";
+    session->commit();
+  }
+
+  std::string extension;
+  for (size_t i = 0; i < 1000; ++i) {
+    extension += static_cast<char>('a' + i % 26);
+  }
+  auto session = contentRepository->createSession();
+  auto stream = session->write(claim, core::ContentSession::WriteMode::APPEND);
+  stream << "-" << extension.substr(0, 10) << extension.substr(10);
+
+  SECTION("Commit") {
+    session->commit();
+    std::string content;
+    contentRepository->read(*claim) >> content;
+    REQUIRE(content == "data-" + extension);
+  }
+
+  SECTION("Rollback") {
+    session->rollback();
+    std::string content;
+    contentRepository->read(*claim) >> content;
+    REQUIRE(content == "data");
+  }
+}
@@ -17,11 +17,18 @@
  */
 
 #include <array>
+#include <atomic>
 #include <chrono>
+#include <limits>
+#include <memory>
 #include <random>
+#include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
 #include "ProvenanceRepository.h"
+#include "FlowFileRecord.h"
 #include "../TestBase.h"
 
 #define TEST_PROVENANCE_STORAGE_SIZE (1024*100)  // 100 KB
@@ -29,6 +36,9 @@
 
 using namespace std::literals::chrono_literals;
 
+using minifi::provenance::ProvenanceEventRecord;
+using minifi::provenance::ProvenanceQuery;
+
 void generateData(std::vector<char>& data) {
   std::random_device rd;
   std::mt19937 eng(rd());
@@ -113,3 +123,388 @@ TEST_CASE("Test time limit", "[timeLimitTest]") {
 
   verifyMaxKeyCount(provdb, 400);
 }
+
+namespace {
+
+const auto TEST_EPOCH = std::chrono::system_clock::time_point{1600000000000ms};
+
+std::shared_ptr<ProvenanceEventRecord> createEvent(ProvenanceEventRecord::ProvenanceEventType type, const std::string& component_id, std::shared_ptr<core::FlowFile> flow_file,
+    std::chrono::system_clock::time_point event_time) {
+  auto event = std::make_shared<ProvenanceEventRecord>(type, component_id, "TestProcessor");
+  event->fromFlowFile(flow_file);
+  event->setEventTime(event_time);
+  return event;
+}
+
+void storeEvents(minifi::provenance::ProvenanceRepository& repo, const std::vector<std::shared_ptr<ProvenanceEventRecord>>& events) {
+  std::vector<std::pair<std::string, std::unique_ptr<minifi::io::BufferStream>>> data;
+  for (const auto& event : events) {
+    auto stream = std::make_unique<minifi::io::BufferStream>();
+    REQUIRE(event->Serialize(*stream));
+    data.emplace_back(event->getUUIDStr(), std::move(stream));
+  }
+  REQUIRE(repo.MultiPut(data));
+}
+
+std::vector<utils::Identifier> getEventIds(const minifi::provenance::ProvenanceQueryResult& events) {
+  std::vector<utils::Identifier> ids;
+  for (const auto& event : events) {
+    ids.push_back(event->getEventId());
+  }
+  return ids;
+}
+
+}  // namespace
+
+TEST_CASE("Provenance events can be queried by FlowFile, component and time", "[provenanceQuery]") {
+  TestController testController;
+  auto temp_dir = testController.createTempDirectory();
+  minifi::provenance::ProvenanceRepository provdb("TestProvRepo", temp_dir, 1min, TEST_MAX_PROVENANCE_STORAGE_SIZE, 1s);
+  REQUIRE(provdb.initialize(std::make_shared<minifi::Configure>()));
+
+  std::shared_ptr<core::FlowFile> first_flow_file = std::make_shared<minifi::FlowFileRecord>();
+  std::shared_ptr<core::FlowFile> second_flow_file = std::make_shared<minifi::FlowFileRecord>();
+  const auto create = createEvent(ProvenanceEventRecord::CREATE, "generator", first_flow_file, TEST_EPOCH);
+  const auto modify = createEvent(ProvenanceEventRecord::CONTENT_MODIFIED, "replacer", first_flow_file, TEST_EPOCH + 1s);
+  const auto other_create = createEvent(ProvenanceEventRecord::CREATE, "generator", second_flow_file, TEST_EPOCH + 2s);
+  const auto send = createEvent(ProvenanceEventRecord::SEND, "sender", first_flow_file, TEST_EPOCH + 3s);
+  storeEvents(provdb, {create, modify, other_create, send});
+
+  ProvenanceQuery query;
+  SECTION("by FlowFile") {
+    query.flow_file_uuid = first_flow_file->getUUID();
+    const auto result = provdb.queryProvenance(query);
+    REQUIRE(result);
+    REQUIRE(getEventIds(*result) == std::vector<utils::Identifier>{send->getEventId(), modify->getEventId(), create->getEventId()});
+    REQUIRE((*result)[1]->getEventType() == ProvenanceEventRecord::CONTENT_MODIFIED);
+  }
+  SECTION("by component") {
+    query.component_id = "generator";
+    const auto result = provdb.queryProvenance(query);
+    REQUIRE(result);
+    REQUIRE(getEventIds(*result) == std::vector<utils::Identifier>{other_create->getEventId(), create->getEventId()});
+  }
+  SECTION("by component id which is a prefix of another one") {
+    query.component_id = "gen";
+    const auto result = provdb.queryProvenance(query);
+    REQUIRE(result);
+    REQUIRE(result->empty());
+  }
+  SECTION("by time") {
+    query.begin = TEST_EPOCH + 1s;
+    query.end = TEST_EPOCH + 2s;
+    const auto result = provdb.queryProvenance(query);
+    REQUIRE(result);
+    REQUIRE(getEventIds(*result) == std::vector<utils::Identifier>{other_create->getEventId(), modify->getEventId()});
+  }
+  SECTION("by FlowFile and time, limited") {
+    query.flow_file_uuid = first_flow_file->getUUID();
+    query.begin = TEST_EPOCH + 500ms;
+    query.max_results = 1;
+    const auto result = provdb.queryProvenance(query);
+    REQUIRE(result);
+    REQUIRE(getEventIds(*result) == std::vector<utils::Identifier>{send->getEventId()});
+  }
+  SECTION("by FlowFile and component") {
+    query.flow_file_uuid = first_flow_file->getUUID();
+    query.component_id = "replacer";
+    const auto result = provdb.queryProvenance(query);
+    REQUIRE(result);
+    REQUIRE(getEventIds(*result) == std::vector<utils::Identifier>{modify->getEventId()});
+  }
+}
+
+TEST_CASE("The lineage of a FlowFile can be queried from the provenance repository", "[provenanceQuery]") {
+  TestController testController;
+  auto temp_dir = testController.createTempDirectory();
+  minifi::provenance::ProvenanceRepository provdb("TestProvRepo", temp_dir, 1min, TEST_MAX_PROVENANCE_STORAGE_SIZE, 1s);
+  REQUIRE(provdb.initialize(std::make_shared<minifi::Configure>()));
+
+  std::shared_ptr<core::FlowFile> parent = std::make_shared<minifi::FlowFileRecord>();
+  std::shared_ptr<core::FlowFile> child = std::make_shared<minifi::FlowFileRecord>();
+  std::shared_ptr<core::FlowFile> unrelated = std::make_shared<minifi::FlowFileRecord>();
+  const auto create = createEvent(ProvenanceEventRecord::CREATE, "generator", parent, TEST_EPOCH);
+  const auto fork = createEvent(ProvenanceEventRecord::FORK, "splitter", parent, TEST_EPOCH + 1s);
+  fork->addChildFlowFile(child);
+  const auto send = createEvent(ProvenanceEventRecord::SEND, "sender", child, TEST_EPOCH + 2s);
+  const auto other_create = createEvent(ProvenanceEventRecord::CREATE, "generator", unrelated, TEST_EPOCH + 3s);
+  storeEvents(provdb, {create, fork, send, other_create});
+
+  ProvenanceQuery query;
+  query.flow_file_uuid = child->getUUID();
+  auto result = provdb.queryProvenance(query);
+  REQUIRE(result);
+  REQUIRE(getEventIds(*result) == std::vector<utils::Identifier>{send->getEventId(), fork->getEventId()});
+
+  query.include_lineage = true;
+  result = provdb.queryProvenance(query);
+  REQUIRE(result);
+  REQUIRE(getEventIds(*result) == std::vector<utils::Identifier>{send->getEventId(), fork->getEventId(), create->getEventId()});
+
+  query.component_id = "generator";
+  result = provdb.queryProvenance(query);
+  REQUIRE(result);
+  REQUIRE(getEventIds(*result) == std::vector<utils::Identifier>{create->getEventId()});
+}
+
+TEST_CASE("Query arguments are parsed", "[provenanceQuery]") {
+  const auto uuid = utils::IdGenerator::getIdGenerator()->generate();
+  const auto query = ProvenanceQuery::parse({{"flowFileUuid", uuid.to_string()}, {"lineage", "true"}, {"componentId", "processor"},
+      {"startTime", "1000"}, {"endTime", "2000"}, {"maxResults", "10"}});
+  REQUIRE(query);
+  REQUIRE(query->flow_file_uuid == uuid);
+  REQUIRE(query->include_lineage);
+  REQUIRE(query->component_id == "processor");
+  REQUIRE(query->begin == std::chrono::system_clock::time_point{1000ms});
+  REQUIRE(query->end == std::chrono::system_clock::time_point{2000ms});
+  REQUIRE(query->max_results == 10);
+
+  REQUIRE(ProvenanceQuery::parse({})->max_results == ProvenanceQuery::DEFAULT_MAX_RESULTS);
+  REQUIRE_FALSE(ProvenanceQuery::parse({{"flowFileUuid", "not a uuid"}}));
+  REQUIRE_FALSE(ProvenanceQuery::parse({{"lineage", "true"}}));
+  REQUIRE_FALSE(ProvenanceQuery::parse({{"startTime", "-5"}}));
+  REQUIRE_FALSE(ProvenanceQuery::parse({{"maxResults", "0"}}));
+}
+
+// hidden, as it writes a million events, run it explicitly with the [provenanceQuery] tag
+TEST_CASE("Provenance query latency", "[.][provenanceQuery][speed]") {
+  TestController testController;
+  LogTestController::getInstance().setWarn<minifi::provenance::ProvenanceRepository>();
+  auto temp_dir = testController.createTempDirectory();
+  minifi::provenance::ProvenanceRepository provdb("TestProvRepo", temp_dir, 1h, int64_t{4} * 1024 * 1024 * 1024, 1s);
+  REQUIRE(provdb.initialize(std::make_shared<minifi::Configure>()));
+
+  // 10 events for each FlowFile, emitted by 100 components over an hour
+  const size_t event_count = 1000000;
+  const size_t events_per_flow_file = 10;
+  const size_t component_count = 100;
+  std::vector<std::shared_ptr<core::FlowFile>> flow_files;
+  std::vector<std::shared_ptr<ProvenanceEventRecord>> batch;
+  const auto write_start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < event_count; ++i) {
+    if (i % events_per_flow_file == 0) {
+      flow_files.push_back(std::make_shared<minifi::FlowFileRecord>());
+    }
+    const auto event_time = TEST_EPOCH + std::chrono::milliseconds(i * 3600 * 1000 / event_count);
+    batch.push_back(createEvent(ProvenanceEventRecord::ATTRIBUTES_MODIFIED, "component-" + std::to_string(i % component_count), flow_files.back(), event_time));
+    if (batch.size() == 1000) {
+      storeEvents(provdb, batch);
+      batch.clear();
+    }
+  }
+  const auto write_duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - write_start);
+  std::cerr << "Writing " << event_count << " provenance events took " << write_duration.count() << "ms" << std::endl;
+
+  const auto measure = [&](const std::string& name, const ProvenanceQuery& query, size_t expected_count) {
+    const auto start = std::chrono::steady_clock::now();
+    const auto result = provdb.queryProvenance(query);
+    const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    REQUIRE(result);
+    REQUIRE(result->size() == expected_count);
+    std::cerr << "Querying " << name << " took " << duration.count() << "us" << std::endl;
+  };
+
+  ProvenanceQuery flow_file_query;
+  flow_file_query.flow_file_uuid = flow_files[flow_files.size() / 2]->getUUID();
+  measure("the events of a FlowFile", flow_file_query, events_per_flow_file);
+
+  ProvenanceQuery component_query;
+  component_query.component_id = "component-42";
+  component_query.begin = TEST_EPOCH + 55min;
+  measure("the events of a component in the last 5 minutes", component_query, event_count / component_count / 12);
+
+  ProvenanceQuery time_query;
+  time_query.begin = TEST_EPOCH + 30min;
+  time_query.end = TEST_EPOCH + 31min;
+  time_query.max_results = 100;
+  measure("100 events of a given minute", time_query, 100);
+}
+
+namespace {
+
+// runs without a repository thread, so the queued events are only written on flush()
+class PausedProvenanceRepository : public minifi::provenance::ProvenanceRepository {
+ public:
+  PausedProvenanceRepository(const std::string& name, const std::string& directory)
+      : core::SerializableComponent(name),
+        ProvenanceRepository(name, directory, 1min, TEST_MAX_PROVENANCE_STORAGE_SIZE, 1s) {
+  }
+
+  void start() override {
+    running_ = true;
+  }
+};
+
+std::shared_ptr<minifi::Configure> createWriteQueueConfiguration(const std::string& size, const std::string& full_policy) {
+  auto configuration = std::make_shared<minifi::Configure>();
+  configuration->set(minifi::Configure::nifi_provenance_repository_write_queue_size, size);
+  configuration->set(minifi::Configure::nifi_provenance_repository_write_queue_full_policy, full_policy);
+  return configuration;
+}
+
+std::vector<std::shared_ptr<ProvenanceEventRecord>> createEvents(size_t count) {
+  std::vector<std::shared_ptr<ProvenanceEventRecord>> events;
+  for (size_t i = 0; i < count; ++i) {
+    events.push_back(createEvent(ProvenanceEventRecord::CREATE, "generator", std::make_shared<minifi::FlowFileRecord>(), TEST_EPOCH + std::chrono::milliseconds(i)));
+  }
+  return events;
+}
+
+bool tryStoreEvents(minifi::provenance::ProvenanceRepository& repo, const std::vector<std::shared_ptr<ProvenanceEventRecord>>& events) {
+  std::vector<std::pair<std::string, std::unique_ptr<minifi::io::BufferStream>>> data;
+  for (const auto& event : events) {
+    auto stream = std::make_unique<minifi::io::BufferStream>();
+    event->Serialize(*stream);
+    data.emplace_back(event->getUUIDStr(), std::move(stream));
+  }
+  return repo.MultiPut(data);
+}
+
+size_t countStoredEvents(minifi::provenance::ProvenanceRepository& repo) {
+  ProvenanceQuery query;
+  query.max_results = std::numeric_limits<size_t>::max();
+  return repo.queryProvenance(query)->size();
+}
+
+}  // namespace
+
+TEST_CASE("The events of concurrent commits are written by the repository thread", "[provenanceWriteQueue]") {
+  TestController testController;
+  auto temp_dir = testController.createTempDirectory();
+  auto provdb = std::make_shared<minifi::provenance::ProvenanceRepository>("TestProvRepo", temp_dir, 1min, TEST_MAX_PROVENANCE_STORAGE_SIZE, 1s);
+  REQUIRE(provdb->initialize(createWriteQueueConfiguration("100", "block")));
+  provdb->start();
+
+  const size_t thread_count = 4;
+  const size_t commits_per_thread = 50;
+  const size_t events_per_commit = 5;
+  std::atomic<size_t> failed_commits{0};
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < thread_count; ++i) {
+    threads.emplace_back([&] {
+      for (size_t j = 0; j < commits_per_thread; ++j) {
+        if (!tryStoreEvents(*provdb, createEvents(events_per_commit))) {
+          ++failed_commits;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  provdb->stop();
+
+  REQUIRE(failed_commits == 0);
+  REQUIRE(countStoredEvents(*provdb) == thread_count * commits_per_thread * events_per_commit);
+  const auto metrics = provdb->getWriteMetrics();
+  REQUIRE(metrics);
+  REQUIRE(metrics->backlog == 0);
+  REQUIRE(metrics->capacity == 100);
+  REQUIRE(metrics->dropped == 0);
+  REQUIRE(metrics->last_batch_size > 0);
+}
+
+TEST_CASE("Without a write queue the events are written on commit", "[provenanceWriteQueue]") {
+  TestController testController;
+  auto temp_dir = testController.createTempDirectory();
+  PausedProvenanceRepository provdb("TestProvRepo", temp_dir);
+  REQUIRE(provdb.initialize(createWriteQueueConfiguration("0", "block")));
+  provdb.start();
+
+  REQUIRE(tryStoreEvents(provdb, createEvents(5)));
+  REQUIRE(provdb.getKeyCount() > 0);
+  REQUIRE_FALSE(provdb.getWriteMetrics());
+}
+
+TEST_CASE("The events of a commit are dropped if the write queue is full", "[provenanceWriteQueue]") {
+  TestController testController;
+  auto temp_dir = testController.createTempDirectory();
+  PausedProvenanceRepository provdb("TestProvRepo", temp_dir);
+  REQUIRE(provdb.initialize(createWriteQueueConfiguration("10", "drop")));
+  provdb.start();
+
+  REQUIRE(tryStoreEvents(provdb, createEvents(6)));
+  REQUIRE_FALSE(tryStoreEvents(provdb, createEvents(6)));
+  REQUIRE(tryStoreEvents(provdb, createEvents(4)));
+  REQUIRE(provdb.getWriteMetrics()->backlog == 10);
+  REQUIRE(provdb.getWriteMetrics()->dropped == 6);
+
+  provdb.flush();
+  REQUIRE(provdb.getWriteMetrics()->backlog == 0);
+  REQUIRE(provdb.getWriteMetrics()->last_batch_size == 10);
+
+  // a commit larger than the queue fits into the empty queue
+  REQUIRE(tryStoreEvents(provdb, createEvents(12)));
+  REQUIRE(countStoredEvents(provdb) == 22);
+  REQUIRE(provdb.getWriteMetrics()->dropped == 6);
+}
+
+TEST_CASE("A commit waits for room in the write queue if it is full", "[provenanceWriteQueue]") {
+  TestController testController;
+  auto temp_dir = testController.createTempDirectory();
+  PausedProvenanceRepository provdb("TestProvRepo", temp_dir);
+  REQUIRE(provdb.initialize(createWriteQueueConfiguration("10", "block")));
+  provdb.start();
+
+  REQUIRE(tryStoreEvents(provdb, createEvents(6)));
+  std::atomic<bool> stored{false};
+  std::thread blocked_commit([&] {
+    stored = tryStoreEvents(provdb, createEvents(6));
+  });
+  for (int i = 0; i < 50 && provdb.getWriteMetrics()->blocked == 0; ++i) {
+    std::this_thread::sleep_for(100ms);
+  }
+  REQUIRE(provdb.getWriteMetrics()->blocked == 1);
+  REQUIRE_FALSE(stored);
+
+  SECTION("until the queued events are written") {
+    provdb.flush();
+  }
+  SECTION("until the repository is stopped") {
+    provdb.stop();
+  }
+  blocked_commit.join();
+  REQUIRE(stored);
+  REQUIRE(countStoredEvents(provdb) == 12);
+  REQUIRE(provdb.getWriteMetrics()->dropped == 0);
+}
+
+TEST_CASE("Provenance commit latency with and without a write queue", "[provenanceWriteQueue][speed]") {
+  LogTestController::getInstance().setWarn<minifi::provenance::ProvenanceRepository>();
+  const size_t thread_count = 8;
+  const size_t commits_per_thread = 2000;
+  const size_t events_per_commit = 5;
+  for (const auto* write_queue_size : {"0", "10000"}) {
+    TestController testController;
+    auto temp_dir = testController.createTempDirectory();
+    auto provdb = std::make_shared<minifi::provenance::ProvenanceRepository>("TestProvRepo", temp_dir, 1h, TEST_MAX_PROVENANCE_STORAGE_SIZE, 1s);
+    REQUIRE(provdb->initialize(createWriteQueueConfiguration(write_queue_size, "block")));
+    provdb->start();
+
+    std::vector<std::vector<std::shared_ptr<ProvenanceEventRecord>>> commits;
+    for (size_t i = 0; i < thread_count * commits_per_thread; ++i) {
+      commits.push_back(createEvents(events_per_commit));
+    }
+    std::atomic<uint64_t> commit_time_us{0};
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < thread_count; ++i) {
+      threads.emplace_back([&, i] {
+        for (size_t j = 0; j < commits_per_thread; ++j) {
+          const auto before = std::chrono::steady_clock::now();
+          tryStoreEvents(*provdb, commits[i * commits_per_thread + j]);
+          commit_time_us += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - before).count();
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    provdb->stop();
+    const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    REQUIRE(countStoredEvents(*provdb) == thread_count * commits_per_thread * events_per_commit);
+
+    std::cerr << "Committing " << thread_count * commits_per_thread << " times " << events_per_commit << " provenance events from " << thread_count << " threads with a write queue of "
+              << write_queue_size << " took " << duration.count() << "ms, " << commit_time_us / (thread_count * commits_per_thread) << "us per commit" << std::endl;
+  }
+}
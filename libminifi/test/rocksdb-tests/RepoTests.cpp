@@ -17,6 +17,7 @@
  */
 
 #include <chrono>
+#include <fstream>
 #include <map>
 #include <memory>
 #include <string>
@@ -196,6 +197,47 @@ TEST_CASE("Test Delete Content ", "[TestFFR4]") {
   LogTestController::getInstance().reset();
 }
 
+TEST_CASE("Test Delete Content Without Reading The Record", "[TestFFR4]") {
+  TestController testController;
+  utils::file::FileUtils::delete_dir(REPOTEST_FLOWFILE_CHECKPOINT_DIR, true);
+
+  auto dir = testController.createTempDirectory();
+
+  auto repository = std::make_shared<core::repository::FlowFileRepository>("ff", REPOTEST_FLOWFILE_CHECKPOINT_DIR, dir, 0ms, 0, 1ms);
+  repository->initialize(std::make_shared<minifi::Configure>());
+
+  const std::string content_path = dir + utils::file::FileUtils::get_separator() + "tstFile.ext";
+  std::ofstream{content_path} << "tempFile";
+
+  std::shared_ptr<core::ContentRepository> content_repo = std::make_shared<core::repository::FileSystemRepository>();
+  repository->loadComponent(content_repo);
+
+  auto claim = std::make_shared<minifi::ResourceClaim>(content_path, content_repo);
+  minifi::FlowFileRecord record;
+  record.setResourceClaim(claim);
+  REQUIRE(record.Persist(repository));
+  // on behalf of the persisted instance
+  claim->increaseFlowFileRecordOwnedCount();
+
+  REQUIRE(repository->Delete(record.getUUIDStr(), claim));
+  REQUIRE(repository->getDeleteMetrics()->backlog == 1);
+
+  repository->flush();
+
+  REQUIRE(repository->getDeleteMetrics()->backlog == 0);
+  std::string value;
+  REQUIRE_FALSE(repository->Get(record.getUUIDStr(), value));
+  REQUIRE(claim->getFlowFileRecordOwnedCount() == 1);
+  REQUIRE(std::ifstream{content_path}.good());
+
+  record.setResourceClaim(nullptr);
+  claim = nullptr;
+  REQUIRE_FALSE(std::ifstream{content_path}.good());
+
+  repository->stop();
+  utils::file::FileUtils::delete_dir(REPOTEST_FLOWFILE_CHECKPOINT_DIR, true);
+}
+
 TEST_CASE("Test Validate Checkpoint ", "[TestFFR5]") {
   TestController testController;
   utils::file::FileUtils::delete_dir(REPOTEST_FLOWFILE_CHECKPOINT_DIR, true);
@@ -426,4 +468,46 @@ TEST_CASE("Flush deleted flowfiles before shutdown", "[TestFFR7]") {
   }
 }
 
+TEST_CASE("FlowFile record dictionary is restored from its own column", "[TestFFR8]") {
+  TestController testController;
+  auto dir = testController.createTempDirectory();
+
+  auto config = std::make_shared<minifi::Configure>();
+  config->set(minifi::Configure::nifi_flowfile_repository_directory_default, utils::file::FileUtils::concat_path(dir, "flowfile_repository"));
+
+  auto content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+  auto connection = std::make_shared<minifi::Connection>(nullptr, nullptr, "Connection");
+  std::map<std::string, std::shared_ptr<core::Connectable>> connectionMap{{connection->getUUIDStr(), connection}};
+
+  {
+    auto ff_repository = std::make_shared<core::repository::FlowFileRepository>("flowFileRepository", REPOTEST_FLOWFILE_CHECKPOINT_DIR,
+        FLOWFILE_REPOSITORY_DIRECTORY, 10min, MAX_FLOWFILE_REPOSITORY_STORAGE_SIZE, 1ms);
+    REQUIRE(ff_repository->initialize(config));
+    for (int i = 0; i < 10; ++i) {
+      auto file = std::make_shared<minifi::FlowFileRecord>();
+      file->setConnection(connection);
+      file->addAttribute("dictionary.key", std::to_string(i));
+      REQUIRE(file->Persist(ff_repository));
+    }
+    REQUIRE(ff_repository->getRecordDictionary()->size() > 0);
+  }
+
+  auto ff_repository = std::make_shared<core::repository::FlowFileRepository>("flowFileRepository", REPOTEST_FLOWFILE_CHECKPOINT_DIR,
+      FLOWFILE_REPOSITORY_DIRECTORY, 10min, MAX_FLOWFILE_REPOSITORY_STORAGE_SIZE, 1ms);
+  ff_repository->setConnectionMap(connectionMap);
+  REQUIRE(ff_repository->initialize(config));
+  REQUIRE(ff_repository->getRecordDictionary()->size() > 0);
+  ff_repository->loadComponent(content_repo);
+  ff_repository->start();
+
+  using org::apache::nifi::minifi::utils::verifyEventHappenedInPollTime;
+  REQUIRE(verifyEventHappenedInPollTime(std::chrono::seconds(1), [&connection]{ return connection->getQueueSize() == 10; }, std::chrono::milliseconds(50)));
+  std::set<std::shared_ptr<core::FlowFile>> expired;
+  auto flow_file = connection->poll(expired);
+  REQUIRE(flow_file);
+  std::string value;
+  REQUIRE(flow_file->getAttribute("dictionary.key", value));
+  ff_repository->stop();
+}
+
 }  // namespace
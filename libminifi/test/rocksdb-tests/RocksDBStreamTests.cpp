@@ -18,6 +18,7 @@
 
 #include "../TestBase.h"
 #include "../../extensions/rocksdb-repos/RocksDbStream.h"
+#include "../../extensions/rocksdb-repos/ChunkedRocksDbStream.h"
 #include "../../extensions/rocksdb-repos/DatabaseContentRepository.h"
 #include "../../extensions/rocksdb-repos/database/StringAppender.h"
 
@@ -79,3 +80,46 @@ TEST_CASE_METHOD(RocksDBStreamTest, "Read zero bytes") {
 
   REQUIRE(minifi::io::isError(nonExistingStream.read(nullptr, 0)));
 }
+
+TEST_CASE_METHOD(RocksDBStreamTest, "Chunked stream appends its content one bounded chunk at a time") {
+  minifi::io::RocksDbStream original("one", gsl::make_not_null(db.get()), true);
+  REQUIRE(original.write(reinterpret_cast<const uint8_t*>("start-"), 6) == 6);
+
+  std::string content;
+  for (size_t i = 0; i < 100; ++i) {
+    content += static_cast<char>('a' + i % 26);
+  }
+  {
+    minifi::io::ChunkedRocksDbStream chunked("staged", gsl::make_not_null(db.get()), 16);
+    REQUIRE(chunked.write(reinterpret_cast<const uint8_t*>(content.data()), content.size()) == content.size());
+    REQUIRE(chunked.getChunkCount() == 7);
+    for (size_t i = 0; i < chunked.getChunkCount(); ++i) {
+      minifi::io::RocksDbStream chunk("staged." + std::to_string(i), gsl::make_not_null(db.get()));
+      REQUIRE(chunk.size() <= 16);
+    }
+
+    auto opendb = db->open();
+    REQUIRE(opendb);
+    chunked.appendTo(*opendb, "one");
+    REQUIRE(chunked.getChunkCount() == 0);
+  }
+
+  minifi::io::RocksDbStream result("one", gsl::make_not_null(db.get()));
+  std::string str(result.size(), '\0');
+  REQUIRE(result.read(reinterpret_cast<uint8_t*>(str.data()), str.size()) == str.size());
+  REQUIRE(str == "start-" + content);
+  minifi::io::RocksDbStream first_chunk("staged.0", gsl::make_not_null(db.get()));
+  REQUIRE(minifi::io::isError(first_chunk.read(nullptr, 0)));
+}
+
+TEST_CASE_METHOD(RocksDBStreamTest, "Chunked stream deletes the chunks not appended") {
+  {
+    minifi::io::ChunkedRocksDbStream chunked("staged", gsl::make_not_null(db.get()), 4);
+    REQUIRE(chunked.write(reinterpret_cast<const uint8_t*>("banana"), 6) == 6);
+    REQUIRE(chunked.getChunkCount() == 2);
+  }
+  minifi::io::RocksDbStream first_chunk("staged.0", gsl::make_not_null(db.get()));
+  REQUIRE(minifi::io::isError(first_chunk.read(nullptr, 0)));
+  minifi::io::RocksDbStream second_chunk("staged.1", gsl::make_not_null(db.get()));
+  REQUIRE(minifi::io::isError(second_chunk.read(nullptr, 0)));
+}
@@ -196,3 +196,29 @@ TEST_CASE("ExecuteSQL incoming flow file is malformed", "[ExecuteSQL6]") {
 
   REQUIRE_THROWS(plan->run());
 }
+
+TEST_CASE("ExecuteSQL can write the result set column by column", "[ExecuteSQL7]") {
+  SQLTestController controller;
+
+  auto plan = controller.createSQLPlan("ExecuteSQL", {{"success", "d"}});
+  auto sql_proc = plan->getSQLProcessor();
+  sql_proc->setProperty(minifi::processors::ExecuteSQL::OutputFormat.getName(), "JSON-Columnar");
+  sql_proc->setProperty(minifi::processors::ExecuteSQL::SQLSelectQuery.getName(), "SELECT * FROM test_table ORDER BY int_col ASC");
+
+  controller.insertValues({{11, "one"}, {22, "two"}});
+
+  plan->run();
+
+  auto flow_files = plan->getOutputs({"success", "d"});
+  REQUIRE(flow_files.size() == 1);
+  std::string row_count;
+  flow_files[0]->getAttribute(minifi::processors::ExecuteSQL::RESULT_ROW_COUNT, row_count);
+  REQUIRE(row_count == "2");
+
+  verifyJSON(plan->getContent(flow_files[0]), R"(
+    {
+      "int_col": [11, 22],
+      "text_col": ["one", "two"]
+    }
+  )", true);
+}
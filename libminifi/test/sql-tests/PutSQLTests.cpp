@@ -18,6 +18,9 @@
 
 #undef NDEBUG
 
+#include <algorithm>
+#include <chrono>
+
 #include "../TestBase.h"
 #include "SQLTestController.h"
 
@@ -75,3 +78,100 @@ TEST_CASE("Test Put Content", "[PutSQLPutContent]") {
   REQUIRE(rows[0].text_col == "fdsa");
 }
 
+
+TEST_CASE("PutSQL executes the statements of a batch in a single transaction", "[PutSQLBatch]") {
+  SQLTestController testController;
+
+  auto plan = testController.createSQLPlan("PutSQL", {{"success", "d"}, {"failure", "d"}});
+  auto sql_proc = plan->getSQLProcessor();
+  sql_proc->setProperty(minifi::processors::PutSQL::BatchSize.getName(), "10");
+
+  plan->addInput({{"sql.args.1.value", "1"}, {"sql.args.2.value", "one"}}, "INSERT INTO test_table VALUES(?, ?);");
+  plan->addInput({{"sql.args.1.value", "2"}}, "INSERT INTO test_table VALUES(?, 'two');");
+  plan->addInput({{"sql.args.1.value", "3"}, {"sql.args.2.value", "three"}}, "INSERT INTO test_table VALUES(?, ?);");
+
+  plan->run();
+
+  REQUIRE(plan->getOutputs({"success", "d"}).size() == 3);
+  REQUIRE(plan->getOutputs({"failure", "d"}).empty());
+  auto rows = testController.fetchValues();
+  REQUIRE(rows.size() == 3);
+  std::sort(rows.begin(), rows.end(), [] (const TableRow& left, const TableRow& right) { return left.int_col < right.int_col; });
+  REQUIRE(rows[0].int_col == 1);
+  REQUIRE(rows[0].text_col == "one");
+  REQUIRE(rows[1].int_col == 2);
+  REQUIRE(rows[1].text_col == "two");
+  REQUIRE(rows[2].int_col == 3);
+  REQUIRE(rows[2].text_col == "three");
+}
+
+TEST_CASE("PutSQL routes only the failing flow files of a batch to failure", "[PutSQLBatch]") {
+  SQLTestController testController;
+
+  auto plan = testController.createSQLPlan("PutSQL", {{"success", "d"}, {"failure", "d"}});
+  auto sql_proc = plan->getSQLProcessor();
+  sql_proc->setProperty(minifi::processors::PutSQL::BatchSize.getName(), "10");
+
+  plan->addInput({{"sql.args.1.value", "1"}}, "INSERT INTO test_table VALUES(?, 'one');");
+  const auto invalid_statement = plan->addInput({}, "not a valid sql statement");
+  const auto empty_statement = plan->addInput();
+  plan->addInput({{"sql.args.1.value", "2"}}, "INSERT INTO test_table VALUES(?, 'two');");
+
+  plan->run();
+
+  REQUIRE(plan->getOutputs({"success", "d"}).size() == 2);
+  const auto failed_flow_files = plan->getOutputs({"failure", "d"});
+  REQUIRE(failed_flow_files.size() == 2);
+  for (const auto& flow_file : failed_flow_files) {
+    REQUIRE((flow_file->getUUID() == invalid_statement->getUUID() || flow_file->getUUID() == empty_statement->getUUID()));
+  }
+  // the statements are not executed again, when the transaction of the whole batch is rolled back
+  REQUIRE(testController.fetchValues().size() == 2);
+}
+
+TEST_CASE("PutSQL rolls back a failing statement with the default batch size", "[PutSQLBatch]") {
+  SQLTestController testController;
+
+  auto plan = testController.createSQLPlan("PutSQL", {{"success", "d"}, {"failure", "d"}});
+
+  SECTION("Invalid statement") {
+    plan->addInput({}, "not a valid sql statement");
+  }
+  SECTION("Empty statement") {
+    plan->addInput();
+  }
+
+  REQUIRE_THROWS(plan->run());
+
+  REQUIRE(plan->getOutputs({"success", "d"}).empty());
+  REQUIRE(plan->getOutputs({"failure", "d"}).empty());
+  REQUIRE(testController.fetchValues().empty());
+}
+
+TEST_CASE("PutSQL insert throughput", "[PutSQLBatch][speed]") {
+  const int flow_file_count = 1000;
+  for (const auto* batch_size : {"1", "100", "1000"}) {
+    SQLTestController testController;
+    LogTestController::getInstance().setInfo<minifi::processors::PutSQL>();
+
+    auto plan = testController.createSQLPlan("PutSQL", {{"success", "d"}});
+    auto sql_proc = plan->getSQLProcessor();
+    sql_proc->setProperty(minifi::processors::PutSQL::SQLStatement.getName(), "INSERT INTO test_table VALUES(?, ?);");
+    sql_proc->setProperty(minifi::processors::PutSQL::BatchSize.getName(), batch_size);
+    for (int i = 0; i < flow_file_count; ++i) {
+      plan->addInput({{"sql.args.1.value", std::to_string(i)}, {"sql.args.2.value", "row " + std::to_string(i)}});
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    size_t put_count = 0;
+    while (put_count < flow_file_count) {
+      plan->run();
+      put_count += plan->getOutputs({"success", "d"}).size();
+    }
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+    REQUIRE(testController.fetchValues().size() == flow_file_count);
+    std::cerr << "Putting " << flow_file_count << " rows with Batch Size " << batch_size << " took " << elapsed.count() << " ms, "
+              << (elapsed.count() == 0 ? 0 : flow_file_count * 1000 / elapsed.count()) << " rows/s" << std::endl;
+  }
+}
@@ -0,0 +1,150 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#undef NDEBUG
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../TestBase.h"
+#include "data/ColumnarJSONSQLWriter.h"
+#include "data/JSONSQLWriter.h"
+#include "data/SQLRowsetProcessor.h"
+#include "mocks/MockConnectors.h"
+#ifdef USE_REAL_ODBC_TEST_DRIVER
+#include "services/ODBCConnector.h"
+#endif
+
+namespace sql = org::apache::nifi::minifi::sql;
+
+namespace {
+class BatchCollector : public sql::SQLRowSubscriber {
+ public:
+  explicit BatchCollector(sql::SQLWriter& writer) : writer_(writer) {}
+
+  void beginProcessBatch() override {}
+  void endProcessBatch() override {
+    batches.push_back(writer_.toString());
+  }
+  void beginProcessRow() override {}
+  void endProcessRow() override {}
+  void finishProcessing() override {}
+  void processColumnNames(const std::vector<std::string>& /*names*/) override {}
+  void processColumn(const std::string& /*name*/, const std::string& /*value*/) override {}
+  void processColumn(const std::string& /*name*/, double /*value*/) override {}
+  void processColumn(const std::string& /*name*/, int /*value*/) override {}
+  void processColumn(const std::string& /*name*/, long long /*value*/) override {}  // NOLINT Type comes from SOCI interface
+  void processColumn(const std::string& /*name*/, unsigned long long /*value*/) override {}  // NOLINT Type comes from SOCI interface
+  void processColumn(const std::string& /*name*/, const char* /*value*/) override {}
+
+  std::vector<std::string> batches;
+
+ private:
+  sql::SQLWriter& writer_;
+};
+
+std::unique_ptr<sql::MockRowset> createRowset(int row_count) {
+  auto rowset = std::make_unique<sql::MockRowset>(std::vector<std::string>{"int_col", "text_col", "double_col"},
+      std::vector<sql::DataType>{sql::DataType::INTEGER, sql::DataType::STRING, sql::DataType::DOUBLE});
+  for (int i = 0; i < row_count; ++i) {
+    rowset->addRow({std::to_string(i), i % 3 == 2 ? "NULL" : "text \"" + std::to_string(i) + "\"", "0.5"});
+  }
+  return rowset;
+}
+
+std::vector<std::string> writeBatches(std::unique_ptr<sql::Rowset> rowset, sql::SQLWriter& writer, size_t max_rows) {
+  BatchCollector collector{writer};
+  sql::SQLRowsetProcessor processor(std::move(rowset), {writer, collector});
+  while (processor.process(max_rows) > 0) {}
+  return collector.batches;
+}
+}  // namespace
+
+TEST_CASE("JSONSQLWriter writes the rows of each batch as an array of objects", "[SQLWriter]") {
+  sql::JSONSQLWriter writer{false};
+  const auto batches = writeBatches(createRowset(3), writer, 2);
+  REQUIRE(batches.size() == 3);
+  REQUIRE(batches[0] == R"([{"int_col":0,"text_col":"text \"0\"","double_col":0.5},{"int_col":1,"text_col":"text \"1\"","double_col":0.5}])");
+  REQUIRE(batches[1] == R"([{"int_col":2,"text_col":"NULL","double_col":0.5}])");
+  REQUIRE(batches[2] == "[]");
+}
+
+TEST_CASE("JSONSQLWriter writes pretty JSON", "[SQLWriter]") {
+  sql::JSONSQLWriter writer{true};
+  const auto batches = writeBatches(createRowset(1), writer, 0);
+  REQUIRE(batches.size() == 2);
+  REQUIRE(batches[0] == "[\n    {\n        \"int_col\": 0,\n        \"text_col\": \"text \\\"0\\\"\",\n        \"double_col\": 0.5\n    }\n]");
+}
+
+TEST_CASE("JSONSQLWriter skips the filtered out columns", "[SQLWriter]") {
+  sql::JSONSQLWriter writer{false, [] (const std::string& column_name) { return column_name != "text_col"; }};
+  const auto batches = writeBatches(createRowset(2), writer, 0);
+  REQUIRE(batches[0] == R"([{"int_col":0,"double_col":0.5},{"int_col":1,"double_col":0.5}])");
+}
+
+TEST_CASE("ColumnarJSONSQLWriter writes the values of each column as an array", "[SQLWriter]") {
+  sql::ColumnarJSONSQLWriter writer{[] (const std::string& column_name) { return column_name != "double_col"; }};
+  const auto batches = writeBatches(createRowset(3), writer, 2);
+  REQUIRE(batches.size() == 3);
+  REQUIRE(batches[0] == R"({"int_col":[0,1],"text_col":["text \"0\"","text \"1\""]})");
+  REQUIRE(batches[1] == R"({"int_col":[2],"text_col":["NULL"]})");
+  REQUIRE(batches[2] == "{}");
+}
+
+#ifdef USE_REAL_ODBC_TEST_DRIVER
+TEST_CASE("Writing the rows of a large result set", "[SQLWriter][speed]") {
+  const int row_count = 200000;
+  const size_t max_rows = 10000;
+#ifdef WIN32
+  const std::string driver = "{SQLite3 ODBC Driver}";
+#else
+  const std::string driver = "libsqlite3odbc.so";
+#endif
+  // the in-memory database lives as long as the connection, so the same connection is used for every query
+  sql::ODBCConnection connection{"Driver=" + driver + ";Database=:memory:"};
+  connection.prepareStatement("CREATE TABLE bench_table (int_col INTEGER, text_col TEXT, double_col REAL);")->execute();
+  std::vector<std::vector<std::string>> rows;
+  rows.reserve(row_count);
+  for (int i = 0; i < row_count; ++i) {
+    rows.push_back({std::to_string(i), "text \"" + std::to_string(i) + "\"", "0.5"});
+  }
+  auto session = connection.getSession();
+  session->begin();
+  connection.prepareStatement("INSERT INTO bench_table (int_col, text_col, double_col) VALUES (?, ?, ?);")->executeBatch(rows);
+  session->commit();
+
+  sql::JSONSQLWriter json_writer{false};
+  sql::JSONSQLWriter pretty_json_writer{true};
+  sql::ColumnarJSONSQLWriter columnar_json_writer;
+  for (const auto& [format, writer] : std::vector<std::pair<std::string, sql::SQLWriter*>>{
+      {"JSON", &json_writer}, {"JSON-Pretty", &pretty_json_writer}, {"JSON-Columnar", &columnar_json_writer}}) {
+    const auto start = std::chrono::steady_clock::now();
+    const auto batches = writeBatches(connection.prepareStatement("SELECT int_col, text_col, double_col FROM bench_table;")->execute(), *writer, max_rows);
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    size_t size = 0;
+    for (const auto& batch : batches) {
+      size += batch.size();
+    }
+    REQUIRE(batches.size() == row_count / max_rows + 1);
+    std::cerr << "Querying and writing " << row_count << " rows of an in-memory SQLite database as " << format << " took "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() << " ms, the output is " << size / 1024 << " KB" << std::endl;
+  }
+}
+#endif
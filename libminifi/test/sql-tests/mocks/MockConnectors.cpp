@@ -20,6 +20,7 @@
 
 #include <fstream>
 #include <algorithm>
+#include <iterator>
 #include <utility>
 #include <string>
 #include <memory>
@@ -393,6 +394,23 @@ std::unique_ptr<Rowset> MockStatement::execute(const std::vector<std::string>& a
   return db.execute(query_, args);
 }
 
+void MockSession::begin() {
+  std::ifstream file(file_path_, std::ios::binary);
+  db_snapshot_ = std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+void MockSession::commit() {
+  db_snapshot_.reset();
+}
+
+void MockSession::rollback() {
+  if (db_snapshot_) {
+    std::ofstream file(file_path_, std::ios::binary | std::ios::trunc);
+    file << *db_snapshot_;
+    db_snapshot_.reset();
+  }
+}
+
 MockODBCConnection::MockODBCConnection(std::string connectionString)
     : connection_string_(std::move(connectionString)) {
   std::smatch match;
@@ -410,7 +428,7 @@ std::unique_ptr<sql::Statement> MockODBCConnection::prepareStatement(const std::
 }
 
 std::unique_ptr<Session> MockODBCConnection::getSession() const {
-  return std::make_unique<sql::MockSession>();
+  return std::make_unique<sql::MockSession>(file_path_);
 }
 
 } /* namespace sql */
@@ -23,7 +23,9 @@
 #include <vector>
 #include <algorithm>
 #include <memory>
+#include <optional>
 #include <string>
+#include <utility>
 
 #include "data/DatabaseConnectors.h"
 #include "utils/StringUtils.h"
@@ -141,17 +143,21 @@ class MockStatement : public Statement {
 
 class MockSession : public Session {
  public:
-  void begin() override {
+  explicit MockSession(std::string file_path)
+    : file_path_(std::move(file_path)) {
   }
 
-  void commit() override {
-  }
-
-  void rollback() override {
-  }
+  // the transactions are emulated by restoring the database file on rollback
+  void begin() override;
+  void commit() override;
+  void rollback() override;
 
   void execute(const std::string& /*statement*/) override {
   }
+
+ private:
+  std::string file_path_;
+  std::optional<std::string> db_snapshot_;
 };
 
 class MockODBCConnection : public Connection {
@@ -16,7 +16,12 @@
  * limitations under the License.
  */
 #include <memory>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
 
+#include "../../include/core/state/nodes/PerformanceMetrics.h"
 #include "../../include/core/state/nodes/ProcessMetrics.h"
 #include "../../include/core/state/nodes/QueueMetrics.h"
 #include "../../include/core/state/nodes/RepositoryMetrics.h"
@@ -25,9 +30,50 @@
 #include "io/ClientSocket.h"
 #include "core/Processor.h"
 #include "core/ClassLoader.h"
+#include "core/ProcessSession.h"
+#include "core/ProcessSessionFactory.h"
 #include "core/yaml/YamlConfiguration.h"
 #include "repository/VolatileContentRepository.h"
 #include "ProvenanceTestHelper.h"
+#include "FlowFileRecord.h"
+
+using namespace std::literals::chrono_literals;
+
+namespace {
+
+minifi::state::response::SerializedResponseNode getChild(const minifi::state::response::SerializedResponseNode& node, const std::string& name) {
+  for (const auto& child : node.children) {
+    if (child.name == name) {
+      return child;
+    }
+  }
+  throw std::runtime_error("No child named " + name + " in " + node.name);
+}
+
+class WriteTenBytesProcessor : public core::Processor {
+ public:
+  using core::Processor::Processor;
+  using core::Processor::onTrigger;
+
+  static const core::Relationship Success;
+
+  void initialize() override {
+    setSupportedRelationships({Success});
+  }
+
+  void onTrigger(const std::shared_ptr<core::ProcessContext>& /*context*/, const std::shared_ptr<core::ProcessSession>& session) override {
+    const auto flow_file = session->get();
+    if (!flow_file) {
+      return;
+    }
+    session->writeBuffer(flow_file, gsl::make_span("0123456789", 10));
+    session->transfer(flow_file, Success);
+  }
+};
+
+const core::Relationship WriteTenBytesProcessor::Success{"success", "everything is passed through"};
+
+}  // namespace
 
 TEST_CASE("TestProcessMetrics", "[c2m1]") {
   minifi::state::response::ProcessMetrics metrics;
@@ -231,3 +277,97 @@ TEST_CASE("RepositorymetricsHaveRepo", "[c2m4]") {
     REQUIRE("0" == size.value);
   }
 }
+
+TEST_CASE("ConnectionPerformanceMetrics", "[c2m6]") {
+  minifi::state::response::ConnectionPerformanceMetrics metrics;
+
+  REQUIRE("connectionMetrics" == metrics.getName());
+  REQUIRE(metrics.serialize().empty());
+
+  std::shared_ptr<minifi::Configure> configuration = std::make_shared<minifi::Configure>();
+  std::shared_ptr<core::ContentRepository> content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+  content_repo->initialize(configuration);
+  std::shared_ptr<core::Repository> repo = std::make_shared<TestRepository>();
+  std::shared_ptr<minifi::Connection> connection = std::make_shared<minifi::Connection>(repo, content_repo, "testconnection");
+  metrics.addConnection(connection);
+
+  for (int i = 0; i < 2; ++i) {
+    auto flow_file = std::make_shared<minifi::FlowFileRecord>();
+    flow_file->setSize(10);
+    connection->put(flow_file);
+  }
+  std::this_thread::sleep_for(10ms);
+  std::set<std::shared_ptr<core::FlowFile>> expired;
+  REQUIRE(connection->poll(expired));
+
+  const auto serialized = metrics.serialize();
+  REQUIRE(1 == serialized.size());
+  const auto& resp = serialized.at(0);
+  REQUIRE("testconnection" == resp.name);
+  REQUIRE(connection->getUUIDStr() == getChild(resp, "uuid").value.to_string());
+  REQUIRE("2" == getChild(resp, "flowFilesEnqueued").value.to_string());
+  REQUIRE("20" == getChild(resp, "bytesEnqueued").value.to_string());
+  REQUIRE("1" == getChild(resp, "flowFilesDequeued").value.to_string());
+  REQUIRE("10" == getChild(resp, "bytesDequeued").value.to_string());
+  // the rates are only known from the second serialization on
+  REQUIRE(0.0 == std::stod(getChild(resp, "enqueuedPerSecond").value.to_string()));
+
+  const auto queue_wait_time = getChild(resp, "queueWaitTime");
+  REQUIRE("1" == getChild(queue_wait_time, "count").value.to_string());
+  REQUIRE(10000 <= std::stoull(getChild(queue_wait_time, "maxMicros").value.to_string()));
+}
+
+TEST_CASE("ConnectionPerformanceMetrics does not count the rolled back FlowFiles as enqueued again", "[c2m6]") {
+  TestController test_controller;
+  std::shared_ptr<TestPlan> plan = test_controller.createPlan();
+  auto processor = std::make_shared<WriteTenBytesProcessor>("write_ten_bytes");
+  plan->addProcessor(processor, processor->getName());
+  auto input = plan->addConnection(nullptr, WriteTenBytesProcessor::Success, processor);
+  auto context = plan->getProcessContextForProcessor(processor);
+
+  input->put(std::make_shared<minifi::FlowFileRecord>());
+  core::ProcessSession session(context);
+  REQUIRE(session.get());
+  session.rollback();
+
+  REQUIRE(1 == input->getQueueSize());
+  REQUIRE(1 == input->getMetrics().getEnqueuedFlowFiles());
+  REQUIRE(1 == input->getMetrics().getDequeuedFlowFiles());
+}
+
+TEST_CASE("ProcessorPerformanceMetrics", "[c2m7]") {
+  minifi::state::response::ProcessorPerformanceMetrics metrics;
+
+  REQUIRE("processorMetrics" == metrics.getName());
+  REQUIRE(metrics.serialize().empty());
+
+  TestController test_controller;
+  std::shared_ptr<TestPlan> plan = test_controller.createPlan();
+  auto processor = std::make_shared<WriteTenBytesProcessor>("write_ten_bytes");
+  plan->addProcessor(processor, processor->getName());
+  auto input = plan->addConnection(nullptr, WriteTenBytesProcessor::Success, processor);
+  auto output = plan->addConnection(processor, WriteTenBytesProcessor::Success, nullptr);
+  auto context = plan->getProcessContextForProcessor(processor);
+  auto session_factory = std::make_shared<core::ProcessSessionFactory>(context);
+  processor->setScheduledState(core::ScheduledState::RUNNING);
+  processor->incrementActiveTasks();
+  metrics.addProcessor(processor);
+
+  for (int i = 0; i < 3; ++i) {
+    input->put(std::make_shared<minifi::FlowFileRecord>());
+    processor->onTrigger(context, session_factory);
+  }
+  REQUIRE(3 == output->getQueueSize());
+
+  const auto serialized = metrics.serialize();
+  REQUIRE(1 == serialized.size());
+  const auto& resp = serialized.at(0);
+  REQUIRE("write_ten_bytes" == resp.name);
+  REQUIRE(processor->getUUIDStr() == getChild(resp, "uuid").value.to_string());
+  REQUIRE("3" == getChild(resp, "invocations").value.to_string());
+  REQUIRE("3" == getChild(resp, "flowFilesIn").value.to_string());
+  REQUIRE("0" == getChild(resp, "bytesIn").value.to_string());
+  REQUIRE("3" == getChild(resp, "flowFilesOut").value.to_string());
+  REQUIRE("30" == getChild(resp, "bytesOut").value.to_string());
+  REQUIRE("3" == getChild(getChild(resp, "taskTime"), "count").value.to_string());
+}
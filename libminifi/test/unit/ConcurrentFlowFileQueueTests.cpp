@@ -0,0 +1,124 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "utils/ConcurrentFlowFileQueue.h"
+#include "../TestBase.h"
+
+namespace core = minifi::core;
+
+TEST_CASE("After construction, a ConcurrentFlowFileQueue is empty", "[ConcurrentFlowFileQueue]") {
+  utils::ConcurrentFlowFileQueue queue(10);
+
+  REQUIRE(queue.empty());
+  REQUIRE(queue.size() == 0);
+  REQUIRE_FALSE(queue.isWorkAvailable());
+  REQUIRE(queue.tryPop() == nullptr);
+}
+
+TEST_CASE("ConcurrentFlowFileQueue returns the non-penalized flow files in FIFO order", "[ConcurrentFlowFileQueue]") {
+  utils::ConcurrentFlowFileQueue queue(2);
+  const auto penalized_flow_file = std::make_shared<core::FlowFile>();
+  penalized_flow_file->penalize(std::chrono::seconds{10});
+  queue.push(penalized_flow_file);
+  std::vector<std::shared_ptr<core::FlowFile>> flow_files;
+  for (int i = 0; i < 4; ++i) {
+    flow_files.push_back(std::make_shared<core::FlowFile>());
+    queue.push(flow_files.back());
+  }
+
+  REQUIRE(queue.size() == 5);
+  REQUIRE(queue.isWorkAvailable());
+  // the first two fit into the lock-free queue, the rest overflow and are returned after them
+  REQUIRE(queue.tryPop() == flow_files[0]);
+  REQUIRE(queue.tryPop() == flow_files[1]);
+  REQUIRE(queue.tryPop() == flow_files[2]);
+  REQUIRE(queue.tryPop() == flow_files[3]);
+  REQUIRE_FALSE(queue.isWorkAvailable());
+  REQUIRE(queue.tryPop() == nullptr);
+  REQUIRE(queue.size() == 1);
+
+  REQUIRE(queue.popAll() == std::vector<std::shared_ptr<core::FlowFile>>{penalized_flow_file});
+  REQUIRE(queue.empty());
+}
+
+TEST_CASE("ConcurrentFlowFileQueue keeps the FIFO order across the overflow boundary", "[ConcurrentFlowFileQueue]") {
+  utils::ConcurrentFlowFileQueue queue(3);
+  std::vector<std::shared_ptr<core::FlowFile>> flow_files;
+  const auto push_next = [&] {
+    flow_files.push_back(std::make_shared<core::FlowFile>());
+    queue.push(flow_files.back());
+  };
+  for (int i = 0; i < 8; ++i) {
+    push_next();
+  }
+
+  std::vector<std::shared_ptr<core::FlowFile>> popped;
+  // interleaved pushes land behind the overflow even though the lock-free queue has room again
+  for (int i = 0; i < 4; ++i) {
+    popped.push_back(queue.tryPop());
+    push_next();
+  }
+  while (auto flow_file = queue.tryPop()) {
+    popped.push_back(flow_file);
+  }
+
+  REQUIRE(popped == flow_files);
+  REQUIRE(queue.empty());
+}
+
+TEST_CASE("ConcurrentFlowFileQueue hands over every flow file between concurrent producers and consumers", "[ConcurrentFlowFileQueue]") {
+  utils::ConcurrentFlowFileQueue queue(64);
+  constexpr int PRODUCERS = 4;
+  constexpr int FLOW_FILES_PER_PRODUCER = 5000;
+  std::atomic<int> consumed{0};
+  std::vector<std::vector<std::shared_ptr<core::FlowFile>>> received(PRODUCERS);
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < PRODUCERS; ++i) {
+    threads.emplace_back([&queue] {
+      for (int j = 0; j < FLOW_FILES_PER_PRODUCER; ++j) {
+        queue.push(std::make_shared<core::FlowFile>());
+      }
+    });
+    threads.emplace_back([&queue, &consumed, &received, i] {
+      while (consumed < PRODUCERS * FLOW_FILES_PER_PRODUCER) {
+        if (auto flow_file = queue.tryPop()) {
+          received[i].push_back(flow_file);
+          ++consumed;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  std::set<std::shared_ptr<core::FlowFile>> unique_flow_files;
+  for (const auto& flow_files : received) {
+    unique_flow_files.insert(flow_files.begin(), flow_files.end());
+  }
+  REQUIRE(unique_flow_files.size() == PRODUCERS * FLOW_FILES_PER_PRODUCER);
+  REQUIRE(queue.empty());
+}
@@ -14,7 +14,15 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include <atomic>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
 #include "Connection.h"
+#include "FlowFileRecord.h"
 
 #include "../TestBase.h"
 #include "ProvenanceTestHelper.h"
@@ -83,3 +91,231 @@ TEST_CASE("Connection::poll() works correctly", "[poll]") {
     REQUIRE(nullptr == connection->poll(expired_flow_files));
   }
 }
+
+TEST_CASE("Connection with a lock-free queue", "[poll]") {
+  const auto flow_repo = std::make_shared<TestRepository>();
+  const auto content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+  content_repo->initialize(std::make_shared<minifi::Configure>());
+
+  const auto connection = std::make_shared<minifi::Connection>(flow_repo, content_repo, "test_connection");
+  connection->setMaxQueueSize(2);
+  connection->setLockFreeQueue(true);
+  REQUIRE(connection->hasLockFreeQueue());
+  std::set<std::shared_ptr<core::FlowFile>> expired_flow_files;
+
+  REQUIRE(connection->isEmpty());
+  REQUIRE(nullptr == connection->poll(expired_flow_files));
+
+  const auto penalized_flow_file = std::make_shared<core::FlowFile>();
+  penalized_flow_file->penalize(std::chrono::seconds{10});
+  connection->put(penalized_flow_file);
+  REQUIRE_FALSE(connection->isWorkAvailable());
+  REQUIRE(nullptr == connection->poll(expired_flow_files));
+
+  const auto flow_file = std::make_shared<core::FlowFile>();
+  flow_file->setSize(10);
+  connection->put(flow_file);
+  REQUIRE(connection->isFull());
+  REQUIRE(connection->getQueueSize() == 2);
+  REQUIRE(connection->getQueueDataSize() == 10);
+  REQUIRE(connection->isWorkAvailable());
+  REQUIRE(flow_file == connection->poll(expired_flow_files));
+  REQUIRE(connection->getQueueDataSize() == 0);
+  REQUIRE(nullptr == connection->poll(expired_flow_files));
+
+  connection->drain(false);
+  REQUIRE(connection->isEmpty());
+}
+
+TEST_CASE("Connection swaps out the flow files above the swap threshold", "[swap]") {
+  TestController test_controller;
+  const auto swap_dir = test_controller.createTempDirectory();
+  const auto flow_repo = std::make_shared<TestRepository>();
+  const auto content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+  content_repo->initialize(std::make_shared<minifi::Configure>());
+
+  const auto connection = std::make_shared<minifi::Connection>(flow_repo, content_repo, "test_connection");
+  connection->setSwapThreshold(5, swap_dir);
+  std::set<std::shared_ptr<core::FlowFile>> expired_flow_files;
+
+  for (int i = 0; i < 22; ++i) {
+    auto flow_file = std::make_shared<minifi::FlowFileRecord>();
+    flow_file->setAttribute("index", std::to_string(i));
+    auto claim = std::make_shared<minifi::ResourceClaim>(content_repo);
+    auto stream = content_repo->write(*claim, false);
+    stream->write(reinterpret_cast<const uint8_t*>("content"), 7);
+    stream->close();
+    flow_file->setResourceClaim(claim);
+    flow_file->setSize(7);
+    // on behalf of the persisted record
+    claim->increaseFlowFileRecordOwnedCount();
+    // one of them is not persisted, so it can't be swapped out
+    flow_file->setStoredToRepository(i != 7);
+    connection->put(flow_file);
+  }
+
+  REQUIRE(connection->getQueueSize() == 22);
+  REQUIRE(connection->getQueueDataSize() == 22 * 7);
+  REQUIRE(connection->getSwappedQueueSize() == 14);
+  REQUIRE(connection->getSwappedQueueDataSize() == 14 * 7);
+  REQUIRE(utils::file::FileUtils::list_dir_all(swap_dir, test_controller.getLogger(), false).size() == 3);
+
+  std::vector<int> indices;
+  while (auto flow_file = connection->poll(expired_flow_files)) {
+    indices.push_back(std::stoi(*flow_file->getAttribute("index")));
+    REQUIRE(flow_file->getResourceClaim()->exists());
+  }
+  // the flow file that couldn't be swapped out stayed in memory and skipped ahead
+  std::vector<int> expected{0, 1, 2, 3, 4, 7, 5, 6, 8, 9};
+  for (int i = 10; i < 22; ++i) {
+    expected.push_back(i);
+  }
+  REQUIRE(indices == expected);
+  REQUIRE(connection->isEmpty());
+  REQUIRE(connection->getSwappedQueueSize() == 0);
+  REQUIRE(utils::file::FileUtils::list_dir_all(swap_dir, test_controller.getLogger(), false).empty());
+}
+
+namespace {
+
+std::shared_ptr<minifi::FlowFileRecord> createPersistedFlowFile(const std::shared_ptr<core::ContentRepository>& content_repo, int index) {
+  auto flow_file = std::make_shared<minifi::FlowFileRecord>();
+  flow_file->setAttribute("index", std::to_string(index));
+  auto claim = std::make_shared<minifi::ResourceClaim>(content_repo);
+  auto stream = content_repo->write(*claim, false);
+  stream->write(reinterpret_cast<const uint8_t*>("content"), 7);
+  stream->close();
+  flow_file->setResourceClaim(claim);
+  flow_file->setSize(7);
+  claim->increaseFlowFileRecordOwnedCount();
+  flow_file->setStoredToRepository(true);
+  return flow_file;
+}
+
+}  // namespace
+
+TEST_CASE("Connection keeps the penalty and the lineage of the swapped out flow files", "[swap]") {
+  TestController test_controller;
+  const auto swap_dir = test_controller.createTempDirectory();
+  const auto flow_repo = std::make_shared<TestRepository>();
+  const auto content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+  content_repo->initialize(std::make_shared<minifi::Configure>());
+
+  const auto connection = std::make_shared<minifi::Connection>(flow_repo, content_repo, "test_connection");
+  connection->setSwapThreshold(1, swap_dir);
+  std::set<std::shared_ptr<core::FlowFile>> expired_flow_files;
+
+  const auto lineage_id = utils::IdGenerator::getIdGenerator()->generate();
+  connection->put(createPersistedFlowFile(content_repo, 0));
+  auto penalized_flow_file = createPersistedFlowFile(content_repo, 1);
+  penalized_flow_file->penalize(std::chrono::milliseconds{200});
+  penalized_flow_file->setLineageIdentifiers({lineage_id});
+  connection->put(penalized_flow_file);
+  penalized_flow_file.reset();
+  connection->put(createPersistedFlowFile(content_repo, 2));
+  REQUIRE(connection->getSwappedQueueSize() == 2);
+
+  REQUIRE(connection->poll(expired_flow_files)->getAttribute("index") == "0");
+  // the penalized flow file is swapped in, but it is not available yet
+  REQUIRE(connection->poll(expired_flow_files)->getAttribute("index") == "2");
+  REQUIRE(nullptr == connection->poll(expired_flow_files));
+  REQUIRE_FALSE(connection->isEmpty());
+
+  std::this_thread::sleep_for(std::chrono::milliseconds{300});
+  const auto flow_file = connection->poll(expired_flow_files);
+  REQUIRE(flow_file);
+  REQUIRE(flow_file->getAttribute("index") == "1");
+  REQUIRE(flow_file->getlineageIdentifiers() == std::vector<utils::Identifier>{lineage_id});
+  REQUIRE(connection->isEmpty());
+}
+
+TEST_CASE("Connection keeps the swap files of the connection it replaces", "[swap]") {
+  TestController test_controller;
+  const auto swap_dir = test_controller.createTempDirectory();
+  const auto flow_repo = std::make_shared<TestRepository>();
+  const auto content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+  content_repo->initialize(std::make_shared<minifi::Configure>());
+  const auto connection_id = utils::IdGenerator::getIdGenerator()->generate();
+  std::set<std::shared_ptr<core::FlowFile>> expired_flow_files;
+
+  const auto connection = std::make_shared<minifi::Connection>(flow_repo, content_repo, "test_connection", connection_id);
+  connection->setSwapThreshold(1, swap_dir);
+  for (int i = 0; i < 3; ++i) {
+    connection->put(createPersistedFlowFile(content_repo, i));
+  }
+  REQUIRE(connection->getSwappedQueueSize() == 2);
+
+  // e.g. the same connection in the reloaded flow
+  const auto reloaded_connection = std::make_shared<minifi::Connection>(flow_repo, content_repo, "test_connection", connection_id);
+  reloaded_connection->setSwapThreshold(1, swap_dir);
+  REQUIRE(utils::file::FileUtils::list_dir_all(swap_dir, test_controller.getLogger(), false).size() == 2);
+
+  for (const char* index : {"0", "1", "2"}) {
+    const auto flow_file = connection->poll(expired_flow_files);
+    REQUIRE(flow_file);
+    REQUIRE(flow_file->getAttribute("index") == index);
+  }
+  REQUIRE(connection->isEmpty());
+}
+
+TEST_CASE("Connection swapping out its flow files does not use a lock-free queue", "[swap]") {
+  TestController test_controller;
+  const auto flow_repo = std::make_shared<TestRepository>();
+  const auto content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+  content_repo->initialize(std::make_shared<minifi::Configure>());
+
+  const auto connection = std::make_shared<minifi::Connection>(flow_repo, content_repo, "test_connection");
+  connection->setSwapThreshold(5, test_controller.createTempDirectory());
+  connection->setLockFreeQueue(true);
+  REQUIRE_FALSE(connection->hasLockFreeQueue());
+  REQUIRE(connection->getSwapThreshold() == 5);
+}
+
+TEST_CASE("Connection hand-off throughput", "[speed]") {
+  const auto flow_repo = std::make_shared<TestRepository>();
+  const auto content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+  content_repo->initialize(std::make_shared<minifi::Configure>());
+  const auto connection = std::make_shared<minifi::Connection>(flow_repo, content_repo, "test_connection");
+
+  std::string queue_type;
+  SECTION("mutex guarded queue") {
+    queue_type = "mutex guarded queue";
+  }
+  SECTION("lock-free queue") {
+    queue_type = "lock-free queue";
+    connection->setLockFreeQueue(true);
+  }
+
+  constexpr int FLOW_FILES = 200000;
+  constexpr int CONSUMERS = 4;
+  std::vector<std::shared_ptr<core::FlowFile>> flow_files(FLOW_FILES);
+  for (auto& flow_file : flow_files) {
+    flow_file = std::make_shared<core::FlowFile>();
+  }
+
+  std::atomic<int> consumed{0};
+  const auto before = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  threads.emplace_back([&] {
+    for (const auto& flow_file : flow_files) {
+      connection->put(flow_file);
+    }
+  });
+  for (int i = 0; i < CONSUMERS; ++i) {
+    threads.emplace_back([&] {
+      std::set<std::shared_ptr<core::FlowFile>> expired_flow_files;
+      while (consumed < FLOW_FILES) {
+        if (connection->isWorkAvailable() && connection->poll(expired_flow_files)) {
+          ++consumed;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - before);
+
+  REQUIRE(connection->isEmpty());
+  std::cerr << "Passing " << FLOW_FILES << " flow files from 1 producer to " << CONSUMERS << " consumers (" << queue_type << ") took " << duration.count() << "us" << std::endl;
+}
@@ -174,4 +174,31 @@ void testAppendToManagedFlowFile(std::shared_ptr<core::ContentRepository> conten
   CHECK(to_string(read_result) == "myfoobar");
   CHECK(read_until_it_can_callback.value_ == "myfoobar");
 }
+
+void testAttachContentWrittenOutsideOfTheSession(std::shared_ptr<core::ContentRepository> content_repo) {
+  Fixture fixture = Fixture(content_repo);
+  core::ProcessSession& process_session = fixture.processSession();
+
+  const auto claim = std::make_shared<minifi::ResourceClaim>(content_repo);
+  WriteStringToFlowFile write_callback("merged");
+  REQUIRE(write_callback.process(content_repo->write(*claim)) == 6);
+  const auto owned_count = claim->getFlowFileRecordOwnedCount();
+
+  // the session does not take ownership of the claim if it is rolled back
+  const auto rolled_back_ff = process_session.create();
+  process_session.attachContent(rolled_back_ff, claim, 6);
+  process_session.transfer(rolled_back_ff, fixture.Success);
+  process_session.rollback();
+  CHECK(claim->getFlowFileRecordOwnedCount() == owned_count);
+
+  const auto flow_file = process_session.create();
+  process_session.attachContent(flow_file, claim, 6);
+  fixture.transferAndCommit(flow_file);
+
+  CHECK(flow_file->getSize() == 6);
+  CHECK(flow_file->getResourceClaim() == claim);
+  ReadUntilItCan read_until_it_can_callback;
+  process_session.read(flow_file, &read_until_it_can_callback);
+  CHECK(read_until_it_can_callback.value_ == "merged");
+}
 }  // namespace ContentRepositoryDependentTests
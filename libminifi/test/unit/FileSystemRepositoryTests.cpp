@@ -0,0 +1,160 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/repository/FileSystemRepository.h"
+#include "ResourceClaim.h"
+#include "../TestBase.h"
+
+namespace {
+
+std::shared_ptr<core::repository::FileSystemRepository> createRepository(const std::string& dir, const std::string& container_size = "") {
+  auto config = std::make_shared<minifi::Configure>();
+  config->set(minifi::Configure::nifi_dbcontent_repository_directory_default, dir);
+  if (!container_size.empty()) {
+    config->set(minifi::Configure::nifi_content_repository_container_max_size, container_size);
+  }
+  auto repository = std::make_shared<core::repository::FileSystemRepository>();
+  REQUIRE(repository->initialize(config));
+  return repository;
+}
+
+void writeContent(core::ContentRepository& repository, const minifi::ResourceClaim& claim, const std::string& content) {
+  auto stream = repository.write(claim);
+  REQUIRE(stream);
+  REQUIRE(stream->write(reinterpret_cast<const uint8_t*>(content.data()), content.size()) == content.size());
+  stream->close();
+}
+
+std::string readContent(core::ContentRepository& repository, const minifi::ResourceClaim& claim) {
+  auto stream = repository.read(claim);
+  REQUIRE(stream);
+  std::string content(stream->size(), '\0');
+  REQUIRE(stream->read(reinterpret_cast<uint8_t*>(content.data()), content.size()) == content.size());
+  return content;
+}
+
+}  // namespace
+
+TEST_CASE("FileSystemRepository appends claims into rolling containers", "[FileSystemRepository]") {
+  TestController test_controller;
+  const auto dir = test_controller.createTempDirectory();
+  auto repository = createRepository(dir, "100 B");
+  REQUIRE(repository->isContainerMode());
+
+  std::vector<std::shared_ptr<minifi::ResourceClaim>> claims;
+  for (int i = 0; i < 10; ++i) {
+    claims.push_back(std::make_shared<minifi::ResourceClaim>(repository));
+    writeContent(*repository, *claims.back(), "content of claim " + std::to_string(i));
+  }
+  REQUIRE(repository->getSegmentCount() > 1);
+  REQUIRE(repository->getSegmentCount() < claims.size());
+  REQUIRE(utils::file::FileUtils::list_dir_all(dir, test_controller.getLogger(), false).empty());
+
+  for (int i = 0; i < 10; ++i) {
+    REQUIRE(repository->exists(*claims[i]));
+    REQUIRE(readContent(*repository, *claims[i]) == "content of claim " + std::to_string(i));
+  }
+
+  SECTION("Appending moves the claim into its own file") {
+    for (const auto* appended : {"-appended", "-again"}) {
+      auto stream = repository->write(*claims[0], true);
+      const std::string content{appended};
+      REQUIRE(stream->write(reinterpret_cast<const uint8_t*>(content.data()), content.size()) == content.size());
+      stream->close();
+    }
+    REQUIRE(readContent(*repository, *claims[0]) == "content of claim 0-appended-again");
+    const std::string claim_path = claims[0]->getContentFullPath();
+    REQUIRE(utils::file::FileUtils::exists(claim_path));
+
+    repository->stop();
+    auto restarted_repository = createRepository(dir, "100 B");
+    REQUIRE(readContent(*restarted_repository, minifi::ResourceClaim(claim_path, nullptr)) == "content of claim 0-appended-again");
+    REQUIRE(restarted_repository->remove(minifi::ResourceClaim(claim_path, nullptr)));
+    REQUIRE_FALSE(utils::file::FileUtils::exists(claim_path));
+  }
+
+  SECTION("Containers are deleted once all of their claims are removed") {
+    claims.clear();
+    REQUIRE(repository->getSegmentCount() <= 1);
+  }
+
+  SECTION("Claims are reloaded after a restart") {
+    const std::string removed_claim_path = claims[5]->getContentFullPath();
+    claims.erase(claims.begin() + 5);
+    repository->stop();
+
+    auto restarted_repository = createRepository(dir, "100 B");
+    for (size_t i = 0; i < claims.size(); ++i) {
+      minifi::ResourceClaim claim(claims[i]->getContentFullPath(), nullptr);
+      REQUIRE(restarted_repository->exists(claim));
+      REQUIRE(readContent(*restarted_repository, claim) == "content of claim " + std::to_string(i < 5 ? i : i + 1));
+    }
+    REQUIRE_FALSE(restarted_repository->exists(minifi::ResourceClaim(removed_claim_path, nullptr)));
+  }
+}
+
+TEST_CASE("FileSystemRepository closes the containers in use when stopped", "[FileSystemRepository]") {
+  TestController test_controller;
+  const auto dir = test_controller.createTempDirectory();
+  auto repository = createRepository(dir, "100 B");
+
+  auto committed_claim = std::make_shared<minifi::ResourceClaim>(repository);
+  writeContent(*repository, *committed_claim, "committed");
+  auto pending_claim = std::make_shared<minifi::ResourceClaim>(repository);
+  auto stream = repository->write(*pending_claim);
+  REQUIRE(stream->write(reinterpret_cast<const uint8_t*>("pending"), 7) == 7);
+
+  repository->stop();
+  REQUIRE(minifi::io::isError(stream->write(reinterpret_cast<const uint8_t*>("-more"), 5)));
+  stream->close();
+  REQUIRE_FALSE(repository->exists(*pending_claim));
+
+  auto restarted_repository = createRepository(dir, "100 B");
+  REQUIRE(readContent(*restarted_repository, minifi::ResourceClaim(committed_claim->getContentFullPath(), nullptr)) == "committed");
+  REQUIRE_FALSE(restarted_repository->exists(minifi::ResourceClaim(pending_claim->getContentFullPath(), nullptr)));
+}
+
+TEST_CASE("FileSystemRepository small claim throughput", "[speed]") {
+  TestController test_controller;
+  std::string layout;
+  std::string container_size;
+  SECTION("file per claim") {
+    layout = "file per claim";
+  }
+  SECTION("containers") {
+    layout = "containers";
+    container_size = "1 MB";
+  }
+  auto repository = createRepository(test_controller.createTempDirectory(), container_size);
+
+  const std::string content(256, 'x');
+  std::vector<std::shared_ptr<minifi::ResourceClaim>> claims(10000);
+  const auto before = std::chrono::steady_clock::now();
+  for (auto& claim : claims) {
+    claim = std::make_shared<minifi::ResourceClaim>(repository);
+    writeContent(*repository, *claim, content);
+  }
+  claims.clear();
+  const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - before);
+  std::cerr << "Writing and removing 10000 claims of 256 bytes (" << layout << ") took " << duration.count() << "us" << std::endl;
+}
@@ -0,0 +1,148 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifdef __linux__
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "../TestBase.h"
+#include "utils/file/FileUtils.h"
+#include "utils/file/FileWatcher.h"
+
+using utils::file::FileWatcher;
+
+namespace {
+std::vector<FileWatcher::Change> pollChanges(FileWatcher& watcher) {
+  std::vector<FileWatcher::Change> changes;
+  REQUIRE(watcher.poll([&](const FileWatcher::Change& change) { changes.push_back(change); }));
+  return changes;
+}
+
+bool containsChange(const std::vector<FileWatcher::Change>& changes, const std::string& file_name, FileWatcher::ChangeType type) {
+  return std::any_of(changes.begin(), changes.end(), [&](const FileWatcher::Change& change) { return change.file_name == file_name && change.type == type; });
+}
+}  // namespace
+
+TEST_CASE("FileWatcher reports the changes of the files in the watched directories", "[FileWatcher]") {
+  TestController test_controller;
+  const auto dir = test_controller.createTempDirectory();
+  const auto file_path = utils::file::FileUtils::concat_path(dir, "watched.log");
+
+  FileWatcher watcher;
+  REQUIRE(watcher.isAvailable());
+  REQUIRE(watcher.watch(dir));
+  REQUIRE(pollChanges(watcher).empty());
+
+  std::ofstream{file_path} << "first line\n";
+  auto changes = pollChanges(watcher);
+  REQUIRE(containsChange(changes, "watched.log", FileWatcher::ChangeType::CREATED));
+  REQUIRE(changes.front().directory == dir);
+
+  std::ofstream{file_path, std::ios::app} << "second line\n";
+  REQUIRE(containsChange(pollChanges(watcher), "watched.log", FileWatcher::ChangeType::MODIFIED));
+
+  REQUIRE(std::rename(file_path.c_str(), utils::file::FileUtils::concat_path(dir, "watched.log.1").c_str()) == 0);
+  changes = pollChanges(watcher);
+  REQUIRE(containsChange(changes, "watched.log", FileWatcher::ChangeType::REMOVED));
+  REQUIRE(containsChange(changes, "watched.log.1", FileWatcher::ChangeType::CREATED));
+
+  watcher.unwatch(dir);
+  std::ofstream{file_path} << "not watched\n";
+  REQUIRE(pollChanges(watcher).empty());
+}
+
+TEST_CASE("FileWatcher reports the changes of a directory watched under several names for each name", "[FileWatcher]") {
+  TestController test_controller;
+  const auto dir = test_controller.createTempDirectory();
+  const auto link = utils::file::FileUtils::concat_path(test_controller.createTempDirectory(), "link");
+  REQUIRE(symlink(dir.c_str(), link.c_str()) == 0);
+
+  FileWatcher watcher;
+  REQUIRE(watcher.watch(dir));
+  REQUIRE(watcher.watch(link));
+
+  std::ofstream{utils::file::FileUtils::concat_path(dir, "watched.log")} << "first line\n";
+  auto changes = pollChanges(watcher);
+  REQUIRE(changes.size() == 2);
+  REQUIRE(std::any_of(changes.begin(), changes.end(), [&](const FileWatcher::Change& change) { return change.directory == dir; }));
+  REQUIRE(std::any_of(changes.begin(), changes.end(), [&](const FileWatcher::Change& change) { return change.directory == link; }));
+
+  // the other name still keeps the shared watch
+  watcher.unwatch(dir);
+  std::ofstream{utils::file::FileUtils::concat_path(link, "watched.log"), std::ios::app} << "second line\n";
+  changes = pollChanges(watcher);
+  REQUIRE(changes.size() == 1);
+  REQUIRE(changes.front().directory == link);
+
+  watcher.unwatch(link);
+  std::ofstream{utils::file::FileUtils::concat_path(dir, "watched.log"), std::ios::app} << "not watched\n";
+  REQUIRE(pollChanges(watcher).empty());
+}
+
+TEST_CASE("FileWatcher notifies once about the changes until they are polled", "[FileWatcher]") {
+  TestController test_controller;
+  const auto dir = test_controller.createTempDirectory();
+  const auto file_path = utils::file::FileUtils::concat_path(dir, "watched.log");
+
+  std::mutex mutex;
+  std::condition_variable condition;
+  int notification_count = 0;
+  const auto waitForNotifications = [&](int expected_count, std::chrono::milliseconds timeout = std::chrono::seconds(5)) {
+    std::unique_lock<std::mutex> lock(mutex);
+    return condition.wait_for(lock, timeout, [&] { return notification_count >= expected_count; });
+  };
+
+  FileWatcher watcher;
+  REQUIRE(watcher.watch(dir));
+  watcher.notifyOnChanges([&] {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      ++notification_count;
+    }
+    condition.notify_all();
+  });
+  REQUIRE_FALSE(watcher.hasPendingChanges());
+
+  std::ofstream{file_path} << "first line\n";
+  REQUIRE(waitForNotifications(1));
+  REQUIRE(watcher.hasPendingChanges());
+  std::ofstream{file_path, std::ios::app} << "second line\n";
+  REQUIRE_FALSE(waitForNotifications(2, std::chrono::milliseconds(200)));
+
+  REQUIRE(containsChange(pollChanges(watcher), "watched.log", FileWatcher::ChangeType::MODIFIED));
+  REQUIRE_FALSE(watcher.hasPendingChanges());
+
+  std::ofstream{file_path, std::ios::app} << "third line\n";
+  REQUIRE(waitForNotifications(2));
+}
+
+TEST_CASE("FileWatcher cannot watch a directory which does not exist", "[FileWatcher]") {
+  TestController test_controller;
+  const auto dir = test_controller.createTempDirectory();
+
+  FileWatcher watcher;
+  REQUIRE_FALSE(watcher.watch(utils::file::FileUtils::concat_path(dir, "missing")));
+}
+#endif
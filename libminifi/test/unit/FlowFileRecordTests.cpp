@@ -0,0 +1,189 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "FlowFileRecord.h"
+#include "FlowFileRecordDictionary.h"
+#include "io/BufferStream.h"
+#include "../TestBase.h"
+
+namespace {
+
+std::shared_ptr<minifi::FlowFileRecord> createFlowFile(const std::string& content_path) {
+  auto flow_file = std::make_shared<minifi::FlowFileRecord>();
+  flow_file->setAttribute("path", "/var/log/");
+  flow_file->setAttribute("mime.type", "text/plain");
+  flow_file->setAttribute("kafka.topic", "events");
+  flow_file->setSize(1024);
+  flow_file->setOffset(42);
+  flow_file->setResourceClaim(std::make_shared<minifi::ResourceClaim>(content_path, nullptr));
+  return flow_file;
+}
+
+std::shared_ptr<minifi::FlowFileRecord> deserialize(const minifi::io::BufferStream& buffer, const std::shared_ptr<minifi::FlowFileRecordDictionary>& dictionary = nullptr) {
+  utils::Identifier container;
+  return minifi::FlowFileRecord::DeSerialize(buffer.getBuffer(), gsl::narrow<int>(buffer.size()), nullptr, container, dictionary);
+}
+
+void requireSameRecord(const minifi::FlowFileRecord& expected, const minifi::FlowFileRecord& actual) {
+  REQUIRE(expected.getUUID() == actual.getUUID());
+  REQUIRE(expected.getAttributes() == actual.getAttributes());
+  REQUIRE(expected.getSize() == actual.getSize());
+  REQUIRE(expected.getOffset() == actual.getOffset());
+  // the timestamps are persisted with millisecond precision
+  REQUIRE(std::chrono::time_point_cast<std::chrono::milliseconds>(expected.getEntryDate()) == actual.getEntryDate());
+  REQUIRE(std::chrono::time_point_cast<std::chrono::milliseconds>(expected.getlineageStartDate()) == actual.getlineageStartDate());
+  REQUIRE(expected.getResourceClaim()->getContentFullPath() == actual.getResourceClaim()->getContentFullPath());
+}
+
+}  // namespace
+
+TEST_CASE("FlowFileRecord serialization round trip", "[FlowFileRecord]") {
+  auto flow_file = createFlowFile("./content_repository/1631096765117-1");
+
+  SECTION("Without a dictionary") {
+    minifi::io::BufferStream buffer;
+    REQUIRE(flow_file->Serialize(buffer));
+    auto read = deserialize(buffer);
+    REQUIRE(read);
+    requireSameRecord(*flow_file, *read);
+  }
+
+  SECTION("With a dictionary") {
+    auto dictionary = std::make_shared<minifi::FlowFileRecordDictionary>();
+    minifi::io::BufferStream first_buffer;
+    REQUIRE(flow_file->Serialize(first_buffer, dictionary));
+    REQUIRE(dictionary->size() == flow_file->getAttributes().size() + 1);  // the content directory
+    REQUIRE(dictionary->getUnpersistedEntries().size() == dictionary->size());
+
+    minifi::io::BufferStream inline_buffer;
+    REQUIRE(flow_file->Serialize(inline_buffer));
+    REQUIRE(first_buffer.size() < inline_buffer.size());
+
+    auto read = deserialize(first_buffer, dictionary);
+    REQUIRE(read);
+    requireSameRecord(*flow_file, *read);
+
+    // the keys can't be resolved without the dictionary
+    REQUIRE_FALSE(deserialize(first_buffer));
+    REQUIRE_FALSE(deserialize(first_buffer, std::make_shared<minifi::FlowFileRecordDictionary>()));
+
+    SECTION("The dictionary can be restored from its entries") {
+      auto restored_dictionary = std::make_shared<minifi::FlowFileRecordDictionary>();
+      for (const auto& entry : dictionary->getUnpersistedEntries()) {
+        REQUIRE(restored_dictionary->restore(entry.first, entry.second));
+      }
+      REQUIRE(restored_dictionary->getUnpersistedEntries().empty());
+      auto restored_read = deserialize(first_buffer, restored_dictionary);
+      REQUIRE(restored_read);
+      requireSameRecord(*flow_file, *restored_read);
+    }
+  }
+}
+
+TEST_CASE("FlowFileRecord dictionary entries are only added until the dictionary is full", "[FlowFileRecord]") {
+  minifi::FlowFileRecordDictionary dictionary;
+  for (uint32_t i = 0; i < minifi::FlowFileRecordDictionary::MAX_SIZE; ++i) {
+    REQUIRE(dictionary.intern("key" + std::to_string(i)) == i);
+  }
+  REQUIRE(dictionary.intern("key0") == 0);
+  REQUIRE_FALSE(dictionary.intern("one key too many"));
+
+  const auto entries = dictionary.getUnpersistedEntries();
+  REQUIRE(entries.size() == minifi::FlowFileRecordDictionary::MAX_SIZE);
+  dictionary.markPersisted(entries);
+  REQUIRE(dictionary.getUnpersistedEntries().empty());
+  REQUIRE_FALSE(dictionary.restore(0, "another key"));
+}
+
+TEST_CASE("FlowFileRecord reads the legacy record format", "[FlowFileRecord]") {
+  const auto event_time = std::chrono::system_clock::time_point() + std::chrono::milliseconds(1631096765117);
+  const auto uuid = utils::IdGenerator::getIdGenerator()->generate();
+  const auto container = utils::IdGenerator::getIdGenerator()->generate();
+
+  minifi::io::BufferStream buffer;
+  buffer.write(uint64_t{1631096765117});  // event time
+  buffer.write(uint64_t{1631096765118});  // entry date
+  buffer.write(uint64_t{1631096765100});  // lineage start date
+  buffer.write(uuid);
+  buffer.write(container);
+  buffer.write(uint32_t{2});
+  buffer.write("filename", true);
+  buffer.write("file.txt", true);
+  buffer.write("path", true);
+  buffer.write("/var/log/", true);
+  buffer.write("./content_repository/1631096765117-1");
+  buffer.write(uint64_t{1024});
+  buffer.write(uint64_t{42});
+
+  utils::Identifier read_container;
+  auto read = minifi::FlowFileRecord::DeSerialize(buffer.getBuffer(), gsl::narrow<int>(buffer.size()), nullptr, read_container);
+  REQUIRE(read);
+  REQUIRE(read_container == container);
+  REQUIRE(read->getUUID() == uuid);
+  REQUIRE(read->getEntryDate() == event_time + std::chrono::milliseconds(1));
+  REQUIRE(read->getlineageStartDate() == event_time - std::chrono::milliseconds(17));
+  REQUIRE(read->getAttributes() == std::map<std::string, std::string>{{"filename", "file.txt"}, {"path", "/var/log/"}});
+  REQUIRE(read->getResourceClaim()->getContentFullPath() == "./content_repository/1631096765117-1");
+  REQUIRE(read->getSize() == 1024);
+  REQUIRE(read->getOffset() == 42);
+}
+
+TEST_CASE("FlowFileRecord serialization throughput", "[speed]") {
+  std::shared_ptr<minifi::FlowFileRecordDictionary> dictionary;
+  std::string format;
+  SECTION("inline keys") {
+    format = "inline keys";
+  }
+  SECTION("dictionary") {
+    format = "dictionary";
+    dictionary = std::make_shared<minifi::FlowFileRecordDictionary>();
+  }
+
+  std::vector<std::shared_ptr<minifi::FlowFileRecord>> flow_files;
+  for (int i = 0; i < 10000; ++i) {
+    auto flow_file = createFlowFile("./content_repository/1631096765117-" + std::to_string(i));
+    for (int attr = 0; attr < 12; ++attr) {
+      flow_file->setAttribute("attribute.key." + std::to_string(attr), std::to_string(i));
+    }
+    flow_files.push_back(flow_file);
+  }
+
+  size_t total_size = 0;
+  std::vector<std::unique_ptr<minifi::io::BufferStream>> buffers;
+  const auto before_serialize = std::chrono::steady_clock::now();
+  for (const auto& flow_file : flow_files) {
+    buffers.push_back(std::make_unique<minifi::io::BufferStream>());
+    REQUIRE(flow_file->Serialize(*buffers.back(), dictionary));
+    total_size += buffers.back()->size();
+  }
+  const auto before_deserialize = std::chrono::steady_clock::now();
+  for (const auto& buffer : buffers) {
+    REQUIRE(deserialize(*buffer, dictionary));
+  }
+  const auto after = std::chrono::steady_clock::now();
+
+  std::cerr << "Serializing 10000 FlowFile records (" << format << ") took "
+            << std::chrono::duration_cast<std::chrono::microseconds>(before_deserialize - before_serialize).count() << "us, deserializing took "
+            << std::chrono::duration_cast<std::chrono::microseconds>(after - before_deserialize).count() << "us, "
+            << total_size / flow_files.size() << " bytes per record" << std::endl;
+}
@@ -0,0 +1,102 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <thread>
+#include <vector>
+
+#include "../TestBase.h"
+#include "utils/LatencyHistogram.h"
+
+using utils::LatencyHistogram;
+using namespace std::literals::chrono_literals;
+
+TEST_CASE("The buckets of the latency histogram cover the durations without gaps", "[latencyHistogram]") {
+  REQUIRE(LatencyHistogram::getBucketIndex(0) == 0);
+  REQUIRE(LatencyHistogram::getBucketIndex(7) == 7);
+  REQUIRE(LatencyHistogram::getBucketIndex(8) == 8);
+  REQUIRE(LatencyHistogram::getBucketIndex(15) == 15);
+  REQUIRE(LatencyHistogram::getBucketIndex(16) == 16);
+  REQUIRE(LatencyHistogram::getBucketIndex(17) == 16);
+  REQUIRE(LatencyHistogram::getBucketIndex(18) == 17);
+  REQUIRE(LatencyHistogram::getBucketIndex(LatencyHistogram::MAX_DURATION.count()) == LatencyHistogram::BUCKET_COUNT - 1);
+  REQUIRE(LatencyHistogram::getBucketIndex(std::numeric_limits<uint64_t>::max()) == LatencyHistogram::BUCKET_COUNT - 1);
+  REQUIRE(LatencyHistogram::getBucketUpperLimit(LatencyHistogram::BUCKET_COUNT - 1) == static_cast<uint64_t>(LatencyHistogram::MAX_DURATION.count()));
+
+  for (size_t i = 1; i < LatencyHistogram::BUCKET_COUNT; ++i) {
+    const uint64_t lower_limit = LatencyHistogram::getBucketUpperLimit(i - 1) + 1;
+    REQUIRE(LatencyHistogram::getBucketIndex(lower_limit) == i);
+    REQUIRE(LatencyHistogram::getBucketIndex(LatencyHistogram::getBucketUpperLimit(i)) == i);
+    // the relative error is bounded
+    REQUIRE(LatencyHistogram::getBucketUpperLimit(i) - lower_limit <= lower_limit / 8);
+  }
+}
+
+TEST_CASE("The quantiles of the latency histogram", "[latencyHistogram]") {
+  LatencyHistogram histogram;
+  REQUIRE(histogram.getSnapshot().getCount() == 0);
+  REQUIRE(histogram.getSnapshot().getQuantile(0.5) == 0us);
+
+  for (int i = 1; i <= 1000; ++i) {
+    histogram.record(std::chrono::microseconds(i));
+  }
+  const auto snapshot = histogram.getSnapshot();
+  REQUIRE(snapshot.getCount() == 1000);
+  REQUIRE(snapshot.getSum() == 500500us);
+  REQUIRE(snapshot.getMax() == 1000us);
+  REQUIRE(snapshot.getQuantile(0.0) == 1us);
+  REQUIRE(snapshot.getQuantile(1.0) == 1000us);
+  const auto median = snapshot.getQuantile(0.5);
+  REQUIRE(500us <= median);
+  REQUIRE(median <= 500us + 500us / 8);
+  const auto p99 = snapshot.getQuantile(0.99);
+  REQUIRE(990us <= p99);
+  REQUIRE(p99 <= 1000us);
+  REQUIRE(snapshot.getCountNotAbove(7us) == 7);
+  REQUIRE(snapshot.getCountNotAbove(std::chrono::microseconds(LatencyHistogram::getBucketUpperLimit(LatencyHistogram::getBucketIndex(100)))) >= 100);
+  REQUIRE(snapshot.getCountNotAbove(1h) == 1000);
+}
+
+TEST_CASE("The negative and too long durations are recorded at the ends of the latency histogram", "[latencyHistogram]") {
+  LatencyHistogram histogram;
+  histogram.record(-5us);
+  histogram.record(std::chrono::hours(24 * 30));
+  const auto snapshot = histogram.getSnapshot();
+  REQUIRE(snapshot.getCount() == 2);
+  REQUIRE(snapshot.getQuantile(0.5) == 0us);
+  REQUIRE(snapshot.getQuantile(1.0) == LatencyHistogram::MAX_DURATION);
+}
+
+TEST_CASE("The latency histogram can be recorded from several threads", "[latencyHistogram]") {
+  LatencyHistogram histogram;
+  const size_t thread_count = 4;
+  const size_t records_per_thread = 10000;
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < thread_count; ++i) {
+    threads.emplace_back([&histogram, i] {
+      for (size_t j = 0; j < records_per_thread; ++j) {
+        histogram.record(std::chrono::microseconds(i * records_per_thread + j));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  const auto snapshot = histogram.getSnapshot();
+  REQUIRE(snapshot.getCount() == thread_count * records_per_thread);
+  REQUIRE(snapshot.getMax() == std::chrono::microseconds(thread_count * records_per_thread - 1));
+}
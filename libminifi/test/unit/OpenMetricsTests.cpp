@@ -0,0 +1,147 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../TestBase.h"
+#include "core/state/OpenMetrics.h"
+#include "core/state/nodes/QueueMetrics.h"
+#include "core/state/nodes/RepositoryMetrics.h"
+#include "repository/VolatileContentRepository.h"
+#include "ProvenanceTestHelper.h"
+
+using minifi::state::PublishedMetric;
+using minifi::state::serializeOpenMetrics;
+
+TEST_CASE("An empty exposition only contains the EOF marker", "[openmetrics]") {
+  REQUIRE("# EOF\n" == serializeOpenMetrics({}));
+}
+
+TEST_CASE("The samples are grouped into families", "[openmetrics]") {
+  const std::vector<PublishedMetric> metrics{
+    {"queued", 3, {{"connection", "b"}}},
+    {"processed", 5, {}, PublishedMetric::Type::COUNTER},
+    {"queued", 1, {{"connection", "a"}}}
+  };
+
+  REQUIRE(
+      "# TYPE minifi_processed counter\n"
+      "minifi_processed_total 5\n"
+      "# TYPE minifi_queued gauge\n"
+      "minifi_queued{connection=\"b\"} 3\n"
+      "minifi_queued{connection=\"a\"} 1\n"
+      "# EOF\n" == serializeOpenMetrics(metrics));
+}
+
+TEST_CASE("The samples of a summary keep their suffix", "[openmetrics]") {
+  const std::vector<PublishedMetric> metrics{
+    {"latency_seconds", 0.25, {{"quantile", "0.5"}}, PublishedMetric::Type::SUMMARY},
+    {"latency_seconds", 1.5, {}, PublishedMetric::Type::SUMMARY, "_sum"},
+    {"latency_seconds", 4, {}, PublishedMetric::Type::SUMMARY, "_count"}
+  };
+
+  REQUIRE(
+      "# TYPE minifi_latency_seconds summary\n"
+      "minifi_latency_seconds{quantile=\"0.5\"} 0.25\n"
+      "minifi_latency_seconds_sum 1.5\n"
+      "minifi_latency_seconds_count 4\n"
+      "# EOF\n" == serializeOpenMetrics(metrics));
+}
+
+TEST_CASE("The samples whose type differs from their family are left out", "[openmetrics]") {
+  const std::vector<PublishedMetric> metrics{
+    {"size", 1},
+    {"size", 2, {}, PublishedMetric::Type::COUNTER}
+  };
+
+  REQUIRE(
+      "# TYPE minifi_size gauge\n"
+      "minifi_size 1\n"
+      "# EOF\n" == serializeOpenMetrics(metrics));
+}
+
+TEST_CASE("Names are sanitized and label values are escaped", "[openmetrics]") {
+  const std::vector<PublishedMetric> metrics{
+    {"queue size:bytes", 1, {{"0connection-name", "a \"quoted\" \\ name\nwith a new line"}}}
+  };
+
+  REQUIRE(
+      "# TYPE minifi_queue_size:bytes gauge\n"
+      "minifi_queue_size:bytes{_connection_name=\"a \\\"quoted\\\" \\\\ name\\nwith a new line\"} 1\n"
+      "# EOF\n" == serializeOpenMetrics(metrics));
+}
+
+TEST_CASE("Special values are spelled out", "[openmetrics]") {
+  const std::vector<PublishedMetric> metrics{
+    {"a", std::numeric_limits<double>::quiet_NaN()},
+    {"b", std::numeric_limits<double>::infinity()},
+    {"c", -std::numeric_limits<double>::infinity()},
+    {"d", 12345678901234.0}
+  };
+
+  REQUIRE(
+      "# TYPE minifi_a gauge\n"
+      "minifi_a NaN\n"
+      "# TYPE minifi_b gauge\n"
+      "minifi_b +Inf\n"
+      "# TYPE minifi_c gauge\n"
+      "minifi_c -Inf\n"
+      "# TYPE minifi_d gauge\n"
+      "minifi_d 12345678901234\n"
+      "# EOF\n" == serializeOpenMetrics(metrics));
+}
+
+TEST_CASE("The queue metrics are published per connection", "[openmetrics]") {
+  minifi::state::response::QueueMetrics queue_metrics;
+  REQUIRE(queue_metrics.calculateMetrics().empty());
+
+  std::shared_ptr<minifi::Configure> configuration = std::make_shared<minifi::Configure>();
+  std::shared_ptr<core::ContentRepository> content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+  content_repo->initialize(configuration);
+  std::shared_ptr<core::Repository> repo = std::make_shared<TestRepository>();
+  std::shared_ptr<minifi::Connection> connection = std::make_shared<minifi::Connection>(repo, content_repo, "testconnection");
+  connection->setMaxQueueDataSize(1024);
+  connection->setMaxQueueSize(100);
+  queue_metrics.addConnection(connection);
+
+  const auto exposition = serializeOpenMetrics(queue_metrics.calculateMetrics());
+  const std::string labels = "{connection_name=\"testconnection\",connection_uuid=\"" + connection->getUUIDStr() + "\"}";
+  REQUIRE(exposition.find("minifi_connection_queued_bytes" + labels + " 0\n") != std::string::npos);
+  REQUIRE(exposition.find("minifi_connection_max_queued_bytes" + labels + " 1024\n") != std::string::npos);
+  REQUIRE(exposition.find("minifi_connection_queued_flow_files" + labels + " 0\n") != std::string::npos);
+  REQUIRE(exposition.find("minifi_connection_max_queued_flow_files" + labels + " 100\n") != std::string::npos);
+}
+
+TEST_CASE("The repository metrics are published per repository", "[openmetrics]") {
+  minifi::state::response::RepositoryMetrics repository_metrics;
+  REQUIRE(repository_metrics.calculateMetrics().empty());
+
+  auto repo = std::make_shared<TestRepository>();
+  repository_metrics.addRepository(repo);
+  repo->start();
+
+  const auto exposition = serializeOpenMetrics(repository_metrics.calculateMetrics());
+  REQUIRE(exposition.find("# TYPE minifi_repository_running gauge\nminifi_repository_running{repository_name=\"repo_name\"} 1\n") != std::string::npos);
+  REQUIRE(exposition.find("minifi_repository_full{repository_name=\"repo_name\"} 0\n") != std::string::npos);
+  REQUIRE(exposition.find("minifi_repository_size_bytes{repository_name=\"repo_name\"} 0\n") != std::string::npos);
+  // only the repositories backed by RocksDB report storage estimates
+  REQUIRE(exposition.find("minifi_repository_estimated_keys") == std::string::npos);
+  repo->stop();
+}
@@ -109,3 +109,8 @@ TEST_CASE("ProcessSession::append should append to the flowfile and set its size
   ContentRepositoryDependentTests::testAppendToManagedFlowFile(std::make_shared<minifi::core::repository::VolatileContentRepository>());
   ContentRepositoryDependentTests::testAppendToManagedFlowFile(std::make_shared<minifi::core::repository::FileSystemRepository>());
 }
+
+TEST_CASE("ProcessSession::attachContent makes the content written outside of the session the content of the flowfile", "[attachContent]") {
+  ContentRepositoryDependentTests::testAttachContentWrittenOutsideOfTheSession(std::make_shared<minifi::core::repository::VolatileContentRepository>());
+  ContentRepositoryDependentTests::testAttachContentWrittenOutsideOfTheSession(std::make_shared<minifi::core::repository::FileSystemRepository>());
+}
@@ -19,9 +19,14 @@
 #include <utility>
 #include <future>
 #include <memory>
+#include <string>
+#include <vector>
 #include "../TestBase.h"
+#include "utils/IntegrationTestUtils.h"
 #include "utils/ThreadPool.h"
 
+using namespace std::literals::chrono_literals;
+
 bool function() {
   return true;
 }
@@ -94,3 +99,158 @@ TEST_CASE("ThreadPoolTest2", "[TPT2]") {
   fut.wait();
   REQUIRE(20 == fut.get());
 }
+
+TEST_CASE("Notified tasks don't wait for their delay to elapse", "[TPT3]") {
+  utils::ThreadPool<utils::TaskRescheduleInfo> pool(2);
+  std::atomic<int> runs{0};
+  bool notifiable = true;
+  SECTION("Notifiable task") {
+    notifiable = true;
+  }
+  SECTION("Task that can't be notified") {
+    notifiable = false;
+  }
+  std::function<utils::TaskRescheduleInfo()> f_ex = [&runs, notifiable] {
+    ++runs;
+    return notifiable ? utils::TaskRescheduleInfo::RetryOnNotificationOrIn(1h) : utils::TaskRescheduleInfo::RetryIn(1h);
+  };
+  utils::Worker<utils::TaskRescheduleInfo> functor(f_ex, "id", std::make_unique<utils::ComplexMonitor>());
+  pool.start();
+  std::future<utils::TaskRescheduleInfo> fut;
+  REQUIRE(pool.execute(std::move(functor), fut));
+  REQUIRE(utils::verifyEventHappenedInPollTime(1s, [&] { return runs == 1; }, 1ms));
+
+  pool.notifyTasks("other id");
+  pool.notifyTasks("id");
+  if (notifiable) {
+    REQUIRE(utils::verifyEventHappenedInPollTime(1s, [&] { return runs == 2; }, 1ms));
+  }
+
+  pool.stopTasks("id");
+  pool.notifyTasks("id");
+  std::this_thread::sleep_for(100ms);
+  REQUIRE(runs == (notifiable ? 2 : 1));
+  pool.shutdown();
+}
+
+TEST_CASE("Paused thread pools don't run tasks until they are resumed", "[TPT4]") {
+  utils::ThreadPool<int> pool(2);
+  std::atomic<int> runs{0};
+  pool.start();
+  pool.pause();
+  std::function<int()> f_ex = [&runs] { return ++runs; };
+  std::future<int> fut;
+  REQUIRE(pool.execute(utils::Worker<int>(f_ex, "id"), fut));
+  std::this_thread::sleep_for(100ms);
+  REQUIRE(runs == 0);
+
+  pool.resume();
+  REQUIRE(fut.wait_for(1s) == std::future_status::ready);
+  REQUIRE(fut.get() == 1);
+  pool.shutdown();
+}
+
+TEST_CASE("Stopped tasks are dropped from the delayed tasks", "[TPT5]") {
+  utils::ThreadPool<utils::TaskRescheduleInfo> pool(2);
+  std::atomic<int> runs{0};
+  std::function<utils::TaskRescheduleInfo()> f_ex = [&runs] {
+    ++runs;
+    return utils::TaskRescheduleInfo::RetryIn(10ms);
+  };
+  pool.start();
+  std::future<utils::TaskRescheduleInfo> fut;
+  REQUIRE(pool.execute(utils::Worker<utils::TaskRescheduleInfo>(f_ex, "id", std::make_unique<utils::ComplexMonitor>()), fut));
+  REQUIRE(pool.isTaskRunning("id"));
+  REQUIRE(utils::verifyEventHappenedInPollTime(1s, [&] { return runs >= 3; }, 1ms));
+
+  pool.stopTasks("id");
+  REQUIRE_FALSE(pool.isTaskRunning("id"));
+  std::this_thread::sleep_for(20ms);
+  const int runs_after_stop = runs;
+  std::this_thread::sleep_for(100ms);
+  REQUIRE(runs == runs_after_stop);
+  pool.shutdown();
+}
+
+TEST_CASE("The number of workers can be changed while tasks are submitted", "[TPT6]") {
+  utils::ThreadPool<int> pool(2);
+  std::atomic<int> runs{0};
+  std::function<int()> f_ex = [&runs] { return ++runs; };
+  pool.start();
+  std::atomic<bool> done{false};
+  std::thread submitter{[&] {
+    for (int i = 0; !done; ++i) {
+      std::future<int> fut;
+      pool.execute(utils::Worker<int>(f_ex, "id" + std::to_string(i % 10)), fut);
+      std::this_thread::sleep_for(100us);
+    }
+  }};
+  for (uint16_t max_tasks : {4, 1, 3}) {
+    pool.setMaxConcurrentTasks(max_tasks);
+    std::this_thread::sleep_for(20ms);
+  }
+  done = true;
+  submitter.join();
+  REQUIRE(runs > 0);
+
+  std::future<int> fut;
+  REQUIRE(pool.execute(utils::Worker<int>(f_ex, "last"), fut));
+  REQUIRE(fut.wait_for(1s) == std::future_status::ready);
+  pool.shutdown();
+}
+
+class RunCount : public utils::AfterExecute<int> {
+ public:
+  RunCount(int runs, std::chrono::milliseconds wait_time)
+      : remaining_runs_(runs),
+        wait_time_(wait_time) {
+  }
+
+  bool isFinished(const int& /*result*/) override {
+    return --remaining_runs_ <= 0;
+  }
+  bool isCancelled(const int& /*result*/) override {
+    return false;
+  }
+  std::chrono::milliseconds wait_time() override {
+    return wait_time_;
+  }
+
+ private:
+  int remaining_runs_;
+  std::chrono::milliseconds wait_time_;
+};
+
+TEST_CASE("ThreadPool scheduler throughput", "[speed]") {
+  int task_count = 0;
+  int runs_per_task = 0;
+  std::chrono::milliseconds wait_time{0};
+  SECTION("tasks rescheduled immediately") {
+    task_count = 256;
+    runs_per_task = 1000;
+  }
+  SECTION("delayed tasks") {
+    task_count = 1024;
+    runs_per_task = 20;
+    wait_time = 1ms;
+  }
+
+  utils::ThreadPool<int> pool(8);
+  std::atomic<int> runs{0};
+  std::function<int()> f_ex = [&runs] { return ++runs; };
+  pool.start();
+  std::vector<std::future<int>> futures(task_count);
+  const auto before = std::chrono::steady_clock::now();
+  for (int i = 0; i < task_count; ++i) {
+    REQUIRE(pool.execute(utils::Worker<int>(f_ex, "task" + std::to_string(i), std::make_unique<RunCount>(runs_per_task, wait_time)), futures[i]));
+  }
+  for (auto& future : futures) {
+    future.wait();
+  }
+  const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - before);
+  pool.shutdown();
+
+  REQUIRE(runs == task_count * runs_per_task);
+  std::cerr << "Running " << task_count << " tasks " << runs_per_task << " times each (" << wait_time.count() << "ms delay) on 8 threads took "
+            << duration.count() << "us" << std::endl;
+}
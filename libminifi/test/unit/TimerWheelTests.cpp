@@ -0,0 +1,94 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "../TestBase.h"
+#include "utils/TimerWheel.h"
+
+using namespace std::literals::chrono_literals;
+
+TEST_CASE("TimerWheel expires the items when their deadline elapses", "[TimerWheel]") {
+  utils::TimerWheel<int> wheel(1ms, 16);
+  const auto now = std::chrono::steady_clock::now();
+  wheel.insert(now + 5ms, 5);
+  wheel.insert(now + 1ms, 1);
+  wheel.insert(now - 10ms, 0);
+  wheel.insert(now + 100ms, 100);  // more than a revolution away
+  REQUIRE(wheel.size() == 4);
+  REQUIRE(wheel.nextExpiration() <= now);
+
+  std::vector<int> expired;
+  const auto collect = [&expired](int item) { expired.push_back(item); };
+  REQUIRE(wheel.advance(now, collect) == 1);
+  REQUIRE(expired == std::vector<int>{0});
+  REQUIRE(wheel.nextExpiration() == now + 1ms);
+
+  REQUIRE(wheel.advance(now + 5ms, collect) == 2);
+  REQUIRE(expired == std::vector<int>{0, 1, 5});
+
+  REQUIRE(wheel.advance(now + 99ms, collect) == 0);
+  REQUIRE(wheel.nextExpiration() == now + 100ms);
+  REQUIRE(wheel.advance(now + 150ms, collect) == 1);
+  REQUIRE(expired == std::vector<int>{0, 1, 5, 100});
+  REQUIRE(wheel.empty());
+  REQUIRE_FALSE(wheel.nextExpiration());
+}
+
+TEST_CASE("TimerWheel holds move-only items and removes them on request", "[TimerWheel]") {
+  utils::TimerWheel<std::unique_ptr<int>> wheel;
+  const auto now = std::chrono::steady_clock::now();
+  for (int i = 0; i < 10; ++i) {
+    wheel.insert(now + std::chrono::hours(1), std::make_unique<int>(i));
+  }
+
+  int removed_sum = 0;
+  REQUIRE(wheel.removeIf([](const std::unique_ptr<int>& item) { return *item % 2 == 0; },
+      [&removed_sum](std::unique_ptr<int>&& item) { removed_sum += *item; }) == 5);
+  REQUIRE(removed_sum == 0 + 2 + 4 + 6 + 8);
+  REQUIRE(wheel.size() == 5);
+
+  wheel.clear();
+  REQUIRE(wheel.empty());
+}
+
+TEST_CASE("TimerWheel finds the items of the sparse slots across the end of the wheel", "[TimerWheel]") {
+  utils::TimerWheel<int> wheel(1ms, 200);
+  // move the wheel to the slot 190, so that the items due in more than 10 ms are in the slots after the end of the wheel
+  auto now = std::chrono::steady_clock::now();
+  const auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
+  now += std::chrono::milliseconds((190 - now_ms % 200 + 200) % 200);
+  std::vector<int> expired;
+  const auto collect = [&expired](int item) { expired.push_back(item); };
+  REQUIRE(wheel.advance(now, collect) == 0);
+
+  wheel.insert(now + 5ms, 5);
+  wheel.insert(now + 20ms, 20);
+  wheel.insert(now + 100ms, 100);
+  REQUIRE(wheel.nextExpiration() == now + 5ms);
+
+  REQUIRE(wheel.removeIf([](int item) { return item == 5; }, collect) == 1);
+  REQUIRE(wheel.nextExpiration() == now + 20ms);
+  REQUIRE(wheel.advance(now + 50ms, collect) == 1);
+  REQUIRE(wheel.nextExpiration() == now + 100ms);
+  REQUIRE(wheel.advance(now + 100ms, collect) == 1);
+  REQUIRE(expired == std::vector<int>{5, 20, 100});
+  REQUIRE(wheel.empty());
+}